@@ -1896,6 +1896,12 @@ virtual class NonlinearOptimizerParams {
   
   void setLinearSolverType(string solver);
   void setOrdering(const gtsam::Ordering& ordering);
+  string getOrderingType() const;
+  void setOrderingType(string type);
+  bool getLinearizeToHessian() const;
+  void setLinearizeToHessian(bool value);
+  bool getReuseEliminationPlan() const;
+  void setReuseEliminationPlan(bool value);
   void setIterativeParams(gtsam::IterativeOptimizationParameters* params);
 
   bool isMultifrontal() const;
@@ -2037,6 +2043,10 @@ class ISAM2Params {
   void setEnableDetailedResults(bool enableDetailedResults);
   bool isEnablePartialRelinearizationCheck() const;
   void setEnablePartialRelinearizationCheck(bool enablePartialRelinearizationCheck);
+  int getNumThreads() const;
+  void setNumThreads(int numThreads);
+  size_t getParallelRelinearizeThreshold() const;
+  void setParallelRelinearizeThreshold(size_t parallelRelinearizeThreshold);
 };
 
 class ISAM2Clique {
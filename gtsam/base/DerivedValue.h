@@ -98,6 +98,13 @@ public:
     return resultAsValue;
   }
 
+  /// Generic Value interface version of in-place retract, without allocating a new Value
+  virtual void retractInPlace_(const Vector& delta) {
+    // Call retract on the derived class and assign the result
+    const DERIVED retractResult = (static_cast<const DERIVED*>(this))->retract(delta);
+    static_cast<DERIVED&>(*this) = retractResult;
+  }
+
   /// Generic Value interface version of localCoordinates
   virtual Vector localCoordinates_(const Value& value2) const {
     // Cast the base class Value pointer to a derived class pointer
@@ -89,6 +89,38 @@ private:
   }
 };
 
+namespace traits {
+
+namespace internal {
+  /// Detects whether T declares a compile-time constant T::dimension
+  template<typename T>
+  struct has_dimension {
+    typedef char yes[1];
+    typedef char no[2];
+    template<typename U> static yes& test(char (*)[U::dimension + 1]);
+    template<typename U> static no& test(...);
+    static const bool value = sizeof(test<T>(0)) == sizeof(yes);
+  };
+}
+
+/**
+ * Compile-time dimensionality of the tangent space of a manifold type T, taken from the
+ * constant T::dimension that fixed-size types like Pose3 and Point3 declare, or Eigen::Dynamic
+ * for types whose dimension is only known at run time, like LieVector.  Used to size the
+ * fixed-size Jacobians of FixedNoiseModelFactor1..6.
+ */
+template<typename T, bool = internal::has_dimension<T>::value>
+struct dimension {
+  static const int value = Eigen::Dynamic;
+};
+
+template<typename T>
+struct dimension<T, true> {
+  static const int value = T::dimension;
+};
+
+} // namespace traits
+
 } // namespace gtsam
 
 /**
@@ -114,6 +114,19 @@ namespace gtsam {
      */
     virtual Value* retract_(const Vector& delta) const = 0;
 
+    /** Increment this value in-place, by the vector delta in its tangent space,
+     * equivalent to assigning the result of retract_() to this value.  The
+     * default implementation calls retract_(), DerivedValue overrides it with a
+     * version that does not allocate memory.
+     * @param delta The delta vector in the tangent space of this value, by
+     * which to increment this value.
+     */
+    virtual void retractInPlace_(const Vector& delta) {
+      Value* retracted = retract_(delta);
+      *this = *retracted;
+      retracted->deallocate_();
+    }
+
     /** Compute the coordinates in the tangent space of this value that
      * retract() would map to \c value.
      * @param value The value whose coordinates should be determined in the
@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testTiming.cpp
+ * @brief   Unit tests for the tic/toc timing instrumentation
+ */
+
+#include <gtsam/base/timing.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+  void timedWork(size_t n) {
+    gttic_(timedWork);
+    for(size_t i = 0; i < n; ++i) {
+      gttic_(timedStep);
+    }
+  }
+}
+
+/* ************************************************************************* */
+TEST(timing, nesting)
+{
+  tictoc_reset_();
+  {
+    gttic_(outer);
+    timedWork(3);
+    gttoc_(outer);
+    timedWork(2);
+  }
+
+  const size_t outerId = internal::getTicTocID("outer");
+  const size_t workId = internal::getTicTocID("timedWork");
+  const size_t stepId = internal::getTicTocID("timedStep");
+  boost::shared_ptr<internal::TimingOutline> root = internal::timingMerged();
+  EXPECT_LONGS_EQUAL(1, root->child(outerId, "outer")->count());
+  EXPECT_LONGS_EQUAL(1, root->child(outerId, "outer")->child(workId, "timedWork")->count());
+  EXPECT_LONGS_EQUAL(3, root->child(outerId, "outer")->child(workId, "timedWork")->child(stepId, "timedStep")->count());
+  EXPECT_LONGS_EQUAL(1, root->child(workId, "timedWork")->count());
+  EXPECT_LONGS_EQUAL(2, root->child(workId, "timedWork")->child(stepId, "timedStep")->count());
+
+  // Mismatched tic and toc
+  longtic_(first);
+  CHECK_EXCEPTION(internal::tocInternal(outerId, "outer"), std::invalid_argument);
+  longtoc_(first);
+  tictoc_reset_();
+}
+
+/* ************************************************************************* */
+TEST(timing, threads)
+{
+  // Every thread records into its own tree, and the trees are merged when reporting
+  tictoc_reset_();
+  timedWork(5);
+  boost::thread_group threads;
+  for(size_t t = 0; t < 4; ++t)
+    threads.create_thread(boost::bind(&timedWork, 10));
+  threads.join_all();
+
+  const size_t workId = internal::getTicTocID("timedWork");
+  const size_t stepId = internal::getTicTocID("timedStep");
+  boost::shared_ptr<internal::TimingOutline> work =
+    internal::timingMerged()->child(workId, "timedWork");
+  EXPECT_LONGS_EQUAL(5, work->count());
+  EXPECT_LONGS_EQUAL(45, work->child(stepId, "timedStep")->count());
+
+  // The calling thread only sees its own sections
+  EXPECT_LONGS_EQUAL(5, internal::timingThread().root->child(workId, "timedWork")
+    ->child(stepId, "timedStep")->count());
+  tictoc_reset_();
+}
+
+/* ************************************************************************* */
+TEST(timing, disabled)
+{
+  tictoc_reset_();
+  tictoc_setEnabled_(false);
+  timedWork(3);
+  tictoc_setEnabled_(true);
+  EXPECT_LONGS_EQUAL(0, internal::timingMerged()->child(
+    internal::getTicTocID("timedWork"), "timedWork")->count());
+  tictoc_reset_();
+}
+
+/* ************************************************************************* */
+TEST(timing, trace)
+{
+  tictoc_reset_();
+  tictoc_setTraceCapacity_(100);
+  {
+    gttic_(outer);
+    timedWork(2);
+  }
+  boost::thread worker(boost::bind(&timedWork, 1));
+  worker.join();
+
+  // One complete event per section, each on the thread that ran it
+  std::ostringstream trace;
+  tictoc_writeChromeTrace_(trace);
+  const std::string json = trace.str();
+  EXPECT(boost::starts_with(json, "{\"traceEvents\":["));
+  size_t nrEvents = 0, nrSteps = 0;
+  for(size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos; pos = json.find("\"ph\":\"X\"", pos + 1))
+    ++nrEvents;
+  for(size_t pos = json.find("\"name\":\"timedStep\""); pos != std::string::npos; pos = json.find("\"name\":\"timedStep\"", pos + 1))
+    ++nrSteps;
+  EXPECT_LONGS_EQUAL(6, nrEvents);
+  EXPECT_LONGS_EQUAL(3, nrSteps);
+
+  // Stacks of both threads, sorted
+  std::ostringstream folded;
+  tictoc_writeFoldedStacks_(folded);
+  std::istringstream lines(folded.str());
+  std::vector<std::string> stacks;
+  std::string line;
+  while(std::getline(lines, line))
+    stacks.push_back(line.substr(0, line.find(' ')));
+  EXPECT_LONGS_EQUAL(5, stacks.size());
+  EXPECT(stacks[0] == "outer");
+  EXPECT(stacks[1] == "outer;timedWork");
+  EXPECT(stacks[2] == "outer;timedWork;timedStep");
+  EXPECT(stacks[3] == "timedWork");
+  EXPECT(stacks[4] == "timedWork;timedStep");
+
+  // With a small ring buffer only the most recent sections are kept.  The last 4 events of
+  // timedWork(10) are the end of step 8, step 9, and the end of timedWork.
+  tictoc_setTraceCapacity_(4);
+  timedWork(10);
+  std::ostringstream recentStream;
+  tictoc_writeFoldedStacks_(recentStream);
+  const std::string recent = recentStream.str();
+  EXPECT(boost::starts_with(recent, "timedStep "));
+  EXPECT_LONGS_EQUAL(1, std::count(recent.begin(), recent.end(), '\n'));
+
+  tictoc_setTraceCapacity_(0);
+  tictoc_reset_();
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
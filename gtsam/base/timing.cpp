@@ -24,16 +24,118 @@
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <vector>
+#include <map>
+#include <utility>
 
 #include <gtsam/base/debug.h>
 #include <gtsam/base/timing.h>
 
+#ifndef GTSAM_USING_NEW_BOOST_TIMERS
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#endif
+
 namespace gtsam {
 namespace internal {
 
-GTSAM_EXPORT boost::shared_ptr<TimingOutline> timingRoot(
-    new TimingOutline("Total", getTicTocID("Total")));
-GTSAM_EXPORT boost::weak_ptr<TimingOutline> timingCurrent(timingRoot);
+GTSAM_EXPORT bool timingEnabled = true;
+GTSAM_EXPORT size_t timingTraceCapacity = 0;
+
+namespace {
+  // The timing trees of all threads that have used the instrumentation, so that they can be
+  // merged and reset together.  The mutex is only taken when a thread first uses the
+  // instrumentation and when reporting or resetting, never in gttic/gttoc themselves.  The
+  // trees are kept after their threads exit so that their times are still reported.
+  typedef std::vector<boost::shared_ptr<TimingThread> > TimingThreads;
+
+  boost::mutex& timingThreadsMutex() {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  TimingThreads& timingThreads() {
+    static TimingThreads threads;
+    return threads;
+  }
+
+  // The trees are owned by timingThreads(), so nothing is deleted at thread exit
+  void keepTimingThread(TimingThread*) {}
+
+  boost::thread_specific_ptr<TimingThread>& thisTimingThread() {
+    static boost::thread_specific_ptr<TimingThread> thread(&keepTimingThread);
+    return thread;
+  }
+
+  boost::mutex& ticTocIDMutex() {
+    static boost::mutex mutex;
+    return mutex;
+  }
+
+  // Whether gttic_/gttoc print each call.  The "timing-verbose" debug flag is read once, on the
+  // first timed section, since reading it inserts into debugFlags, which is not thread-safe.
+  bool timingVerbose() {
+    static const bool verbose = ISDEBUG("timing-verbose");
+    return verbose;
+  }
+
+  // Labels indexed by ID, the inverse of the map in getTicTocID, guarded by ticTocIDMutex()
+  std::vector<std::string>& ticTocLabels() {
+    static std::vector<std::string> labels;
+    return labels;
+  }
+
+  // Wall time in microseconds used to timestamp traced events
+  double traceTime() {
+#ifdef GTSAM_USING_NEW_BOOST_TIMERS
+    return double(boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+        boost::chrono::steady_clock::now().time_since_epoch()).count()) * 1e-3;
+#else
+    static const boost::posix_time::ptime origin =
+        boost::posix_time::microsec_clock::universal_time();
+    return double((boost::posix_time::microsec_clock::universal_time() - origin)
+        .total_microseconds());
+#endif
+  }
+
+  // A traced section, with its self time excluding nested sections, and the labels of the
+  // enclosing traced sections
+  struct TracedSection {
+    size_t id;
+    double begin;
+    double duration;
+    double self;
+    std::string stack;
+  };
+
+  // Match the begin and end events of a thread's trace into sections, in order of their end
+  std::vector<TracedSection> tracedSections(const TimingThread& thread) {
+    std::vector<TracedSection> sections;
+    // Open sections, with the total duration of the sections nested in them so far
+    std::vector<std::pair<TracedSection, double> > open;
+    BOOST_FOREACH(const TimingEvent& event, thread.trace()) {
+      if (event.begin) {
+        TracedSection section;
+        section.id = event.id;
+        section.begin = event.time;
+        section.stack = open.empty() ? "" : open.back().first.stack + ";";
+        section.stack += getTicTocLabel(event.id);
+        open.push_back(std::make_pair(section, 0.0));
+      } else if (!open.empty() && open.back().first.id == event.id) {
+        // Ends of sections whose begin was overwritten in the ring buffer are skipped
+        TracedSection section = open.back().first;
+        section.duration = event.time - section.begin;
+        section.self = section.duration - open.back().second;
+        open.pop_back();
+        if (!open.empty())
+          open.back().second += section.duration;
+        sections.push_back(section);
+      }
+    }
+    return sections;
+  }
+}
 
 /* ************************************************************************* */
 // Implementation of TimingOutline
@@ -52,10 +154,7 @@ void TimingOutline::add(size_t usecs, size_t usecsWall) {
 /* ************************************************************************* */
 TimingOutline::TimingOutline(const std::string& label, size_t myId) :
     myId_(myId), t_(0), tWall_(0), t2_(0.0), tIt_(0), tMax_(0), tMin_(0), n_(0), myOrder_(
-        0), lastChildOrder_(0), label_(label) {
-#ifdef GTSAM_USING_NEW_BOOST_TIMERS
-  timer_.stop();
-#endif
+        0), lastChildOrder_(0), label_(label), parent_(0) {
 }
 
 /* ************************************************************************* */
@@ -139,61 +238,60 @@ void TimingOutline::print2(const std::string& outline,
 
 /* ************************************************************************* */
 const boost::shared_ptr<TimingOutline>& TimingOutline::child(size_t child,
-    const std::string& label, const boost::weak_ptr<TimingOutline>& thisPtr) {
-  assert(thisPtr.lock().get() == this);
+    const char* label) {
   boost::shared_ptr<TimingOutline>& result = children_[child];
   if (!result) {
     // Create child if necessary
     result.reset(new TimingOutline(label, child));
     ++this->lastChildOrder_;
     result->myOrder_ = this->lastChildOrder_;
-    result->parent_ = thisPtr;
+    result->parent_ = this;
   }
   return result;
 }
 
 /* ************************************************************************* */
 void TimingOutline::ticInternal() {
+  assert(!timerActive_);
+  *timerActive_ = true;
 #ifdef GTSAM_USING_NEW_BOOST_TIMERS
-  assert(timer_.is_stopped());
-  timer_.start();
+  cpuStart_ = CpuClock::now();
+  wallStart_ = boost::chrono::steady_clock::now();
 #else
-  assert(!timerActive_);
   timer_.restart();
-  *timerActive_ = true;
-#endif
-
-#ifdef GTSAM_USE_TBB
+#  ifdef GTSAM_USE_TBB
   tbbTimer_ = tbb::tick_count::now();
+#  endif
 #endif
 }
 
 /* ************************************************************************* */
 void TimingOutline::tocInternal() {
+  assert(timerActive_);
+  *timerActive_ = false;
 #ifdef GTSAM_USING_NEW_BOOST_TIMERS
 
-  assert(!timer_.is_stopped());
-  timer_.stop();
-  size_t cpuTime = (timer_.elapsed().user + timer_.elapsed().system) / 1000;
-#  ifndef GTSAM_USE_TBB
-  size_t wallTime = timer_.elapsed().wall / 1000;
-#  endif
+  const boost::chrono::steady_clock::time_point wallEnd =
+      boost::chrono::steady_clock::now();
+  const CpuClock::time_point cpuEnd = CpuClock::now();
+  size_t cpuTime = size_t(
+      boost::chrono::duration_cast<boost::chrono::microseconds>(
+          cpuEnd - cpuStart_).count());
+  size_t wallTime = size_t(
+      boost::chrono::duration_cast<boost::chrono::microseconds>(
+          wallEnd - wallStart_).count());
 
 #else
 
-  assert(timerActive_);
   double elapsed = timer_.elapsed();
   size_t cpuTime = size_t(elapsed * 1000000.0);
-  *timerActive_ = false;
-#  ifndef GTSAM_USE_TBB
+#  ifdef GTSAM_USE_TBB
+  size_t wallTime = size_t(
+      (tbb::tick_count::now() - tbbTimer_).seconds() * 1e6);
+#  else
   size_t wallTime = cpuTime;
 #  endif
 
-#endif
-
-#ifdef GTSAM_USE_TBB
-  size_t wallTime = size_t(
-      (tbb::tick_count::now() - tbbTimer_).seconds() * 1e6);
 #endif
 
   add(cpuTime, wallTime);
@@ -211,19 +309,180 @@ void TimingOutline::finishedIteration() {
   }
 }
 
+/* ************************************************************************* */
+void TimingOutline::merge(const TimingOutline& other) {
+  t_ += other.t_;
+  tWall_ += other.tWall_;
+  t2_ += other.t2_;
+  tIt_ += other.tIt_;
+  n_ += other.n_;
+  tMax_ = std::max(tMax_, other.tMax_);
+  if (tMin_ == 0 || (other.tMin_ != 0 && other.tMin_ < tMin_))
+    tMin_ = other.tMin_;
+  // Merge children in the order they were created in other, so that children first seen in
+  // other are printed in a sensible order
+  typedef FastMap<size_t, boost::shared_ptr<TimingOutline> > ChildOrder;
+  ChildOrder childOrder;
+  BOOST_FOREACH(const ChildMap::value_type& child, other.children_) {
+    childOrder[child.second->myOrder_] = child.second;
+  }
+  BOOST_FOREACH(const ChildOrder::value_type& order_child, childOrder) {
+    const TimingOutline& otherChild = *order_child.second;
+    child(otherChild.myId_, otherChild.label_.c_str())->merge(otherChild);
+  }
+}
+
+/* ************************************************************************* */
+// Implementation of the per-thread timing trees
+/* ************************************************************************* */
+
+/* ************************************************************************* */
+TimingThread::TimingThread() : current(0), index(0), nextEvent(0) {
+  reset();
+}
+
+/* ************************************************************************* */
+void TimingThread::reset() {
+  static const size_t totalId = getTicTocID("Total");
+  root.reset(new TimingOutline("Total", totalId));
+  current = root.get();
+  events.clear();
+  nextEvent = 0;
+}
+
+/* ************************************************************************* */
+void TimingThread::record(size_t id, bool begin) {
+  TimingEvent event;
+  event.id = id;
+  event.begin = begin;
+  event.time = traceTime();
+  if (events.size() < timingTraceCapacity) {
+    events.push_back(event);
+  } else if (!events.empty()) {
+    if (nextEvent >= events.size())
+      nextEvent = 0;
+    events[nextEvent++] = event;
+  }
+}
+
+/* ************************************************************************* */
+std::vector<TimingEvent> TimingThread::trace() const {
+  // Until the buffer is full, nextEvent is 0 and the events are in order
+  const size_t oldest = events.empty() ? 0 : nextEvent % events.size();
+  std::vector<TimingEvent> result(events.begin() + oldest, events.end());
+  result.insert(result.end(), events.begin(), events.begin() + oldest);
+  return result;
+}
+
+/* ************************************************************************* */
+TimingThread& timingThread() {
+  TimingThread* thread = thisTimingThread().get();
+  if (!thread) {
+    boost::shared_ptr<TimingThread> created(new TimingThread());
+    {
+      boost::mutex::scoped_lock lock(timingThreadsMutex());
+      created->index = timingThreads().size();
+      timingThreads().push_back(created);
+    }
+    thisTimingThread().reset(created.get());
+    thread = created.get();
+  }
+  return *thread;
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<TimingOutline> timingMerged() {
+  boost::shared_ptr<TimingOutline> merged(
+      new TimingOutline("Total", getTicTocID("Total")));
+  boost::mutex::scoped_lock lock(timingThreadsMutex());
+  BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+    merged->merge(*thread->root);
+  }
+  return merged;
+}
+
+/* ************************************************************************* */
+void timingReset() {
+  boost::mutex::scoped_lock lock(timingThreadsMutex());
+  BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+    thread->reset();
+  }
+}
+
+/* ************************************************************************* */
+void timingSetTraceCapacity(size_t capacity) {
+  boost::mutex::scoped_lock lock(timingThreadsMutex());
+  timingTraceCapacity = capacity;
+  BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+    thread->events.clear();
+    thread->events.reserve(capacity);
+    thread->nextEvent = 0;
+  }
+}
+
+/* ************************************************************************* */
+void timingWriteChromeTrace(std::ostream& os) {
+  // Complete ("X") events, with times in microseconds.  Labels are C++ identifiers, so they
+  // need no escaping.
+  boost::mutex::scoped_lock lock(timingThreadsMutex());
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+    BOOST_FOREACH(const TracedSection& section, tracedSections(*thread)) {
+      os << (first ? "\n" : ",\n") << "{\"name\":\"" << getTicTocLabel(section.id)
+          << "\",\"cat\":\"gtsam\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread->index
+          << std::fixed << std::setprecision(3) << ",\"ts\":" << section.begin
+          << ",\"dur\":" << section.duration << "}";
+      first = false;
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+/* ************************************************************************* */
+void timingWriteFoldedStacks(std::ostream& os) {
+  // Sum the self times of identical stacks over all threads, flamegraph.pl needs integer counts
+  std::map<std::string, double> stacks;
+  {
+    boost::mutex::scoped_lock lock(timingThreadsMutex());
+    BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+      BOOST_FOREACH(const TracedSection& section, tracedSections(*thread)) {
+        stacks[section.stack] += section.self;
+      }
+    }
+  }
+  typedef std::map<std::string, double>::value_type Stack;
+  BOOST_FOREACH(const Stack& stack, stacks) {
+    os << stack.first << " " << size_t(stack.second + 0.5) << "\n";
+  }
+  os.flush();
+}
+
+/* ************************************************************************* */
+void timingFinishedIteration() {
+  boost::mutex::scoped_lock lock(timingThreadsMutex());
+  BOOST_FOREACH(const boost::shared_ptr<TimingThread>& thread, timingThreads()) {
+    thread->root->finishedIteration();
+  }
+}
+
 /* ************************************************************************* */
 // Generate or retrieve a unique global ID number that will be used to look up tic_/toc statements
 size_t getTicTocID(const char *descriptionC) {
   const std::string description(descriptionC);
-  // Global (static) map from strings to ID numbers and current next ID number
+  // Global (static) map from strings to ID numbers and current next ID number.  This is only
+  // called once for each gttic_ statement, when its static ID variable is initialized, but that
+  // may happen concurrently in different threads.
   static size_t nextId = 0;
   static gtsam::FastMap<std::string, size_t> idMap;
+  boost::mutex::scoped_lock lock(ticTocIDMutex());
 
   // Retrieve or add this string
   gtsam::FastMap<std::string, size_t>::const_iterator it = idMap.find(
       description);
   if (it == idMap.end()) {
     it = idMap.insert(std::make_pair(description, nextId)).first;
+    ticTocLabels().push_back(description);
     ++nextId;
   }
 
@@ -232,37 +491,47 @@ size_t getTicTocID(const char *descriptionC) {
 }
 
 /* ************************************************************************* */
-void ticInternal(size_t id, const char *labelC) {
-  const std::string label(labelC);
-  if (ISDEBUG("timing-verbose"))
+std::string getTicTocLabel(size_t id) {
+  boost::mutex::scoped_lock lock(ticTocIDMutex());
+  return ticTocLabels().at(id);
+}
+
+/* ************************************************************************* */
+void ticInternal(size_t id, const char *label) {
+  if (timingVerbose())
     std::cout << "gttic_(" << id << ", " << label << ")" << std::endl;
-  boost::shared_ptr<TimingOutline> node = //
-      timingCurrent.lock()->child(id, label, timingCurrent);
-  timingCurrent = node;
+  TimingThread& thread = timingThread();
+  TimingOutline* node = thread.current->child(id, label).get();
+  thread.current = node;
+  if (timingTraceCapacity > 0)
+    thread.record(id, true);
   node->ticInternal();
 }
 
 /* ************************************************************************* */
 void tocInternal(size_t id, const char *label) {
-  if (ISDEBUG("timing-verbose"))
+  if (timingVerbose())
     std::cout << "gttoc(" << id << ", " << label << ")" << std::endl;
-  boost::shared_ptr<TimingOutline> current(timingCurrent.lock());
+  TimingThread& thread = timingThread();
+  TimingOutline* current = thread.current;
   if (id != current->myId_) {
-    timingRoot->print();
+    thread.root->print();
     throw std::invalid_argument(
         (boost::format(
             "gtsam timing:  Mismatched tic/toc: gttoc(\"%s\") called when last tic was \"%s\".")
             % label % current->label_).str());
   }
-  if (!current->parent_.lock()) {
-    timingRoot->print();
+  if (!current->parent_) {
+    thread.root->print();
     throw std::invalid_argument(
         (boost::format(
             "gtsam timing:  Mismatched tic/toc: extra gttoc(\"%s\"), already at the root")
             % label).str());
   }
   current->tocInternal();
-  timingCurrent = current->parent_;
+  if (timingTraceCapacity > 0)
+    thread.record(id, false);
+  thread.current = current->parent_;
 }
 
 } // namespace internal
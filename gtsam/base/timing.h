@@ -18,6 +18,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <iosfwd>
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/version.hpp>
@@ -101,6 +103,32 @@
 //   too scope.  Note that if you use these, it may become difficult to ensure that you
 //   have matching gttic/gttoc statments.  You may want to consider reorganizing your timing
 //   outline to match the scope of your code.
+//
+// - Multithreaded code.  gttic and gttoc may be called concurrently from any number of threads,
+//   for example from inside TBB tasks.  Each thread records into its own timing tree, so
+//   gttic and gttoc never lock or share data with other threads, and a section timed on a
+//   worker thread nests under the sections that are open on that same worker thread.  The
+//   trees of all threads are merged by label when reporting, with their times summed.
+//   Printing, resetting and finishing iterations read or modify the trees of all threads, so
+//   they should only be called while no timed sections are running on other threads, e.g.
+//   between calls to ISAM2::update or between optimizer iterations.  Locks are only taken the
+//   first time a thread times a section, and the first time each gttic statement runs, when its
+//   label is interned into the static ID of the statement.  The "timing-verbose" debug flag,
+//   which prints every gttic and gttoc, is read once, so set it before the first timed section.
+//
+// - Switching timing off at run time.  tictoc_setEnabled_(false) turns gttic_, gttoc_, longtic_
+//   and longtoc_ into a single test of a global flag, so that instrumentation can be left in
+//   production builds at near-zero cost.  Only switch timing on or off outside of timed
+//   sections, since sections started while it is off are not recorded when they end.
+//
+// - Tracing.  The call tree only keeps cumulative statistics.  To see when sections ran and how
+//   they overlap across threads, call tictoc_setTraceCapacity_(n) to additionally record the
+//   begin and end time of every section in a ring buffer of the last n events of each thread.
+//   tictoc_writeChromeTrace_(stream) then writes them in the Chrome trace event JSON format,
+//   which can be opened in chrome://tracing or Perfetto, and tictoc_writeFoldedStacks_(stream)
+//   writes the self time of each call stack in the folded format read by flamegraph.pl.  When
+//   the ring buffer has wrapped around, sections whose begin was overwritten are left out, and
+//   call stacks start at the outermost section whose begin is still recorded.
 
 // Automatically use the new Boost timers if version is recent enough.
 #if BOOST_VERSION >= 104800
@@ -110,25 +138,36 @@
 #endif
 
 #ifdef GTSAM_USING_NEW_BOOST_TIMERS
-#  include <boost/timer/timer.hpp>
+#  include <boost/chrono/chrono.hpp>
+#  include <boost/chrono/thread_clock.hpp>
 #else
 #  include <boost/timer.hpp>
-#endif
-
-#ifdef GTSAM_USE_TBB
-#  include <tbb/tick_count.h>
-#  undef min
-#  undef max
-#  undef ERROR
+#  ifdef GTSAM_USE_TBB
+#    include <tbb/tick_count.h>
+#    undef min
+#    undef max
+#    undef ERROR
+#  endif
 #endif
 
 namespace gtsam {
 
   namespace internal {
     GTSAM_EXPORT size_t getTicTocID(const char *description);
+    GTSAM_EXPORT std::string getTicTocLabel(size_t id);
     GTSAM_EXPORT void ticInternal(size_t id, const char *label);
     GTSAM_EXPORT void tocInternal(size_t id, const char *label);
 
+#ifdef GTSAM_USING_NEW_BOOST_TIMERS
+    /// Clock measuring the CPU time of the calling thread, which is what a per-thread timing tree
+    /// should accumulate.  Falls back to wall time on platforms without a thread CPU clock.
+#  ifdef BOOST_CHRONO_HAS_THREAD_CLOCK
+    typedef boost::chrono::thread_clock CpuClock;
+#  else
+    typedef boost::chrono::steady_clock CpuClock;
+#  endif
+#endif
+
     /**
      * Timing Entry, arranged in a tree
      */
@@ -147,18 +186,19 @@ namespace gtsam {
       std::string label_;
 
       // Tree structure
-      boost::weak_ptr<TimingOutline> parent_; ///< parent pointer
+      TimingOutline* parent_; ///< parent pointer, the parent owns this node
       typedef FastMap<size_t, boost::shared_ptr<TimingOutline> > ChildMap;
       ChildMap children_; ///< subtrees
 
+      gtsam::ValueWithDefault<bool,false> timerActive_;
 #ifdef GTSAM_USING_NEW_BOOST_TIMERS
-      boost::timer::cpu_timer timer_;
+      CpuClock::time_point cpuStart_;
+      boost::chrono::steady_clock::time_point wallStart_;
 #else
       boost::timer timer_;
-      gtsam::ValueWithDefault<bool,false> timerActive_;
-#endif
-#ifdef GTSAM_USE_TBB
+#  ifdef GTSAM_USE_TBB
       tbb::tick_count tbbTimer_;
+#  endif
 #endif
       void add(size_t usecs, size_t usecsWall);
 
@@ -172,17 +212,72 @@ namespace gtsam {
       double min()  const { return double(tMin_)  / 1000000.0;} ///< min time, in seconds
       double max()  const { return double(tMax_)  / 1000000.0;} ///< max time, in seconds
       double mean() const { return self() / double(n_); } ///< mean self time, in seconds
+      size_t count() const { return n_; } ///< number of times this section was timed
       void print(const std::string& outline = "") const;
       void print2(const std::string& outline = "", const double parentTotal = -1.0) const;
-      const boost::shared_ptr<TimingOutline>&
-        child(size_t child, const std::string& label, const boost::weak_ptr<TimingOutline>& thisPtr);
+      const boost::shared_ptr<TimingOutline>& child(size_t child, const char* label);
       void ticInternal();
       void tocInternal();
       void finishedIteration();
 
+      /// Add the statistics of another tree into this one, matching children by ID
+      void merge(const TimingOutline& other);
+
       GTSAM_EXPORT friend void tocInternal(size_t id, const char *label);
     }; // \TimingOutline
 
+    /**
+     * The begin or end of a timed section, recorded when tracing is enabled
+     */
+    struct TimingEvent {
+      size_t id;   ///< ID of the label, see getTicTocID
+      bool begin;  ///< true for gttic, false for gttoc
+      double time; ///< wall time in microseconds, from an arbitrary but fixed origin
+    };
+
+    /**
+     * The timing tree of one thread, the node in it of the innermost open gttic, and the ring
+     * buffer of its most recent events when tracing
+     */
+    struct GTSAM_EXPORT TimingThread {
+      boost::shared_ptr<TimingOutline> root;
+      TimingOutline* current;
+      size_t index; ///< order in which the thread first used timing, the thread ID in traces
+      std::vector<TimingEvent> events; ///< ring buffer of at most timingTraceCapacity events
+      size_t nextEvent; ///< position in events overwritten next once the buffer is full
+      TimingThread();
+      void reset(); ///< Start a new, empty tree and trace
+      void record(size_t id, bool begin); ///< Add an event to the trace
+      std::vector<TimingEvent> trace() const; ///< The recorded events, oldest first
+    };
+
+    /// The timing tree of the calling thread, created on its first use
+    GTSAM_EXPORT TimingThread& timingThread();
+
+    /// The timing trees of all threads merged into a new tree
+    GTSAM_EXPORT boost::shared_ptr<TimingOutline> timingMerged();
+
+    /// Reset the timing trees of all threads
+    GTSAM_EXPORT void timingReset();
+
+    /// Finish the current iteration in the timing trees of all threads
+    GTSAM_EXPORT void timingFinishedIteration();
+
+    /// Set the number of events traced per thread, clearing the traces of all threads
+    GTSAM_EXPORT void timingSetTraceCapacity(size_t capacity);
+
+    /// Write the traces of all threads as Chrome trace event JSON
+    GTSAM_EXPORT void timingWriteChromeTrace(std::ostream& os);
+
+    /// Write the self time in microseconds of each traced call stack in folded format
+    GTSAM_EXPORT void timingWriteFoldedStacks(std::ostream& os);
+
+    /// Whether gttic_ and gttoc_ record anything, see tictoc_setEnabled_
+    GTSAM_EXTERN_EXPORT bool timingEnabled;
+
+    /// Number of events traced per thread, 0 when not tracing, see tictoc_setTraceCapacity_
+    GTSAM_EXTERN_EXPORT size_t timingTraceCapacity;
+
     /**
      * No documentation
      */
@@ -191,14 +286,13 @@ namespace gtsam {
       size_t id_;
       const char *label_;
       bool isSet_;
+      bool enabled_;
     public:
-      AutoTicToc(size_t id, const char* label) : id_(id), label_(label), isSet_(true) { ticInternal(id_, label_); }
-      void stop() { tocInternal(id_, label_); isSet_ = false; }
+      AutoTicToc(size_t id, const char* label) : id_(id), label_(label), isSet_(true), enabled_(timingEnabled) {
+        if(enabled_) ticInternal(id_, label_); }
+      void stop() { if(enabled_) tocInternal(id_, label_); isSet_ = false; }
       ~AutoTicToc() { if(isSet_) stop(); }
     };
-
-    GTSAM_EXTERN_EXPORT boost::shared_ptr<TimingOutline> timingRoot;
-    GTSAM_EXTERN_EXPORT boost::weak_ptr<TimingOutline> timingCurrent;
   }
 
 // Tic and toc functions that are always active (whether or not ENABLE_TIMING is defined)
@@ -219,35 +313,50 @@ namespace gtsam {
 // tic
 #define longtic_(label) \
   static const size_t label##_id_tic = ::gtsam::internal::getTicTocID(#label); \
-  ::gtsam::internal::ticInternal(label##_id_tic, #label)
+  if(::gtsam::internal::timingEnabled) ::gtsam::internal::ticInternal(label##_id_tic, #label)
 
 // toc
 #define longtoc_(label) \
   static const size_t label##_id_toc = ::gtsam::internal::getTicTocID(#label); \
-  ::gtsam::internal::tocInternal(label##_id_toc, #label)
+  if(::gtsam::internal::timingEnabled) ::gtsam::internal::tocInternal(label##_id_toc, #label)
 
 // indicate iteration is finished
 inline void tictoc_finishedIteration_() {
-  ::gtsam::internal::timingRoot->finishedIteration(); }
+  ::gtsam::internal::timingFinishedIteration(); }
 
 // print
 inline void tictoc_print_() {
-  ::gtsam::internal::timingRoot->print(); }
+  ::gtsam::internal::timingMerged()->print(); }
 
 // print mean and standard deviation
 inline void tictoc_print2_() {
-  ::gtsam::internal::timingRoot->print2(); }
+  ::gtsam::internal::timingMerged()->print2(); }
 
-// get a node by label and assign it to variable
+// get a node of the calling thread by label and assign it to variable
 #define tictoc_getNode(variable, label) \
   static const size_t label##_id_getnode = ::gtsam::internal::getTicTocID(#label); \
   const boost::shared_ptr<const ::gtsam::internal::TimingOutline> variable = \
-  ::gtsam::internal::timingCurrent.lock()->child(label##_id_getnode, #label, ::gtsam::internal::timingCurrent);
+  ::gtsam::internal::timingThread().current->child(label##_id_getnode, #label);
 
 // reset
 inline void tictoc_reset_() {
-  ::gtsam::internal::timingRoot.reset(new ::gtsam::internal::TimingOutline("Total", ::gtsam::internal::getTicTocID("Total")));
-  ::gtsam::internal::timingCurrent = ::gtsam::internal::timingRoot; }
+  ::gtsam::internal::timingReset(); }
+
+// switch recording on or off at run time
+inline void tictoc_setEnabled_(bool enabled) {
+  ::gtsam::internal::timingEnabled = enabled; }
+
+// trace the last 'capacity' events of each thread, or stop tracing if 0
+inline void tictoc_setTraceCapacity_(size_t capacity) {
+  ::gtsam::internal::timingSetTraceCapacity(capacity); }
+
+// write the traced events as Chrome trace event JSON
+inline void tictoc_writeChromeTrace_(std::ostream& os) {
+  ::gtsam::internal::timingWriteChromeTrace(os); }
+
+// write the traced call stacks in the folded format of flamegraph.pl
+inline void tictoc_writeFoldedStacks_(std::ostream& os) {
+  ::gtsam::internal::timingWriteFoldedStacks(os); }
 
 #ifdef ENABLE_TIMING
 #define gttic(label) gttic_(label)
@@ -29,7 +29,11 @@
 #include <boost/assign/std/vector.hpp>
 using boost::assign::operator+=;
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/tss.hpp>
 
 #include <list>
 #include <cmath>
@@ -46,6 +50,126 @@ namespace gtsam {
   int DecisionTree<L, Y>::Node::nrNodes = 0;
 #endif
 
+  /*********************************************************************************/
+  // UniqueTable
+  /*********************************************************************************/
+  // Leaf and Choice nodes are looked up here before being used, so that structurally
+  // identical subtrees are one and the same node ("hash-consing"), and equal functions
+  // typically have the same root.  The table of each thread only refers to nodes weakly:
+  // it never keeps a node alive, and entries of destroyed nodes are removed whenever the
+  // table has doubled in size since the last sweep, so its size stays proportional to the
+  // number of nodes in use.  Nodes are immutable, so they can be shared across threads.
+  template<typename L, typename Y>
+  class DecisionTree<L, Y>::UniqueTable: boost::noncopyable {
+
+    typedef boost::unordered_multimap<size_t, boost::weak_ptr<const Node> > Nodes;
+
+    /** the nodes, indexed by their hash */
+    Nodes nodes_;
+
+    /** size of the table at which to remove the entries of destroyed nodes */
+    size_t purgeSize_;
+
+    static const size_t MinPurgeSize = 1024;
+
+    UniqueTable() :
+      purgeSize_(MinPurgeSize) {}
+
+    /** remove the entries of destroyed nodes */
+    void purge() {
+      for (typename Nodes::iterator it = nodes_.begin(); it != nodes_.end();) {
+        if (it->second.expired())
+          it = nodes_.erase(it);
+        else
+          ++it;
+      }
+      purgeSize_ = 2 * nodes_.size();
+      if (purgeSize_ < MinPurgeSize)
+        purgeSize_ = MinPurgeSize;
+    }
+
+  public:
+
+    /** the table of the calling thread */
+    static UniqueTable& ThisThread() {
+      static boost::thread_specific_ptr<UniqueTable> table;
+      if (!table.get())
+        table.reset(new UniqueTable());
+      return *table;
+    }
+
+    /** return the node identical to node, which has the given hash, or null if there is none */
+    NodePtr find(const Node& node, size_t hash) const {
+      typedef typename Nodes::const_iterator Iterator;
+      std::pair<Iterator, Iterator> range = nodes_.equal_range(hash);
+      for (Iterator it = range.first; it != range.second; ++it) {
+        NodePtr existing = it->second.lock();
+        if (existing && existing->sameNode(node))
+          return existing;
+      }
+      return NodePtr();
+    }
+
+    /** add a node that is not in the table yet */
+    void insert(const NodePtr& node, size_t hash) {
+      nodes_.insert(std::make_pair(hash, boost::weak_ptr<const Node>(node)));
+      if (nodes_.size() >= purgeSize_)
+        purge();
+    }
+
+    /** return the node identical to node, adding node if there is none */
+    NodePtr unique(const NodePtr& node) {
+      const size_t hash = node->hash();
+      NodePtr existing = find(*node, hash);
+      if (existing)
+        return existing;
+      insert(node, hash);
+      return node;
+    }
+
+    /** number of entries, including those of destroyed nodes not removed yet */
+    size_t size() const {
+      return nodes_.size();
+    }
+
+  }; // UniqueTable
+
+  /*********************************************************************************/
+  // Cache
+  /*********************************************************************************/
+  // Binary apply recurses on pairs of nodes of f and g, and shared subtrees make the same
+  // pair come up many times.  The cache memoizes the result for each pair, keyed on the
+  // addresses of the nodes: it lives for a single top-level apply only, during which f and g
+  // keep all of their nodes alive and the operator does not change.
+  template<typename L, typename Y>
+  class DecisionTree<L, Y>::Cache: boost::noncopyable {
+
+    typedef std::pair<const Node*, const Node*> Operands;
+    typedef boost::unordered_map<Operands, NodePtr> Results;
+
+    /** the results so far */
+    Results results_;
+
+  public:
+
+    /** h = f op g, only recursing on pairs of nodes that were not seen before */
+    NodePtr apply(const Node& f, const Node& g, const Binary& op) {
+      const Operands operands(&f, &g);
+      typename Results::const_iterator it = results_.find(operands);
+      if (it != results_.end())
+        return it->second;
+      NodePtr h = f.apply_f_op_g(*this, g, op);
+      results_.insert(std::make_pair(operands, h));
+      return h;
+    }
+
+    /** number of pairs of nodes visited */
+    size_t size() const {
+      return results_.size();
+    }
+
+  }; // Cache
+
   /*********************************************************************************/
   // Leaf
   /*********************************************************************************/
@@ -61,6 +185,22 @@ namespace gtsam {
     Leaf(const Y& constant) :
       constant_(constant) {}
 
+    /** The leaf with the given constant from the unique table, created if needed.  Leaves of
+     *  types without a hash, see DecisionTreeLeafHash, are always created. */
+    static NodePtr Unique(const Y& constant) {
+      if (!DecisionTreeLeafHash<Y>::shared)
+        return NodePtr(new Leaf(constant));
+      UniqueTable& table = UniqueTable::ThisThread();
+      const Leaf candidate(constant);
+      const size_t hash = candidate.hash();
+      NodePtr leaf = table.find(candidate, hash);
+      if (!leaf) {
+        leaf.reset(new Leaf(constant));
+        table.insert(leaf, hash);
+      }
+      return leaf;
+    }
+
     /** return the constant */
     const Y& constant() const {
       return constant_;
@@ -83,6 +223,16 @@ namespace gtsam {
       return fabs(double(this->constant_ - other->constant_)) < tol;
     }
 
+    /** hash of the constant, for the unique table */
+    size_t hash() const {
+      return DecisionTreeLeafHash<Y>::hash(constant_);
+    }
+
+    /** exact equality, for the unique table */
+    bool sameNode(const Node& q) const {
+      return sameLeaf(q);
+    }
+
     /** print */
     void print(const std::string& s) const {
       bool showZero = true;
@@ -103,8 +253,7 @@ namespace gtsam {
 
     /** apply unary operator */
     NodePtr apply(const Unary& op) const {
-      NodePtr f(new Leaf(op(constant_)));
-      return f;
+      return Unique(op(constant_));
     }
 
     // Apply binary operator "h = f op g" on Leaf node
@@ -112,24 +261,23 @@ namespace gtsam {
     // Simply calls apply on argument to call correct virtual method:
     // fL.apply_f_op_g(gL) -> gL.apply_g_op_fL(fL) (below)
     // fL.apply_f_op_g(gC) -> gC.apply_g_op_fL(fL) (Choice)
-    NodePtr apply_f_op_g(const Node& g, const Binary& op) const {
-      return g.apply_g_op_fL(*this, op);
+    NodePtr apply_f_op_g(Cache& cache, const Node& g, const Binary& op) const {
+      return g.apply_g_op_fL(cache, *this, op);
     }
 
     // Applying binary operator to two leaves results in a leaf
-    NodePtr apply_g_op_fL(const Leaf& fL, const Binary& op) const {
-      NodePtr h(new Leaf(op(fL.constant_, constant_))); // fL op gL
-      return h;
+    NodePtr apply_g_op_fL(Cache& cache, const Leaf& fL, const Binary& op) const {
+      return Unique(op(fL.constant_, constant_)); // fL op gL
     }
 
     // If second argument is a Choice node, call it's apply with leaf as second
-    NodePtr apply_g_op_fC(const Choice& fC, const Binary& op) const {
-      return fC.apply_fC_op_gL(*this, op); // operand order back to normal
+    NodePtr apply_g_op_fC(Cache& cache, const Choice& fC, const Binary& op) const {
+      return fC.apply_fC_op_gL(cache, *this, op); // operand order back to normal
     }
 
-    /** choose a branch, create new memory ! */
+    /** choose a branch, which is the unique leaf with this constant */
     NodePtr choose(const L& label, size_t index) const {
-      return NodePtr(new Leaf(constant()));
+      return Unique(constant());
     }
 
     bool isLeaf() const { return true; }
@@ -162,18 +310,16 @@ namespace gtsam {
 #endif
     }
 
-    /** If all branches of a choice node f are the same, just return a branch */
+    /** If all branches of a choice node f are the same, just return a branch,
+     *  otherwise return the node identical to f from the unique table */
     static NodePtr Unique(const ChoicePtr& f) {
 #ifndef DT_NO_PRUNING
       if (f->allSame_) {
         assert(f->branches().size() > 0);
-        NodePtr f0 = f->branches_[0];
-        assert(f0->isLeaf());
-        NodePtr newLeaf(new Leaf(boost::dynamic_pointer_cast<const Leaf>(f0)->constant()));
-        return newLeaf;
-      } else
+        return f->branches_[0];
+      }
 #endif
-        return f;
+      return UniqueTable::ThisThread().unique(f);
     }
 
     bool isLeaf() const { return false; }
@@ -187,7 +333,7 @@ namespace gtsam {
     /**
      * Construct from applying binary op to two Choice nodes
      */
-    Choice(const Choice& f, const Choice& g, const Binary& op) :
+    Choice(Cache& cache, const Choice& f, const Choice& g, const Binary& op) :
       allSame_(true) {
 
       // Choose what to do based on label
@@ -197,21 +343,21 @@ namespace gtsam {
         size_t count = f.nrChoices();
         branches_.reserve(count);
         for (size_t i = 0; i < count; i++)
-          push_back(f.branches_[i]->apply_f_op_g(g, op));
+          push_back(cache.apply(*f.branches_[i], g, op));
       } else if (g.label() > f.label()) {
         // f lower than g
         label_ = g.label();
         size_t count = g.nrChoices();
         branches_.reserve(count);
         for (size_t i = 0; i < count; i++)
-          push_back(g.branches_[i]->apply_g_op_fC(f, op));
+          push_back(cache.apply(f, *g.branches_[i], op));
       } else {
         // f same level as g
         label_ = f.label();
         size_t count = f.nrChoices();
         branches_.reserve(count);
         for (size_t i = 0; i < count; i++)
-          push_back(f.branches_[i]->apply_f_op_g(*g.branches_[i], op));
+          push_back(cache.apply(*f.branches_[i], *g.branches_[i], op));
       }
     }
 
@@ -229,9 +375,9 @@ namespace gtsam {
 
     /** add a branch: TODO merge into constructor */
     void push_back(const NodePtr& node) {
-      // allSame_ is restricted to leaf nodes in a decision tree
+      // subtrees are shared through the unique table, so identical ones are the same node
       if (allSame_ && !branches_.empty()) {
-        allSame_ = node->sameLeaf(*branches_.back());
+        allSame_ = node == branches_.back() || node->sameLeaf(*branches_.back());
       }
       branches_.push_back(node);
     }
@@ -288,6 +434,25 @@ namespace gtsam {
       return true;
     }
 
+    /** hash of the label and the branches, for the unique table */
+    size_t hash() const {
+      size_t seed = boost::hash<L>()(label_);
+      BOOST_FOREACH(const NodePtr& branch, branches_)
+        boost::hash_combine(seed, branch.get());
+      return seed;
+    }
+
+    /** same label and the very same branches, for the unique table */
+    bool sameNode(const Node& q) const {
+      const Choice* other = dynamic_cast<const Choice*> (&q);
+      if (!other) return false;
+      if (this->label_ != other->label_) return false;
+      if (branches_.size() != other->branches_.size()) return false;
+      for (size_t i = 0; i < branches_.size(); i++)
+        if (branches_[i] != other->branches_[i]) return false;
+      return true;
+    }
+
     /** evaluate */
     const Y& operator()(const Assignment<L>& x) const {
 #ifndef NDEBUG
@@ -325,30 +490,30 @@ namespace gtsam {
     // Simply calls apply on argument to call correct virtual method:
     // fC.apply_f_op_g(gL) -> gL.apply_g_op_fC(fC) -> (Leaf)
     // fC.apply_f_op_g(gC) -> gC.apply_g_op_fC(fC) -> (below)
-    NodePtr apply_f_op_g(const Node& g, const Binary& op) const {
-      return g.apply_g_op_fC(*this, op);
+    NodePtr apply_f_op_g(Cache& cache, const Node& g, const Binary& op) const {
+      return g.apply_g_op_fC(cache, *this, op);
     }
 
     // If second argument of binary op is Leaf node, recurse on branches
-    NodePtr apply_g_op_fL(const Leaf& fL, const Binary& op) const {
+    NodePtr apply_g_op_fL(Cache& cache, const Leaf& fL, const Binary& op) const {
       boost::shared_ptr<Choice> h(new Choice(label(), nrChoices()));
       BOOST_FOREACH(NodePtr branch, branches_)
-              h->push_back(fL.apply_f_op_g(*branch, op));
+              h->push_back(cache.apply(fL, *branch, op));
       return Unique(h);
     }
 
     // If second argument of binary op is Choice, call constructor
-    NodePtr apply_g_op_fC(const Choice& fC, const Binary& op) const {
-      boost::shared_ptr<Choice> h(new Choice(fC, *this, op));
+    NodePtr apply_g_op_fC(Cache& cache, const Choice& fC, const Binary& op) const {
+      boost::shared_ptr<Choice> h(new Choice(cache, fC, *this, op));
       return Unique(h);
     }
 
     // If second argument of binary op is Leaf
     template<typename OP>
-    NodePtr apply_fC_op_gL(const Leaf& gL, OP op) const {
+    NodePtr apply_fC_op_gL(Cache& cache, const Leaf& gL, OP op) const {
       boost::shared_ptr<Choice> h(new Choice(label(), nrChoices()));
       BOOST_FOREACH(const NodePtr& branch, branches_)
-              h->push_back(branch->apply_f_op_g(gL, op));
+              h->push_back(cache.apply(*branch, gL, op));
       return Unique(h);
     }
 
@@ -381,7 +546,7 @@ namespace gtsam {
   /*********************************************************************************/
   template<typename L, typename Y>
   DecisionTree<L, Y>::DecisionTree(const Y& y)  {
-    root_ = NodePtr(new Leaf(y));
+    root_ = Leaf::Unique(y);
   }
 
   /*********************************************************************************/
@@ -389,7 +554,7 @@ namespace gtsam {
   DecisionTree<L, Y>::DecisionTree(//
       const L& label, const Y& y1, const Y& y2)  {
     boost::shared_ptr<Choice> a(new Choice(label, 2));
-    NodePtr l1(new Leaf(y1)), l2(new Leaf(y2));
+    NodePtr l1(Leaf::Unique(y1)), l2(Leaf::Unique(y2));
     a->push_back(l1);
     a->push_back(l2);
     root_ = Choice::Unique(a);
@@ -402,7 +567,7 @@ namespace gtsam {
     if (labelC.second != 2) throw std::invalid_argument(
         "DecisionTree: binary constructor called with non-binary label");
     boost::shared_ptr<Choice> a(new Choice(labelC.first, 2));
-    NodePtr l1(new Leaf(y1)), l2(new Leaf(y2));
+    NodePtr l1(Leaf::Unique(y1)), l2(Leaf::Unique(y2));
     a->push_back(l1);
     a->push_back(l2);
     root_ = Choice::Unique(a);
@@ -546,7 +711,7 @@ namespace gtsam {
       }
       boost::shared_ptr<Choice> choice(new Choice(begin->first, endY - beginY));
       for (ValueIt y = beginY; y != endY; y++)
-        choice->push_back(NodePtr(new Leaf(*y)));
+        choice->push_back(Leaf::Unique(*y));
       return Choice::Unique(choice);
     }
 
@@ -578,7 +743,7 @@ namespace gtsam {
     // ugliness below because apparently we can't have templated virtual functions
     // If leaf, apply unary conversion "op" and create a unique leaf
     const MXLeaf* leaf = dynamic_cast<const MXLeaf*> (f.get());
-    if (leaf) return NodePtr(new Leaf(op(leaf->constant())));
+    if (leaf) return Leaf::Unique(op(leaf->constant()));
 
     // Check if Choice
     boost::shared_ptr<const MXChoice> choice = boost::dynamic_pointer_cast<const MXChoice> (f);
@@ -628,8 +793,10 @@ namespace gtsam {
   template<typename L, typename Y>
   DecisionTree<L, Y> DecisionTree<L, Y>::apply(const DecisionTree& g,
       const Binary& op) const {
-    // apply the operaton on the root of both diagrams
-    NodePtr h = root_->apply_f_op_g(*g.root_, op);
+    // apply the operaton on the root of both diagrams, visiting each pair of
+    // subtrees only once
+    Cache cache;
+    NodePtr h = cache.apply(*root_, *g.root_, op);
     // create a new class with the resulting root "h"
     DecisionTree result(h);
     return result;
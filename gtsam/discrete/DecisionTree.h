@@ -21,16 +21,50 @@
 
 #include <gtsam/discrete/Assignment.h>
 #include <boost/function.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/utility/enable_if.hpp>
 #include <iostream>
+#include <string>
 #include <vector>
 #include <map>
 
 namespace gtsam {
 
+  /**
+   * Hashing of the leaf values of a DecisionTree, with which identical leaves are shared.  Only
+   * arithmetic types and std::string are hashed by default: the leaves of other types are never
+   * shared, which gives the same functions, only with more nodes.  Specialize this with
+   * \c shared = true and a \c hash function to share the leaves of another type.
+   */
+  template<typename Y, typename ENABLE = void>
+  struct DecisionTreeLeafHash {
+    static const bool shared = false;
+    static size_t hash(const Y&) { return 0; }
+  };
+
+  /// Arithmetic leaves are hashed with boost::hash
+  template<typename Y>
+  struct DecisionTreeLeafHash<Y, typename boost::enable_if<boost::is_arithmetic<Y> >::type> {
+    static const bool shared = true;
+    static size_t hash(const Y& y) { return boost::hash<Y>()(y); }
+  };
+
+  /// String leaves are hashed with boost::hash
+  template<>
+  struct DecisionTreeLeafHash<std::string> {
+    static const bool shared = true;
+    static size_t hash(const std::string& y) { return boost::hash<std::string>()(y); }
+  };
+
   /**
    * Decision Tree
    * L = label for variables
    * Y = function range (any algebra), e.g., bool, int, double
+   *
+   * Besides copying, Y needs ==, a difference convertible to double for equals(), output with <<
+   * and a conversion to bool for printing.  The leaves are shared if DecisionTreeLeafHash<Y> says
+   * so, and the labels L need a boost::hash.
    */
   template<typename L, typename Y>
   class DecisionTree {
@@ -48,6 +82,12 @@ namespace gtsam {
     class Leaf;
     class Choice;
 
+    /** Per-thread table of the nodes in use, so identical subtrees are shared */
+    class UniqueTable;
+
+    /** Results of a binary apply for pairs of nodes, so shared subtrees are visited once */
+    class Cache;
+
     /** ------------------------ Node base class --------------------------- */
     class Node {
     public:
@@ -80,11 +120,13 @@ namespace gtsam {
       virtual bool sameLeaf(const Leaf& q) const = 0;
       virtual bool sameLeaf(const Node& q) const = 0;
       virtual bool equals(const Node& other, double tol = 1e-9) const = 0;
+      virtual size_t hash() const = 0;
+      virtual bool sameNode(const Node& q) const = 0;
       virtual const Y& operator()(const Assignment<L>& x) const = 0;
       virtual Ptr apply(const Unary& op) const = 0;
-      virtual Ptr apply_f_op_g(const Node&, const Binary&) const = 0;
-      virtual Ptr apply_g_op_fL(const Leaf&, const Binary&) const = 0;
-      virtual Ptr apply_g_op_fC(const Choice&, const Binary&) const = 0;
+      virtual Ptr apply_f_op_g(Cache&, const Node&, const Binary&) const = 0;
+      virtual Ptr apply_g_op_fL(Cache&, const Leaf&, const Binary&) const = 0;
+      virtual Ptr apply_g_op_fC(Cache&, const Choice&, const Binary&) const = 0;
       virtual Ptr choose(const L& label, size_t index) const = 0;
       virtual bool isLeaf() const = 0;
     };
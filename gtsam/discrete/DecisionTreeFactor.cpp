@@ -19,6 +19,7 @@
 
 #include <gtsam/discrete/DecisionTreeFactor.h>
 #include <gtsam/discrete/DiscreteConditional.h>
+#include <gtsam/discrete/DiscreteTable.h>
 #include <gtsam/base/FastSet.h>
 
 #include <boost/foreach.hpp>
@@ -29,18 +30,30 @@ using namespace std;
 namespace gtsam {
 
   /* ******************************************************************************** */
-  DecisionTreeFactor::DecisionTreeFactor() {
+  DecisionTreeFactor::DecisionTreeFactor() : dense_(computeDense()) {
   }
 
   /* ******************************************************************************** */
   DecisionTreeFactor::DecisionTreeFactor(const DiscreteKeys& keys,
       const ADT& potentials) :
-      DiscreteFactor(keys.indices()), Potentials(keys, potentials) {
+      DiscreteFactor(keys.indices()), Potentials(keys, potentials), dense_(computeDense()) {
   }
 
   /* *************************************************************************/
   DecisionTreeFactor::DecisionTreeFactor(const DiscreteConditional& c) :
-      DiscreteFactor(c.keys()), Potentials(c) {
+      DiscreteFactor(c.keys()), Potentials(c), dense_(c.isDense()) {
+  }
+
+  /* ************************************************************************* */
+  bool DecisionTreeFactor::computeDense() const {
+    // Tables larger than DiscreteTable::MaxPreferredSize are never used, so skip the traversal
+    size_t size = 1;
+    BOOST_FOREACH(Key j, keys()) {
+      size *= cardinality(j);
+      if (size > DiscreteTable::MaxPreferredSize)
+        return false;
+    }
+    return DiscreteTable::Dense(*this, size);
   }
 
   /* ************************************************************************* */
@@ -64,6 +77,21 @@ namespace gtsam {
   /* ************************************************************************* */
   DecisionTreeFactor DecisionTreeFactor::apply(const DecisionTreeFactor& f,
     ADT::Binary op) const {
+    // Use dense tables for dense factors on small domains
+    std::vector<const DecisionTreeFactor*> operands;
+    operands.push_back(this);
+    operands.push_back(&f);
+    if (DiscreteTable::Preferred(operands)) {
+      typedef double (*Function)(const double&, const double&);
+      const Function* function = op.target<Function>();
+      if (function && *function == &ADT::Ring::mul)
+        return (DiscreteTable(*this) * DiscreteTable(f)).toDecisionTreeFactor();
+      else if (function && *function == &safe_div)
+        return (DiscreteTable(*this) / DiscreteTable(f)).toDecisionTreeFactor();
+      else
+        return DiscreteTable(*this).apply(DiscreteTable(f), op).toDecisionTreeFactor();
+    }
+
     map<Key,size_t> cs; // new cardinalities
     // make unique key-cardinality map
     BOOST_FOREACH(Key j, keys()) cs[j] = cardinality(j);
@@ -79,60 +107,94 @@ namespace gtsam {
   }
 
   /* ************************************************************************* */
-  DecisionTreeFactor::shared_ptr DecisionTreeFactor::combine(size_t nrFrontals,
-    ADT::Binary op) const {
-
-    if (nrFrontals > size()) throw invalid_argument(
-        (boost::format(
-            "DecisionTreeFactor::combine: invalid number of frontal keys %d, nr.keys=%d")
-            % nrFrontals % size()).str());
-
-    // sum over nrFrontals keys
-    size_t i;
-    ADT result(*this);
-    for (i = 0; i < nrFrontals; i++) {
-      Key j = keys()[i];
-      result = result.combine(j, cardinality(j), op);
+  namespace {
+    // The dense-table combinations, so that sum and max run the DiscreteTable kernels with
+    // concrete operators, as EliminateDiscrete does, instead of calling a boost::function per entry
+    struct TableSum {
+      DiscreteTable operator()(const DiscreteTable& table, const Ordering& frontalKeys) const {
+        return table.sum(frontalKeys);
+      }
+    };
+
+    struct TableMax {
+      DiscreteTable operator()(const DiscreteTable& table, const Ordering& frontalKeys) const {
+        return table.max(frontalKeys);
+      }
+    };
+
+    struct TableCombine {
+      const DecisionTreeFactor::ADT::Binary& op;
+      TableCombine(const DecisionTreeFactor::ADT::Binary& op) : op(op) {}
+      DiscreteTable operator()(const DiscreteTable& table, const Ordering& frontalKeys) const {
+        return table.combine(frontalKeys, op);
+      }
+    };
+
+    /* ************************************************************************* */
+    Ordering firstKeys(const DecisionTreeFactor& factor, size_t nrFrontals) {
+      if (nrFrontals > factor.size()) throw invalid_argument(
+          (boost::format(
+              "DecisionTreeFactor::combine: invalid number of frontal keys %d, nr.keys=%d")
+              % nrFrontals % factor.size()).str());
+      return Ordering(factor.keys().begin(), factor.keys().begin() + nrFrontals);
     }
 
-    // create new factor, note we start keys after nrFrontals
-    DiscreteKeys dkeys;
-    for (; i < keys().size(); i++) {
-      Key j = keys()[i];
-      dkeys.push_back(DiscreteKey(j,cardinality(j)));
+    /* ************************************************************************* */
+    template<class TABLE_COMBINE>
+    DecisionTreeFactor::shared_ptr combineFactor(const DecisionTreeFactor& factor,
+      const Ordering& frontalKeys, const DecisionTreeFactor::ADT::Binary& op,
+      const TABLE_COMBINE& tableCombine) {
+
+      if (frontalKeys.size() > factor.size()) throw invalid_argument(
+          (boost::format(
+              "DecisionTreeFactor::combine: invalid number of frontal keys %d, nr.keys=%d")
+              % frontalKeys.size() % factor.size()).str());
+
+      // sum over nrFrontals keys, in a dense table for a dense factor
+      DecisionTreeFactor::ADT result(factor);
+      if (DiscreteTable::Preferred(std::vector<const DecisionTreeFactor*>(1, &factor))) {
+        result = tableCombine(DiscreteTable(factor), frontalKeys).toDecisionTree();
+      } else {
+        BOOST_FOREACH(Key j, frontalKeys)
+          result = result.combine(j, factor.cardinality(j), op);
+      }
+
+      // create new factor, note we collect keys that are not in frontalKeys
+      DiscreteKeys dkeys;
+      BOOST_FOREACH(Key j, factor.keys()) {
+        if (std::find(frontalKeys.begin(), frontalKeys.end(), j) != frontalKeys.end())
+          continue;
+        dkeys.push_back(DiscreteKey(j, factor.cardinality(j)));
+      }
+      return boost::make_shared<DecisionTreeFactor>(dkeys, result);
     }
-    return boost::make_shared<DecisionTreeFactor>(dkeys, result);
   }
 
+  /* ************************************************************************* */
+  DecisionTreeFactor::shared_ptr DecisionTreeFactor::sum(size_t nrFrontals) const {
+    return combineFactor(*this, firstKeys(*this, nrFrontals), ADT::Ring::add, TableSum());
+  }
 
   /* ************************************************************************* */
-  DecisionTreeFactor::shared_ptr DecisionTreeFactor::combine(const Ordering& frontalKeys,
-    ADT::Binary op) const {
+  DecisionTreeFactor::shared_ptr DecisionTreeFactor::sum(const Ordering& keys) const {
+    return combineFactor(*this, keys, ADT::Ring::add, TableSum());
+  }
 
-    if (frontalKeys.size() > size()) throw invalid_argument(
-        (boost::format(
-            "DecisionTreeFactor::combine: invalid number of frontal keys %d, nr.keys=%d")
-            % frontalKeys.size() % size()).str());
-
-    // sum over nrFrontals keys
-    size_t i;
-    ADT result(*this);
-    for (i = 0; i < frontalKeys.size(); i++) {
-      Key j = frontalKeys[i];
-      result = result.combine(j, cardinality(j), op);
-    }
+  /* ************************************************************************* */
+  DecisionTreeFactor::shared_ptr DecisionTreeFactor::max(size_t nrFrontals) const {
+    return combineFactor(*this, firstKeys(*this, nrFrontals), ADT::Ring::max, TableMax());
+  }
 
-    // create new factor, note we collect keys that are not in frontalKeys
-    // TODO: why do we need this??? result should contain correct keys!!!
-    DiscreteKeys dkeys;
-    for (i = 0; i < keys().size(); i++) {
-      Key j = keys()[i];
-      // TODO: inefficient!
-      if (std::find(frontalKeys.begin(), frontalKeys.end(), j) != frontalKeys.end())
-        continue;
-      dkeys.push_back(DiscreteKey(j,cardinality(j)));
-    }
-    return boost::make_shared<DecisionTreeFactor>(dkeys, result);
+  /* ************************************************************************* */
+  DecisionTreeFactor::shared_ptr DecisionTreeFactor::combine(size_t nrFrontals,
+    ADT::Binary op) const {
+    return combineFactor(*this, firstKeys(*this, nrFrontals), op, TableCombine(op));
+  }
+
+  /* ************************************************************************* */
+  DecisionTreeFactor::shared_ptr DecisionTreeFactor::combine(const Ordering& frontalKeys,
+    ADT::Binary op) const {
+    return combineFactor(*this, frontalKeys, op, TableCombine(op));
   }
 
 /* ************************************************************************* */
@@ -45,6 +45,11 @@ namespace gtsam {
     typedef DiscreteFactor Base; ///< Typedef to base class
     typedef boost::shared_ptr<DecisionTreeFactor> shared_ptr;
 
+  protected:
+
+    /// Whether the decision tree is dense enough to be operated on as a DiscreteTable, see isDense()
+    bool dense_;
+
   public:
 
     /// @name Standard Constructors
@@ -59,7 +64,7 @@ namespace gtsam {
     /** Constructor from Indices and (string or doubles) */
     template<class SOURCE>
     DecisionTreeFactor(const DiscreteKeys& keys, SOURCE table) :
-        DiscreteFactor(keys.indices()), Potentials(keys, table) {
+        DiscreteFactor(keys.indices()), Potentials(keys, table), dense_(computeDense()) {
     }
 
     /** Construct from a DiscreteConditional type */
@@ -101,19 +106,13 @@ namespace gtsam {
     }
 
     /// Create new factor by summing all values with the same separator values
-    shared_ptr sum(size_t nrFrontals) const {
-      return combine(nrFrontals, ADT::Ring::add);
-    }
+    shared_ptr sum(size_t nrFrontals) const;
 
     /// Create new factor by summing all values with the same separator values
-    shared_ptr sum(const Ordering& keys) const {
-      return combine(keys, ADT::Ring::add);
-    }
+    shared_ptr sum(const Ordering& keys) const;
 
     /// Create new factor by maximizing over all values with the same separator values
-    shared_ptr max(size_t nrFrontals) const {
-      return combine(nrFrontals, ADT::Ring::max);
-    }
+    shared_ptr max(size_t nrFrontals) const;
 
     /// @}
     /// @name Advanced Interface
@@ -142,6 +141,13 @@ namespace gtsam {
      */
     shared_ptr combine(const Ordering& keys, ADT::Binary op) const;
 
+    /**
+     * Whether the decision tree has enough leaves for its table to be faster to operate on, see
+     * DiscreteTable::Preferred.  This is computed once on construction, since it requires
+     * traversing the tree.
+     */
+    bool isDense() const { return dense_; }
+
 
 //    /**
 //     * @brief Permutes the keys in Potentials and DiscreteFactor
@@ -164,6 +170,11 @@ namespace gtsam {
 //    }
 
     /// @}
+
+  private:
+
+    /// Whether the decision tree is dense, see isDense()
+    bool computeDense() const;
 };
 // DecisionTreeFactor
 
@@ -58,6 +58,15 @@ DiscreteConditional::DiscreteConditional(const DecisionTreeFactor& joint,
   }
 }
 
+/* ******************************************************************************** */
+DiscreteConditional::DiscreteConditional(const DiscreteTable& joint,
+    const DiscreteTable& marginal, const Ordering& orderedKeys) :
+    BaseFactor((joint / marginal).toDecisionTreeFactor()), BaseConditional(
+        joint.keys().size() - marginal.keys().size()) {
+  keys_.clear();
+  keys_.insert(keys_.end(), orderedKeys.begin(), orderedKeys.end());
+}
+
 /* ******************************************************************************** */
 DiscreteConditional::DiscreteConditional(const Signature& signature) :
         BaseFactor(signature.discreteKeysParentsFirst(), signature.cpt()), BaseConditional(
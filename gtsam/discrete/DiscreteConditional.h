@@ -20,6 +20,7 @@
 
 #include <gtsam/discrete/DecisionTreeFactor.h>
 #include <gtsam/discrete/Signature.h>
+#include <gtsam/discrete/DiscreteTable.h>
 #include <gtsam/inference/Conditional.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
@@ -62,6 +63,10 @@ public:
   DiscreteConditional(const DecisionTreeFactor& joint,
       const DecisionTreeFactor& marginal, const boost::optional<Ordering>& orderedKeys = boost::none);
 
+  /** construct P(X|Y)=P(X,Y)/P(Y) from dense tables of P(X,Y) and P(Y), see DiscreteTable */
+  DiscreteConditional(const DiscreteTable& joint, const DiscreteTable& marginal,
+      const Ordering& orderedKeys);
+
   /**
    * Combine several conditional into a single one.
    * The conditionals must be given in increasing order, meaning that the parents
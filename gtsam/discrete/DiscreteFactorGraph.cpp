@@ -22,6 +22,7 @@
 #include <gtsam/discrete/DiscreteBayesTree.h>
 #include <gtsam/discrete/DiscreteEliminationTree.h>
 #include <gtsam/discrete/DiscreteJunctionTree.h>
+#include <gtsam/discrete/DiscreteTable.h>
 #include <gtsam/inference/FactorGraph-inst.h>
 #include <gtsam/inference/EliminateableFactorGraph-inst.h>
 #include <boost/make_shared.hpp>
@@ -100,10 +101,55 @@ namespace gtsam {
     return BaseEliminateable::eliminateSequential()->optimize();
   }
 
+  /* ************************************************************************* */
+  namespace {
+    std::pair<DiscreteConditional::shared_ptr, DecisionTreeFactor::shared_ptr>  //
+    EliminateDiscreteTable(const std::vector<const DecisionTreeFactor*>& factors,
+      const Ordering& frontalKeys) {
+
+      // PRODUCT: multiply all factors
+      gttic(product);
+      DiscreteTable product;
+      BOOST_FOREACH(const DecisionTreeFactor* factor, factors)
+        product = product * DiscreteTable(*factor);
+      gttoc(product);
+
+      // sum out frontals, this is the factor on the separator
+      gttic(sum);
+      DiscreteTable sum = product.sum(frontalKeys);
+      DecisionTreeFactor::shared_ptr sumFactor =
+        boost::make_shared<DecisionTreeFactor>(sum.toDecisionTreeFactor());
+      gttoc(sum);
+
+      // Ordering keys for the conditional so that frontalKeys are really in front
+      Ordering orderedKeys;
+      orderedKeys.insert(orderedKeys.end(), frontalKeys.begin(), frontalKeys.end());
+      orderedKeys.insert(orderedKeys.end(), sumFactor->keys().begin(), sumFactor->keys().end());
+
+      // now divide product/sum to get conditional
+      gttic(divide);
+      DiscreteConditional::shared_ptr cond(new DiscreteConditional(product, sum, orderedKeys));
+      gttoc(divide);
+
+      return std::make_pair(cond, sumFactor);
+    }
+  }
+
   /* ************************************************************************* */
   std::pair<DiscreteConditional::shared_ptr, DecisionTreeFactor::shared_ptr>  //
   EliminateDiscrete(const DiscreteFactorGraph& factors, const Ordering& frontalKeys) {
 
+    // Use dense tables if all factors are dense enough
+    std::vector<const DecisionTreeFactor*> treeFactors;
+    BOOST_FOREACH(const DiscreteFactor::shared_ptr& factor, factors) {
+      const DecisionTreeFactor* treeFactor = dynamic_cast<const DecisionTreeFactor*>(factor.get());
+      if (!treeFactor)
+        break;
+      treeFactors.push_back(treeFactor);
+    }
+    if (treeFactors.size() == factors.size() && DiscreteTable::Preferred(treeFactors))
+      return EliminateDiscreteTable(treeFactors, frontalKeys);
+
     // PRODUCT: multiply all factors
     gttic(product);
     DecisionTreeFactor product;
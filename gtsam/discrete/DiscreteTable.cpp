@@ -0,0 +1,352 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file DiscreteTable.cpp
+ * @brief Dense table representation of discrete potentials
+ */
+
+#include <gtsam/discrete/DiscreteTable.h>
+#include <gtsam/discrete/DecisionTreeFactor.h>
+#include <gtsam/discrete/DecisionTree-inl.h>
+
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gtsam {
+
+  const size_t DiscreteTable::MaxPreferredSize;
+  const double DiscreteTable::MinPreferredDensity = 0.25;
+
+  namespace {
+
+    typedef DecisionTree<Key, double> DT;
+
+    /* ************************************************************************* */
+    // Kernels, as functors so that the loops below can be inlined and vectorized
+    struct Multiply {
+      double operator()(double a, double b) const { return a * b; }
+    };
+
+    struct SafeDivide {
+      double operator()(double a, double b) const { return (a == 0 || b == 0) ? 0 : (a / b); }
+    };
+
+    struct Add {
+      double operator()(double a, double b) const { return a + b; }
+    };
+
+    struct Max {
+      double operator()(double a, double b) const { return std::max(a, b); }
+    };
+
+    struct BinaryFunction {
+      const DT::Binary& op;
+      BinaryFunction(const DT::Binary& op) : op(op) {}
+      double operator()(double a, double b) const { return op(a, b); }
+    };
+
+    /* ************************************************************************* */
+    bool greaterKey(const DiscreteKey& a, const DiscreteKey& b) {
+      return a.first > b.first;
+    }
+
+    bool sameKey(const DiscreteKey& a, const DiscreteKey& b) {
+      return a.first == b.first;
+    }
+
+    /* ************************************************************************* */
+    // Sort the variables in decreasing order, remove duplicates, and compute the strides
+    size_t layout(DiscreteKeys& keys, vector<size_t>& strides) {
+      sort(keys.begin(), keys.end(), greaterKey);
+      keys.erase(unique(keys.begin(), keys.end(), sameKey), keys.end());
+      strides.resize(keys.size());
+      size_t size = 1;
+      for(size_t d = keys.size(); d-- > 0; ) {
+        strides[d] = size;
+        size *= keys[d].second;
+      }
+      return size;
+    }
+
+    /* ************************************************************************* */
+    // The stride of a table along each variable of another, 0 for the variables it does not have
+    vector<size_t> stridesAlong(const DiscreteKeys& keys, const DiscreteKeys& tableKeys,
+      const vector<size_t>& tableStrides) {
+      vector<size_t> strides(keys.size(), 0);
+      for(size_t d = 0; d < keys.size(); ++d)
+        for(size_t t = 0; t < tableKeys.size(); ++t)
+          if(tableKeys[t].first == keys[d].first)
+            strides[d] = tableStrides[t];
+      return strides;
+    }
+
+    /* ************************************************************************* */
+    // Fill the block of the table for variables d and up from a subtree.  Since the labels of a
+    // decision tree decrease along its paths, this visits every node and every entry once.
+    void fillFromTree(const DT::NodePtr& node, const DiscreteKeys& keys,
+      const vector<size_t>& strides, size_t d, double* values) {
+      if(node->isLeaf()) {
+        const size_t blockSize = (d < keys.size()) ? strides[d] * keys[d].second : 1;
+        fill(values, values + blockSize, static_cast<const DT::Leaf&>(*node).constant());
+        return;
+      }
+
+      const DT::Choice& choice = static_cast<const DT::Choice&>(*node);
+      if(d == keys.size() || choice.label() > keys[d].first)
+        throw invalid_argument("DiscreteTable: the decision tree splits on a variable that is not in the table");
+
+      if(choice.label() == keys[d].first) {
+        if(choice.nrChoices() != keys[d].second)
+          throw invalid_argument("DiscreteTable: the decision tree and the table disagree on a cardinality");
+        for(size_t i = 0; i < keys[d].second; ++i)
+          fillFromTree(choice.branches()[i], keys, strides, d + 1, values + i * strides[d]);
+      } else {
+        // The tree does not depend on this variable, so all of its values share the same block
+        fillFromTree(node, keys, strides, d + 1, values);
+        for(size_t i = 1; i < keys[d].second; ++i)
+          copy(values, values + strides[d], values + i * strides[d]);
+      }
+    }
+
+    /* ************************************************************************* */
+    // Count the leaves on all paths of a tree, stopping once the limit is reached
+    size_t countLeaves(const DT::NodePtr& node, size_t limit) {
+      if(node->isLeaf())
+        return 1;
+      size_t count = 0;
+      BOOST_FOREACH(const DT::NodePtr& branch, static_cast<const DT::Choice&>(*node).branches()) {
+        count += countLeaves(branch, limit - count);
+        if(count >= limit)
+          break;
+      }
+      return count;
+    }
+
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable::DiscreteTable() : values_(1, 1.0) {
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable::DiscreteTable(const DiscreteKeys& keys) : keys_(keys) {
+    values_.resize(layout(keys_, strides_));
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable::DiscreteTable(const DiscreteKeys& keys, const ADT& tree) : keys_(keys) {
+    values_.resize(layout(keys_, strides_));
+    fillFromTree(tree.root_, keys_, strides_, 0, &values_[0]);
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable::DiscreteTable(const DecisionTreeFactor& factor) {
+    BOOST_FOREACH(Key j, factor.keys())
+      keys_.push_back(DiscreteKey(j, factor.cardinality(j)));
+    values_.resize(layout(keys_, strides_));
+    fillFromTree(factor.root_, keys_, strides_, 0, &values_[0]);
+  }
+
+  /* ************************************************************************* */
+  void DiscreteTable::print(const string& s, const KeyFormatter& formatter) const {
+    cout << s << "\n  Cardinalities: ";
+    BOOST_FOREACH(const DiscreteKey& key, keys_)
+      cout << formatter(key.first) << "=" << key.second << " ";
+    cout << "\n  Values:";
+    BOOST_FOREACH(double value, values_)
+      cout << " " << value;
+    cout << endl;
+  }
+
+  /* ************************************************************************* */
+  bool DiscreteTable::equals(const DiscreteTable& other, double tol) const {
+    if(keys_ != other.keys_)
+      return false;
+    for(size_t i = 0; i < values_.size(); ++i)
+      if(fabs(values_[i] - other.values_[i]) > tol)
+        return false;
+    return true;
+  }
+
+  /* ************************************************************************* */
+  double DiscreteTable::operator()(const DiscreteFactor::Values& values) const {
+    size_t offset = 0;
+    for(size_t d = 0; d < keys_.size(); ++d)
+      offset += values.at(keys_[d].first) * strides_[d];
+    return values_[offset];
+  }
+
+  /* ************************************************************************* */
+  template<class OP>
+  DiscreteTable DiscreteTable::applyKernel(const DiscreteTable& f, const OP& op) const {
+    // The result is on the union of the variables
+    DiscreteKeys keys(keys_);
+    keys.insert(keys.end(), f.keys_.begin(), f.keys_.end());
+    DiscreteTable result(keys);
+    const size_t n = result.keys_.size();
+    if(n == 0) {
+      result.values_[0] = op(values_[0], f.values_[0]);
+      return result;
+    }
+
+    const vector<size_t> sa = stridesAlong(result.keys_, keys_, strides_);
+    const vector<size_t> sb = stridesAlong(result.keys_, f.keys_, f.strides_);
+    const double* a = &values_[0];
+    const double* b = &f.values_[0];
+    double* r = &result.values_[0];
+
+    // Loop over the last variable in the inner loop, and over the others like an odometer
+    const size_t last = n - 1, inner = result.keys_[last].second;
+    const size_t sal = sa[last], sbl = sb[last];
+    vector<size_t> index(n, 0);
+    size_t ia = 0, ib = 0;
+    for(size_t ir = 0; ir < result.values_.size(); ir += inner) {
+      for(size_t k = 0; k < inner; ++k)
+        r[ir + k] = op(a[ia + k * sal], b[ib + k * sbl]);
+      for(size_t d = last; d-- > 0; ) {
+        ia += sa[d];
+        ib += sb[d];
+        if(++index[d] < result.keys_[d].second)
+          break;
+        ia -= sa[d] * index[d];
+        ib -= sb[d] * index[d];
+        index[d] = 0;
+      }
+    }
+    return result;
+  }
+
+  /* ************************************************************************* */
+  template<class OP>
+  DiscreteTable DiscreteTable::combineKernel(const Ordering& frontalKeys, const OP& op) const {
+    // Offsets of all assignments of the frontal variables, and the remaining variables
+    vector<size_t> frontalOffsets(1, 0);
+    DiscreteKeys remaining;
+    vector<size_t> remainingStrides;
+    size_t nrFound = 0;
+    for(size_t d = 0; d < keys_.size(); ++d) {
+      if(find(frontalKeys.begin(), frontalKeys.end(), keys_[d].first) != frontalKeys.end()) {
+        ++nrFound;
+        const size_t nrOffsets = frontalOffsets.size();
+        for(size_t i = 1; i < keys_[d].second; ++i)
+          for(size_t o = 0; o < nrOffsets; ++o)
+            frontalOffsets.push_back(frontalOffsets[o] + i * strides_[d]);
+      } else {
+        remaining.push_back(keys_[d]);
+        remainingStrides.push_back(strides_[d]);
+      }
+    }
+    if(nrFound != frontalKeys.size())
+      throw invalid_argument("DiscreteTable::combine: a frontal variable is not in the table");
+
+    // Combine all frontal assignments for each assignment of the remaining variables
+    DiscreteTable result(remaining);
+    const size_t m = remaining.size(), nrFrontal = frontalOffsets.size();
+    const double* v = &values_[0];
+    vector<size_t> index(m, 0);
+    size_t base = 0;
+    for(size_t ir = 0; ir < result.values_.size(); ++ir) {
+      double combined = v[base];
+      for(size_t k = 1; k < nrFrontal; ++k)
+        combined = op(combined, v[base + frontalOffsets[k]]);
+      result.values_[ir] = combined;
+      for(size_t d = m; d-- > 0; ) {
+        base += remainingStrides[d];
+        if(++index[d] < remaining[d].second)
+          break;
+        base -= remainingStrides[d] * index[d];
+        index[d] = 0;
+      }
+    }
+    return result;
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::operator*(const DiscreteTable& f) const {
+    return applyKernel(f, Multiply());
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::operator/(const DiscreteTable& f) const {
+    return applyKernel(f, SafeDivide());
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::apply(const DiscreteTable& f, const ADT::Binary& op) const {
+    return applyKernel(f, BinaryFunction(op));
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::sum(const Ordering& frontalKeys) const {
+    return combineKernel(frontalKeys, Add());
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::max(const Ordering& frontalKeys) const {
+    return combineKernel(frontalKeys, Max());
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable DiscreteTable::combine(const Ordering& frontalKeys, const ADT::Binary& op) const {
+    return combineKernel(frontalKeys, BinaryFunction(op));
+  }
+
+  /* ************************************************************************* */
+  DiscreteTable::ADT DiscreteTable::toDecisionTree() const {
+    if(keys_.empty())
+      return ADT(DT(values_[0]));
+    // The labels are already highest first, so create() does not need to reorder them
+    return ADT(keys_, values_);
+  }
+
+  /* ************************************************************************* */
+  DecisionTreeFactor DiscreteTable::toDecisionTreeFactor() const {
+    DiscreteKeys increasing(std::vector<DiscreteKey>(keys_.rbegin(), keys_.rend()));
+    return DecisionTreeFactor(increasing, toDecisionTree());
+  }
+
+  /* ************************************************************************* */
+  bool DiscreteTable::Preferred(const vector<const DecisionTreeFactor*>& factors) {
+    // The table on all variables must be small enough
+    map<Key, size_t> cardinalities;
+    BOOST_FOREACH(const DecisionTreeFactor* factor, factors)
+      BOOST_FOREACH(Key j, factor->keys())
+        cardinalities[j] = factor->cardinality(j);
+    size_t size = 1;
+    typedef map<Key, size_t>::value_type KeyCardinality;
+    BOOST_FOREACH(const KeyCardinality& keyCardinality, cardinalities) {
+      size *= keyCardinality.second;
+      if(size > MaxPreferredSize)
+        return false;
+    }
+
+    // and the trees must not be much smaller than their tables, which the factors know already
+    BOOST_FOREACH(const DecisionTreeFactor* factor, factors)
+      if(!factor->isDense())
+        return false;
+    return true;
+  }
+
+  /* ************************************************************************* */
+  bool DiscreteTable::Dense(const ADT& tree, size_t size) {
+    const size_t minLeaves = (size_t) ceil(MinPreferredDensity * size);
+    return countLeaves(tree.root_, minLeaves) >= minLeaves;
+  }
+
+} // namespace gtsam
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file DiscreteTable.h
+ * @brief Dense table representation of discrete potentials
+ */
+
+#pragma once
+
+#include <gtsam/discrete/Potentials.h>
+#include <gtsam/discrete/DiscreteFactor.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <vector>
+
+namespace gtsam {
+
+  class DecisionTreeFactor;
+
+  /**
+   * A dense table of the values of a discrete potential on all assignments of its variables.
+   * For factors whose decision trees have nearly as many leaves as assignments, products and
+   * marginalization on tables are much faster than on trees: they are plain strided loops over
+   * contiguous arrays instead of recursions over heap-allocated nodes.  Tables are converted
+   * from and to the decision tree form of DecisionTreeFactor, which selects them automatically
+   * when Preferred() says so.
+   *
+   * The variables are stored in decreasing order of their keys, the last one varying fastest.
+   * This is the order of the labels along the paths of a decision tree, so conversions in both
+   * directions take time linear in the size of the table.
+   */
+  class GTSAM_EXPORT DiscreteTable {
+
+  public:
+
+    typedef Potentials::ADT ADT;
+
+    /// Largest table that Preferred() accepts, in number of entries
+    static const size_t MaxPreferredSize = 1 << 20;
+
+    /// Smallest ratio of leaves to table entries of the decision trees for Preferred()
+    static const double MinPreferredDensity;
+
+  protected:
+
+    DiscreteKeys keys_; ///< The variables with their cardinalities, in decreasing key order
+    std::vector<size_t> strides_; ///< The distance between consecutive values of each variable
+    std::vector<double> values_; ///< The values in row-major order
+
+  public:
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Construct the table of the constant 1, with no variables */
+    DiscreteTable();
+
+    /** Construct from the decision tree of a factor */
+    explicit DiscreteTable(const DecisionTreeFactor& factor);
+
+    /** Construct from variables and a decision tree on a subset of them */
+    DiscreteTable(const DiscreteKeys& keys, const ADT& tree);
+
+    /// @}
+    /// @name Testable
+    /// @{
+
+    /** print */
+    void print(const std::string& s = "DiscreteTable: ",
+      const KeyFormatter& formatter = DefaultKeyFormatter) const;
+
+    /** equality up to a tolerance on the values */
+    bool equals(const DiscreteTable& other, double tol = 1e-9) const;
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** The variables, in decreasing key order */
+    const DiscreteKeys& keys() const { return keys_; }
+
+    /** The values, in row-major order of keys() */
+    const std::vector<double>& values() const { return values_; }
+
+    /** The number of entries of the table */
+    size_t size() const { return values_.size(); }
+
+    /** Look up the value of an assignment */
+    double operator()(const DiscreteFactor::Values& values) const;
+
+    /** Multiply two tables */
+    DiscreteTable operator*(const DiscreteTable& f) const;
+
+    /** Divide by table f, with 0 wherever either value is 0 (see Potentials::safe_div) */
+    DiscreteTable operator/(const DiscreteTable& f) const;
+
+    /** Apply a binary operator to the values of two tables */
+    DiscreteTable apply(const DiscreteTable& f, const ADT::Binary& op) const;
+
+    /** Sum out the given variables */
+    DiscreteTable sum(const Ordering& frontalKeys) const;
+
+    /** Maximize over the given variables */
+    DiscreteTable max(const Ordering& frontalKeys) const;
+
+    /** Combine the values of the given variables with a binary operator */
+    DiscreteTable combine(const Ordering& frontalKeys, const ADT::Binary& op) const;
+
+    /** Convert to a decision tree */
+    ADT toDecisionTree() const;
+
+    /** Convert to a factor, with the keys in increasing order like DecisionTreeFactor::apply */
+    DecisionTreeFactor toDecisionTreeFactor() const;
+
+    /// @}
+    /// @name Advanced Interface
+    /// @{
+
+    /** Whether operating on tables is expected to be faster than on the decision trees of the
+     *  given factors: the table on all of their variables must have at most MaxPreferredSize
+     *  entries, and none of the trees may have fewer than MinPreferredDensity leaves per entry of
+     *  its own table, since sparse trees stay much smaller than tables. */
+    static bool Preferred(const std::vector<const DecisionTreeFactor*>& factors);
+
+    /** Whether a decision tree has at least MinPreferredDensity leaves per entry of its table of
+     *  \c size entries.  DecisionTreeFactor computes this once on construction, see
+     *  DecisionTreeFactor::isDense(), so that Preferred() does not traverse the trees. */
+    static bool Dense(const ADT& tree, size_t size);
+
+    /// @}
+
+  protected:
+
+    /** Construct with uninitialized values on the given variables, in any order */
+    explicit DiscreteTable(const DiscreteKeys& keys);
+
+    /** Combine the values of the given variables with the binary functor OP */
+    template<class OP>
+    DiscreteTable combineKernel(const Ordering& frontalKeys, const OP& op) const;
+
+    /** Apply the binary functor OP to the values of two tables */
+    template<class OP>
+    DiscreteTable applyKernel(const DiscreteTable& f, const OP& op) const;
+  };
+
+} // namespace gtsam
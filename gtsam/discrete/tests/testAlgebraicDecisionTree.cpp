@@ -172,7 +172,7 @@ TEST(ADT, joint)
   dot(joint, "Asia-ASTLBEX");
   joint = apply(joint, pD, &mul);
   dot(joint, "Asia-ASTLBEXD");
-  EXPECT_LONGS_EQUAL(346, (long)muls);
+  EXPECT_LONGS_EQUAL(302, (long)muls);
   printCounts("Asia joint");
 
   ADT pASTL = pA;
@@ -223,7 +223,7 @@ TEST(ADT, inference)
   dot(joint, "Joint-Product-ASTLBEX");
   joint = apply(joint, pD, &mul);
   dot(joint, "Joint-Product-ASTLBEXD");
-  EXPECT_LONGS_EQUAL(370, (long)muls); // different ordering
+  EXPECT_LONGS_EQUAL(302, (long)muls); // different ordering
   printCounts("Asia product");
 
   ADT marginal = joint;
@@ -235,7 +235,7 @@ TEST(ADT, inference)
   dot(marginal, "Joint-Sum-ADBLE");
   marginal = marginal.combine(E, &add_);
   dot(marginal, "Joint-Sum-ADBL");
-  EXPECT_LONGS_EQUAL(161, (long)adds);
+  EXPECT_LONGS_EQUAL(150, (long)adds);
   printCounts("Asia sum");
 }
 
@@ -264,7 +264,7 @@ TEST(ADT, factor_graph)
   fg = apply(fg, pX, &mul);
   fg = apply(fg, pD, &mul);
   dot(fg, "FactorGraph");
-  EXPECT_LONGS_EQUAL(158, (long)muls);
+  EXPECT_LONGS_EQUAL(130, (long)muls);
   printCounts("Asia FG");
 
   fg = fg.combine(X, &add_);
@@ -512,6 +512,37 @@ TEST(ADT, zero)
   EXPECT_DOUBLES_EQUAL(0, anotb(x11), 1e-9);
 }
 
+/* ******************************************************************************** */
+// test sharing of identical subtrees
+TEST(ADT, sharing)
+{
+  DiscreteKey A(0,2), B(1,2), C(2,2);
+
+  // Equal functions have the same root, however they were built
+  ADT f1(A & B, "1 2 3 4"), f2(A & B, "1 2 3 4");
+  EXPECT(f1.root_ == f2.root_);
+  EXPECT(ADT(B, 4, 6).root_ == f1.sum(A).root_);
+
+  // The subtrees on A are shared between both values of C
+  ADT f(C & B & A, "1 2 3 4 3 4 1 2");
+  typedef boost::shared_ptr<const ADT::Choice> ChoicePtr;
+  ChoicePtr c = boost::dynamic_pointer_cast<const ADT::Choice>(f.root_);
+  ChoicePtr c0 = boost::dynamic_pointer_cast<const ADT::Choice>(c->branches()[0]);
+  ChoicePtr c1 = boost::dynamic_pointer_cast<const ADT::Choice>(c->branches()[1]);
+  EXPECT(c0->branches()[0] == c1->branches()[1]);
+  EXPECT(c0->branches()[1] == c1->branches()[0]);
+
+  // A choice between identical subtrees is removed
+  ADT g(C & B & A, "1 2 1 2 3 4 3 4");
+  EXPECT(assert_equal(ADT(C & A, "1 2 3 4"), g));
+
+  // Binary apply visits shared subtrees only once
+  resetCounts();
+  ADT h = apply(f, ADT::Super(2.0), &mul);
+  EXPECT_LONGS_EQUAL(4, (long)muls);
+  EXPECT(assert_equal(ADT(C & B & A, "2 4 6 8 6 8 2 4"), h));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
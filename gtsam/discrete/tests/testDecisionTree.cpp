@@ -41,7 +41,15 @@ void dot(const T&f, const string& filename) {
 
 #define DOT(x)(dot(x,#x))
 
-struct Crazy { int a; double b; };
+// A leaf type with the operations DecisionTree needs, but without a boost::hash
+struct Crazy {
+  int a; double b;
+  Crazy(int a = 0, double b = 0.0) : a(a), b(b) {}
+  bool operator==(const Crazy& other) const { return a == other.a && b == other.b; }
+  double operator-(const Crazy& other) const { return fabs(double(a - other.a)) + fabs(b - other.b); }
+  operator bool() const { return a != 0 || b != 0.0; }
+};
+ostream& operator<<(ostream& os, const Crazy& c) { return os << "(" << c.a << ", " << c.b << ")"; }
 typedef DecisionTree<string,Crazy> CrazyDecisionTree; // check that DecisionTree is actually generic (as it pretends to be)
 
 /* ******************************************************************************** */
@@ -232,6 +240,36 @@ TEST(DT, Compose)
   DOT(f5);
 }
 
+/* ******************************************************************************** */
+// test a leaf type without a hash, whose leaves are not shared
+TEST(DT, generic)
+{
+  string A("A"), B("B");
+  Assignment<string> x00, x10, x11;
+  x00[A] = 0, x00[B] = 0;
+  x10[A] = 1, x10[B] = 0;
+  x11[A] = 1, x11[B] = 1;
+
+  CrazyDecisionTree a(A, Crazy(1, 0.5), Crazy(2, 1.5));
+  EXPECT(a(x00) == Crazy(1, 0.5));
+  EXPECT(a(x10) == Crazy(2, 1.5));
+
+  // Equal leaves are separate nodes, unlike those of hashable types
+  EXPECT(CrazyDecisionTree(Crazy(1, 0.5)).root_ != CrazyDecisionTree(Crazy(1, 0.5)).root_);
+  EXPECT(DT(5).root_ == DT(5).root_);
+
+  // Choices on equal leaves are still pruned
+  CrazyDecisionTree p(A, Crazy(3, 2.0), Crazy(3, 2.0));
+  EXPECT(p.root_->isLeaf());
+  EXPECT(assert_equal(CrazyDecisionTree(Crazy(3, 2.0)), p, 1e-9));
+
+  // but choices on equal subtrees are not, which gives the same function with more nodes
+  CrazyDecisionTree f(B, a, CrazyDecisionTree(A, Crazy(1, 0.5), Crazy(2, 1.5)));
+  EXPECT(!f.root_->isLeaf() && f.root_ != a.root_);
+  EXPECT(f(x00) == a(x00));
+  EXPECT(f(x11) == a(x11));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
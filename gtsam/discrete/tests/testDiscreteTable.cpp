@@ -0,0 +1,168 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/*
+ * testDiscreteTable.cpp
+ *
+ *  @brief Unit tests for dense tables of discrete potentials
+ */
+
+#include <gtsam/discrete/DiscreteTable.h>
+#include <gtsam/discrete/DecisionTreeFactor.h>
+#include <gtsam/discrete/DiscreteConditional.h>
+#include <gtsam/base/Testable.h>
+#include <CppUnitLite/TestHarness.h>
+#include <boost/foreach.hpp>
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+  typedef AlgebraicDecisionTree<Key> ADT;
+
+  // Check that a table and a tree agree on all assignments of the given variables
+  bool sameValues(const DiscreteKeys& keys, const DiscreteTable& table, const ADT& tree) {
+    BOOST_FOREACH(const DiscreteFactor::Values& values, cartesianProduct(keys)) {
+      if(fabs(table(values) - tree(values)) > 1e-9)
+        return false;
+    }
+    return true;
+  }
+}
+
+/* ************************************************************************* */
+TEST(DiscreteTable, conversion)
+{
+  DiscreteKey X(0,2), Y(1,3), Z(2,2);
+  DecisionTreeFactor f(X & Y & Z, "2 5 3 6 4 7 25 55 35 65 45 75");
+
+  // The table is laid out with the highest key first
+  DiscreteTable table(f);
+  EXPECT_LONGS_EQUAL(12, table.size());
+  EXPECT_LONGS_EQUAL(2, table.keys().front().first);
+  EXPECT(sameValues(X & Y & Z, table, f));
+  EXPECT(assert_equal(f, table.toDecisionTreeFactor()));
+
+  // A tree that does not depend on all variables of the table
+  DecisionTreeFactor g(Y, "1 2 3");
+  DiscreteTable broadcast(X & Y & Z, g);
+  EXPECT_LONGS_EQUAL(12, broadcast.size());
+  EXPECT(sameValues(X & Y & Z, broadcast, g));
+
+  // A tree on a variable that is not in the table
+  CHECK_EXCEPTION(DiscreteTable(X & Z, g), std::invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(DiscreteTable, product)
+{
+  DiscreteKey v0(0,2), v1(1,3), v2(2,2);
+  DecisionTreeFactor f1(v0 & v1, "1 2 3 4 5 6");
+  DecisionTreeFactor f2(v1 & v2, "5 6 7 8 9 10");
+
+  DiscreteTable product = DiscreteTable(f1) * DiscreteTable(f2);
+  EXPECT_LONGS_EQUAL(12, product.size());
+  EXPECT(sameValues(v0 & v1 & v2, product, ADT(f1) * ADT(f2)));
+
+  DiscreteTable quotient = DiscreteTable(f1) / DiscreteTable(f2);
+  EXPECT(sameValues(v0 & v1 & v2, quotient, ADT(f1) / ADT(f2)));
+
+  // The factor product selects the dense table and gives the same factor
+  DecisionTreeFactor expected(v0 & v1 & v2, ADT(f1) * ADT(f2));
+  EXPECT(assert_equal(expected, f1 * f2));
+}
+
+/* ************************************************************************* */
+TEST(DiscreteTable, sum_max)
+{
+  DiscreteKey v0(0,3), v1(1,2), v2(2,2);
+  DecisionTreeFactor f(v0 & v1 & v2, "1 2 3 4 5 6 7 8 9 10 11 12");
+  DiscreteTable table(f);
+
+  DiscreteTable sum = table.sum(Ordering(list_of(0)));
+  EXPECT(sameValues(v1 & v2, sum, ADT(f).sum(v0)));
+
+  DiscreteTable max = table.max(Ordering(list_of(0)(2)));
+  EXPECT(sameValues(DiscreteKeys(v1), max, ADT(f).combine(v0, ADT::Ring::max).combine(v2, ADT::Ring::max)));
+
+  CHECK_EXCEPTION(table.sum(Ordering(list_of(5))), std::invalid_argument);
+
+  // Marginalizing a factor selects the dense table and gives the same factor
+  DecisionTreeFactor expected(v1 & v2, ADT(f).sum(v0));
+  EXPECT(assert_equal(expected, *f.sum(1)));
+  EXPECT(assert_equal(expected, *f.sum(Ordering(list_of(0)))));
+  EXPECT(assert_equal(expected, *f.combine(1, ADT::Ring::add)));
+
+  DecisionTreeFactor expectedMax(v1 & v2, ADT(ADT(f).combine(v0, ADT::Ring::max)));
+  EXPECT(assert_equal(expectedMax, *f.max(1)));
+  EXPECT(assert_equal(expectedMax, *f.combine(Ordering(list_of(0)), ADT::Ring::max)));
+
+  CHECK_EXCEPTION(f.max(4), std::invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(DiscreteTable, conditional)
+{
+  DiscreteKey v0(0,2), v1(1,3);
+  DecisionTreeFactor joint(v0 & v1, "1 2 3 4 5 6");
+  DiscreteTable jointTable(joint);
+  DiscreteTable marginal = jointTable.sum(Ordering(list_of(0)));
+
+  DiscreteConditional expected(joint, *joint.sum(1));
+  DiscreteConditional actual(jointTable, marginal, Ordering(list_of(0)(1)));
+  EXPECT(assert_equal(expected, actual));
+}
+
+/* ************************************************************************* */
+TEST(DiscreteTable, preferred)
+{
+  DiscreteKey v0(0,10), v1(1,10);
+  DecisionTreeFactor dense(v0 & v1, vector<double>(100, 1.0));
+  vector<const DecisionTreeFactor*> factors(1, &dense);
+
+  // A tree that is pruned to a single leaf stays much smaller than its table
+  EXPECT(!DiscreteTable::Preferred(factors));
+  EXPECT(!dense.isDense());
+  EXPECT(!DiscreteTable::Dense(dense, 100));
+
+  vector<double> ramp;
+  for(size_t i = 0; i < 100; ++i)
+    ramp.push_back(i);
+  DecisionTreeFactor distinct(v0 & v1, ramp);
+  factors[0] = &distinct;
+  EXPECT(DiscreteTable::Preferred(factors));
+  EXPECT(distinct.isDense());
+
+  // The density is kept by copies and by the results of operations
+  DecisionTreeFactor copy(distinct);
+  EXPECT(copy.isDense());
+  EXPECT(distinct.sum(1)->isDense());
+
+  // Dense factors whose product would have too many entries
+  DiscreteKey v2(2,1100), v3(3,1100);
+  vector<double> longRamp;
+  for(size_t i = 0; i < 1100; ++i)
+    longRamp.push_back(i);
+  DecisionTreeFactor f2(v2, longRamp), f3(v3, longRamp);
+  factors[0] = &f2;
+  EXPECT(DiscreteTable::Preferred(factors));
+  factors.push_back(&f3);
+  EXPECT(!DiscreteTable::Preferred(factors));
+}
+
+/* ************************************************************************* */
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
+/* ************************************************************************* */
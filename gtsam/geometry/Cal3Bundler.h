@@ -37,6 +37,9 @@ private:
 
 public:
 
+  /// dimension of the variable - used to autodetect sizes
+  static const size_t dimension = 3;
+
   /// @name Standard Constructors
   /// @{
 
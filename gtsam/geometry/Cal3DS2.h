@@ -43,6 +43,9 @@ class GTSAM_EXPORT Cal3DS2 : public Cal3DS2_Base, public DerivedValue<Cal3DS2> {
 
 public:
 
+  /// dimension of the variable - used to autodetect sizes
+  static const size_t dimension = 9;
+
   /// @name Standard Constructors
   /// @{
 
@@ -50,6 +50,10 @@ private:
   double xi_;  // mirror parameter
 
 public:
+
+  /// dimension of the variable - used to autodetect sizes
+  static const size_t dimension = 10;
+
   //Matrix K() const ;
   //Eigen::Vector4d k() const { return Base::k(); }
   Vector vector() const ;
@@ -37,6 +37,9 @@ private:
 
 public:
 
+  /// dimension of the variable - used to autodetect sizes
+  static const size_t dimension = 5;
+
   typedef boost::shared_ptr<Cal3_S2> shared_ptr; ///< shared pointer to calibration object
 
   /// @name Standard Constructors
@@ -22,6 +22,7 @@
 #include <boost/optional.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <gtsam/base/DerivedValue.h>
+#include <gtsam/base/Manifold.h>
 #include <gtsam/base/Vector.h>
 #include <gtsam/base/Matrix.h>
 #include <gtsam/geometry/Point2.h>
@@ -411,6 +412,42 @@ public:
     }
   }
 
+  /** project a point from world coordinate to the image, as project(), but with the Jacobians
+   *  written into fixed-size matrices, for factors deriving from FixedNoiseModelFactor2.  A
+   *  null pointer skips the corresponding Jacobian.
+   *  @param pw is a point in the world coordinate
+   *  @param Dpose is the 2*6 Jacobian w.r.t. pose3
+   *  @param Dpoint is the 2*3 Jacobian w.r.t. point3
+   *  @param Dcal is the Jacobian w.r.t. calibration, of dynamic size if Calibration does not
+   *  declare a compile-time dimension
+   */
+  inline Point2 projectFixed(const Point3& pw,
+      Eigen::Matrix<double, 2, 6>* Dpose,
+      Eigen::Matrix<double, 2, 3>* Dpoint,
+      Eigen::Matrix<double, 2, traits::dimension<Calibration>::value>* Dcal = 0) const {
+
+    const Point3 pc = pose_.transform_to(pw);
+    const Point2 pn = project_to_camera(pc);
+
+    if (!Dpose && !Dpoint && !Dcal)
+      return K_.uncalibrate(pn);
+
+    const double d = 1.0 / pc.z();
+
+    // uncalibration, the calibrations only provide dynamic-size Jacobians
+    Matrix Dcal_, Dpi_pn(2, 2);
+    const Point2 pi = K_.uncalibrate(pn,
+        Dcal ? boost::optional<Matrix&>(Dcal_) : boost::optional<Matrix&>(), Dpi_pn);
+
+    if (Dpose)
+      calculateDpose(pn, d, Dpi_pn, *Dpose);
+    if (Dpoint)
+      calculateDpoint(pn, d, pose_.rotation().matrix(), Dpi_pn, *Dpoint);
+    if (Dcal)
+      *Dcal = Dcal_;
+    return pi;
+  }
+
   /// backproject a 2-dimensional point to a 3-dimensional point at given depth
   inline Point3 backproject(const Point2& p, double depth) const {
     const Point2 pn = K_.calibrate(p);
@@ -522,7 +559,7 @@ private:
    * See http://eigen.tuxfamily.org/dox/TopicFunctionTakingEigenTypes.html
    */
   template<typename Derived>
-  static void calculateDpose(const Point2& pn, double d, const Matrix& Dpi_pn,
+  static void calculateDpose(const Point2& pn, double d, const Eigen::Matrix2d& Dpi_pn,
       Eigen::MatrixBase<Derived> const & Dpose) {
     // optimized version of derivatives, see CalibratedCamera.nb
     const double u = pn.x(), v = pn.y();
@@ -543,8 +580,8 @@ private:
    * See http://eigen.tuxfamily.org/dox/TopicFunctionTakingEigenTypes.html
    */
   template<typename Derived>
-  static void calculateDpoint(const Point2& pn, double d, const Matrix& R,
-      const Matrix& Dpi_pn, Eigen::MatrixBase<Derived> const & Dpoint) {
+  static void calculateDpoint(const Point2& pn, double d, const Matrix3& R,
+      const Eigen::Matrix2d& Dpi_pn, Eigen::MatrixBase<Derived> const & Dpoint) {
     // optimized version of derivatives, see CalibratedCamera.nb
     const double u = pn.x(), v = pn.y();
     Eigen::Matrix<double, 2, 3> Dpn_point;
@@ -570,5 +607,20 @@ private:
     ar & BOOST_SERIALIZATION_NVP(K_);
   }
   /// @}
-      }
-      ;}
+      };
+
+namespace traits {
+
+/**
+ * The compile-time dimension of a PinholeCamera is that of Pose3 plus that of its calibration,
+ * or Eigen::Dynamic if the calibration does not declare one.
+ */
+template<typename Calibration, bool HAS_DIMENSION>
+struct dimension<PinholeCamera<Calibration>, HAS_DIMENSION> {
+  static const int value = traits::dimension<Calibration>::value == Eigen::Dynamic ?
+      Eigen::Dynamic : int(Pose3::dimension) + traits::dimension<Calibration>::value;
+};
+
+} // namespace traits
+
+}
@@ -224,6 +224,49 @@ TEST( PinholeCamera, Dproject2)
   CHECK(assert_equal(numerical_point,  Dpoint,  1e-7));
 }
 
+/* ************************************************************************* */
+namespace {
+  /* A Cal3_S2 without the compile-time dimension, like calibrations outside of gtsam */
+  class DynamicCal3_S2 {
+    Cal3_S2 K_;
+  public:
+    DynamicCal3_S2() {}
+    DynamicCal3_S2(const Cal3_S2& K) : K_(K) {}
+    bool equals(const DynamicCal3_S2& K, double tol = 1e-9) const { return K_.equals(K.K_, tol); }
+    void print(const std::string& s = "") const { K_.print(s); }
+    void print(std::ostream& os, const std::string& s = "") const { K_.print(os, s); }
+    size_t dim() const { return K_.dim(); }
+    DynamicCal3_S2 retract(const Vector& d) const { return K_.retract(d); }
+    Vector localCoordinates(const DynamicCal3_S2& K) const { return K_.localCoordinates(K.K_); }
+    Point2 uncalibrate(const Point2& p, boost::optional<Matrix&> Dcal = boost::none,
+        boost::optional<Matrix&> Dp = boost::none) const { return K_.uncalibrate(p, Dcal, Dp); }
+  };
+}
+
+TEST( PinholeCamera, projectFixed)
+{
+  LONGS_EQUAL(11, traits::dimension<Camera>::value);
+  Matrix Dpose, Dpoint, Dcal;
+  const Point2 expected = camera.project(point1, Dpose, Dpoint, Dcal);
+
+  Eigen::Matrix<double, 2, 6> fixedPose;
+  Eigen::Matrix<double, 2, 3> fixedPoint;
+  Eigen::Matrix<double, 2, 5> fixedCal;
+  EXPECT(assert_equal(expected, camera.projectFixed(point1, &fixedPose, &fixedPoint, &fixedCal)));
+  EXPECT(assert_equal(Dpose, Matrix(fixedPose)));
+  EXPECT(assert_equal(Dpoint, Matrix(fixedPoint)));
+  EXPECT(assert_equal(Dcal, Matrix(fixedCal)));
+
+  // with a calibration of dynamic dimension, the calibration Jacobian is dynamic
+  typedef PinholeCamera<DynamicCal3_S2> DynamicCamera;
+  LONGS_EQUAL(Eigen::Dynamic, traits::dimension<DynamicCamera>::value);
+  const DynamicCamera dynamicCamera(pose1, DynamicCal3_S2(K));
+  Eigen::Matrix<double, 2, Eigen::Dynamic> dynamicCal;
+  EXPECT(assert_equal(expected, dynamicCamera.projectFixed(point1, &fixedPose, 0, &dynamicCal)));
+  EXPECT(assert_equal(Dpose, Matrix(fixedPose)));
+  EXPECT(assert_equal(Dcal, Matrix(dynamicCal)));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
 /* ************************************************************************* */
@@ -30,6 +30,10 @@
 #include <boost/assign/list_of.hpp>
 #include <fstream>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#endif
+
 using boost::assign::cref_list_of;
 
 namespace gtsam {
@@ -164,7 +168,7 @@ namespace gtsam {
 
   /* ************************************************************************* */
   template<class CLIQUE>
-  BayesTree<CLIQUE>::BayesTree(const This& other) {
+  BayesTree<CLIQUE>::BayesTree(const This& other) : shortcutCacheCapacity_(0) {
     *this = other;
   }
 
@@ -193,6 +197,10 @@ namespace gtsam {
       root->parent_ = typename Clique::weak_ptr(); // Reset the parent since it's set to the dummy clique
       insertRoot(root);
     }
+    // The copied separator marginals are not tracked by the cache policy, so drop them if bounded
+    shortcutCacheCapacity_ = other.shortcutCacheCapacity_;
+    if(shortcutCacheCapacity_ > 0)
+      deleteCachedShortcuts();
     return *this;
   }
 
@@ -269,6 +277,8 @@ namespace gtsam {
     // Now, marginalize out everything that is not variable j
     BayesNetType marginalBN = *cliqueMarginal.marginalMultifrontalBayesNet(
       Ordering(cref_list_of<1,Key>(j)), boost::none, function);
+    touchShortcuts(clique);
+    enforceShortcutCacheCapacity();
 
     // The Bayes net should contain only one conditional for variable j, so return it
     return marginalBN.front();
@@ -287,109 +297,245 @@ namespace gtsam {
 
   /* ************************************************************************* */
   template<class CLIQUE>
-  typename BayesTree<CLIQUE>::sharedBayesNet
-    BayesTree<CLIQUE>::jointBayesNet(Key j1, Key j2, const Eliminate& function) const
+  typename BayesTree<CLIQUE>::sharedClique
+    BayesTree<CLIQUE>::lowestCommonAncestor(const sharedClique& C1, const sharedClique& C2)
   {
-    gttic(BayesTree_jointBayesNet);
-    // get clique C1 and C2
-    sharedClique C1 = (*this)[j1], C2 = (*this)[j2];
-
     gttic(Lowest_common_ancestor);
-    // Find lowest common ancestor clique
-    sharedClique B; {
-      // Build two paths to the root
-      FastList<sharedClique> path1, path2; {
-        sharedClique p = C1;
-        while(p) {
-          path1.push_front(p);
-          p = p->parent();
-        }
-      } {
-        sharedClique p = C2;
-        while(p) {
-          path2.push_front(p);
-          p = p->parent();
-        }
+    sharedClique B;
+    // Build two paths to the root
+    FastList<sharedClique> path1, path2; {
+      sharedClique p = C1;
+      while(p) {
+        path1.push_front(p);
+        p = p->parent();
       }
-      // Find the path intersection
-      typename FastList<sharedClique>::const_iterator p1 = path1.begin(), p2 = path2.begin();
-      if(*p1 == *p2)
-        B = *p1;
-      while(p1 != path1.end() && p2 != path2.end() && *p1 == *p2) {
-        B = *p1;
-        ++p1;
-        ++p2;
+    } {
+      sharedClique p = C2;
+      while(p) {
+        path2.push_front(p);
+        p = p->parent();
       }
     }
-    gttoc(Lowest_common_ancestor);
+    // Find the path intersection
+    typename FastList<sharedClique>::const_iterator p1 = path1.begin(), p2 = path2.begin();
+    if(*p1 == *p2)
+      B = *p1;
+    while(p1 != path1.end() && p2 != path2.end() && *p1 == *p2) {
+      B = *p1;
+      ++p1;
+      ++p2;
+    }
+    return B;
+  }
 
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  boost::shared_ptr<typename BayesTree<CLIQUE>::EliminationTraitsType::BayesTreeType>
+    BayesTree<CLIQUE>::shortcutGivenAncestor(const sharedClique& C, const sharedClique& B, const Eliminate& function)
+  {
+    // Compute the shortcut of the clique given the lowest common ancestor
+    gttic(Clique_shortcuts);
+    BayesNetType p_C_Bred = C->shortcut(B, function);
+    gttoc(Clique_shortcuts);
+
+    // Factor the shortcut to be conditioned on the full root
+    // Get the set of variables to eliminate, which is C\B.
+    gttic(Full_root_factoring);
+    FastVector<Key> C_minus_B; {
+      FastSet<Key> C_minus_B_set(C->conditional()->beginParents(), C->conditional()->endParents());
+      BOOST_FOREACH(const Key j, *B->conditional()) {
+        C_minus_B_set.erase(j); }
+      C_minus_B.assign(C_minus_B_set.begin(), C_minus_B_set.end());
+    }
+    // Factor into C\B | B.
+    boost::shared_ptr<typename EliminationTraitsType::BayesTreeType> p_C_B;
+    sharedFactorGraph temp_remaining;
+    boost::tie(p_C_B, temp_remaining) =
+      FactorGraphType(p_C_Bred).eliminatePartialMultifrontal(Ordering(C_minus_B), function);
+    return p_C_B;
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  typename BayesTree<CLIQUE>::sharedBayesNet
+    BayesTree<CLIQUE>::jointFromShortcuts(Key j1, Key j2, const sharedClique& C1, const sharedClique& C2,
+      const sharedClique& B, const FactorGraphType& p_B,
+      const typename EliminationTraitsType::BayesTreeType& p_C1_B,
+      const typename EliminationTraitsType::BayesTreeType& p_C2_B, const Eliminate& function)
+  {
     // Build joint on all involved variables
+    gttic(Variable_joint);
     FactorGraphType p_BC1C2;
+    p_BC1C2 += p_B;
+    p_BC1C2 += p_C1_B;
+    p_BC1C2 += p_C2_B;
+    if(C1 != B)
+      p_BC1C2 += C1->conditional();
+    if(C2 != B)
+      p_BC1C2 += C2->conditional();
+    gttoc(Variable_joint);
 
+    // now, marginalize out everything that is not variable j1 or j2
+    return p_BC1C2.marginalMultifrontalBayesNet(Ordering(cref_list_of<2,Key>(j1)(j2)), boost::none, function);
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  typename BayesTree<CLIQUE>::sharedBayesNet
+    BayesTree<CLIQUE>::jointBayesNet(Key j1, Key j2, const Eliminate& function) const
+  {
+    gttic(BayesTree_jointBayesNet);
+    // get clique C1 and C2
+    sharedClique C1 = (*this)[j1], C2 = (*this)[j2];
+
+    // Find lowest common ancestor clique
+    sharedClique B = lowestCommonAncestor(C1, C2);
+
+    sharedBayesNet joint;
     if(B)
     {
       // Compute marginal on lowest common ancestor clique
       gttic(LCA_marginal);
       FactorGraphType p_B = B->marginal2(function);
       gttoc(LCA_marginal);
+      touchShortcuts(B);
 
-      // Compute shortcuts of the requested cliques given the lowest common ancestor
-      gttic(Clique_shortcuts);
-      BayesNetType p_C1_Bred = C1->shortcut(B, function);
-      BayesNetType p_C2_Bred = C2->shortcut(B, function);
-      gttoc(Clique_shortcuts);
-
-      // Factor the shortcuts to be conditioned on the full root
-      // Get the set of variables to eliminate, which is C1\B.
-      gttic(Full_root_factoring);
-      boost::shared_ptr<typename EliminationTraitsType::BayesTreeType> p_C1_B; {
-        FastVector<Key> C1_minus_B; {
-          FastSet<Key> C1_minus_B_set(C1->conditional()->beginParents(), C1->conditional()->endParents());
-          BOOST_FOREACH(const Key j, *B->conditional()) {
-            C1_minus_B_set.erase(j); }
-          C1_minus_B.assign(C1_minus_B_set.begin(), C1_minus_B_set.end());
-        }
-        // Factor into C1\B | B.
-        sharedFactorGraph temp_remaining;
-        boost::tie(p_C1_B, temp_remaining) =
-          FactorGraphType(p_C1_Bred).eliminatePartialMultifrontal(Ordering(C1_minus_B), function);
-      }
-      boost::shared_ptr<typename EliminationTraitsType::BayesTreeType> p_C2_B; {
-        FastVector<Key> C2_minus_B; {
-          FastSet<Key> C2_minus_B_set(C2->conditional()->beginParents(), C2->conditional()->endParents());
-          BOOST_FOREACH(const Key j, *B->conditional()) {
-            C2_minus_B_set.erase(j); }
-          C2_minus_B.assign(C2_minus_B_set.begin(), C2_minus_B_set.end());
-        }
-        // Factor into C2\B | B.
-        sharedFactorGraph temp_remaining;
-        boost::tie(p_C2_B, temp_remaining) =
-          FactorGraphType(p_C2_Bred).eliminatePartialMultifrontal(Ordering(C2_minus_B), function);
-      }
-      gttoc(Full_root_factoring);
-
-      gttic(Variable_joint);
-      p_BC1C2 += p_B;
-      p_BC1C2 += *p_C1_B;
-      p_BC1C2 += *p_C2_B;
-      if(C1 != B)
-        p_BC1C2 += C1->conditional();
-      if(C2 != B)
-        p_BC1C2 += C2->conditional();
-      gttoc(Variable_joint);
+      joint = jointFromShortcuts(j1, j2, C1, C2, B, p_B,
+        *shortcutGivenAncestor(C1, B, function), *shortcutGivenAncestor(C2, B, function), function);
     }
     else
     {
       // The nodes have no common ancestor, they're in different trees, so they're joint is just the
       // product of their marginals.
       gttic(Disjoint_marginals);
-      p_BC1C2 += C1->marginal2(function);
-      p_BC1C2 += C2->marginal2(function);
+      FactorGraphType p_C1C2;
+      p_C1C2 += C1->marginal2(function);
+      p_C1C2 += C2->marginal2(function);
       gttoc(Disjoint_marginals);
+      touchShortcuts(C1);
+      touchShortcuts(C2);
+
+      // now, marginalize out everything that is not variable j1 or j2
+      joint = p_C1C2.marginalMultifrontalBayesNet(Ordering(cref_list_of<2,Key>(j1)(j2)), boost::none, function);
     }
 
-    // now, marginalize out everything that is not variable j1 or j2
-    return p_BC1C2.marginalMultifrontalBayesNet(Ordering(cref_list_of<2,Key>(j1)(j2)), boost::none, function);
+    enforceShortcutCacheCapacity();
+    return joint;
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  void BayesTree<CLIQUE>::jointBayesNetsGroup(const JointGroup& group, const std::vector<KeyPair>& pairs,
+    const Nodes& nodes, std::vector<sharedBayesNet>& results, const Eliminate& function)
+  {
+    if(group.B)
+    {
+      // The marginal on the common ancestor and the factored shortcut of each clique are shared by
+      // the queries of the group
+      FactorGraphType p_B = group.B->marginal2(function);
+      typedef boost::shared_ptr<typename EliminationTraitsType::BayesTreeType> sharedShortcut;
+      FastMap<sharedClique, sharedShortcut> shortcuts;
+      BOOST_FOREACH(size_t i, group.queries) {
+        const Key j1 = pairs[i].first, j2 = pairs[i].second;
+        sharedClique C1 = nodes.at(j1), C2 = nodes.at(j2);
+        sharedShortcut& p_C1_B = shortcuts[C1];
+        if(!p_C1_B)
+          p_C1_B = shortcutGivenAncestor(C1, group.B, function);
+        sharedShortcut& p_C2_B = shortcuts[C2];
+        if(!p_C2_B)
+          p_C2_B = shortcutGivenAncestor(C2, group.B, function);
+        results[i] = jointFromShortcuts(j1, j2, C1, C2, group.B, p_B, *p_C1_B, *p_C2_B, function);
+      }
+    }
+    else
+    {
+      // Queries on different trees are the product of the marginals of both cliques
+      BOOST_FOREACH(size_t i, group.queries) {
+        const Key j1 = pairs[i].first, j2 = pairs[i].second;
+        FactorGraphType p_C1C2;
+        p_C1C2 += nodes.at(j1)->marginal2(function);
+        p_C1C2 += nodes.at(j2)->marginal2(function);
+        results[i] = p_C1C2.marginalMultifrontalBayesNet(Ordering(cref_list_of<2,Key>(j1)(j2)), boost::none, function);
+      }
+    }
+  }
+
+#ifdef GTSAM_USE_TBB
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  struct BayesTree<CLIQUE>::JointBayesNetsGroups {
+    const FastVector<JointGroup>& groups;
+    const std::vector<KeyPair>& pairs;
+    const Nodes& nodes;
+    std::vector<sharedBayesNet>& results;
+    const Eliminate& function;
+    JointBayesNetsGroups(const FastVector<JointGroup>& groups, const std::vector<KeyPair>& pairs,
+      const Nodes& nodes, std::vector<sharedBayesNet>& results, const Eliminate& function) :
+      groups(groups), pairs(pairs), nodes(nodes), results(results), function(function) {}
+    void operator()(const tbb::blocked_range<size_t>& r) const
+    {
+      for(size_t g = r.begin(); g != r.end(); ++g)
+        jointBayesNetsGroup(groups[g], pairs, nodes, results, function);
+    }
+  };
+#endif
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  std::vector<typename BayesTree<CLIQUE>::sharedBayesNet>
+    BayesTree<CLIQUE>::jointBayesNets(const std::vector<KeyPair>& pairs, const Eliminate& function) const
+  {
+    gttic(BayesTree_jointBayesNets);
+
+    // Group the queries by the lowest common ancestor of their cliques
+    FastVector<JointGroup> groups;
+    {
+      FastMap<sharedClique, size_t> groupIndices;
+      for(size_t i = 0; i < pairs.size(); ++i) {
+        sharedClique B = lowestCommonAncestor(clique(pairs[i].first), clique(pairs[i].second));
+        typename FastMap<sharedClique, size_t>::const_iterator group =
+          groupIndices.insert(std::make_pair(B, groups.size())).first;
+        if(group->second == groups.size()) {
+          groups.push_back(JointGroup());
+          groups.back().B = B;
+        }
+        groups[group->second].queries.push_back(i);
+      }
+    }
+
+    // Compute the separator marginals needed by all groups here, so that evaluating the groups
+    // only reads the cached marginals and can safely run concurrently
+    gttic(Prefetch_marginals);
+    BOOST_FOREACH(const JointGroup& group, groups) {
+      if(group.B) {
+        group.B->separatorMarginal(function);
+        touchShortcuts(group.B);
+      } else {
+        BOOST_FOREACH(size_t i, group.queries) {
+          const sharedClique& C1 = nodes_.at(pairs[i].first);
+          const sharedClique& C2 = nodes_.at(pairs[i].second);
+          C1->separatorMarginal(function);
+          C2->separatorMarginal(function);
+          touchShortcuts(C1);
+          touchShortcuts(C2);
+        }
+      }
+    }
+    gttoc(Prefetch_marginals);
+
+    // Evaluate the groups
+    std::vector<sharedBayesNet> results(pairs.size());
+#ifdef GTSAM_USE_TBB
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, groups.size()),
+      JointBayesNetsGroups(groups, pairs, nodes_, results, function));
+#else
+    BOOST_FOREACH(const JointGroup& group, groups) {
+      jointBayesNetsGroup(group, pairs, nodes_, results, function); }
+#endif
+
+    enforceShortcutCacheCapacity();
+    return results;
   }
 
   /* ************************************************************************* */
@@ -398,6 +544,8 @@ namespace gtsam {
     // Remove all nodes and clear the root pointer
     nodes_.clear();
     roots_.clear();
+    shortcutCacheOrder_.clear();
+    shortcutCachePositions_.clear();
   }
 
   /* ************************************************************************* */
@@ -406,6 +554,84 @@ namespace gtsam {
     BOOST_FOREACH(const sharedClique& root, roots_) {
       root->deleteCachedShortcuts();
     }
+    shortcutCacheOrder_.clear();
+    shortcutCachePositions_.clear();
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  void BayesTree<CLIQUE>::setShortcutCacheCapacity(size_t capacity) {
+    // Separator marginals are only tracked while the cache is bounded, so those cached while it
+    // was unbounded are dropped, as when copying a tree
+    if(shortcutCacheCapacity_ == 0 && capacity > 0)
+      deleteCachedShortcuts();
+    shortcutCacheCapacity_ = capacity;
+    if(capacity == 0) {
+      shortcutCacheOrder_.clear();
+      shortcutCachePositions_.clear();
+    }
+    enforceShortcutCacheCapacity();
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  void BayesTree<CLIQUE>::prefetchShortcuts(const FastVector<Key>& keys, const Eliminate& function) const {
+    gttic(BayesTree_prefetchShortcuts);
+    BOOST_FOREACH(Key j, keys) {
+      const sharedClique& C = clique(j);
+      C->separatorMarginal(function);
+      touchShortcuts(C);
+    }
+    enforceShortcutCacheCapacity();
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  void BayesTree<CLIQUE>::touchShortcuts(const sharedClique& clique) const {
+    // Nothing is evicted from an unbounded cache, so there is no need to track its use
+    if(shortcutCacheCapacity_ == 0)
+      return;
+    // Move the clique to the front first and then each ancestor, so that ancestors are always
+    // more recently used than their descendants
+    for(sharedClique C = clique; C && C->cachedSeparatorMarginal(); C = C->parent()) {
+      typename FastMap<const Clique*, typename ShortcutCacheOrder::iterator>::iterator position =
+        shortcutCachePositions_.find(C.get());
+      if(position != shortcutCachePositions_.end()) {
+        // The address may have been reused by a new clique, so also refresh the weak pointer
+        position->second->second = C;
+        shortcutCacheOrder_.splice(shortcutCacheOrder_.begin(), shortcutCacheOrder_, position->second);
+      } else {
+        shortcutCacheOrder_.push_front(std::make_pair(C.get(), boost::weak_ptr<Clique>(C)));
+        shortcutCachePositions_.insert(std::make_pair(C.get(), shortcutCacheOrder_.begin()));
+      }
+    }
+  }
+
+  /* ************************************************************************* */
+  template<class CLIQUE>
+  void BayesTree<CLIQUE>::enforceShortcutCacheCapacity() const {
+    if(shortcutCacheCapacity_ == 0 || shortcutCacheOrder_.size() <= shortcutCacheCapacity_)
+      return;
+    // First drop the cliques that were removed from the tree or whose cache was already cleared,
+    // so that they do not take up the capacity
+    for(typename ShortcutCacheOrder::iterator it = shortcutCacheOrder_.begin();
+        it != shortcutCacheOrder_.end(); ) {
+      sharedClique C = it->second.lock();
+      if(!C || !C->cachedSeparatorMarginal()) {
+        shortcutCachePositions_.erase(it->first);
+        it = shortcutCacheOrder_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    while(shortcutCacheOrder_.size() > shortcutCacheCapacity_) {
+      // Deleting recursively also clears any cached marginals below the evicted clique that were
+      // computed without going through this tree
+      if(sharedClique C = shortcutCacheOrder_.back().second.lock())
+        C->deleteCachedShortcuts();
+      shortcutCachePositions_.erase(shortcutCacheOrder_.back().first);
+      shortcutCacheOrder_.pop_back();
+    }
   }
 
   /* ************************************************************************* */
@@ -25,6 +25,11 @@
 #include <gtsam/base/FastList.h>
 #include <gtsam/base/ConcurrentMap.h>
 #include <gtsam/base/FastVector.h>
+#include <gtsam/base/FastMap.h>
+
+#include <boost/weak_ptr.hpp>
+#include <utility>
+#include <vector>
 
 namespace gtsam {
 
@@ -82,6 +87,7 @@ namespace gtsam {
     typedef boost::shared_ptr<FactorGraphType> sharedFactorGraph;
     typedef typename FactorGraphType::Eliminate Eliminate;
     typedef typename CLIQUE::EliminationTraitsType EliminationTraitsType;
+    typedef std::pair<Key, Key> KeyPair; ///< A pair of variables, for batched joint queries
 
     /** A convenience class for a list of shared cliques */
     typedef FastList<sharedClique> Cliques;
@@ -100,11 +106,23 @@ namespace gtsam {
     /** Root cliques */
     Roots roots_;
 
+    /** Maximum number of cliques with cached separator marginals, 0 for no limit */
+    size_t shortcutCacheCapacity_;
+
+    /** Cliques with cached separator marginals, most recently used first.  Ancestors are always
+     *  used after their descendants, so evicting from the back never evicts a clique before the
+     *  cached cliques below it. */
+    typedef FastList<std::pair<const Clique*, boost::weak_ptr<Clique> > > ShortcutCacheOrder;
+    mutable ShortcutCacheOrder shortcutCacheOrder_;
+
+    /** Position of each clique in shortcutCacheOrder_ */
+    mutable FastMap<const Clique*, typename ShortcutCacheOrder::iterator> shortcutCachePositions_;
+
     /// @name Standard Constructors
     /// @{
 
     /** Create an empty Bayes Tree */
-    BayesTree() {}
+    BayesTree() : shortcutCacheCapacity_(0) {}
 
     /** Copy constructor */
     BayesTree(const This& other);
@@ -180,6 +198,17 @@ namespace gtsam {
      */
     sharedBayesNet jointBayesNet(Key j1, Key j2, const Eliminate& function = EliminationTraitsType::DefaultEliminate) const;
 
+    /**
+     * Return the joints on many pairs of variables as BayesNets, in the order of the pairs.  This
+     * is equivalent to calling jointBayesNet() for each pair, but the pairs are grouped by the
+     * lowest common ancestor of their cliques, so that the marginal of the ancestor and the
+     * shortcut of each clique are only computed once per group.  The separator marginals are
+     * computed serially first, after which the groups are evaluated in parallel when compiled
+     * with TBB.
+     */
+    std::vector<sharedBayesNet> jointBayesNets(const std::vector<KeyPair>& pairs,
+      const Eliminate& function = EliminationTraitsType::DefaultEliminate) const;
+
     /**
      * Read only with side effects
      */
@@ -204,6 +233,24 @@ namespace gtsam {
     /** Clear all shortcut caches - use before timing on marginal calculation to avoid residual cache data */
     void deleteCachedShortcuts();
 
+    /** Limit the number of cliques that keep their separator marginal cached by marginalFactor(),
+     *  jointBayesNet() and related queries.  When the limit is exceeded, the least recently used
+     *  cached marginals are discarded, starting from the leaves.  The default of 0 means no limit,
+     *  in which case the use of the cached marginals is not tracked.  Marginals cached while there
+     *  was no limit are therefore discarded when setting one.
+     */
+    void setShortcutCacheCapacity(size_t capacity);
+
+    /** The limit on the number of cached separator marginals, see setShortcutCacheCapacity() */
+    size_t shortcutCacheCapacity() const { return shortcutCacheCapacity_; }
+
+    /** Compute and cache the separator marginals on the paths from the cliques of the given
+     *  variables to the root, e.g. before querying many marginals near those variables.  The
+     *  cache capacity is enforced afterwards, so prefetching more cliques than the capacity only
+     *  keeps the most recent ones. */
+    void prefetchShortcuts(const FastVector<Key>& keys,
+      const Eliminate& function = EliminationTraitsType::DefaultEliminate) const;
+
     /**
      * Remove path from clique to root and return that path as factors
      * plus a list of orphaned subtree roots. Used in removeTop below.
@@ -246,6 +293,41 @@ namespace gtsam {
     /** Fill the nodes index for a subtree */
     void fillNodesIndex(const sharedClique& subtree);
 
+    /** Mark the cached separator marginals of a clique and its ancestors as most recently used */
+    void touchShortcuts(const sharedClique& clique) const;
+
+    /** Discard the least recently used separator marginals until at most shortcutCacheCapacity_
+     *  remain cached */
+    void enforceShortcutCacheCapacity() const;
+
+    /** Find the lowest common ancestor of two cliques, or null if they are in different trees */
+    static sharedClique lowestCommonAncestor(const sharedClique& C1, const sharedClique& C2);
+
+    /** Factor the shortcut of clique C to its ancestor B into a Bayes tree on \f$ S \setminus B \f$
+     *  given B, where S is the separator of C */
+    static boost::shared_ptr<typename EliminationTraitsType::BayesTreeType> shortcutGivenAncestor(
+      const sharedClique& C, const sharedClique& B, const Eliminate& function);
+
+    /** Compute the joint on j1 and j2 from the marginal on their lowest common ancestor B and the
+     *  factored shortcuts of their cliques C1 and C2 (see shortcutGivenAncestor()) */
+    static sharedBayesNet jointFromShortcuts(Key j1, Key j2, const sharedClique& C1, const sharedClique& C2,
+      const sharedClique& B, const FactorGraphType& p_B,
+      const typename EliminationTraitsType::BayesTreeType& p_C1_B,
+      const typename EliminationTraitsType::BayesTreeType& p_C2_B, const Eliminate& function);
+
+    /** The queries of jointBayesNets() that share the same lowest common ancestor, which is null
+     *  for queries on cliques in different trees */
+    struct JointGroup {
+      sharedClique B;
+      FastVector<size_t> queries;
+    };
+
+    /** Evaluate one group of jointBayesNets(), reading only separator marginals that are cached */
+    static void jointBayesNetsGroup(const JointGroup& group, const std::vector<KeyPair>& pairs,
+      const Nodes& nodes, std::vector<sharedBayesNet>& results, const Eliminate& function);
+
+    struct JointBayesNetsGroups;
+
     // Friend JunctionTree because it directly fills roots and nodes index.
     template<class BAYESRTEE, class GRAPH> friend class ClusterTree;
 
@@ -197,6 +197,186 @@ namespace gtsam {
     return Ordering::COLAMDConstrained(variableIndex, cmember);
   }
 
+  /* ************************************************************************* */
+  namespace {
+    const size_t separatorRegion = numeric_limits<size_t>::max();
+
+    /* ************************************************************************* */
+    // Recursive bisection of the variable graph that assigns CCOLAMD constraint groups in
+    // postorder, i.e. the groups of both halves before the group of their separator.  Vertices
+    // belong to regions, and all graph searches are restricted to the current region.
+    class NestedDissector {
+    public:
+      NestedDissector(const vector<vector<size_t> >& adjacency, size_t maxLeafSize) :
+        groups(adjacency.size(), -1), nrGroups(0),
+        adjacency_(adjacency), maxLeafSize_(std::max(maxLeafSize, size_t(1))),
+        region_(adjacency.size(), 0), nrRegions_(1), visited_(adjacency.size(), 0), nrSearches_(0) {}
+
+      vector<int> groups; ///< Constraint group of each vertex
+      int nrGroups; ///< Number of groups assigned so far
+
+      /// Dissect all connected components of region 0, which initially holds all vertices
+      void dissect() {
+        vector<size_t> vertices(adjacency_.size());
+        for(size_t v = 0; v < vertices.size(); ++v)
+          vertices[v] = v;
+        dissectComponents(vertices, 0);
+      }
+
+    private:
+      const vector<vector<size_t> >& adjacency_;
+      const size_t maxLeafSize_;
+      vector<size_t> region_; // Current region of each vertex, or separatorRegion
+      size_t nrRegions_;
+      vector<size_t> visited_; // Last search that visited each vertex
+      size_t nrSearches_;
+
+      // Breadth-first search from root within its region, returning the vertices in visiting order
+      // and the start of each level in levelStarts, followed by the number of vertices visited.
+      void levelStructure(size_t root, vector<size_t>& order, vector<size_t>& levelStarts) {
+        const size_t region = region_[root], search = ++nrSearches_;
+        order.clear();
+        levelStarts.clear();
+        order.push_back(root);
+        visited_[root] = search;
+        size_t begin = 0;
+        while(begin < order.size()) {
+          levelStarts.push_back(begin);
+          const size_t end = order.size();
+          for(size_t i = begin; i < end; ++i) {
+            BOOST_FOREACH(size_t w, adjacency_[order[i]]) {
+              if(region_[w] == region && visited_[w] != search) {
+                visited_[w] = search;
+                order.push_back(w);
+              }
+            }
+          }
+          begin = end;
+        }
+        levelStarts.push_back(order.size());
+      }
+
+      // Split the given vertices of region into connected components, give the ones of at most
+      // maxLeafSize_ vertices together one group, and dissect the others.
+      void dissectComponents(const vector<size_t>& vertices, size_t region) {
+        vector<size_t> leaves, order, levelStarts;
+        vector<vector<size_t> > components;
+        BOOST_FOREACH(size_t v, vertices) {
+          if(region_[v] != region)
+            continue;
+          levelStructure(v, order, levelStarts);
+          const size_t component = nrRegions_++;
+          BOOST_FOREACH(size_t w, order)
+            region_[w] = component;
+          if(order.size() <= maxLeafSize_)
+            leaves.insert(leaves.end(), order.begin(), order.end());
+          else
+            components.push_back(order);
+        }
+
+        if(!leaves.empty()) {
+          BOOST_FOREACH(size_t v, leaves)
+            groups[v] = nrGroups;
+          ++ nrGroups;
+        }
+        BOOST_FOREACH(const vector<size_t>& component, components)
+          bisect(component);
+      }
+
+      // Bisect a connected component of more than maxLeafSize_ vertices
+      void bisect(const vector<size_t>& vertices) {
+        // Find a pseudo-peripheral root by restarting from a vertex of minimum degree in the last
+        // level, for as long as that increases the number of levels
+        vector<size_t> order, levelStarts, candidateOrder, candidateStarts;
+        levelStructure(vertices.front(), order, levelStarts);
+        for(;;) {
+          size_t candidate = order[levelStarts[levelStarts.size() - 2]];
+          for(size_t i = levelStarts[levelStarts.size() - 2]; i < order.size(); ++i)
+            if(adjacency_[order[i]].size() < adjacency_[candidate].size())
+              candidate = order[i];
+          levelStructure(candidate, candidateOrder, candidateStarts);
+          if(candidateStarts.size() <= levelStarts.size())
+            break;
+          order.swap(candidateOrder);
+          levelStarts.swap(candidateStarts);
+        }
+
+        // Without at least three levels there is no separator that splits the component
+        const size_t nrLevels = levelStarts.size() - 1;
+        if(nrLevels < 3) {
+          BOOST_FOREACH(size_t v, vertices)
+            groups[v] = nrGroups;
+          ++ nrGroups;
+          return;
+        }
+
+        // The separator is the level containing the median vertex, but not the first or last
+        size_t middle = 1;
+        while(middle < nrLevels - 2 && levelStarts[middle + 1] <= order.size() / 2)
+          ++ middle;
+
+        // Separator vertices without neighbors in the next level are moved to the first half
+        const size_t region = region_[vertices.front()], next = ++nrSearches_;
+        for(size_t i = levelStarts[middle + 1]; i < levelStarts[middle + 2]; ++i)
+          visited_[order[i]] = next;
+        vector<size_t> separatorVertices;
+        for(size_t i = levelStarts[middle]; i < levelStarts[middle + 1]; ++i) {
+          const size_t v = order[i];
+          BOOST_FOREACH(size_t w, adjacency_[v]) {
+            if(visited_[w] == next) {
+              separatorVertices.push_back(v);
+              break;
+            }
+          }
+        }
+        BOOST_FOREACH(size_t v, separatorVertices)
+          region_[v] = separatorRegion;
+
+        // Order both halves, then the separator
+        dissectComponents(vertices, region);
+        BOOST_FOREACH(size_t v, separatorVertices)
+          groups[v] = nrGroups;
+        ++ nrGroups;
+      }
+    };
+  }
+
+  /* ************************************************************************* */
+  Ordering Ordering::NestedDissection(const VariableIndex& variableIndex, size_t maxLeafSize)
+  {
+    gttic(Ordering_NestedDissection);
+
+    // Number the variables in key order as COLAMDConstrained does, and collect the variables of
+    // each factor
+    const size_t nVars = variableIndex.size();
+    vector<vector<size_t> > factorVariables(variableIndex.nFactors());
+    size_t index = 0;
+    BOOST_FOREACH(const VariableIndex::value_type& key_factors, variableIndex) {
+      BOOST_FOREACH(size_t factorIndex, key_factors.second)
+        factorVariables[factorIndex].push_back(index);
+      ++ index;
+    }
+
+    // Variables are adjacent if they share a factor
+    vector<vector<size_t> > adjacency(nVars);
+    BOOST_FOREACH(const vector<size_t>& variables, factorVariables) {
+      BOOST_FOREACH(size_t i, variables) {
+        BOOST_FOREACH(size_t j, variables) {
+          if(i != j)
+            adjacency[i].push_back(j);
+        }
+      }
+    }
+    BOOST_FOREACH(vector<size_t>& neighbors, adjacency) {
+      std::sort(neighbors.begin(), neighbors.end());
+      neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    NestedDissector dissector(adjacency, maxLeafSize);
+    dissector.dissect();
+    return Ordering::COLAMDConstrained(variableIndex, dissector.groups);
+  }
+
   /* ************************************************************************* */
   void Ordering::print(const std::string& str, const KeyFormatter& keyFormatter) const
   {
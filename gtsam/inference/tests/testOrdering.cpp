@@ -16,11 +16,13 @@
 
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/symbolic/SymbolicFactorGraph.h>
+#include <gtsam/symbolic/SymbolicBayesTree.h>
 #include <gtsam/inference/Ordering.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <CppUnitLite/TestHarness.h>
 
 #include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
 
 using namespace std;
 using namespace gtsam;
@@ -77,6 +79,65 @@ TEST(Ordering, grouped_constrained_ordering) {
   EXPECT(assert_equal(expConstrained, actConstrained));
 }
 
+namespace {
+  // Number of cliques on the longest path from clique to a leaf
+  size_t height(const SymbolicBayesTree::sharedClique& clique) {
+    size_t result = 0;
+    BOOST_FOREACH(const SymbolicBayesTree::sharedClique& child, clique->children)
+      result = std::max(result, height(child));
+    return result + 1;
+  }
+}
+
+/* ************************************************************************* */
+TEST(Ordering, nestedDissection_chain) {
+  // A chain of 63 variables is bisected in the middle, recursively
+  SymbolicFactorGraph sfg;
+  for(size_t j = 1; j < 63; ++j)
+    sfg.push_factor(j - 1, j);
+
+  Ordering actual = Ordering::NestedDissection(sfg, 1);
+  LONGS_EQUAL(63, (long)actual.size());
+  FastMap<Key, size_t> positions = actual.invert();
+  LONGS_EQUAL(63, (long)positions.size());
+  EXPECT_LONGS_EQUAL(31, (long)actual.back());
+
+  // Both halves are ordered before their separators, which are in the middle of each half
+  EXPECT_LONGS_EQUAL(15, (long)actual[30]);
+  EXPECT_LONGS_EQUAL(47, (long)actual[61]);
+  for(size_t j = 0; j < 31; ++j)
+    EXPECT(positions[j] < 31 && positions[j + 32] >= 31);
+}
+
+/* ************************************************************************* */
+TEST(Ordering, nestedDissection_grid) {
+  // A 12x12 grid with a few disconnected variables
+  const size_t n = 12;
+  SymbolicFactorGraph sfg;
+  for(size_t i = 0; i < n; ++i) {
+    for(size_t j = 0; j < n; ++j) {
+      if(i > 0) sfg.push_factor((i - 1) * n + j, i * n + j);
+      if(j > 0) sfg.push_factor(i * n + j - 1, i * n + j);
+    }
+  }
+  sfg.push_factor(1000);
+  sfg.push_factor(1001, 1002);
+
+  // Small leaves, every variable appears once
+  Ordering actual = Ordering::NestedDissection(sfg, 8);
+  LONGS_EQUAL(n * n + 3, (long)actual.size());
+  EXPECT_LONGS_EQUAL(n * n + 3, (long)actual.invert().size());
+
+  // The Bayes tree of the grid is shallower than with COLAMD
+  sfg.resize(sfg.size() - 2);
+  Ordering nestedDissection = Ordering::NestedDissection(sfg, 8), colamd = Ordering::COLAMD(sfg);
+  EXPECT(height(sfg.eliminateMultifrontal(nestedDissection)->roots().front()) <
+    height(sfg.eliminateMultifrontal(colamd)->roots().front()));
+
+  // Without bisection this is the same as COLAMD
+  EXPECT(assert_equal(Ordering::COLAMD(sfg), Ordering::NestedDissection(sfg, 1000)));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
 /* ************************************************************************* */
@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file CompiledGaussianFactorGraph.cpp
+ * @brief A GaussianFactorGraph flattened into a block-sparse operator for iterative solvers
+ */
+
+#include <gtsam/linear/CompiledGaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/base/timing.h>
+
+#include <boost/foreach.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <stdexcept>
+
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#endif
+
+using namespace std;
+
+namespace gtsam {
+
+  namespace {
+    /* ************************************************************************* */
+    // The matrix and vector compiled for a factor: the whitened Jacobian and b of a
+    // JacobianFactor, or the information matrix and linear term of a HessianFactor.  Returns
+    // whether gf is a JacobianFactor.
+    bool compiledBlocks(const GaussianFactor::shared_ptr& gf, Matrix& A, Vector& b)
+    {
+      if(JacobianFactor::shared_ptr jf = boost::dynamic_pointer_cast<JacobianFactor>(gf)) {
+        if(jf->get_model() && jf->isConstrained())
+          throw invalid_argument(
+            "CompiledGaussianFactorGraph: constrained noise models are not supported");
+        boost::tie(A, b) = jf->jacobian();
+        return true;
+      } else if(HessianFactor::shared_ptr hf = boost::dynamic_pointer_cast<HessianFactor>(gf)) {
+        A = hf->information();
+        b = hf->linearTerm();
+        return false;
+      } else {
+        throw invalid_argument(
+          "CompiledGaussianFactorGraph: gfg contains a factor that is neither a JacobianFactor nor a HessianFactor.");
+      }
+    }
+  }
+
+  /* ************************************************************************* */
+  CompiledGaussianFactorGraph::CompiledGaussianFactorGraph(
+    const GaussianFactorGraph& gfg, const KeyInfo& keyInfo) : dim_((DenseIndex)keyInfo.numCols())
+  {
+    gttic(CompiledGaussianFactorGraph_compile);
+
+    const size_t n = keyInfo.size();
+    columns_.resize(n);
+    dims_.resize(n);
+    BOOST_FOREACH(const KeyInfo::value_type& key_entry, keyInfo) {
+      columns_[key_entry.second.index()] = (DenseIndex)key_entry.second.colstart();
+      dims_[key_entry.second.index()] = (DenseIndex)key_entry.second.dim();
+    }
+
+    // Copy the blocks of all factors, and collect the contributions to each variable
+    vector<double> rhs;
+    vector<pair<size_t, Contribution> > jacobianContributions, hessianContributions;
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& gf, gfg) {
+      if(!gf)
+        continue;
+
+      Matrix A;
+      Vector b;
+      const bool isJacobian = compiledBlocks(gf, A, b);
+
+      Factor factor;
+      factor.firstBlock = blocks_.size();
+      factor.nrBlocks = gf->size();
+      factor.rows = A.rows();
+      factor.buffer = (DenseIndex)rhs.size();
+
+      DenseIndex column = 0;
+      BOOST_FOREACH(Key key, gf->keys()) {
+        const KeyInfoEntry& entry = keyInfo.find(key)->second;
+        Block block;
+        block.column = (DenseIndex)entry.colstart();
+        block.dim = (DenseIndex)entry.dim();
+        block.values = values_.size() + column * A.rows();
+        blocks_.push_back(block);
+
+        Contribution contribution;
+        contribution.values = block.values;
+        contribution.rows = isJacobian ? factor.rows : block.dim;
+        contribution.buffer = isJacobian ? factor.buffer : factor.buffer + column;
+        if(isJacobian)
+          jacobianContributions.push_back(make_pair(entry.index(), contribution));
+        else
+          hessianContributions.push_back(make_pair(entry.index(), contribution));
+        column += block.dim;
+      }
+
+      values_.insert(values_.end(), A.data(), A.data() + A.size());
+      rhs.insert(rhs.end(), b.data(), b.data() + b.size());
+      (isJacobian ? jacobians_ : hessians_).push_back(factor);
+    }
+
+    rhs_ = Eigen::Map<const Vector>(rhs.empty() ? 0 : &rhs[0], rhs.size());
+    buffer_ = Vector::Zero(rhs.size());
+
+    // Sort the contributions by variable, keeping the order of the factors
+    typedef pair<size_t, Contribution> IndexedContribution;
+    jacobianStarts_.assign(n + 1, 0);
+    hessianStarts_.assign(n + 1, 0);
+    BOOST_FOREACH(const IndexedContribution& c, jacobianContributions)
+      ++ jacobianStarts_[c.first + 1];
+    BOOST_FOREACH(const IndexedContribution& c, hessianContributions)
+      ++ hessianStarts_[c.first + 1];
+    for(size_t j = 0; j < n; ++j) {
+      jacobianStarts_[j + 1] += jacobianStarts_[j];
+      hessianStarts_[j + 1] += hessianStarts_[j];
+    }
+    jacobianContributions_.resize(jacobianContributions.size());
+    hessianContributions_.resize(hessianContributions.size());
+    vector<size_t> next(jacobianStarts_.begin(), jacobianStarts_.end() - 1);
+    BOOST_FOREACH(const IndexedContribution& c, jacobianContributions)
+      jacobianContributions_[next[c.first]++] = c.second;
+    next.assign(hessianStarts_.begin(), hessianStarts_.end() - 1);
+    BOOST_FOREACH(const IndexedContribution& c, hessianContributions)
+      hessianContributions_[next[c.first]++] = c.second;
+  }
+
+  /* ************************************************************************* */
+  bool CompiledGaussianFactorGraph::refresh(const GaussianFactorGraph& gfg)
+  {
+    gttic(CompiledGaussianFactorGraph_refresh);
+
+    // The factors are compiled in the order of gfg, the JacobianFactors and HessianFactors
+    // separately, and the blocks of each factor are contiguous in values_
+    size_t nextJacobian = 0, nextHessian = 0;
+    Matrix A;
+    Vector b;
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& gf, gfg) {
+      if(!gf)
+        continue;
+      const bool isJacobian = compiledBlocks(gf, A, b);
+      const vector<Factor>& factors = isJacobian ? jacobians_ : hessians_;
+      size_t& next = isJacobian ? nextJacobian : nextHessian;
+      if(next == factors.size())
+        return false;
+      const Factor& factor = factors[next++];
+      if(factor.rows != A.rows() || factor.nrBlocks != gf->size())
+        return false;
+      copy(A.data(), A.data() + A.size(), values_.begin() + blocks_[factor.firstBlock].values);
+      rhs_.segment(factor.buffer, factor.rows) = b;
+    }
+    return nextJacobian == jacobians_.size() && nextHessian == hessians_.size();
+  }
+
+  /* ************************************************************************* */
+  void CompiledGaussianFactorGraph::multiplyFactors(
+    const vector<Factor>& factors, const Vector& x, size_t begin, size_t end) const
+  {
+    for(size_t f = begin; f != end; ++f) {
+      const Factor& factor = factors[f];
+      Vector::SegmentReturnType y = buffer_.segment(factor.buffer, factor.rows);
+      y.setZero();
+      for(size_t k = factor.firstBlock; k != factor.firstBlock + factor.nrBlocks; ++k) {
+        const Block& block = blocks_[k];
+        y.noalias() += Eigen::Map<const Matrix>(&values_[block.values], factor.rows, block.dim)
+          * x.segment(block.column, block.dim);
+      }
+    }
+  }
+
+  /* ************************************************************************* */
+  void CompiledGaussianFactorGraph::gatherVariables(
+    const Vector& source, Vector& y, size_t begin, size_t end) const
+  {
+    for(size_t j = begin; j != end; ++j) {
+      Vector::SegmentReturnType yj = y.segment(columns_[j], dims_[j]);
+      yj.setZero();
+      for(size_t i = jacobianStarts_[j]; i != jacobianStarts_[j + 1]; ++i) {
+        const Contribution& c = jacobianContributions_[i];
+        yj.noalias() += Eigen::Map<const Matrix>(&values_[c.values], c.rows, dims_[j]).transpose()
+          * source.segment(c.buffer, c.rows);
+      }
+      for(size_t i = hessianStarts_[j]; i != hessianStarts_[j + 1]; ++i) {
+        const Contribution& c = hessianContributions_[i];
+        yj += source.segment(c.buffer, c.rows);
+      }
+    }
+  }
+
+#ifdef GTSAM_USE_TBB
+  /* ************************************************************************* */
+  struct CompiledGaussianFactorGraph::MultiplyFactors {
+    const CompiledGaussianFactorGraph& graph;
+    const vector<Factor>& factors;
+    const Vector& x;
+    MultiplyFactors(const CompiledGaussianFactorGraph& graph, const vector<Factor>& factors, const Vector& x) :
+      graph(graph), factors(factors), x(x) {}
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+      graph.multiplyFactors(factors, x, r.begin(), r.end());
+    }
+  };
+
+  /* ************************************************************************* */
+  struct CompiledGaussianFactorGraph::GatherVariables {
+    const CompiledGaussianFactorGraph& graph;
+    const Vector& source;
+    Vector& y;
+    GatherVariables(const CompiledGaussianFactorGraph& graph, const Vector& source, Vector& y) :
+      graph(graph), source(source), y(y) {}
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+      graph.gatherVariables(source, y, r.begin(), r.end());
+    }
+  };
+#endif
+
+  /* ************************************************************************* */
+  void CompiledGaussianFactorGraph::multiply(const Vector& x, Vector& y) const
+  {
+#ifdef GTSAM_USE_TBB
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, jacobians_.size()),
+      MultiplyFactors(*this, jacobians_, x));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, hessians_.size()),
+      MultiplyFactors(*this, hessians_, x));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, dims_.size()),
+      GatherVariables(*this, buffer_, y));
+#else
+    multiplyFactors(jacobians_, x, 0, jacobians_.size());
+    multiplyFactors(hessians_, x, 0, hessians_.size());
+    gatherVariables(buffer_, y, 0, dims_.size());
+#endif
+  }
+
+  /* ************************************************************************* */
+  void CompiledGaussianFactorGraph::getb(Vector& b) const
+  {
+    gatherVariables(rhs_, b, 0, dims_.size());
+  }
+
+}
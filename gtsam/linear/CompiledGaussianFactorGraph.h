@@ -0,0 +1,129 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file CompiledGaussianFactorGraph.h
+ * @brief A GaussianFactorGraph flattened into a block-sparse operator for iterative solvers
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/IterativeSolver.h>
+
+#include <vector>
+
+namespace gtsam {
+
+  /**
+   * The Hessian of a GaussianFactorGraph as a block-sparse linear operator on the dense vectors
+   * used by iterative solvers, whose variables are laid out as in a KeyInfo.
+   *
+   * The constructor "compiles" the graph once: the whitened Jacobians of all JacobianFactors and
+   * the information matrices of all HessianFactors are copied into one contiguous array, and the
+   * offset of every block in the vectors is precomputed.  multiply() then needs no factor casts,
+   * key lookups or allocations.  It runs in two passes that do not write to shared memory, which
+   * are both parallel when GTSAM is built with TBB: first each factor multiplies its blocks with
+   * the input into its own segment of a buffer, and then each variable gathers the contributions
+   * of its factors from the buffer.
+   *
+   * Factors with constrained noise models have no Hessian and cannot be compiled.  Since
+   * multiply() uses an internal buffer, it must not be called concurrently on the same object.
+   */
+  class GTSAM_EXPORT CompiledGaussianFactorGraph {
+  public:
+    typedef CompiledGaussianFactorGraph This; ///< This class
+    typedef boost::shared_ptr<This> shared_ptr; ///< Shared pointer to this class
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Compile \c gfg, whose variables are laid out as in \c keyInfo.  Throws
+     *  std::invalid_argument for factors that are neither JacobianFactor nor HessianFactor, and
+     *  for constrained noise models. */
+    CompiledGaussianFactorGraph(const GaussianFactorGraph& gfg, const KeyInfo& keyInfo);
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** Copy the numeric values of \c gfg, e.g. a relinearization of the graph compiled into this
+     *  object, keeping the block layout.  \c gfg must have the same factors on the same keys, in
+     *  the same variable layout.  Returns false, leaving this object unusable until it is
+     *  recompiled, if a factor changed its type or number of rows. */
+    bool refresh(const GaussianFactorGraph& gfg);
+
+    /** Compute y = A'A x, where A'A is the Hessian of all factors.  y must have the size of x. */
+    void multiply(const Vector& x, Vector& y) const;
+
+    /** Compute b = A'b, i.e. the negative gradient at zero, the sum of the whitened A'b of the
+     *  JacobianFactors and the linear terms of the HessianFactors.  b must be allocated. */
+    void getb(Vector& b) const;
+
+    /** The number of scalar variables */
+    DenseIndex dim() const { return dim_; }
+
+    /** The number of stored matrix entries */
+    size_t nnz() const { return values_.size(); }
+
+    /// @}
+
+  private:
+    /** A dense block of a factor that multiplies one variable */
+    struct Block {
+      DenseIndex column; ///< Offset of the variable in x
+      DenseIndex dim; ///< Dimension of the variable
+      size_t values; ///< Offset of the first column of the block in values_
+    };
+
+    /** A compiled factor, whose product with x is a segment of buffer_.  For a JacobianFactor the
+     *  blocks are the whitened Jacobians, for a HessianFactor the columns of the information
+     *  matrix. */
+    struct Factor {
+      size_t firstBlock; ///< Index of the first block in blocks_
+      size_t nrBlocks; ///< Number of blocks
+      DenseIndex rows; ///< Number of rows of each block, and of the segment in buffer_
+      DenseIndex buffer; ///< Offset of the segment in buffer_
+    };
+
+    /** The contribution of a factor to one variable, with the rows of the factor's segment of
+     *  buffer_ that correspond to the variable for a HessianFactor */
+    struct Contribution {
+      size_t values; ///< Offset of the block in values_, only for JacobianFactors
+      DenseIndex rows; ///< Number of rows of the block
+      DenseIndex buffer; ///< Offset of the factor's segment, or of the variable's rows in it
+    };
+
+    DenseIndex dim_; ///< Total dimension
+    std::vector<double> values_; ///< Blocks of all factors, each column-major
+    std::vector<Block> blocks_; ///< Blocks of all factors
+    std::vector<Factor> jacobians_; ///< The JacobianFactors
+    std::vector<Factor> hessians_; ///< The HessianFactors
+    std::vector<DenseIndex> columns_; ///< Offset of each variable in x, in KeyInfo index order
+    std::vector<DenseIndex> dims_; ///< Dimension of each variable, in KeyInfo index order
+    std::vector<size_t> jacobianStarts_; ///< Start of each variable's contributions in jacobianContributions_
+    std::vector<Contribution> jacobianContributions_; ///< Blocks A_j of JacobianFactors, by variable
+    std::vector<size_t> hessianStarts_; ///< Start of each variable's contributions in hessianContributions_
+    std::vector<Contribution> hessianContributions_; ///< Rows of HessianFactors, by variable
+    Vector rhs_; ///< Whitened b of the JacobianFactors and linear terms of the HessianFactors, laid out as buffer_
+    mutable Vector buffer_; ///< A x of the JacobianFactors and H x of the HessianFactors
+
+    struct MultiplyFactors;
+    struct GatherVariables;
+
+    /** Compute the segments of buffer_ of the factors [begin, end) of \c factors */
+    void multiplyFactors(const std::vector<Factor>& factors, const Vector& x, size_t begin, size_t end) const;
+
+    /** Compute y for the variables [begin, end) from the segments of all factors in \c source */
+    void gatherVariables(const Vector& source, Vector& y, size_t begin, size_t end) const;
+  };
+
+}
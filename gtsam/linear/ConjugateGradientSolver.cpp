@@ -21,7 +21,8 @@ void ConjugateGradientParameters::print(ostream &os) const {
         << "maxIter:       " << maxIterations_ << endl
         << "resetIter:     " << reset_ << endl
         << "eps_rel:       " << epsilon_rel_ << endl
-        << "eps_abs:       " << epsilon_abs_ << endl;
+        << "eps_abs:       " << epsilon_abs_ << endl
+        << "blasKernel:    " << blasTranslator(blas_kernel_) << endl;
 }
 
 /*****************************************************************************/
@@ -29,6 +30,7 @@ std::string ConjugateGradientParameters::blasTranslator(const BLASKernel value)
   std::string s;
   switch (value) {
   case ConjugateGradientParameters::GTSAM:      s = "GTSAM" ;      break;
+  case ConjugateGradientParameters::PARALLEL:   s = "PARALLEL" ;   break;
   default:                                      s = "UNDEFINED" ;  break;
   }
   return s;
@@ -38,6 +40,7 @@ std::string ConjugateGradientParameters::blasTranslator(const BLASKernel value)
 ConjugateGradientParameters::BLASKernel ConjugateGradientParameters::blasTranslator(const std::string &src) {
   std::string s = src;  boost::algorithm::to_upper(s);
   if (s == "GTSAM")  return ConjugateGradientParameters::GTSAM;
+  if (s == "PARALLEL")  return ConjugateGradientParameters::PARALLEL;
 
   /* default is SBM */
   return ConjugateGradientParameters::GTSAM;
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <gtsam/linear/IterativeSolver.h>
+#include <cmath>
 #include <iosfwd>
 
 namespace gtsam {
@@ -34,6 +35,7 @@ public:
   /* Matrix Operation Kernel */
   enum BLASKernel {
     GTSAM = 0,        ///< Jacobian Factor Graph of GTSAM
+    PARALLEL,         ///< Jacobian Factor Graph of GTSAM, products and reductions multithreaded with TBB
   } blas_kernel_ ;
 
   ConjugateGradientParameters()
@@ -47,7 +49,7 @@ public:
 
   ConjugateGradientParameters(const ConjugateGradientParameters &p)
     : Base(p), minIterations_(p.minIterations_), maxIterations_(p.maxIterations_), reset_(p.reset_),
-               epsilon_rel_(p.epsilon_rel_), epsilon_abs_(p.epsilon_abs_), blas_kernel_(GTSAM) {}
+               epsilon_rel_(p.epsilon_rel_), epsilon_abs_(p.epsilon_abs_), blas_kernel_(p.blas_kernel_) {}
 
   /* general interface */
   inline size_t minIterations() const { return minIterations_; }
@@ -56,6 +58,7 @@ public:
   inline double epsilon() const { return epsilon_rel_; }
   inline double epsilon_rel() const { return epsilon_rel_; }
   inline double epsilon_abs() const { return epsilon_abs_; }
+  inline BLASKernel blasKernel() const { return blas_kernel_; }
 
   inline size_t getMinIterations() const { return minIterations_; }
   inline size_t getMaxIterations() const { return maxIterations_; }
@@ -63,6 +66,7 @@ public:
   inline double getEpsilon() const { return epsilon_rel_; }
   inline double getEpsilon_rel() const { return epsilon_rel_; }
   inline double getEpsilon_abs() const { return epsilon_abs_; }
+  inline BLASKernel getBlasKernel() const { return blas_kernel_; }
 
   inline void setMinIterations(size_t value) { minIterations_ = value; }
   inline void setMaxIterations(size_t value) { maxIterations_ = value; }
@@ -70,6 +74,7 @@ public:
   inline void setEpsilon(double value) { epsilon_rel_ = value; }
   inline void setEpsilon_rel(double value) { epsilon_rel_ = value; }
   inline void setEpsilon_abs(double value) { epsilon_abs_ = value; }
+  inline void setBlasKernel(BLASKernel value) { blas_kernel_ = value; }
 
 
   void print() const { Base::print(); }
@@ -82,21 +87,26 @@ public:
 /*********************************************************************************************/
 /*
  * A template of linear preconditioned conjugate gradient method.
- * System class should support residual(v, g), multiply(v,Av), leftPrecondition(v, S^{-t}v,
- * rightPrecondition(v, S^{-1}v), scal(alpha,v), dot(v,v), axpy(alpha,x,y)
- * Note that the residual is in the preconditioned domain. Refer to Section 9.2 of Saad's book.
+ * System class should support residual(v, g), multiply(v,Av), precondition(v, M^{-1}v),
+ * scal(alpha,v), dot(v,v), axpy(alpha,x,y)
+ * M^{-1} can be any symmetric positive definite operator, it does not have to be available in
+ * factored form.  For M^{-1} = S^{-1} S^{-T}, the iterates are those of CG on the split
+ * preconditioned system, and gamma = r' M^{-1} r is the squared norm of its residual, refer to
+ * Section 9.2 of Saad's book.
+ * If given, iterations is set to the number of iterations.
  */
 template <class S, class V>
-V preconditionedConjugateGradient(const S &system, const V &initial, const ConjugateGradientParameters &parameters) {
+V preconditionedConjugateGradient(const S &system, const V &initial, const ConjugateGradientParameters &parameters,
+                                  boost::optional<size_t&> iterations = boost::none) {
 
-  V estimate, residual, direction, q1, q2;
-  estimate = residual = direction = q1 = q2 = initial;
+  V estimate, residual, preconditioned, direction, q1;
+  estimate = residual = preconditioned = direction = q1 = initial;
 
-  system.residual(estimate, q1);                /* q1 = b-Ax */
-  system.leftPrecondition(q1, residual);        /* r = S^{-T} (b-Ax) */
-  system.rightPrecondition(residual, direction);/* d = S^{-1} r */
+  system.residual(estimate, residual);          /* r = b-Ax */
+  system.precondition(residual, preconditioned);/* z = M^{-1} r */
+  direction = preconditioned;                   /* d = z */
 
-  double currentGamma = system.dot(residual, residual), prevGamma, alpha, beta;
+  double currentGamma = system.dot(residual, preconditioned), prevGamma, alpha, beta;
 
   const size_t iMaxIterations = parameters.maxIterations(),
                iMinIterations = parameters.minIterations(),
@@ -115,22 +125,21 @@ V preconditionedConjugateGradient(const S &system, const V &initial, const Conju
   for ( k = 1 ; k <= iMaxIterations && (currentGamma > threshold || k <= iMinIterations) ; k++ ) {
 
     if ( k % iReset == 0 ) {
-      system.residual(estimate, q1);                      /* q1 = b-Ax */
-      system.leftPrecondition(q1, residual);              /* r = S^{-T} (b-Ax) */
-      system.rightPrecondition(residual, direction);      /* d = S^{-1} r */
-      currentGamma = system.dot(residual, residual);
+      system.residual(estimate, residual);                /* r = b-Ax */
+      system.precondition(residual, preconditioned);      /* z = M^{-1} r */
+      direction = preconditioned;                         /* d = z */
+      currentGamma = system.dot(residual, preconditioned);
     }
     system.multiply(direction, q1);                       /* q1 = A d */
     alpha = currentGamma / system.dot(direction, q1);     /* alpha = gamma / (d' A d) */
     system.axpy(alpha, direction, estimate);              /* estimate += alpha * direction */
-    system.leftPrecondition(q1, q2);                      /* q2 = S^{-T} * q1 */
-    system.axpy(-alpha, q2, residual);                    /* residual -= alpha * q2 */
+    system.axpy(-alpha, q1, residual);                    /* residual -= alpha * q1 */
+    system.precondition(residual, preconditioned);        /* z = M^{-1} residual */
     prevGamma = currentGamma;
-    currentGamma = system.dot(residual, residual);        /* gamma = |residual|^2 */
+    currentGamma = system.dot(residual, preconditioned);  /* gamma = r' M^{-1} r */
     beta = currentGamma / prevGamma;
-    system.rightPrecondition(residual, q1);               /* q1 = S^{-1} residual */
     system.scal(beta, direction);
-    system.axpy(1.0, q1, direction);                      /* direction = q1 + beta * direction */
+    system.axpy(1.0, preconditioned, direction);          /* direction = z + beta * direction */
 
     if (parameters.verbosity() >= ConjugateGradientParameters::ERROR )
        std::cout << "[PCG] k = " << k
@@ -144,6 +153,94 @@ V preconditionedConjugateGradient(const S &system, const V &initial, const Conju
                << ", ||r||^2 = " << currentGamma
                << std::endl;
 
+  if (iterations) *iterations = k - 1;
+  return estimate;
+}
+
+/*********************************************************************************************/
+/*
+ * Steihaug's truncated preconditioned conjugate gradient method for the trust region subproblem
+ *   min 1/2 x'Ax - b'x  subject to  ||x||_M <= Delta,
+ * where the norm is the one of the preconditioner, ||x||_M^2 = x'Mx, which is Euclidean for the
+ * identity.  Starting from zero, the iterates of PCG grow monotonically in this norm, and their
+ * norms are updated by recurrences without applying M, refer to Algorithm 7.5.1 of Conn, Gould
+ * and Toint, "Trust-Region Methods".  Iterating stops as preconditionedConjugateGradient does,
+ * or at the boundary of the trust region, when a step would leave it or when a direction of
+ * nonpositive curvature is found.
+ * System class should support the same operations as for preconditionedConjugateGradient, and
+ * zero is the zero vector.  stepNorm is set to ||x||_M, and if given, iterations to the number of
+ * iterations.
+ */
+template <class S, class V>
+V steihaugConjugateGradient(const S &system, const V &zero, double Delta,
+                            const ConjugateGradientParameters &parameters, double &stepNorm,
+                            boost::optional<size_t&> iterations = boost::none) {
+
+  V estimate, residual, preconditioned, direction, q1;
+  estimate = residual = preconditioned = direction = q1 = zero;
+
+  system.residual(estimate, residual);          /* r = b */
+  system.precondition(residual, preconditioned);/* z = M^{-1} r */
+  direction = preconditioned;                   /* d = z */
+
+  double currentGamma = system.dot(residual, preconditioned), prevGamma, alpha, beta;
+  double xMx = 0.0, xMd = 0.0, dMd = currentGamma; /* x'Mx, x'Md and d'Md */
+
+  const size_t iMaxIterations = parameters.maxIterations(),
+               iMinIterations = parameters.minIterations();
+  const double threshold = std::max(parameters.epsilon_abs(),
+                                    parameters.epsilon() * parameters.epsilon() * currentGamma);
+
+  if (parameters.verbosity() >= ConjugateGradientParameters::COMPLEXITY )
+    std::cout << "[Steihaug] epsilon = " << parameters.epsilon()
+             << ", max = " << parameters.maxIterations()
+             << ", Delta = " << Delta
+             << ", ||r0||^2 = " << currentGamma
+             << ", threshold = " << threshold << std::endl;
+
+  size_t k;
+  bool boundary = false;
+  for ( k = 1 ; k <= iMaxIterations && (currentGamma > threshold || k <= iMinIterations) ; k++ ) {
+    system.multiply(direction, q1);                       /* q1 = A d */
+    const double kappa = system.dot(direction, q1);       /* kappa = d' A d */
+    alpha = currentGamma / kappa;
+    if ( kappa <= 0.0 || xMx + alpha * (2.0 * xMd + alpha * dMd) >= Delta * Delta ) {
+      /* move along d to the boundary, ||x + tau d||_M = Delta */
+      const double tau = (-xMd + std::sqrt(xMd * xMd + dMd * (Delta * Delta - xMx))) / dMd;
+      system.axpy(tau, direction, estimate);
+      boundary = true;
+      break;
+    }
+    system.axpy(alpha, direction, estimate);              /* estimate += alpha * direction */
+    system.axpy(-alpha, q1, residual);                    /* residual -= alpha * q1 */
+    system.precondition(residual, preconditioned);        /* z = M^{-1} residual */
+    prevGamma = currentGamma;
+    currentGamma = system.dot(residual, preconditioned);  /* gamma = r' M^{-1} r */
+    beta = currentGamma / prevGamma;
+    system.scal(beta, direction);
+    system.axpy(1.0, preconditioned, direction);          /* direction = z + beta * direction */
+
+    xMx += alpha * (2.0 * xMd + alpha * dMd);
+    xMd = beta * (xMd + alpha * dMd);
+    dMd = currentGamma + beta * beta * dMd;
+
+    if (parameters.verbosity() >= ConjugateGradientParameters::ERROR )
+       std::cout << "[Steihaug] k = " << k
+                 << ", alpha = " << alpha
+                 << ", beta = " << beta
+                 << ", ||r||^2 = " << currentGamma
+                 << ", ||x||_M = " << std::sqrt(xMx)
+                 << std::endl;
+  }
+  stepNorm = boundary ? Delta : std::sqrt(xMx);
+
+  if (parameters.verbosity() >= ConjugateGradientParameters::COMPLEXITY )
+     std::cout << "[Steihaug] iterations = " << k
+               << ", ||r||^2 = " << currentGamma
+               << (boundary ? ", on the boundary" : "")
+               << std::endl;
+
+  if (iterations) *iterations = boundary ? k : k - 1;
   return estimate;
 }
 
@@ -22,6 +22,11 @@
 #include <gtsam/linear/Errors.h>
 #include <gtsam/linear/VectorValues.h>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -118,11 +123,104 @@ void axpy<Errors,Errors>(double alpha, const Errors& x, Errors& y) {
     axpy(alpha,*(it++),yi);
 }
 
+/* ************************************************************************* */
+double dot(const Errors& a, const Errors& b, bool parallel) {
+  if (!parallel)
+    return dot(a, b);
+  if (b.size() != a.size())
+    throw(std::invalid_argument("Errors::dot: incompatible sizes"));
+  vector<const Vector*> as, bs;
+  as.reserve(a.size());
+  bs.reserve(b.size());
+  Errors::const_iterator it = b.begin();
+  BOOST_FOREACH(const Vector& ai, a) {
+    as.push_back(&ai);
+    bs.push_back(&*(it++));
+  }
+  return internal::parallelDot(as, bs);
+}
+
+/* ************************************************************************* */
+void axpy(double alpha, const Errors& x, Errors& y, bool parallel) {
+  if (!parallel) {
+    axpy(alpha, x, y);
+    return;
+  }
+  vector<const Vector*> xs;
+  vector<Vector*> ys;
+  xs.reserve(x.size());
+  ys.reserve(y.size());
+  Errors::const_iterator it = x.begin();
+  BOOST_FOREACH(Vector& yi, y) {
+    xs.push_back(&*(it++));
+    ys.push_back(&yi);
+  }
+  internal::parallelAxpy(alpha, xs, ys);
+}
+
 /* ************************************************************************* */
 void print(const Errors& a, const string& s) {
   a.print(s);
 }
 
+namespace internal {
+
+#ifdef GTSAM_USE_TBB
+  /* ************************************************************************* */
+  struct DotProducts {
+    const vector<const Vector*>& a;
+    const vector<const Vector*>& b;
+    double result;
+    DotProducts(const vector<const Vector*>& a, const vector<const Vector*>& b) :
+      a(a), b(b), result(0.0) {}
+    DotProducts(DotProducts& other, tbb::split) : a(other.a), b(other.b), result(0.0) {}
+    void operator()(const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); ++i)
+        result += a[i]->dot(*b[i]);
+    }
+    void join(const DotProducts& other) { result += other.result; }
+  };
+
+  /* ************************************************************************* */
+  struct Axpys {
+    const double alpha;
+    const vector<const Vector*>& x;
+    const vector<Vector*>& y;
+    Axpys(double alpha, const vector<const Vector*>& x, const vector<Vector*>& y) :
+      alpha(alpha), x(x), y(y) {}
+    void operator()(const tbb::blocked_range<size_t>& r) const {
+      for (size_t i = r.begin(); i != r.end(); ++i)
+        *y[i] += alpha * *x[i];
+    }
+  };
+#endif
+
+  /* ************************************************************************* */
+  double parallelDot(const vector<const Vector*>& a, const vector<const Vector*>& b) {
+#ifdef GTSAM_USE_TBB
+    DotProducts dotProducts(a, b);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, a.size()), dotProducts);
+    return dotProducts.result;
+#else
+    double result = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+      result += a[i]->dot(*b[i]);
+    return result;
+#endif
+  }
+
+  /* ************************************************************************* */
+  void parallelAxpy(double alpha, const vector<const Vector*>& x, const vector<Vector*>& y) {
+#ifdef GTSAM_USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, y.size()), Axpys(alpha, x, y));
+#else
+    for (size_t i = 0; i < y.size(); ++i)
+      *y[i] += alpha * *x[i];
+#endif
+  }
+
+} // internal
+
 /* ************************************************************************* */
 
 } // gtsam
@@ -23,6 +23,7 @@
 #include <gtsam/base/Vector.h>
 
 #include <string>
+#include <vector>
 
 namespace gtsam {
 
@@ -67,7 +68,26 @@ namespace gtsam {
   template <>
   GTSAM_EXPORT void axpy<Errors,Errors>(double alpha, const Errors& x, Errors& y);
 
+  /**
+  * dot product, summed over ranges of errors with TBB if parallel is true and GTSAM uses TBB.
+  * The order of summation, and so the last bits of the result, then depend on the scheduling.
+  */
+  GTSAM_EXPORT double dot(const Errors& a, const Errors& b, bool parallel);
+
+  /**
+  * BLAS level 2 style, over ranges of errors with TBB if parallel is true and GTSAM uses TBB
+  */
+  GTSAM_EXPORT void axpy(double alpha, const Errors& x, Errors& y, bool parallel);
+
   /** print with optional string */
   GTSAM_EXPORT void print(const Errors& a, const std::string& s = "Error");
 
+  namespace internal {
+    /** dot product of the pairs of vectors of a and b, in parallel with TBB if available */
+    GTSAM_EXPORT double parallelDot(const std::vector<const Vector*>& a, const std::vector<const Vector*>& b);
+
+    /** *y[i] += alpha * *x[i] for all i, in parallel with TBB if available */
+    GTSAM_EXPORT void parallelAxpy(double alpha, const std::vector<const Vector*>& x, const std::vector<Vector*>& y);
+  }
+
 } // gtsam
@@ -0,0 +1,197 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file FlatVectorValues.cpp
+ * @brief Implementations for FlatVectorValues
+ */
+
+#include <gtsam/linear/FlatVectorValues.h>
+#include <gtsam/linear/IterativeSolver.h>
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+using namespace std;
+
+namespace gtsam {
+
+  /* ************************************************************************* */
+  void FlatVectorValues::Layout::add(Key j, DenseIndex dim)
+  {
+    if(!slots_.insert(make_pair(j, make_pair(dim_, dim))).second)
+      throw invalid_argument("Requested to create a FlatVectorValues layout with a repeated key.");
+    keys_.push_back(j);
+    dim_ += dim;
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues::Layout::Layout(const Ordering& ordering, const VectorValues::Dims& dims) : dim_(0)
+  {
+    keys_.reserve(ordering.size());
+    BOOST_FOREACH(Key j, ordering)
+      add(j, dims.at(j));
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues::Layout::Layout(const KeyInfo& keyInfo) : dim_(0)
+  {
+    keys_.reserve(keyInfo.size());
+    BOOST_FOREACH(Key j, keyInfo.ordering())
+      add(j, keyInfo.at(j).dim());
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues::Layout::Layout(const VectorValues& values) : dim_(0)
+  {
+    keys_.reserve(values.size());
+    BOOST_FOREACH(const VectorValues::KeyValuePair& v, values)
+      add(v.first, v.second.size());
+  }
+
+  /* ************************************************************************* */
+  const pair<DenseIndex, DenseIndex>& FlatVectorValues::Layout::at(Key j) const
+  {
+    FastMap<Key, pair<DenseIndex, DenseIndex> >::const_iterator item = slots_.find(j);
+    if(item == slots_.end())
+      throw out_of_range("Requested variable '" + DefaultKeyFormatter(j) + "' is not in this FlatVectorValues.");
+    return item->second;
+  }
+
+  /* ************************************************************************* */
+  bool FlatVectorValues::Layout::equals(const Layout& other) const
+  {
+    // Same keys in the same order imply the same offsets, as long as the dimensions agree
+    if(dim_ != other.dim_ || keys_ != other.keys_)
+      return false;
+    BOOST_FOREACH(Key j, keys_)
+      if(slots_.at(j).second != other.slots_.at(j).second)
+        return false;
+    return true;
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues::FlatVectorValues(const Layout::shared_ptr& layout, const Vector& values) :
+    layout_(layout), values_(values)
+  {
+    if(values_.size() != layout_->dim())
+      throw invalid_argument("Requested to create a FlatVectorValues from a Vector with a dimension different from its layout.");
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues::FlatVectorValues(const KeyInfo& keyInfo) :
+    layout_(boost::make_shared<Layout>(keyInfo)), values_(Vector::Zero(layout_->dim())) {}
+
+  /* ************************************************************************* */
+  FlatVectorValues::FlatVectorValues(const VectorValues& values) :
+    layout_(boost::make_shared<Layout>(values)), values_(values.vector()) {}
+
+  /* ************************************************************************* */
+  FlatVectorValues::FlatVectorValues(const VectorValues& values, const Ordering& ordering)
+  {
+    VectorValues::Dims dims;
+    BOOST_FOREACH(Key j, ordering)
+      dims.insert(make_pair(j, values.at(j).size()));
+    layout_ = boost::make_shared<Layout>(ordering, dims);
+    values_ = values.vector(ordering);
+  }
+
+  /* ************************************************************************* */
+  void FlatVectorValues::update(const VectorValues& values)
+  {
+    BOOST_FOREACH(const VectorValues::KeyValuePair& v, values) {
+      const pair<DenseIndex, DenseIndex>& slot = layout_->at(v.first);
+      if(slot.second != v.second.size())
+        throw invalid_argument("Requested to update a FlatVectorValues variable with a vector of a different dimension.");
+      values_.segment(slot.first, slot.second) = v.second;
+    }
+  }
+
+  /* ************************************************************************* */
+  VectorValues FlatVectorValues::toVectorValues() const
+  {
+    VectorValues result;
+    BOOST_FOREACH(Key j, keys())
+      result.insert(j, at(j));
+    return result;
+  }
+
+  /* ************************************************************************* */
+  void FlatVectorValues::print(const string& str, const KeyFormatter& formatter) const {
+    cout << str << ": " << size() << " elements\n";
+    BOOST_FOREACH(Key j, keys())
+      cout << "  " << formatter(j) << ": " << at(j).transpose() << "\n";
+    cout.flush();
+  }
+
+  /* ************************************************************************* */
+  bool FlatVectorValues::equals(const FlatVectorValues& x, double tol) const {
+    return hasSameStructure(x) && equal_with_abs_tol(values_, x.values_, tol);
+  }
+
+  /* ************************************************************************* */
+  void FlatVectorValues::checkStructure(const FlatVectorValues& other, const char* operation) const
+  {
+    if(!hasSameStructure(other))
+      throw invalid_argument(string("FlatVectorValues::") + operation + " called with a FlatVectorValues of different structure");
+  }
+
+  /* ************************************************************************* */
+  double FlatVectorValues::dot(const FlatVectorValues& v) const
+  {
+    checkStructure(v, "dot");
+    return values_.dot(v.values_);
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues FlatVectorValues::operator+(const FlatVectorValues& c) const
+  {
+    checkStructure(c, "operator+");
+    return FlatVectorValues(layout_, values_ + c.values_);
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues& FlatVectorValues::operator+=(const FlatVectorValues& c)
+  {
+    checkStructure(c, "operator+=");
+    values_ += c.values_;
+    return *this;
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues FlatVectorValues::operator-(const FlatVectorValues& c) const
+  {
+    checkStructure(c, "operator-");
+    return FlatVectorValues(layout_, values_ - c.values_);
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues& FlatVectorValues::operator-=(const FlatVectorValues& c)
+  {
+    checkStructure(c, "operator-=");
+    values_ -= c.values_;
+    return *this;
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues operator*(const double a, const FlatVectorValues& v)
+  {
+    return FlatVectorValues(v.layout_, a * v.values_);
+  }
+
+  /* ************************************************************************* */
+  void axpy(double alpha, const FlatVectorValues& x, FlatVectorValues& y)
+  {
+    x.checkStructure(y, "axpy");
+    y.values_ += alpha * x.values_;
+  }
+
+} // \namespace gtsam
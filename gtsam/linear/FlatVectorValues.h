@@ -0,0 +1,259 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    FlatVectorValues.h
+ * @brief   Vector-valued variables stored contiguously in a single Vector
+ */
+
+#pragma once
+
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/base/FastMap.h>
+
+namespace gtsam {
+
+  // Forward declarations
+  class KeyInfo;
+
+  /**
+   * A collection of vector-valued variables, like VectorValues, but with all variables stored
+   * contiguously in one Vector instead of in one heap-allocated Vector per key.  The position of
+   * each variable in the Vector is given by a FlatVectorValues::Layout, which is computed once (from
+   * an Ordering and dimensions, a KeyInfo, or an existing VectorValues) and then shared, without
+   * copying, by all FlatVectorValues created from each other.
+   *
+   * Because of this, the linear algebra operations (dot(), operator+(), axpy(), scale, ...)
+   * between FlatVectorValues with the same layout are single BLAS-1 operations over the
+   * underlying Vector, instead of a loop over the keys of two maps.  This makes this class suited
+   * for the inner loops of iterative solvers, while VectorValues remains the general-purpose
+   * container that supports inserting and erasing variables.
+   *
+   * The interface mirrors that of VectorValues, except that variables are accessed as SubVector
+   * views into the underlying Vector, and that the set of variables is fixed by the layout.
+   * \nosubgrouping
+   */
+  class GTSAM_EXPORT FlatVectorValues {
+  public:
+
+    /**
+     * Maps each key to the range of the underlying Vector holding its value.  Keys are stored in
+     * the order in which they were given, which is also the order used by print() and
+     * toVectorValues().
+     */
+    class GTSAM_EXPORT Layout {
+    public:
+      typedef boost::shared_ptr<const Layout> shared_ptr;
+
+      /** Create an empty layout */
+      Layout() : dim_(0) {}
+
+      /** Create the layout with the variables in \c ordering, with the dimensions in \c dims */
+      Layout(const Ordering& ordering, const VectorValues::Dims& dims);
+
+      /** Create the layout with the ordering and dimensions stored in a KeyInfo */
+      explicit Layout(const KeyInfo& keyInfo);
+
+      /** Create the layout with the keys (in increasing order) and dimensions of \c values */
+      explicit Layout(const VectorValues& values);
+
+      /** Number of variables */
+      size_t size() const { return keys_.size(); }
+
+      /** Total dimension of all variables */
+      DenseIndex dim() const { return dim_; }
+
+      /** The keys, in storage order */
+      const FastVector<Key>& keys() const { return keys_; }
+
+      /** Check whether a variable with key \c j exists */
+      bool exists(Key j) const { return slots_.find(j) != slots_.end(); }
+
+      /** Offset and dimension of variable \c j, throws std::out_of_range if \c j does not exist */
+      const std::pair<DenseIndex, DenseIndex>& at(Key j) const;
+
+      /** Check whether two layouts store the same keys at the same positions */
+      bool equals(const Layout& other) const;
+
+    private:
+      void add(Key j, DenseIndex dim);
+
+      FastVector<Key> keys_; ///< Keys in storage order
+      FastMap<Key, std::pair<DenseIndex, DenseIndex> > slots_; ///< Key to (offset, dimension)
+      DenseIndex dim_; ///< Total dimension
+    };
+
+  protected:
+    typedef FlatVectorValues This;
+    Layout::shared_ptr layout_; ///< Position of each variable in values_, shared between instances
+    Vector values_; ///< All variables, stored contiguously
+
+  public:
+    typedef boost::shared_ptr<This> shared_ptr; ///< shared_ptr to this class
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Default constructor creates an empty FlatVectorValues */
+    FlatVectorValues() : layout_(boost::make_shared<Layout>()) {}
+
+    /** Create a FlatVectorValues with the given layout, filled with zeros */
+    explicit FlatVectorValues(const Layout::shared_ptr& layout) :
+      layout_(layout), values_(Vector::Zero(layout->dim())) {}
+
+    /** Create a FlatVectorValues with the given layout and underlying Vector */
+    FlatVectorValues(const Layout::shared_ptr& layout, const Vector& values);
+
+    /** Create a FlatVectorValues with the variables ordered as in \c keyInfo, filled with zeros */
+    explicit FlatVectorValues(const KeyInfo& keyInfo);
+
+    /** Copy the variables of \c values, stored in increasing key order */
+    explicit FlatVectorValues(const VectorValues& values);
+
+    /** Copy the variables of \c values, stored in the order given by \c ordering.  Throws
+     * std::out_of_range if a key in \c ordering is not in \c values. */
+    FlatVectorValues(const VectorValues& values, const Ordering& ordering);
+
+    /** Create a FlatVectorValues with the same layout as \c other, but filled with zeros. */
+    static FlatVectorValues Zero(const FlatVectorValues& other) { return FlatVectorValues(other.layout_); }
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** Number of variables stored */
+    size_t size() const { return layout_->size(); }
+
+    /** Total dimension of all variables */
+    DenseIndex dim() const { return layout_->dim(); }
+
+    /** Return the dimension of variable \c j */
+    size_t dim(Key j) const { return layout_->at(j).second; }
+
+    /** Check whether a variable with key \c j exists */
+    bool exists(Key j) const { return layout_->exists(j); }
+
+    /** Read/write access to the value of variable \c j, throws std::out_of_range if \c j does not exist */
+    SubVector at(Key j) {
+      const std::pair<DenseIndex, DenseIndex>& slot = layout_->at(j);
+      return values_.segment(slot.first, slot.second);
+    }
+
+    /** Access the value of variable \c j (const version), throws std::out_of_range if \c j does not exist */
+    ConstSubVector at(Key j) const {
+      const std::pair<DenseIndex, DenseIndex>& slot = layout_->at(j);
+      return static_cast<const Vector&>(values_).segment(slot.first, slot.second);
+    }
+
+    /** Read/write access to the value of variable \c j, identical to at(Key) */
+    SubVector operator[](Key j) { return at(j); }
+
+    /** Access the value of variable \c j (const version), identical to at(Key) */
+    ConstSubVector operator[](Key j) const { return at(j); }
+
+    /** The keys, in storage order */
+    const FastVector<Key>& keys() const { return layout_->keys(); }
+
+    /** The layout, which may be shared with other FlatVectorValues */
+    const Layout::shared_ptr& layout() const { return layout_; }
+
+    /** For all key/value pairs in \c values, replace values with corresponding keys in this class
+     *  with those in \c values.  Throws std::out_of_range if any keys in \c values are not present
+     *  in this class. */
+    void update(const VectorValues& values);
+
+    /** Set all values to zero */
+    void setZero() { values_.setZero(); }
+
+    /** Copy into a VectorValues */
+    VectorValues toVectorValues() const;
+
+    /** print required by Testable for unit testing */
+    void print(const std::string& str = "FlatVectorValues: ",
+        const KeyFormatter& formatter = DefaultKeyFormatter) const;
+
+    /** equals required by Testable for unit testing */
+    bool equals(const FlatVectorValues& x, double tol = 1e-9) const;
+
+    /// @}
+    /// @name Advanced Interface
+    /// @{
+
+    /** The underlying Vector holding all variables */
+    const Vector& vector() const { return values_; }
+
+    /** The underlying Vector holding all variables (read/write) */
+    Vector& vector() { return values_; }
+
+    /** Swap the data in this FlatVectorValues with another */
+    void swap(FlatVectorValues& other) { layout_.swap(other.layout_); values_.swap(other.values_); }
+
+    /** Check if this FlatVectorValues has the same layout (keys, order and dimensions) as another.
+     *  This is a pointer comparison if both share the same layout. */
+    bool hasSameStructure(const FlatVectorValues& other) const {
+      return layout_ == other.layout_ || layout_->equals(*other.layout_); }
+
+    /// @}
+    /// @name Linear algebra operations
+    /// @{
+
+    /** Dot product with another FlatVectorValues with the same layout */
+    double dot(const FlatVectorValues& v) const;
+
+    /** Vector L2 norm */
+    double norm() const { return values_.norm(); }
+
+    /** Squared vector L2 norm */
+    double squaredNorm() const { return values_.squaredNorm(); }
+
+    /** Element-wise addition, the layouts must be the same */
+    FlatVectorValues operator+(const FlatVectorValues& c) const;
+
+    /** Element-wise addition, synonym for operator+() */
+    FlatVectorValues add(const FlatVectorValues& c) const { return *this + c; }
+
+    /** Element-wise addition in-place, the layouts must be the same */
+    FlatVectorValues& operator+=(const FlatVectorValues& c);
+
+    /** Element-wise addition in-place, synonym for operator+=() */
+    FlatVectorValues& addInPlace(const FlatVectorValues& c) { return *this += c; }
+
+    /** Element-wise subtraction, the layouts must be the same */
+    FlatVectorValues operator-(const FlatVectorValues& c) const;
+
+    /** Element-wise subtraction, synonym for operator-() */
+    FlatVectorValues subtract(const FlatVectorValues& c) const { return *this - c; }
+
+    /** Element-wise subtraction in-place, the layouts must be the same */
+    FlatVectorValues& operator-=(const FlatVectorValues& c);
+
+    /** Element-wise scaling by a constant */
+    friend GTSAM_EXPORT FlatVectorValues operator*(const double a, const FlatVectorValues& v);
+
+    /** Element-wise scaling by a constant */
+    FlatVectorValues scale(const double a) const { return a * *this; }
+
+    /** Element-wise scaling by a constant in-place */
+    FlatVectorValues& operator*=(double alpha) { values_ *= alpha; return *this; }
+
+    /** Element-wise scaling by a constant in-place */
+    FlatVectorValues& scaleInPlace(double alpha) { return *this *= alpha; }
+
+    /** BLAS Level 1 axpy: y <- alpha*x + y, without temporaries */
+    friend GTSAM_EXPORT void axpy(double alpha, const FlatVectorValues& x, FlatVectorValues& y);
+
+    /// @}
+
+  private:
+    void checkStructure(const FlatVectorValues& other, const char* operation) const;
+  }; // FlatVectorValues definition
+
+} // \namespace gtsam
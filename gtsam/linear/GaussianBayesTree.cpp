@@ -24,6 +24,10 @@
 #include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/linearExceptions.h>
+
+#include <stdexcept>
+#include <algorithm>
 
 namespace gtsam {
 
@@ -101,6 +105,86 @@ namespace gtsam {
     return marginalFactor(key)->information().inverse();
   }
 
+  /* ************************************************************************* */
+  FastMap<Key, GaussianCliqueCovariance> GaussianBayesTree::cliqueCovariances() const
+  {
+    return internal::linearAlgorithms::cliqueCovariancesBayesTree(*this);
+  }
+
+  /* ************************************************************************* */
+  GaussianCliqueCovariance::GaussianCliqueCovariance(
+    const GaussianConditional& conditional, const GaussianCliqueCovariance* parent) :
+    keys(conditional.begin(), conditional.end()), nrFrontals(conditional.nrFrontals())
+  {
+    // Variable positions
+    offsets.reserve(keys.size() + 1);
+    offsets.push_back(0);
+    for(GaussianConditional::const_iterator key = conditional.begin(); key != conditional.end(); ++key)
+      offsets.push_back(offsets.back() + conditional.getDim(key));
+    const DenseIndex nF = offsets[nrFrontals];
+    const DenseIndex nS = offsets.back() - nF;
+
+    // Whitened R and S, as in the information matrix of the conditional
+    Matrix R = conditional.get_R();
+    Matrix S = conditional.get_S();
+    if(conditional.get_model()) {
+      R = conditional.get_model()->Whiten(R);
+      S = conditional.get_model()->Whiten(S);
+    }
+
+    // Covariance of the frontal variables given the separator
+    const Matrix Rinv = R.triangularView<Eigen::Upper>().solve(Matrix::Identity(nF, nF));
+    if(Rinv.hasNaN())
+      throw IndeterminantLinearSystemException(keys.front());
+    covariance.resize(nF + nS, nF + nS);
+    covariance.topLeftCorner(nF, nF).noalias() = Rinv * Rinv.transpose();
+
+    if(nS > 0)
+    {
+      if(!parent)
+        throw std::invalid_argument("GaussianCliqueCovariance: a clique with a separator needs the covariance of its parent");
+
+      // Copy the separator covariance from the parent clique
+      FastVector<size_t> parentPositions;
+      parentPositions.reserve(keys.size() - nrFrontals);
+      for(size_t i = nrFrontals; i < keys.size(); ++i)
+        parentPositions.push_back(parent->find(keys[i]));
+      for(size_t i = nrFrontals; i < keys.size(); ++i) {
+        const size_t pi = parentPositions[i - nrFrontals];
+        for(size_t j = nrFrontals; j < keys.size(); ++j) {
+          const size_t pj = parentPositions[j - nrFrontals];
+          covariance.block(offsets[i], offsets[j], offsets[i+1] - offsets[i], offsets[j+1] - offsets[j]) =
+            parent->covariance.block(parent->offsets[pi], parent->offsets[pj],
+            parent->offsets[pi+1] - parent->offsets[pi], parent->offsets[pj+1] - parent->offsets[pj]);
+        }
+      }
+
+      // Cross-covariance and frontal covariance from the selected inversion formulas
+      const Matrix RinvS = Rinv.triangularView<Eigen::Upper>() * S;
+      const Matrix SigmaFS = -RinvS * covariance.bottomRightCorner(nS, nS);
+      covariance.topRightCorner(nF, nS) = SigmaFS;
+      covariance.bottomLeftCorner(nS, nF) = SigmaFS.transpose();
+      covariance.topLeftCorner(nF, nF).noalias() -= SigmaFS * RinvS.transpose();
+    }
+  }
+
+  /* ************************************************************************* */
+  size_t GaussianCliqueCovariance::find(Key j) const
+  {
+    FastVector<Key>::const_iterator it = std::find(keys.begin(), keys.end(), j);
+    if(it == keys.end())
+      throw std::out_of_range("GaussianCliqueCovariance: requested variable is not in the clique");
+    return it - keys.begin();
+  }
+
+  /* ************************************************************************* */
+  Matrix GaussianCliqueCovariance::block(Key i, Key j) const
+  {
+    const size_t pi = find(i), pj = find(j);
+    return covariance.block(offsets[pi], offsets[pj],
+      offsets[pi+1] - offsets[pi], offsets[pj+1] - offsets[pj]);
+  }
+
 
 } // \namespace gtsam
 
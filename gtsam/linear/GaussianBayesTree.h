@@ -30,6 +30,37 @@ namespace gtsam {
   class GaussianConditional;
   class VectorValues;
 
+  /* ************************************************************************* */
+  /** The joint covariance of the frontal and separator variables of one clique of a Gaussian
+   *  Bayes tree, as recovered by GaussianBayesTree::cliqueCovariances().  Together, the clique
+   *  covariances of a Bayes tree contain every entry of the full covariance matrix that is in the
+   *  sparsity pattern of the square-root information matrix \f$ R \f$. */
+  struct GTSAM_EXPORT GaussianCliqueCovariance
+  {
+    FastVector<Key> keys; ///< The frontal variables followed by the separator, as in the conditional
+    FastVector<DenseIndex> offsets; ///< Position of each variable in \c covariance, and the total dimension at the end
+    size_t nrFrontals; ///< The number of frontal variables
+    Matrix covariance; ///< The dense joint covariance of all variables of the clique
+
+    /** Default constructor, for use in containers */
+    GaussianCliqueCovariance() : nrFrontals(0) {}
+
+    /** Recover the covariance of a clique from its conditional \f$ R x_F + S x_S = d \f$ and the
+     *  covariance of its parent clique, which contains the covariance \f$ \Sigma_{SS} \f$ of the
+     *  separator by the running intersection property.  This uses the selected inversion formulas
+     *  \f$ \Sigma_{FS} = -R^{-1} S \Sigma_{SS} \f$ and
+     *  \f$ \Sigma_{FF} = R^{-1} R^{-T} - R^{-1} S \Sigma_{SF} \f$.
+     *  @param conditional The conditional of the clique
+     *  @param parent The covariance of the parent clique, or null for a root clique */
+    GaussianCliqueCovariance(const GaussianConditional& conditional, const GaussianCliqueCovariance* parent);
+
+    /** The position of variable \c j in \c keys, throws std::out_of_range if not in the clique */
+    size_t find(Key j) const;
+
+    /** The covariance block of variables \c i and \c j, which must both be in the clique */
+    Matrix block(Key i, Key j) const;
+  };
+
   /* ************************************************************************* */
   /** A clique in a GaussianBayesTree */
   class GTSAM_EXPORT GaussianBayesTreeClique :
@@ -126,6 +157,13 @@ namespace gtsam {
     /** Return the marginal on the requested variable as a covariance matrix.  See also
     *   marginalFactor(). */
     Matrix marginalCovariance(Key key) const;
+
+    /** Compute the joint covariance of the frontal and separator variables of every clique, in
+     *  one top-down pass over the tree (see GaussianCliqueCovariance).  Subtrees are processed in
+     *  parallel when compiled with TBB.  This is much cheaper than calling marginalCovariance()
+     *  for many variables, which recomputes shortcuts and re-eliminates for every query.
+     *  @return The covariance of each clique, indexed by the first frontal variable of the clique */
+    FastMap<Key, GaussianCliqueCovariance> cliqueCovariances() const;
   };
 
 }
@@ -0,0 +1,427 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file GaussianEliminationPlan.cpp
+ * @brief Symbolic multifrontal elimination structure, reusable for repeated numeric factorization
+ */
+
+#include <gtsam/linear/GaussianEliminationPlan.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/symbolic/SymbolicFactorGraph.h>
+#include <gtsam/symbolic/SymbolicEliminationTree.h>
+#include <gtsam/symbolic/SymbolicJunctionTree.h>
+#include <gtsam/inference/inferenceExceptions.h>
+#include <gtsam/base/treeTraversal-inst.h>
+#include <gtsam/base/timing.h>
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+#include <limits>
+
+using namespace std;
+
+namespace gtsam {
+
+  namespace {
+    /* ************************************************************************* */
+    // Junction tree traversal data used to build the plan - the cluster created for the visited
+    // junction tree node.
+    struct ConstructionData {
+      GaussianEliminationPlan::sharedCluster cluster;
+    };
+
+    /* ************************************************************************* */
+    // Pre-order visitor - creates the cluster for a junction tree node, with the indices of its
+    // factors, as a child of the parent cluster.
+    struct ConstructionVisitorPre {
+      const FastMap<const SymbolicFactor*, size_t>& factorIndices;
+      ConstructionVisitorPre(const FastMap<const SymbolicFactor*, size_t>& factorIndices) :
+        factorIndices(factorIndices) {}
+      ConstructionData operator()(const SymbolicJunctionTree::sharedNode& node, ConstructionData& parentData)
+      {
+        ConstructionData myData;
+        myData.cluster = boost::make_shared<GaussianEliminationPlan::Cluster>();
+        myData.cluster->frontals = Ordering(node->keys);
+        myData.cluster->problemSize_ = node->problemSize();
+        myData.cluster->factors.reserve(node->factors.size());
+        BOOST_FOREACH(const SymbolicFactor::shared_ptr& factor, node->factors)
+          myData.cluster->factors.push_back(factorIndices.at(factor.get()));
+        parentData.cluster->children.push_back(myData.cluster);
+        return myData;
+      }
+    };
+
+    /* ************************************************************************* */
+    // Post-order visitor - once the children are built, lays out the frontal and separator
+    // variables of the cluster and allocates its joint factor.
+    struct ConstructionVisitorPost {
+      const GaussianFactorGraph& graph;
+      ConstructionVisitorPost(const GaussianFactorGraph& graph) : graph(graph) {}
+      void operator()(const SymbolicJunctionTree::sharedNode& node, const ConstructionData& myData)
+      {
+        static const size_t none = std::numeric_limits<size_t>::max();
+        GaussianEliminationPlan::Cluster& cluster = *myData.cluster;
+
+        // Union of the variables of the factors and of the separators of the children
+        BOOST_FOREACH(size_t i, cluster.factors) {
+          const GaussianFactor& factor = *graph[i];
+          for(GaussianFactor::const_iterator variable = factor.begin(); variable != factor.end(); ++variable)
+            cluster.scatter.insert(make_pair(*variable, SlotEntry(none, factor.getDim(variable))));
+        }
+        BOOST_FOREACH(const GaussianEliminationPlan::sharedCluster& child, cluster.children) {
+          for(size_t k = child->frontals.size(); k < child->keys.size(); ++k) {
+            const Key j = child->keys[k];
+            cluster.scatter.insert(make_pair(j, SlotEntry(none, child->scatter.at(j).dimension)));
+          }
+        }
+
+        // Frontal variables come first in elimination order, then the separator in key order, as
+        // in EliminateCholesky
+        size_t slot = 0;
+        cluster.keys.reserve(cluster.scatter.size());
+        BOOST_FOREACH(Key j, cluster.frontals) {
+          cluster.scatter.at(j).slot = (slot++);
+          cluster.keys.push_back(j);
+        }
+        BOOST_FOREACH(Scatter::value_type& var_slot, cluster.scatter) {
+          if(var_slot.second.slot == none) {
+            var_slot.second.slot = (slot++);
+            cluster.keys.push_back(var_slot.first);
+          }
+        }
+
+        cluster.joint = boost::make_shared<HessianFactor>(GaussianFactorGraph(), cluster.scatter);
+      }
+    };
+
+    /* ************************************************************************* */
+    // Elimination pre-order visitor - all data is stored in the clusters
+    int eliminationPreOrderVisitor(const GaussianEliminationPlan::sharedCluster& node, int& parentData)
+    {
+      return 0;
+    }
+
+    /* ************************************************************************* */
+    // Add A' * A of the factors of a cluster to its joint factor
+    void addFactors(HessianFactor& joint, const FastVector<size_t>& factors,
+      const GaussianFactorGraph& graph, const Scatter& scatter)
+    {
+      BOOST_FOREACH(size_t i, factors) {
+        const GaussianFactor* factor = graph[i].get();
+        if(const HessianFactor* hessian = dynamic_cast<const HessianFactor*>(factor))
+          joint.updateATA(*hessian, scatter);
+        else if(const JacobianFactor* jacobian = dynamic_cast<const JacobianFactor*>(factor))
+          joint.updateATA(*jacobian, scatter);
+        else
+          throw invalid_argument("GaussianFactor is neither Hessian nor Jacobian");
+      }
+    }
+
+    /* ************************************************************************* */
+    // Create the Bayes tree clique of an eliminated cluster, and attach the cliques of its
+    // children, which are no longer referenced by the children.
+    void createClique(GaussianEliminationPlan::Cluster& cluster,
+      const GaussianConditional::shared_ptr& conditional)
+    {
+      cluster.clique = boost::make_shared<GaussianBayesTreeClique>(conditional);
+      cluster.clique->problemSize_ = cluster.problemSize_;
+      cluster.clique->children.reserve(cluster.children.size());
+      BOOST_FOREACH(const GaussianEliminationPlan::sharedCluster& child, cluster.children) {
+        child->clique->parent_ = cluster.clique;
+        cluster.clique->children.push_back(child->clique);
+        child->clique.reset();
+      }
+    }
+  }
+
+  /* ************************************************************************* */
+  // Assembly visitor - sums the factors of the cluster into its joint factor and keeps a copy of
+  // the result.  The clusters are independent, so the order of traversal does not matter.
+  struct GaussianEliminationPlan::AssembleVisitor
+  {
+    const GaussianFactorGraph& graph;
+    AssembleVisitor(const GaussianFactorGraph& graph) : graph(graph) {}
+    void operator()(const sharedCluster& node, int& myData)
+    {
+      Cluster& cluster = *node;
+      HessianFactor& joint = *cluster.joint;
+      joint.keys_ = cluster.keys;
+      joint.info_.blockStart() = 0;
+      joint.info_.full().triangularView().setZero();
+      addFactors(joint, cluster.factors, graph, cluster.scatter);
+      cluster.assembled = joint.info_.matrix().nestedExpression();
+    }
+  };
+
+  /* ************************************************************************* */
+  // Elimination post-order visitor for multifrontal Cholesky - sums the factors and the remaining
+  // factors of the children into the joint factor of the cluster and does dense partial Cholesky,
+  // after which the joint factor is the remaining factor.  This is EliminateCholesky, except that
+  // the joint factor and its Scatter are not recreated.  Without a graph, the cluster starts from
+  // its assembled Hessian instead, with damping added to the diagonal blocks of its frontal
+  // variables.
+  struct GaussianEliminationPlan::CholeskyEliminationVisitor
+  {
+    const GaussianFactorGraph* graph;
+    const VectorValues* damping;
+    CholeskyEliminationVisitor(const GaussianFactorGraph& graph) : graph(&graph), damping(0) {}
+    CholeskyEliminationVisitor(const VectorValues& damping) : graph(0), damping(&damping) {}
+    void operator()(const sharedCluster& node, int& myData)
+    {
+      Cluster& cluster = *node;
+      HessianFactor& joint = *cluster.joint;
+
+      // Restore the joint factor from its use as a remaining factor
+      joint.keys_ = cluster.keys;
+      joint.info_.blockStart() = 0;
+
+      gttic(update);
+      if(graph) {
+        // Form A' * A
+        joint.info_.full().triangularView().setZero();
+        addFactors(joint, cluster.factors, *graph, cluster.scatter);
+      } else {
+        // Copy the assembled Hessian and damp it.  Each variable is frontal in exactly one
+        // cluster, so damping the frontal diagonal blocks damps each variable exactly once.
+        joint.info_.full() = cluster.assembled;
+        for(size_t k = 0; k < cluster.frontals.size(); ++k) {
+          VectorValues::const_iterator d = damping->find(cluster.keys[k]);
+          if(d != damping->end()) {
+            if(d->second.size() != joint.info_(k, k).rows())
+              throw invalid_argument("GaussianEliminationPlan::eliminateAssembled: damping has the wrong dimension");
+            joint.info_.matrix().nestedExpression().diagonal().segment(joint.info_.offset(k), d->second.size()) += d->second;
+          }
+        }
+      }
+      BOOST_FOREACH(const sharedCluster& child, cluster.children)
+        joint.updateATA(*child->joint, cluster.scatter);
+      gttoc(update);
+
+      // Do dense elimination
+      GaussianConditional::shared_ptr conditional;
+      try {
+        const size_t nrFrontals = cluster.frontals.size();
+        VerticalBlockMatrix Ab = joint.info_.choleskyPartial(nrFrontals);
+        conditional = boost::make_shared<GaussianConditional>(cluster.keys, nrFrontals, Ab);
+        // Erase the eliminated keys in the remaining factor
+        joint.keys_.erase(joint.keys_.begin(), joint.keys_.begin() + nrFrontals);
+      } catch(CholeskyFailed&) {
+        throw IndeterminantLinearSystemException(cluster.frontals.front());
+      }
+
+      createClique(cluster, conditional);
+    }
+  };
+
+  /* ************************************************************************* */
+  // Elimination post-order visitor for a custom elimination function - gathers the factors and the
+  // remaining factors of the children, as in ClusterTree::eliminate.
+  struct GaussianEliminationPlan::FunctionEliminationVisitor
+  {
+    const GaussianFactorGraph& graph;
+    const Eliminate& function;
+    FunctionEliminationVisitor(const GaussianFactorGraph& graph, const Eliminate& function) :
+      graph(graph), function(function) {}
+    void operator()(const sharedCluster& node, int& myData)
+    {
+      Cluster& cluster = *node;
+
+      // Gather factors
+      GaussianFactorGraph gatheredFactors;
+      gatheredFactors.reserve(cluster.factors.size() + cluster.children.size());
+      BOOST_FOREACH(size_t i, cluster.factors)
+        gatheredFactors.push_back(graph[i]);
+      BOOST_FOREACH(const sharedCluster& child, cluster.children) {
+        if(child->remaining)
+          gatheredFactors.push_back(child->remaining);
+        child->remaining.reset();
+      }
+
+      // Do dense elimination step
+      GaussianFactorGraph::EliminationResult eliminationResult = function(gatheredFactors, cluster.frontals);
+      if(!eliminationResult.second->empty())
+        cluster.remaining = eliminationResult.second;
+
+      createClique(cluster, eliminationResult.first);
+    }
+  };
+
+  /* ************************************************************************* */
+  GaussianEliminationPlan::GaussianEliminationPlan(const GaussianFactorGraph& graph,
+    const Ordering& ordering) : ordering_(ordering), isAssembled_(false)
+  {
+    build(graph, VariableIndex(graph));
+  }
+
+  /* ************************************************************************* */
+  GaussianEliminationPlan::GaussianEliminationPlan(const GaussianFactorGraph& graph,
+    const VariableIndex& variableIndex, const Ordering& ordering) : ordering_(ordering), isAssembled_(false)
+  {
+    build(graph, variableIndex);
+  }
+
+  /* ************************************************************************* */
+  bool GaussianEliminationPlan::compatible(const GaussianFactorGraph& graph) const
+  {
+    if(graph.size() + 1 != factorOffsets_.size())
+      return false;
+    for(size_t i = 0; i < graph.size(); ++i) {
+      size_t position = factorOffsets_[i];
+      const size_t end = factorOffsets_[i + 1];
+      if(const GaussianFactor* factor = graph[i].get()) {
+        if(factor->size() != end - position)
+          return false;
+        for(GaussianFactor::const_iterator variable = factor->begin(); variable != factor->end(); ++variable, ++position)
+          if(*variable != factorKeys_[position] || factor->getDim(variable) != factorDims_[position])
+            return false;
+      } else if(position != end) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* ************************************************************************* */
+  GaussianBayesTree::shared_ptr GaussianEliminationPlan::eliminate(const GaussianFactorGraph& graph)
+  {
+    gttic(GaussianEliminationPlan_eliminate);
+    if(graph.size() + 1 != factorOffsets_.size())
+      throw invalid_argument("GaussianEliminationPlan::eliminate: the graph does not have the structure of this plan");
+
+    // Constrained noise models require QR, see EliminatePreferCholesky
+    if(hasConstraints(graph))
+      return eliminate(graph, EliminatePreferCholesky);
+
+    int rootData = 0;
+    CholeskyEliminationVisitor visitorPost(graph);
+    {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      treeTraversal::DepthFirstForestParallel(*this, rootData,
+        eliminationPreOrderVisitor, visitorPost, 10);
+    }
+    return collectBayesTree();
+  }
+
+  /* ************************************************************************* */
+  GaussianBayesTree::shared_ptr GaussianEliminationPlan::eliminate(const GaussianFactorGraph& graph,
+    const Eliminate& function)
+  {
+    gttic(GaussianEliminationPlan_eliminate_function);
+    if(graph.size() + 1 != factorOffsets_.size())
+      throw invalid_argument("GaussianEliminationPlan::eliminate: the graph does not have the structure of this plan");
+
+    int rootData = 0;
+    FunctionEliminationVisitor visitorPost(graph, function);
+    {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      treeTraversal::DepthFirstForestParallel(*this, rootData,
+        eliminationPreOrderVisitor, visitorPost, 10);
+    }
+    return collectBayesTree();
+  }
+
+  /* ************************************************************************* */
+  void GaussianEliminationPlan::assemble(const GaussianFactorGraph& graph)
+  {
+    gttic(GaussianEliminationPlan_assemble);
+    if(graph.size() + 1 != factorOffsets_.size())
+      throw invalid_argument("GaussianEliminationPlan::assemble: the graph does not have the structure of this plan");
+    if(hasConstraints(graph))
+      throw invalid_argument("GaussianEliminationPlan::assemble: constrained noise models cannot be assembled into a Hessian");
+
+    int rootData = 0;
+    AssembleVisitor visitorPost(graph);
+    {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      treeTraversal::DepthFirstForestParallel(*this, rootData,
+        eliminationPreOrderVisitor, visitorPost, 10);
+    }
+    isAssembled_ = true;
+  }
+
+  /* ************************************************************************* */
+  GaussianBayesTree::shared_ptr GaussianEliminationPlan::eliminateAssembled(const VectorValues& damping)
+  {
+    gttic(GaussianEliminationPlan_eliminateAssembled);
+    if(!isAssembled_)
+      throw invalid_argument("GaussianEliminationPlan::eliminateAssembled: assemble() was not called");
+
+    int rootData = 0;
+    CholeskyEliminationVisitor visitorPost(damping);
+    {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      treeTraversal::DepthFirstForestParallel(*this, rootData,
+        eliminationPreOrderVisitor, visitorPost, 10);
+    }
+    return collectBayesTree();
+  }
+
+  /* ************************************************************************* */
+  void GaussianEliminationPlan::build(const GaussianFactorGraph& graph, const VariableIndex& variableIndex)
+  {
+    gttic(GaussianEliminationPlan_build);
+
+    // Make a symbolic graph with a separate symbolic factor for each factor, so that the factors
+    // in the junction tree can be mapped back to their indices in the graph.  Also record the
+    // structure of each factor for compatible().
+    SymbolicFactorGraph symbolicGraph;
+    symbolicGraph.reserve(graph.size());
+    FastMap<const SymbolicFactor*, size_t> factorIndices;
+    factorOffsets_.reserve(graph.size() + 1);
+    factorOffsets_.push_back(0);
+    for(size_t i = 0; i < graph.size(); ++i) {
+      if(const GaussianFactor* factor = graph[i].get()) {
+        SymbolicFactor::shared_ptr symbolicFactor = boost::make_shared<SymbolicFactor>(*factor);
+        factorIndices.insert(make_pair(symbolicFactor.get(), i));
+        symbolicGraph.push_back(symbolicFactor);
+        for(GaussianFactor::const_iterator variable = factor->begin(); variable != factor->end(); ++variable) {
+          factorKeys_.push_back(*variable);
+          factorDims_.push_back(factor->getDim(variable));
+        }
+      } else {
+        symbolicGraph.push_back(SymbolicFactor::shared_ptr());
+      }
+      factorOffsets_.push_back(factorKeys_.size());
+    }
+
+    // Symbolic elimination, which must eliminate all variables
+    if(ordering_.size() != variableIndex.size())
+      throw InconsistentEliminationRequested();
+    SymbolicEliminationTree eliminationTree(symbolicGraph, variableIndex, ordering_);
+    SymbolicJunctionTree junctionTree(eliminationTree);
+
+    // Create the clusters and allocate their joint factors.  The roots are gathered in a dummy
+    // cluster.
+    ConstructionData rootData;
+    rootData.cluster = boost::make_shared<Cluster>();
+    ConstructionVisitorPre visitorPre(factorIndices);
+    ConstructionVisitorPost visitorPost(graph);
+    treeTraversal::DepthFirstForest(junctionTree, rootData, visitorPre, visitorPost);
+    roots_ = rootData.cluster->children;
+  }
+
+  /* ************************************************************************* */
+  GaussianBayesTree::shared_ptr GaussianEliminationPlan::collectBayesTree()
+  {
+    GaussianBayesTree::shared_ptr result = boost::make_shared<GaussianBayesTree>();
+    BOOST_FOREACH(const sharedCluster& root, roots_) {
+      result->insertRoot(root->clique);
+      root->clique.reset();
+      root->remaining.reset();
+    }
+    return result;
+  }
+
+}
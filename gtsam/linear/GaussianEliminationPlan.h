@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file GaussianEliminationPlan.h
+ * @brief Symbolic multifrontal elimination structure, reusable for repeated numeric factorization
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/inference/VariableIndex.h>
+
+namespace gtsam {
+
+  /**
+   * The symbolic part of multifrontal elimination of a GaussianFactorGraph, computed once from an
+   * Ordering and VariableIndex, and reused to numerically factor any number of graphs with the
+   * same structure, e.g. the successive linearizations of a NonlinearFactorGraph in a nonlinear
+   * optimizer, and the damped systems of Levenberg-Marquardt lambda retries.
+   *
+   * The plan holds the junction tree, i.e. which factors (by index in the graph) are eliminated in
+   * each clique, the frontal and separator variables and their dimensions in each clique, and a
+   * preallocated HessianFactor per clique.  eliminate() then only does the numeric work: it sums
+   * the factors and the children's remaining factors into the preallocated joint factors and does
+   * dense partial Cholesky, without building the VariableIndex, elimination tree, junction tree,
+   * or the Scatter of each clique, and without allocating the clique Hessians.
+   *
+   * assemble() and eliminateAssembled() split this in two, keeping the summed but unfactored
+   * Hessian of each clique so that the same system can be eliminated repeatedly with different
+   * damping added to its diagonal.
+   *
+   * A plan may be used by only one thread at a time, since eliminate() overwrites its storage.
+   * The GaussianBayesTree returned from eliminate() does not share any storage with the plan.
+   *
+   * \addtogroup Multifrontal
+   */
+  class GTSAM_EXPORT GaussianEliminationPlan {
+  public:
+    typedef GaussianEliminationPlan This; ///< This class
+    typedef boost::shared_ptr<This> shared_ptr; ///< Shared pointer to this class
+    typedef GaussianFactorGraph::Eliminate Eliminate; ///< Typedef for an eliminate subroutine
+
+    /** A clique of the junction tree, along with its numeric storage */
+    struct Cluster {
+      typedef FastVector<boost::shared_ptr<Cluster> > Children;
+
+      Ordering frontals; ///< Frontal variables, in elimination order
+      FastVector<Key> keys; ///< Frontal variables followed by the separator variables
+      FastVector<size_t> factors; ///< Indices of the factors of the graph eliminated in this clique
+      Children children; ///< sub-trees
+      Scatter scatter; ///< Slot and dimension of each variable in the joint factor
+      int problemSize_;
+
+      HessianFactor::shared_ptr joint; ///< Preallocated joint factor, the remaining factor after elimination
+      Matrix assembled; ///< Sum of the factors eliminated in this clique, see assemble()
+      GaussianFactor::shared_ptr remaining; ///< Remaining factor when eliminating with a custom function
+      GaussianBayesTreeClique::shared_ptr clique; ///< Clique created during elimination
+
+      int problemSize() const { return problemSize_; }
+    };
+
+    typedef boost::shared_ptr<Cluster> sharedCluster; ///< Shared pointer to Cluster
+    typedef Cluster Node; ///< Define Node=Cluster for compatibility with tree traversal functions
+    typedef sharedCluster sharedNode; ///< Define Node=Cluster for compatibility with tree traversal functions
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Build the plan for eliminating graphs with the structure of \c graph in \c ordering.
+     *  Throws InconsistentEliminationRequested if \c ordering does not contain all variables. */
+    GaussianEliminationPlan(const GaussianFactorGraph& graph, const Ordering& ordering);
+
+    /** Build the plan for eliminating graphs with the structure of \c graph in \c ordering,
+     *  using a precomputed VariableIndex of \c graph. */
+    GaussianEliminationPlan(const GaussianFactorGraph& graph, const VariableIndex& variableIndex,
+      const Ordering& ordering);
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** Check whether \c graph has the structure this plan was built for, i.e. the same number of
+     *  factors, each involving the same variables with the same dimensions. */
+    bool compatible(const GaussianFactorGraph& graph) const;
+
+    /** Eliminate \c graph, which must be compatible() with this plan, with multifrontal Cholesky,
+     *  using the preallocated clique storage.  If any factor has a constrained noise model, this
+     *  falls back to eliminate(graph, EliminatePreferCholesky).  Throws
+     *  IndeterminantLinearSystemException if the system is not positive definite. */
+    GaussianBayesTree::shared_ptr eliminate(const GaussianFactorGraph& graph);
+
+    /** Eliminate \c graph, which must be compatible() with this plan, with a custom elimination
+     *  function such as EliminateQR.  This reuses the symbolic structure but not the clique
+     *  storage. */
+    GaussianBayesTree::shared_ptr eliminate(const GaussianFactorGraph& graph, const Eliminate& function);
+
+    /** Sum the factors of \c graph, which must be compatible() with this plan, into the Hessian of
+     *  each clique, without eliminating.  The assembled Hessians are kept until the next call to
+     *  assemble(), and are eliminated with eliminateAssembled().  Throws std::invalid_argument if
+     *  any factor has a constrained noise model, which cannot be represented as a Hessian. */
+    void assemble(const GaussianFactorGraph& graph);
+
+    /** Eliminate the graph last passed to assemble() with multifrontal Cholesky, after adding
+     *  \c damping to the diagonal of its Hessian, i.e. the Hessian H + diag(damping) is
+     *  eliminated.  The assembled Hessians are not modified, so this can be called repeatedly with
+     *  different damping, as in the lambda trials of Levenberg-Marquardt.  Variables missing from
+     *  \c damping are not damped.  Throws IndeterminantLinearSystemException if the damped system
+     *  is not positive definite. */
+    GaussianBayesTree::shared_ptr eliminateAssembled(const VectorValues& damping);
+
+    /// @}
+    /// @name Advanced Interface
+    /// @{
+
+    /** The elimination ordering of this plan */
+    const Ordering& ordering() const { return ordering_; }
+
+    /** Return the set of roots (one for a tree, multiple for a forest) */
+    const FastVector<sharedCluster>& roots() const { return roots_; }
+
+    /// @}
+
+  private:
+    Ordering ordering_; ///< The elimination ordering
+    FastVector<sharedCluster> roots_; ///< Roots of the junction tree
+    FastVector<Key> factorKeys_; ///< Keys of all factors, concatenated
+    FastVector<DenseIndex> factorDims_; ///< Dimension of each entry of factorKeys_
+    FastVector<size_t> factorOffsets_; ///< Start of the keys of each factor in factorKeys_, and the total
+    bool isAssembled_; ///< Whether assemble() was called
+
+    /** Build the junction tree and clique storage */
+    void build(const GaussianFactorGraph& graph, const VariableIndex& variableIndex);
+
+    /** Create the Bayes tree from the cliques at the roots after elimination */
+    GaussianBayesTree::shared_ptr collectBayesTree();
+
+    struct AssembleVisitor;
+    struct CholeskyEliminationVisitor;
+    struct FunctionEliminationVisitor;
+  };
+
+}
@@ -30,6 +30,11 @@
 #include <gtsam/base/timing.h>
 #include <gtsam/base/cholesky.h>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#endif
+
 using namespace std;
 using namespace gtsam;
 
@@ -364,13 +369,66 @@ namespace gtsam {
 
   }
 
+#ifdef GTSAM_USE_TBB
+  namespace {
+    /* ************************************************************************* */
+    // e_i <- A_i*x for a range of factors
+    struct MultiplyFactors {
+      const GaussianFactorGraph& graph;
+      const VectorValues& x;
+      const vector<Vector*>& e;
+      MultiplyFactors(const GaussianFactorGraph& graph, const VectorValues& x, const vector<Vector*>& e) :
+        graph(graph), x(x), e(e) {}
+      void operator()(const tbb::blocked_range<size_t>& r) const {
+        for(size_t i = r.begin(); i != r.end(); ++i)
+          *e[i] = (*convertToJacobianFactorPtr(graph[i])) * x;
+      }
+    };
+
+    /* ************************************************************************* */
+    // Accumulates A_i'*e_i for a range of factors into a contiguous vector, split per thread
+    struct TransposeMultiplyFactors {
+      const GaussianFactorGraph& graph;
+      const vector<const Vector*>& e;
+      const FastMap<Key, DenseIndex>& offsets;
+      Vector result;
+      TransposeMultiplyFactors(const GaussianFactorGraph& graph, const vector<const Vector*>& e,
+        const FastMap<Key, DenseIndex>& offsets, DenseIndex dim) :
+        graph(graph), e(e), offsets(offsets), result(Vector::Zero(dim)) {}
+      TransposeMultiplyFactors(TransposeMultiplyFactors& other, tbb::split) :
+        graph(other.graph), e(other.e), offsets(other.offsets), result(Vector::Zero(other.result.size())) {}
+      void operator()(const tbb::blocked_range<size_t>& r) {
+        for(size_t i = r.begin(); i != r.end(); ++i) {
+          JacobianFactor::shared_ptr Ai = convertToJacobianFactorPtr(graph[i]);
+          const Vector E = Ai->get_model() ? Ai->get_model()->whiten(*e[i]) : *e[i];
+          for(JacobianFactor::const_iterator j = Ai->begin(); j != Ai->end(); ++j)
+            result.segment(offsets.at(*j), Ai->getDim(j)).noalias() += Ai->getA(j).transpose() * E;
+        }
+      }
+      void join(const TransposeMultiplyFactors& other) { result += other.result; }
+    };
+  }
+#endif
+
   /* ************************************************************************* */
-  void GaussianFactorGraph::multiplyInPlace(const VectorValues& x, Errors& e) const {
-    multiplyInPlace(x, e.begin());
+  void GaussianFactorGraph::multiplyInPlace(const VectorValues& x, Errors& e, bool parallel) const {
+    multiplyInPlace(x, e.begin(), parallel);
   }
 
   /* ************************************************************************* */
-  void GaussianFactorGraph::multiplyInPlace(const VectorValues& x, const Errors::iterator& e) const {
+  void GaussianFactorGraph::multiplyInPlace(const VectorValues& x, const Errors::iterator& e, bool parallel) const {
+#ifdef GTSAM_USE_TBB
+    if(parallel) {
+      vector<Vector*> es;
+      es.reserve(size());
+      Errors::iterator ei = e;
+      for(size_t i = 0; i < size(); ++i, ++ei)
+        es.push_back(&*ei);
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, size()), MultiplyFactors(*this, x, es));
+      return;
+    }
+#endif
     Errors::iterator ei = e;
     BOOST_FOREACH(const GaussianFactor::shared_ptr& Ai_G, *this) {
       JacobianFactor::shared_ptr Ai = convertToJacobianFactorPtr(Ai_G);
@@ -394,7 +452,37 @@ namespace gtsam {
   /* ************************************************************************* */
   // x += alpha*A'*e
 void GaussianFactorGraph::transposeMultiplyAdd(double alpha, const Errors& e,
-    VectorValues& x) const {
+    VectorValues& x, bool parallel) const {
+#ifdef GTSAM_USE_TBB
+  if(parallel) {
+    // Lay out the variables of x contiguously, adding the ones it is missing
+    FastMap<Key, DenseIndex> offsets;
+    DenseIndex dim = 0;
+    BOOST_FOREACH(const VectorValues::KeyValuePair& xj, x) {
+      offsets.insert(make_pair(xj.first, dim));
+      dim += xj.second.size();
+    }
+    vector<const Vector*> es;
+    es.reserve(size());
+    Errors::const_iterator ei = e.begin();
+    BOOST_FOREACH(const sharedFactor& Ai_G, *this) {
+      for(GaussianFactor::const_iterator j = Ai_G->begin(); j != Ai_G->end(); ++j) {
+        if(offsets.insert(make_pair(*j, dim)).second) {
+          x.insert(*j, Vector::Zero(Ai_G->getDim(j)));
+          dim += Ai_G->getDim(j);
+        }
+      }
+      es.push_back(&*(ei++));
+    }
+
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    TransposeMultiplyFactors products(*this, es, offsets, dim);
+    tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size()), products);
+    BOOST_FOREACH(VectorValues::KeyValuePair& xj, x)
+      xj.second += alpha * products.result.segment(offsets.at(xj.first), xj.second.size());
+    return;
+  }
+#endif
   // For each factor add the gradient contribution
   Errors::const_iterator ei = e.begin();
   BOOST_FOREACH(const sharedFactor& Ai_G, *this) {
@@ -297,8 +297,9 @@ namespace gtsam {
     /** x = A'*e */
     VectorValues transposeMultiply(const Errors& e) const;
 
-    /** x += alpha*A'*e */
-    void transposeMultiplyAdd(double alpha, const Errors& e, VectorValues& x) const;
+    /** x += alpha*A'*e.  If parallel, and GTSAM uses TBB, each thread accumulates the products of a
+     *  range of factors into its own contiguous vector, and these are summed into x. */
+    void transposeMultiplyAdd(double alpha, const Errors& e, VectorValues& x, bool parallel = false) const;
 
     /** return A*x-b */
     Errors gaussianErrors(const VectorValues& x) const;
@@ -314,11 +315,11 @@ namespace gtsam {
     void multiplyHessianAdd(double alpha, const double* x,
         double* y) const;
 
-    ///** In-place version e <- A*x that overwrites e. */
-    void multiplyInPlace(const VectorValues& x, Errors& e) const;
+    ///** In-place version e <- A*x that overwrites e, over ranges of factors with TBB if parallel. */
+    void multiplyInPlace(const VectorValues& x, Errors& e, bool parallel = false) const;
 
-    /** In-place version e <- A*x that takes an iterator. */
-    void multiplyInPlace(const VectorValues& x, const Errors::iterator& e) const;
+    /** In-place version e <- A*x that takes an iterator, over ranges of factors with TBB if parallel. */
+    void multiplyInPlace(const VectorValues& x, const Errors::iterator& e, bool parallel = false) const;
 
     /// @}
 
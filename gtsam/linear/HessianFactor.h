@@ -34,6 +34,7 @@ namespace gtsam {
   class GaussianConditional;
   class GaussianBayesNet;
   class GaussianFactorGraph;
+  class GaussianEliminationPlan;
 
   GTSAM_EXPORT std::pair<boost::shared_ptr<GaussianConditional>, boost::shared_ptr<GaussianFactor> >
     EliminatePreferCholesky(const GaussianFactorGraph& factors, const Ordering& keys);
@@ -426,6 +427,9 @@ namespace gtsam {
     friend GTSAM_EXPORT std::pair<boost::shared_ptr<GaussianConditional>, boost::shared_ptr<GaussianFactor> >
       EliminatePreferCholesky(const GaussianFactorGraph& factors, const Ordering& keys);
 
+    /// GaussianEliminationPlan reuses HessianFactors as preallocated clique storage
+    friend class GaussianEliminationPlan;
+
   private:
 
     /** Serialization function */
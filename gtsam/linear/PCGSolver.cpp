@@ -17,6 +17,9 @@
 //#include <gsp2/gtsam-interface-sbm.h>
 //#include <ydjian/tool/ThreadSafeTimer.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 
@@ -27,12 +30,23 @@ namespace gtsam {
 /*****************************************************************************/
 void PCGSolverParameters::print(ostream &os) const {
   Base::print(os);
-  os << "PCGSolverParameters:" <<  endl;
+  os << "PCGSolverParameters:" <<  endl
+     << "reuseStructure:        " << reuseStructure_ << endl
+     << "refreshInterval:       " << refreshInterval_ << endl
+     << "refreshIterationRatio: " << refreshIterationRatio_ << endl
+     << "warmStart:             " << warmStart_ << endl
+     << "inexactNewton:         " << inexactNewton_ << endl
+     << "forcingMax:            " << forcingMax_ << endl
+     << "forcingGamma:          " << forcingGamma_ << endl
+     << "forcingAlpha:          " << forcingAlpha_ << endl;
   preconditioner_->print(os);
 }
 
 /*****************************************************************************/
-PCGSolver::PCGSolver(const PCGSolverParameters &p) {
+PCGSolver::PCGSolver(const PCGSolverParameters &p)
+  : parameters_(p), nrSolves_(0), nrBuilds_(0), nrRefreshes_(0), nrCompiles_(0), nrIterations_(0),
+    lastIterations_(0), solvesSinceRefresh_(0), refreshIterations_(0),
+    forcing_(p.forcingMax_), lastGradientNorm_(0.0) {
   preconditioner_ = createPreconditioner(p.preconditioner_);
 }
 
@@ -43,24 +57,144 @@ VectorValues PCGSolver::optimize (
   const std::map<Key, Vector> &lambda,
   const VectorValues &initial)
 {
-  /* build preconditioner */
-  preconditioner_->build(gfg, keyInfo, lambda);
+  const bool warmStart = parameters_.warmStart_ && compatible(gfg, keyInfo);
+  updatePreconditioner(gfg, keyInfo, lambda);
+  const GaussianFactorGraphSystem system(gfg, *compiled_, *preconditioner_, keyInfo, lambda);
+
+  /* with a warm start or forcing terms, the tolerance is relative to the residual of zero */
+  ConjugateGradientParameters parameters(parameters_);
+  if ( warmStart || parameters_.inexactNewton_ ) {
+    Vector b = Vector::Zero(keyInfo.numCols()), z = b;
+    system.getb(b);
+    system.precondition(b, z);
+    const double tolerance = parameters_.inexactNewton_ ? forcingTerm(b.norm()) : parameters_.epsilon_rel();
+    parameters.setEpsilon_rel(0.0);
+    parameters.setEpsilon_abs(std::max(parameters_.epsilon_abs(), tolerance * tolerance * b.dot(z)));
+  }
 
   /* apply pcg */
-  const Vector sol = preconditionedConjugateGradient<GaussianFactorGraphSystem, Vector>(
-        GaussianFactorGraphSystem(gfg, *preconditioner_, keyInfo, lambda),
-        initial.vector(keyInfo.ordering()), parameters_);
+  size_t iterations = 0;
+  lastSolution_ = preconditionedConjugateGradient<GaussianFactorGraphSystem, Vector>(
+        system, warmStart ? lastSolution_ : initial.vector(keyInfo.ordering()), parameters, iterations);
+  recordSolve(iterations);
+
+  return buildVectorValues(lastSolution_, keyInfo);
+}
+
+/*****************************************************************************/
+VectorValues PCGSolver::optimizeTrustRegion (
+  const GaussianFactorGraph &gfg,
+  const KeyInfo &keyInfo,
+  const std::map<Key, Vector> &lambda,
+  double Delta, double &stepNorm)
+{
+  updatePreconditioner(gfg, keyInfo, lambda);
+  const GaussianFactorGraphSystem system(gfg, *compiled_, *preconditioner_, keyInfo, lambda);
 
-  return buildVectorValues(sol, keyInfo);
+  ConjugateGradientParameters parameters(parameters_);
+  if ( parameters_.inexactNewton_ ) {
+    Vector b = Vector::Zero(keyInfo.numCols());
+    system.getb(b);
+    parameters.setEpsilon_rel(forcingTerm(b.norm()));
+  }
+
+  /* apply truncated pcg */
+  size_t iterations = 0;
+  lastSolution_ = steihaugConjugateGradient<GaussianFactorGraphSystem, Vector>(
+        system, Vector::Zero(keyInfo.numCols()), Delta, parameters, stepNorm, iterations);
+  recordSolve(iterations);
+
+  return buildVectorValues(lastSolution_, keyInfo);
+}
+
+/*****************************************************************************/
+void PCGSolver::updatePreconditioner(
+  const GaussianFactorGraph &gfg,
+  const KeyInfo &keyInfo,
+  const std::map<Key, Vector> &lambda)
+{
+  /* compile a new structure, or copy the values of the same one */
+  const bool sameStructure = compatible(gfg, keyInfo);
+  if ( !sameStructure || !compiled_->refresh(gfg) ) {
+    compiled_.reset(new CompiledGaussianFactorGraph(gfg, keyInfo));
+    ++ nrCompiles_;
+  }
+
+  /* build the preconditioner for a new structure, refresh it, or reuse it as is */
+  if ( !sameStructure ) {
+    preconditioner_->build(gfg, keyInfo, lambda);
+    ++ nrBuilds_;
+    solvesSinceRefresh_ = 0;
+
+    ordering_ = keyInfo.ordering();
+    dims_ = keyInfo.colSpec();
+    factorOffsets_.assign(1, 0);
+    factorKeys_.clear();
+    BOOST_FOREACH ( const GaussianFactor::shared_ptr &gf, gfg ) {
+      if ( gf ) factorKeys_.insert(factorKeys_.end(), gf->begin(), gf->end());
+      factorOffsets_.push_back(factorKeys_.size());
+    }
+  }
+  else if ( (parameters_.refreshInterval_ > 0 && solvesSinceRefresh_ >= parameters_.refreshInterval_) ||
+            (parameters_.refreshIterationRatio_ > 0.0 &&
+             lastIterations_ > parameters_.refreshIterationRatio_ * refreshIterations_) ) {
+    if ( parameters_.reuseStructure_ ) {
+      preconditioner_->refresh(gfg, keyInfo, lambda);
+      ++ nrRefreshes_;
+    }
+    else {
+      preconditioner_->build(gfg, keyInfo, lambda);
+      ++ nrBuilds_;
+    }
+    solvesSinceRefresh_ = 0;
+  }
+}
+
+/*****************************************************************************/
+double PCGSolver::forcingTerm(double gradientNorm) {
+  if ( gradientNorm != lastGradientNorm_ ) {
+    if ( lastGradientNorm_ > 0.0 ) {
+      double eta = parameters_.forcingGamma_ * std::pow(gradientNorm / lastGradientNorm_, parameters_.forcingAlpha_);
+      const double safeguard = parameters_.forcingGamma_ * std::pow(forcing_, parameters_.forcingAlpha_);
+      if ( safeguard > 0.1 ) eta = std::max(eta, safeguard);
+      forcing_ = std::min(eta, parameters_.forcingMax_);
+    }
+    lastGradientNorm_ = gradientNorm;
+  }
+  return forcing_;
+}
+
+/*****************************************************************************/
+void PCGSolver::recordSolve(size_t iterations) {
+  ++ nrSolves_;
+  nrIterations_ += iterations;
+  lastIterations_ = iterations;
+  if ( solvesSinceRefresh_++ == 0 ) refreshIterations_ = iterations;
+}
+
+/*****************************************************************************/
+bool PCGSolver::compatible(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo) const {
+  if ( nrBuilds_ == 0 || gfg.size() + 1 != factorOffsets_.size() || !ordering_.equals(keyInfo.ordering()) ||
+       dims_ != keyInfo.colSpec() )
+    return false;
+  for ( size_t i = 0 ; i < gfg.size() ; ++i ) {
+    const size_t size = gfg[i] ? gfg[i]->size() : 0;
+    if ( size != factorOffsets_[i + 1] - factorOffsets_[i] ||
+         (size > 0 && !std::equal(gfg[i]->begin(), gfg[i]->end(), factorKeys_.begin() + factorOffsets_[i])) )
+      return false;
+  }
+  return true;
 }
 
 /*****************************************************************************/
 GaussianFactorGraphSystem::GaussianFactorGraphSystem(
     const GaussianFactorGraph &gfg,
+    const CompiledGaussianFactorGraph &compiled,
     const Preconditioner &preconditioner,
     const KeyInfo &keyInfo,
     const std::map<Key, Vector> &lambda)
-  : gfg_(gfg), preconditioner_(preconditioner), keyInfo_(keyInfo), lambda_(lambda) {}
+  : gfg_(gfg), compiled_(compiled), preconditioner_(preconditioner), keyInfo_(keyInfo),
+    lambda_(lambda) {}
 
 /*****************************************************************************/
 void GaussianFactorGraphSystem::residual(const Vector &x, Vector &r) const {
@@ -77,87 +211,14 @@ void GaussianFactorGraphSystem::residual(const Vector &x, Vector &r) const {
 
 /*****************************************************************************/
 void GaussianFactorGraphSystem::multiply(const Vector &x, Vector& Ax) const {
-  /* implement Ax, assume x and Ax are pre-allocated */
-
-  /* reset y */
-  Ax.setZero();
-
-  BOOST_FOREACH ( const GaussianFactor::shared_ptr &gf, gfg_ ) {
-    if ( JacobianFactor::shared_ptr jf = boost::dynamic_pointer_cast<JacobianFactor>(gf) ) {
-      /* accumulate At A x*/
-      for ( JacobianFactor::const_iterator it = jf->begin() ; it != jf->end() ; ++it ) {
-        const Matrix Ai = jf->getA(it);
-        /* this map lookup should be replaced */
-        const KeyInfoEntry &entry = keyInfo_.find(*it)->second;
-        Ax.segment(entry.colstart(), entry.dim())
-            += Ai.transpose() * (Ai * x.segment(entry.colstart(), entry.dim()));
-      }
-    }
-    else if ( HessianFactor::shared_ptr hf = boost::dynamic_pointer_cast<HessianFactor>(gf) ) {
-      /* accumulate H x */
-
-      /* use buffer to avoid excessive table lookups */
-      const size_t sz = hf->size();
-      vector<Vector> y;
-      y.reserve(sz);
-      for (HessianFactor::const_iterator it = hf->begin(); it != hf->end(); it++) {
-        /* initialize y to zeros */
-        y.push_back(zero(hf->getDim(it)));
-      }
-
-      for (HessianFactor::const_iterator j = hf->begin(); j != hf->end(); j++ ) {
-        /* retrieve the key mapping */
-        const KeyInfoEntry &entry = keyInfo_.find(*j)->second;
-        // xj is the input vector
-        const Vector xj = x.segment(entry.colstart(), entry.dim());
-        size_t idx = 0;
-        for (HessianFactor::const_iterator i = hf->begin(); i != hf->end(); i++, idx++ ) {
-          if ( i == j ) y[idx] += hf->info(j, j).selfadjointView() * xj;
-          else y[idx] += hf->info(i, j).knownOffDiagonal() * xj;
-        }
-      }
-
-      /* accumulate to r */
-      for(DenseIndex i = 0; i < (DenseIndex) sz; ++i) {
-        /* retrieve the key mapping */
-        const KeyInfoEntry &entry = keyInfo_.find(hf->keys()[i])->second;
-        Ax.segment(entry.colstart(), entry.dim()) += y[i];
-      }
-    }
-    else {
-      throw invalid_argument("GaussianFactorGraphSystem::multiply gfg contains a factor that is neither a JacobianFactor nor a HessianFactor.");
-    }
-  }
+  /* implement A'Ax, assume x and Ax are pre-allocated */
+  compiled_.multiply(x, Ax);
 }
 
 /*****************************************************************************/
 void GaussianFactorGraphSystem::getb(Vector &b) const {
   /* compute rhs, assume b pre-allocated */
-
-  /* reset */
-  b.setZero();
-
-  BOOST_FOREACH ( const GaussianFactor::shared_ptr &gf, gfg_ ) {
-    if ( JacobianFactor::shared_ptr jf = boost::dynamic_pointer_cast<JacobianFactor>(gf) ) {
-      const Vector rhs = jf->getb();
-      /* accumulate At rhs */
-      for ( JacobianFactor::const_iterator it = jf->begin() ; it != jf->end() ; ++it ) {
-        /* this map lookup should be replaced */
-        const KeyInfoEntry &entry = keyInfo_.find(*it)->second;
-        b.segment(entry.colstart(), entry.dim()) += jf->getA(it).transpose() * rhs ;
-      }
-    }
-    else if ( HessianFactor::shared_ptr hf = boost::dynamic_pointer_cast<HessianFactor>(gf) ) {
-      /* accumulate g */
-      for (HessianFactor::const_iterator it = hf->begin(); it != hf->end(); it++) {
-        const KeyInfoEntry &entry = keyInfo_.find(*it)->second;
-        b.segment(entry.colstart(), entry.dim()) += hf->linearTerm(it);
-      }
-    }
-    else {
-      throw invalid_argument("GaussianFactorGraphSystem::getb gfg contains a factor that is neither a JacobianFactor nor a HessianFactor.");
-    }
-  }
+  compiled_.getb(b);
 }
 
 /**********************************************************************************/
@@ -168,6 +229,10 @@ void GaussianFactorGraphSystem::leftPrecondition(const Vector &x, Vector &y) con
 void GaussianFactorGraphSystem::rightPrecondition(const Vector &x, Vector &y) const
 { preconditioner_.solve(x, y); }
 
+/**********************************************************************************/
+void GaussianFactorGraphSystem::precondition(const Vector &x, Vector &y) const
+{ preconditioner_.fullSolve(x, y); }
+
 /**********************************************************************************/
 VectorValues buildVectorValues(const Vector &v,
                                const Ordering &ordering,
@@ -9,6 +9,7 @@
 
 #include <gtsam/linear/IterativeSolver.h>
 #include <gtsam/linear/ConjugateGradientSolver.h>
+#include <gtsam/linear/CompiledGaussianFactorGraph.h>
 #include <gtsam/linear/VectorValues.h>
 #include <boost/shared_ptr.hpp>
 
@@ -16,6 +17,7 @@
 #include <iosfwd>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace gtsam {
 
@@ -30,7 +32,10 @@ public:
   typedef ConjugateGradientParameters Base;
   typedef boost::shared_ptr<PCGSolverParameters> shared_ptr;
 
-  PCGSolverParameters() {}
+  PCGSolverParameters()
+    : reuseStructure_(false), refreshInterval_(1), refreshIterationRatio_(0.0),
+      warmStart_(false), inexactNewton_(false), forcingMax_(0.9), forcingGamma_(0.9),
+      forcingAlpha_(2.0) {}
 
   virtual void print(std::ostream &os) const;
 
@@ -40,6 +45,34 @@ public:
   }
 
   boost::shared_ptr<PreconditionerParameters> preconditioner_;
+
+  /* Reuse of the preconditioner across calls of the same PCGSolver, e.g. in the iterations of a
+   * nonlinear optimizer.  The preconditioner is built when the structure of the system changes.
+   * Otherwise it is refreshed after refreshInterval_ calls (0 for never), or when CG needed more
+   * than refreshIterationRatio_ times the iterations of the first call after the last refresh
+   * (0 to disable), and used as is in between.  A refresh rebuilds the preconditioner, or with
+   * reuseStructure_ only recomputes its numeric values, e.g. keeps the spanning tree of a
+   * subgraph preconditioner.  The defaults rebuild it in every call. */
+  bool reuseStructure_;
+  size_t refreshInterval_;
+  double refreshIterationRatio_;
+
+  /* Start CG from the solution of the previous call, if the system has the same structure,
+   * instead of from the given initial estimate.  The relative tolerance then applies to the
+   * residual of a zero solution, not to the one of the warm start. */
+  bool warmStart_;
+
+  /* Inexact Newton: the relative tolerance of each call is the forcing term of Eisenstat and
+   * Walker (choice 2) instead of epsilon_rel_, so that early nonlinear iterations are solved
+   * loosely and later ones accurately.  With the norm of the gradient |g_k|, i.e. of the
+   * right-hand side, the forcing term is
+   *   eta_k = min(forcingMax_, forcingGamma_ (|g_k| / |g_k-1|)^forcingAlpha_),
+   * safeguarded by eta_k >= forcingGamma_ eta_k-1^forcingAlpha_ when the latter exceeds 0.1, and
+   * eta_0 = forcingMax_.  Calls with the same gradient, e.g. damping retries in LM, keep eta. */
+  bool inexactNewton_;
+  double forcingMax_;
+  double forcingGamma_;
+  double forcingAlpha_;
 };
 
 /*****************************************************************************/
@@ -65,6 +98,53 @@ public:
       const KeyInfo &keyInfo, const std::map<Key, Vector> &lambda,
       const VectorValues &initial);
 
+  /* Steihaug's truncated PCG for the trust region subproblem of the Hessian of gfg, see
+   * steihaugConjugateGradient.  Delta bounds the norm of the step in the norm of the
+   * preconditioner, and stepNorm is set to the norm of the step.  Preconditioner reuse and
+   * inexactNewton_ apply as in optimize. */
+  VectorValues optimizeTrustRegion(const GaussianFactorGraph &gfg,
+      const KeyInfo &keyInfo, const std::map<Key, Vector> &lambda,
+      double Delta, double &stepNorm);
+
+  /* statistics over all calls of optimize, for tuning the preconditioner reuse */
+  size_t nrSolves() const { return nrSolves_; }            /* calls of optimize */
+  size_t nrBuilds() const { return nrBuilds_; }            /* full builds of the preconditioner */
+  size_t nrRefreshes() const { return nrRefreshes_; }      /* numeric refreshes with reuseStructure_ */
+  size_t nrCompiles() const { return nrCompiles_; }        /* compilations of the system */
+  size_t nrIterations() const { return nrIterations_; }    /* CG iterations of all calls */
+  size_t lastIterations() const { return lastIterations_; }/* CG iterations of the last call */
+
+protected:
+
+  /* whether gfg has the keys and layout of the system the preconditioner was built for */
+  bool compatible(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo) const;
+
+  /* compile gfg, or only copy its numeric values into the compiled system if it has the structure
+   * of the last call, and build, refresh or keep the preconditioner, following the reuse
+   * parameters */
+  void updatePreconditioner(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo,
+      const std::map<Key, Vector> &lambda);
+
+  /* the Eisenstat-Walker forcing term for a right-hand side with norm gradientNorm */
+  double forcingTerm(double gradientNorm);
+
+  /* update the statistics after a call */
+  void recordSolve(size_t iterations);
+
+  size_t nrSolves_, nrBuilds_, nrRefreshes_, nrCompiles_, nrIterations_, lastIterations_;
+  size_t solvesSinceRefresh_;  /* calls since the last build or refresh */
+  size_t refreshIterations_;   /* CG iterations of the first call after the last build or refresh */
+
+  /* structure of the system the preconditioner was built for */
+  Ordering ordering_;
+  std::vector<size_t> dims_;
+  std::vector<size_t> factorOffsets_;
+  std::vector<Key> factorKeys_;
+  boost::shared_ptr<CompiledGaussianFactorGraph> compiled_; /* the system of the last call */
+
+  Vector lastSolution_;        /* solution of the last call, for warmStart_ */
+  double forcing_;             /* the last forcing term */
+  double lastGradientNorm_;    /* the norm of the right-hand side of the last call, 0 before */
 };
 
 /*****************************************************************************/
@@ -72,10 +152,11 @@ class GTSAM_EXPORT GaussianFactorGraphSystem {
 public:
 
   GaussianFactorGraphSystem(const GaussianFactorGraph &gfg,
-      const Preconditioner &preconditioner, const KeyInfo &info,
-      const std::map<Key, Vector> &lambda);
+      const CompiledGaussianFactorGraph &compiled, const Preconditioner &preconditioner,
+      const KeyInfo &info, const std::map<Key, Vector> &lambda);
 
   const GaussianFactorGraph &gfg_;
+  const CompiledGaussianFactorGraph &compiled_; ///< gfg_ compiled for all products
   const Preconditioner &preconditioner_;
   const KeyInfo &keyInfo_;
   const std::map<Key, Vector> &lambda_;
@@ -84,6 +165,7 @@ public:
   void multiply(const Vector &x, Vector& y) const;
   void leftPrecondition(const Vector &x, Vector &y) const;
   void rightPrecondition(const Vector &x, Vector &y) const;
+  void precondition(const Vector &x, Vector &y) const;
   inline void scal(const double alpha, Vector &x) const {
     x *= alpha;
   }
@@ -13,7 +13,11 @@
 #include <gtsam/linear/NoiseModel.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 using namespace std;
@@ -72,6 +76,14 @@ std::string PreconditionerParameters::verbosityTranslator(PreconditionerParamete
   else return "UNKNOWN";
 }
 
+/***************************************************************************************/
+void Preconditioner::fullSolve(const Vector& y, Vector &x) const {
+  Vector z = y;
+  transposeSolve(y, z);
+  x.resize(y.size());
+  solve(z, x);
+}
+
 /***************************************************************************************/
 BlockJacobiPreconditioner::BlockJacobiPreconditioner()
   : Base(), buffer_(0), bufferSize_(0), nnz_(0) {}
@@ -193,6 +205,441 @@ void BlockJacobiPreconditioner::clean() {
   }
 }
 
+/***************************************************************************************/
+namespace {
+  /* the blocks H_ij, j <= i, of the lower triangle of the Hessian of gfg, by the KeyInfo index i */
+  vector<map<size_t, Matrix> > lowerBlockHessian(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo) {
+    vector<map<size_t, Matrix> > hessian(keyInfo.size());
+    BOOST_FOREACH ( const GaussianFactor::shared_ptr &gf, gfg ) {
+      if ( !gf ) continue;
+
+      Matrix H;
+      if ( JacobianFactor::shared_ptr jf = boost::dynamic_pointer_cast<JacobianFactor>(gf) ) {
+        if ( jf->get_model() && jf->isConstrained() )
+          throw invalid_argument("Preconditioner: constrained noise models are not supported");
+        const Matrix A = jf->jacobian().first;
+        H = A.transpose() * A;
+      }
+      else if ( HessianFactor::shared_ptr hf = boost::dynamic_pointer_cast<HessianFactor>(gf) ) {
+        H = hf->information();
+      }
+      else {
+        throw invalid_argument("Preconditioner: gfg contains a factor that is neither a JacobianFactor nor a HessianFactor.");
+      }
+
+      /* scatter the blocks of the lower triangle */
+      DenseIndex offsetI = 0;
+      for ( GaussianFactor::const_iterator it = gf->begin() ; it != gf->end() ; ++it ) {
+        const KeyInfoEntry &entryI = keyInfo.find(*it)->second;
+        DenseIndex offsetJ = 0;
+        for ( GaussianFactor::const_iterator jt = gf->begin() ; jt != gf->end() ; ++jt ) {
+          const KeyInfoEntry &entryJ = keyInfo.find(*jt)->second;
+          if ( entryJ.index() <= entryI.index() ) {
+            const Matrix block = H.block(offsetI, offsetJ, entryI.dim(), entryJ.dim());
+            map<size_t, Matrix>::iterator hij = hessian[entryI.index()].find(entryJ.index());
+            if ( hij == hessian[entryI.index()].end() )
+              hessian[entryI.index()].insert(make_pair(entryJ.index(), block));
+            else
+              hij->second += block;
+          }
+          offsetJ += entryJ.dim();
+        }
+        offsetI += entryI.dim();
+      }
+    }
+    return hessian;
+  }
+}
+
+/***************************************************************************************/
+void IncompleteCholeskyPreconditionerParameters::print(ostream &os) const {
+  Base::print(os);
+  os << "dropTolerance: " << dropTolerance_ << endl;
+}
+
+/***************************************************************************************/
+IncompleteCholeskyPreconditioner::IncompleteCholeskyPreconditioner(double dropTolerance)
+  : Base(), dropTolerance_(dropTolerance), shift_(0.0) {}
+
+/***************************************************************************************/
+void IncompleteCholeskyPreconditioner::build(
+  const GaussianFactorGraph &gfg, const KeyInfo &keyInfo, const std::map<Key,Vector> &lambda)
+{
+  const vector<map<size_t, Matrix> > hessian = lowerBlockHessian(gfg, keyInfo);
+  dims_ = keyInfo.colSpec();
+  starts_.resize(dims_.size());
+  BOOST_FOREACH ( const KeyInfo::value_type &item, keyInfo )
+    starts_[item.second.index()] = item.second.colstart();
+
+  /* restart with increasing diagonal shifts until the incomplete factorization succeeds */
+  for ( shift_ = 0.0 ; !factorize(hessian, shift_) ; shift_ = (shift_ == 0.0 ? 1e-3 : 2.0 * shift_) ) {
+    if ( shift_ > 1e3 )
+      throw runtime_error("IncompleteCholeskyPreconditioner::build could not factor the Hessian.");
+  }
+}
+
+/***************************************************************************************/
+bool IncompleteCholeskyPreconditioner::factorize(const vector<map<size_t, Matrix> > &hessian, double shift) {
+  const size_t n = hessian.size();
+  diagonal_.assign(n, 0);
+  rows_.assign(n, vector<Entry>());
+  columns_.assign(n, vector<Entry>());
+  values_.clear();
+
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    /* row i of the Hessian, which becomes row i of L */
+    map<size_t, Matrix> row(hessian[i].begin(), hessian[i].end());
+    double rowNorm = 0.0;
+    typedef map<size_t, Matrix>::value_type HessianBlock;
+    BOOST_FOREACH ( const HessianBlock &block, hessian[i] )
+      rowNorm += block.second.squaredNorm();
+    rowNorm = sqrt(rowNorm);
+
+    while ( !row.empty() && row.begin()->first < i ) {
+      const size_t j = row.begin()->first;
+      const Matrix Wij = row.begin()->second;
+      row.erase(row.begin());
+
+      /* L_ij = W_ij L_jj^{-T} */
+      const Eigen::Map<const Matrix> Ljj(&values_[diagonal_[j]], dims_[j], dims_[j]);
+      const Matrix Lij = Ljj.triangularView<Eigen::Lower>().solve(Wij.transpose()).transpose();
+      if ( dropTolerance_ > 0.0 && Lij.norm() < dropTolerance_ * rowNorm )
+        continue;
+
+      const size_t offset = values_.size();
+      values_.insert(values_.end(), Lij.data(), Lij.data() + Lij.size());
+      rows_[i].push_back(make_pair(j, offset));
+
+      /* eliminate L_ij from the rest of row i, creating fill only for threshold IC */
+      BOOST_FOREACH ( const Entry &entry, columns_[j] ) {
+        const Eigen::Map<const Matrix> Lmj(&values_[entry.second], dims_[entry.first], dims_[j]);
+        map<size_t, Matrix>::iterator wim = row.find(entry.first);
+        if ( wim != row.end() )
+          wim->second.noalias() -= Lij * Lmj.transpose();
+        else if ( dropTolerance_ > 0.0 )
+          row.insert(make_pair(entry.first, Matrix(-Lij * Lmj.transpose())));
+      }
+      columns_[j].push_back(make_pair(i, offset));
+      row[i].noalias() -= Lij * Lij.transpose();
+    }
+
+    /* L_ii */
+    Matrix Dii = row[i];
+    if ( shift > 0.0 )
+      Dii.diagonal() += shift * hessian[i].find(i)->second.diagonal();
+    Eigen::LLT<Matrix> llt(Dii);
+    if ( llt.info() != Eigen::Success )
+      return false;
+    const Matrix Lii = llt.matrixL();
+    diagonal_[i] = values_.size();
+    values_.insert(values_.end(), Lii.data(), Lii.data() + Lii.size());
+  }
+  return true;
+}
+
+/***************************************************************************************/
+void IncompleteCholeskyPreconditioner::solve(const Vector& y, Vector &x) const {
+  /* x = L^{-T} y by back substitution */
+  x = y;
+  for ( size_t i = dims_.size() ; i-- > 0 ; ) {
+    Vector::SegmentReturnType xi = x.segment(starts_[i], dims_[i]);
+    BOOST_FOREACH ( const Entry &entry, columns_[i] ) {
+      const Eigen::Map<const Matrix> Lmi(&values_[entry.second], dims_[entry.first], dims_[i]);
+      xi.noalias() -= Lmi.transpose() * x.segment(starts_[entry.first], dims_[entry.first]);
+    }
+    const Eigen::Map<const Matrix> Lii(&values_[diagonal_[i]], dims_[i], dims_[i]);
+    Lii.transpose().triangularView<Eigen::Upper>().solveInPlace(xi);
+  }
+}
+
+/***************************************************************************************/
+void IncompleteCholeskyPreconditioner::transposeSolve(const Vector& y, Vector& x) const {
+  /* x = L^{-1} y by forward substitution */
+  x = y;
+  for ( size_t i = 0 ; i < dims_.size() ; ++i ) {
+    Vector::SegmentReturnType xi = x.segment(starts_[i], dims_[i]);
+    BOOST_FOREACH ( const Entry &entry, rows_[i] ) {
+      const Eigen::Map<const Matrix> Lij(&values_[entry.second], dims_[i], dims_[entry.first]);
+      xi.noalias() -= Lij * x.segment(starts_[entry.first], dims_[entry.first]);
+    }
+    const Eigen::Map<const Matrix> Lii(&values_[diagonal_[i]], dims_[i], dims_[i]);
+    Lii.triangularView<Eigen::Lower>().solveInPlace(xi);
+  }
+}
+
+/***************************************************************************************/
+void MultilevelPreconditionerParameters::print(ostream &os) const {
+  Base::print(os);
+  os << "strengthThreshold: " << strengthThreshold_ << endl
+     << "maxCoarseDim:      " << maxCoarseDim_ << endl
+     << "maxLevels:         " << maxLevels_ << endl
+     << "smoothingSweeps:   " << smoothingSweeps_ << endl;
+}
+
+/***************************************************************************************/
+MultilevelPreconditioner::MultilevelPreconditioner(const MultilevelPreconditionerParameters &p)
+  : Base(), parameters_(p) {}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::solve(const Vector& y, Vector &x) const {
+  throw runtime_error("MultilevelPreconditioner is not available in factored form, use fullSolve.");
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::transposeSolve(const Vector& y, Vector& x) const {
+  throw runtime_error("MultilevelPreconditioner is not available in factored form, use fullSolve.");
+}
+
+/***************************************************************************************/
+namespace {
+  /* a strongly coupled variable, with the norm of the coupling block */
+  typedef pair<double, size_t> Neighbor;
+
+  /* factor a diagonal block, with a small shift if it is singular */
+  Eigen::LLT<Matrix> factorDiagonal(const Matrix &D) {
+    Eigen::LLT<Matrix> llt(D);
+    for ( double shift = 1e-10 * std::max(D.trace(), 1.0) ; llt.info() != Eigen::Success ; shift *= 10.0 )
+      llt.compute(D + shift * Matrix::Identity(D.rows(), D.cols()));
+    return llt;
+  }
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::build(
+  const GaussianFactorGraph &gfg, const KeyInfo &keyInfo, const std::map<Key,Vector> &lambda)
+{
+  levels_.assign(1, Level());
+  assemble(gfg, keyInfo);
+
+  /* coarsen until the coarsest level is small enough, or aggregation stalls */
+  for ( ;; ) {
+    Level &level = levels_.back();
+    const size_t dim = level.dims.empty() ? 0 : level.starts.back() + level.dims.back();
+    if ( dim <= parameters_.maxCoarseDim_ || levels_.size() >= parameters_.maxLevels_ )
+      break;
+
+    Level coarse;
+    aggregate(level, coarse);
+    if ( coarse.dims.size() == level.dims.size() ) {
+      level.aggregates.clear();
+      break;
+    }
+    levels_.push_back(coarse);
+  }
+
+  factorize();
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::refresh(
+  const GaussianFactorGraph &gfg, const KeyInfo &keyInfo, const std::map<Key,Vector> &lambda)
+{
+  if ( levels_.empty() || levels_.front().dims != keyInfo.colSpec() ) {
+    build(gfg, keyInfo, lambda);
+    return;
+  }
+
+  /* keep the aggregates, and only recompute the Hessians of all levels */
+  assemble(gfg, keyInfo);
+  for ( size_t l = 0 ; l + 1 < levels_.size() ; ++l )
+    galerkin(levels_[l], levels_[l + 1]);
+  factorize();
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::assemble(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo) {
+  /* the finest level has all blocks of the Hessian */
+  const vector<map<size_t, Matrix> > hessian = lowerBlockHessian(gfg, keyInfo);
+  Level &finest = levels_.front();
+  finest.dims = keyInfo.colSpec();
+  finest.starts.resize(finest.dims.size());
+  BOOST_FOREACH ( const KeyInfo::value_type &item, keyInfo )
+    finest.starts[item.second.index()] = item.second.colstart();
+  finest.rows.assign(hessian.size(), vector<Block>());
+  for ( size_t i = 0 ; i < hessian.size() ; ++i ) {
+    typedef map<size_t, Matrix>::value_type HessianBlock;
+    BOOST_FOREACH ( const HessianBlock &block, hessian[i] ) {
+      finest.rows[i].push_back(block);
+      if ( block.first != i )
+        finest.rows[block.first].push_back(make_pair(i, Matrix(block.second.transpose())));
+    }
+  }
+  BOOST_FOREACH ( vector<Block> &row, finest.rows )
+    sort(row.begin(), row.end(), boost::bind(&Block::first, _1) < boost::bind(&Block::first, _2));
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::factorize() {
+  /* factor the diagonal blocks of all but the coarsest level for smoothing */
+  for ( size_t l = 0 ; l + 1 < levels_.size() ; ++l ) {
+    Level &level = levels_[l];
+    level.diagonal.clear();
+    level.diagonal.reserve(level.rows.size());
+    for ( size_t i = 0 ; i < level.rows.size() ; ++i ) {
+      BOOST_FOREACH ( const Block &block, level.rows[i] ) {
+        if ( block.first == i ) {
+          level.diagonal.push_back(factorDiagonal(block.second));
+          break;
+        }
+      }
+    }
+  }
+
+  /* factor the coarsest level densely */
+  const Level &coarsest = levels_.back();
+  const size_t dim = coarsest.dims.empty() ? 0 : coarsest.starts.back() + coarsest.dims.back();
+  Matrix dense = Matrix::Zero(dim, dim);
+  for ( size_t i = 0 ; i < coarsest.rows.size() ; ++i ) {
+    BOOST_FOREACH ( const Block &block, coarsest.rows[i] )
+      dense.block(coarsest.starts[i], coarsest.starts[block.first],
+                  coarsest.dims[i], coarsest.dims[block.first]) = block.second;
+  }
+  coarsest_ = factorDiagonal(dense);
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::aggregate(Level &level, Level &coarse) const {
+  const size_t n = level.rows.size();
+  const size_t none = numeric_limits<size_t>::max();
+
+  /* strong couplings between variables of the same dimension */
+  vector<double> diagonalNorms(n, 0.0);
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    BOOST_FOREACH ( const Block &block, level.rows[i] )
+      if ( block.first == i ) diagonalNorms[i] = block.second.norm();
+  }
+  vector<vector<Neighbor> > strong(n);
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    BOOST_FOREACH ( const Block &block, level.rows[i] ) {
+      const size_t j = block.first;
+      const double norm = block.second.norm();
+      if ( j != i && level.dims[i] == level.dims[j] &&
+           norm >= parameters_.strengthThreshold_ * sqrt(diagonalNorms[i] * diagonalNorms[j]) )
+        strong[i].push_back(make_pair(norm, j));
+    }
+  }
+
+  /* 1. variables whose strong neighbors are all free form an aggregate with them */
+  level.aggregates.assign(n, none);
+  size_t nrAggregates = 0;
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    if ( level.aggregates[i] != none || strong[i].empty() ) continue;
+    bool free = true;
+    BOOST_FOREACH ( const Neighbor &neighbor, strong[i] )
+      if ( level.aggregates[neighbor.second] != none ) { free = false; break; }
+    if ( !free ) continue;
+    level.aggregates[i] = nrAggregates;
+    BOOST_FOREACH ( const Neighbor &neighbor, strong[i] )
+      level.aggregates[neighbor.second] = nrAggregates;
+    ++ nrAggregates;
+  }
+
+  /* 2. remaining variables join the aggregate of their strongest aggregated neighbor */
+  vector<size_t> joined = level.aggregates;
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    if ( level.aggregates[i] != none ) continue;
+    double strongest = 0.0;
+    BOOST_FOREACH ( const Neighbor &neighbor, strong[i] ) {
+      if ( level.aggregates[neighbor.second] != none && neighbor.first > strongest ) {
+        strongest = neighbor.first;
+        joined[i] = level.aggregates[neighbor.second];
+      }
+    }
+  }
+  level.aggregates.swap(joined);
+
+  /* 3. the others form aggregates with their free strong neighbors, or alone */
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    if ( level.aggregates[i] != none ) continue;
+    level.aggregates[i] = nrAggregates;
+    BOOST_FOREACH ( const Neighbor &neighbor, strong[i] )
+      if ( level.aggregates[neighbor.second] == none )
+        level.aggregates[neighbor.second] = nrAggregates;
+    ++ nrAggregates;
+  }
+
+  /* the coarse variables have the dimension of their aggregates */
+  coarse.dims.assign(nrAggregates, 0);
+  coarse.starts.assign(nrAggregates, 0);
+  for ( size_t i = 0 ; i < n ; ++i )
+    coarse.dims[level.aggregates[i]] = level.dims[i];
+  for ( size_t a = 1 ; a < nrAggregates ; ++a )
+    coarse.starts[a] = coarse.starts[a - 1] + coarse.dims[a - 1];
+
+  galerkin(level, coarse);
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::galerkin(const Level &level, Level &coarse) const {
+  /* Galerkin product P'HP, where P is the identity from each variable to its aggregate */
+  const size_t n = level.rows.size(), nrAggregates = coarse.dims.size();
+  vector<map<size_t, Matrix> > rows(nrAggregates);
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    const size_t a = level.aggregates[i];
+    BOOST_FOREACH ( const Block &block, level.rows[i] ) {
+      const size_t b = level.aggregates[block.first];
+      map<size_t, Matrix>::iterator hab = rows[a].find(b);
+      if ( hab == rows[a].end() )
+        rows[a].insert(make_pair(b, block.second));
+      else
+        hab->second += block.second;
+    }
+  }
+  coarse.rows.assign(nrAggregates, vector<Block>());
+  for ( size_t a = 0 ; a < nrAggregates ; ++a )
+    coarse.rows[a].assign(rows[a].begin(), rows[a].end());
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::gaussSeidel(const Level &level, const Vector &b, Vector &x, bool forward) const {
+  const size_t n = level.rows.size();
+  for ( size_t k = 0 ; k < n ; ++k ) {
+    const size_t i = forward ? k : n - 1 - k;
+    Vector ri = b.segment(level.starts[i], level.dims[i]);
+    BOOST_FOREACH ( const Block &block, level.rows[i] )
+      if ( block.first != i )
+        ri.noalias() -= block.second * x.segment(level.starts[block.first], level.dims[block.first]);
+    x.segment(level.starts[i], level.dims[i]) = level.diagonal[i].solve(ri);
+  }
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::vcycle(size_t l, const Vector &b, Vector &x) const {
+  if ( l + 1 == levels_.size() ) {
+    x = coarsest_.solve(b);
+    return;
+  }
+
+  const Level &level = levels_[l], &coarse = levels_[l + 1];
+  x = Vector::Zero(b.size());
+  for ( size_t sweep = 0 ; sweep < parameters_.smoothingSweeps_ ; ++sweep )
+    gaussSeidel(level, b, x, true);
+
+  /* restrict the residual, P' (b - H x) */
+  const size_t n = level.rows.size();
+  Vector coarseB = Vector::Zero(coarse.dims.empty() ? 0 : coarse.starts.back() + coarse.dims.back());
+  for ( size_t i = 0 ; i < n ; ++i ) {
+    Vector ri = b.segment(level.starts[i], level.dims[i]);
+    BOOST_FOREACH ( const Block &block, level.rows[i] )
+      ri.noalias() -= block.second * x.segment(level.starts[block.first], level.dims[block.first]);
+    coarseB.segment(coarse.starts[level.aggregates[i]], level.dims[i]) += ri;
+  }
+
+  /* coarse correction, prolongated by P */
+  Vector coarseX;
+  vcycle(l + 1, coarseB, coarseX);
+  for ( size_t i = 0 ; i < n ; ++i )
+    x.segment(level.starts[i], level.dims[i]) += coarseX.segment(coarse.starts[level.aggregates[i]], level.dims[i]);
+
+  for ( size_t sweep = 0 ; sweep < parameters_.smoothingSweeps_ ; ++sweep )
+    gaussSeidel(level, b, x, false);
+}
+
+/***************************************************************************************/
+void MultilevelPreconditioner::fullSolve(const Vector& y, Vector &x) const {
+  vcycle(0, y, x);
+}
+
 /***************************************************************************************/
 boost::shared_ptr<Preconditioner> createPreconditioner(const boost::shared_ptr<PreconditionerParameters> parameters) {
 
@@ -205,6 +652,12 @@ boost::shared_ptr<Preconditioner> createPreconditioner(const boost::shared_ptr<P
   else if ( SubgraphPreconditionerParameters::shared_ptr subgraph = boost::dynamic_pointer_cast<SubgraphPreconditionerParameters>(parameters) ) {
     return boost::make_shared<SubgraphPreconditioner>(*subgraph);
   }
+  else if ( IncompleteCholeskyPreconditionerParameters::shared_ptr ic = boost::dynamic_pointer_cast<IncompleteCholeskyPreconditionerParameters>(parameters) ) {
+    return boost::make_shared<IncompleteCholeskyPreconditioner>(ic->dropTolerance_);
+  }
+  else if ( MultilevelPreconditionerParameters::shared_ptr multilevel = boost::dynamic_pointer_cast<MultilevelPreconditionerParameters>(parameters) ) {
+    return boost::make_shared<MultilevelPreconditioner>(*multilevel);
+  }
 
   throw invalid_argument("createPreconditioner: unexpected preconditioner parameter type");
 }
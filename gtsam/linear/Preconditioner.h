@@ -7,11 +7,13 @@
 
 #pragma once
 
+#include <gtsam/base/Matrix.h>
 #include <gtsam/base/Vector.h>
 #include <boost/shared_ptr.hpp>
 #include <iosfwd>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace gtsam {
 
@@ -78,8 +80,9 @@ public:
   virtual void transposeSolve(const Vector& y, Vector& x) const = 0;
 //  virtual void transposeSolve(const VectorValues& y, VectorValues &x) const = 0;
 
-//  /* implement x = S^{-1} S^{-T} y */
-//  virtual void fullSolve(const Vector& y, Vector &x) const = 0;
+  /* implement x = S^{-1} S^{-T} y, by default with transposeSolve and solve.  This is all that
+   * PCG needs, so preconditioners that are not available in factored form override it */
+  virtual void fullSolve(const Vector& y, Vector &x) const;
 //  virtual void fullSolve(const VectorValues& y, VectorValues &x) const = 0;
 
   /* build/factorize the preconditioner */
@@ -88,6 +91,15 @@ public:
     const KeyInfo &info,
     const std::map<Key,Vector> &lambda
     ) = 0;
+
+  /* recompute the numeric values of the preconditioner for a system with the structure of the
+   * one it was built for, keeping structural choices such as a spanning tree.  By default the
+   * preconditioner is rebuilt */
+  virtual void refresh(
+    const GaussianFactorGraph &gfg,
+    const KeyInfo &info,
+    const std::map<Key,Vector> &lambda
+    ) { build(gfg, info, lambda); }
 };
 
 /*******************************************************************************************/
@@ -161,6 +173,141 @@ protected:
   size_t nnz_;
 };
 
+/*******************************************************************************************/
+struct GTSAM_EXPORT IncompleteCholeskyPreconditionerParameters : public PreconditionerParameters {
+  typedef PreconditionerParameters Base;
+  typedef boost::shared_ptr<IncompleteCholeskyPreconditionerParameters> shared_ptr;
+  IncompleteCholeskyPreconditionerParameters(double dropTolerance = 0.0)
+    : Base(), dropTolerance_(dropTolerance) {}
+  virtual ~IncompleteCholeskyPreconditionerParameters() {}
+  virtual void print(std::ostream &os) const;
+
+  /* 0 for IC(0), which keeps the block sparsity of the Hessian.  Otherwise threshold IC, which
+   * allows fill but drops the blocks of L whose norm is below dropTolerance_ times the norm of the
+   * block row of the Hessian */
+  double dropTolerance_;
+};
+
+/*******************************************************************************************/
+/* Block incomplete Cholesky factorization H ~ L L' of the Hessian, in the order of the KeyInfo,
+ * with S = L'.  The blocks of L are dense and only exist where H has a block, for IC(0), or where
+ * they are not dropped, for threshold IC.  If the incomplete factorization breaks down, it is
+ * restarted with the diagonal blocks of H scaled by (1 + shift), for increasing shifts. */
+class GTSAM_EXPORT IncompleteCholeskyPreconditioner : public Preconditioner {
+public:
+  typedef Preconditioner Base;
+  IncompleteCholeskyPreconditioner(double dropTolerance = 0.0);
+  virtual ~IncompleteCholeskyPreconditioner() {}
+
+  /* Computation Interfaces for raw vector */
+  virtual void solve(const Vector& y, Vector &x) const;
+  virtual void transposeSolve(const Vector& y, Vector& x) const;
+
+  virtual void build(
+    const GaussianFactorGraph &gfg,
+    const KeyInfo &info,
+    const std::map<Key,Vector> &lambda
+    ) ;
+
+  /* the number of stored entries of L */
+  size_t nnz() const { return values_.size(); }
+
+  /* the diagonal shift of the last build */
+  double shift() const { return shift_; }
+
+protected:
+
+  /* an off-diagonal block of L, with the index of the other variable and its offset in values_ */
+  typedef std::pair<size_t, size_t> Entry;
+
+  bool factorize(const std::vector<std::map<size_t, Matrix> > &hessian, double shift);
+
+  double dropTolerance_;
+  double shift_;
+  std::vector<size_t> dims_, starts_;
+  std::vector<size_t> diagonal_;                  /* offset of L_ii in values_ */
+  std::vector<std::vector<Entry> > rows_;         /* L_ij, j < i, by row i */
+  std::vector<std::vector<Entry> > columns_;      /* L_ij, i > j, by column j */
+  std::vector<double> values_;
+};
+
+/*******************************************************************************************/
+struct GTSAM_EXPORT MultilevelPreconditionerParameters : public PreconditionerParameters {
+  typedef PreconditionerParameters Base;
+  typedef boost::shared_ptr<MultilevelPreconditionerParameters> shared_ptr;
+  MultilevelPreconditionerParameters()
+    : Base(), strengthThreshold_(0.08), maxCoarseDim_(500), maxLevels_(10), smoothingSweeps_(1) {}
+  virtual ~MultilevelPreconditionerParameters() {}
+  virtual void print(std::ostream &os) const;
+
+  double strengthThreshold_;  /* variables are aggregated if |H_ij| >= threshold * sqrt(|H_ii| |H_jj|) */
+  size_t maxCoarseDim_;       /* dimension at or below which a level is solved directly */
+  size_t maxLevels_;          /* maximum number of levels, including the finest */
+  size_t smoothingSweeps_;    /* block Gauss-Seidel sweeps before and after each coarse correction */
+};
+
+/*******************************************************************************************/
+/* Algebraic multigrid preconditioner by aggregation on the variable graph.  Each level groups
+ * strongly coupled variables of the same dimension into aggregates, which become the variables of
+ * the next level, with the Galerkin product P'HP of the piecewise constant prolongation P as
+ * Hessian.  The preconditioner applies one symmetric V-cycle, with forward block Gauss-Seidel
+ * before and backward block Gauss-Seidel after each coarse correction and a dense Cholesky
+ * solve at the coarsest level.  It is not available in factored form, so only fullSolve is
+ * implemented, and solve and transposeSolve throw. */
+class GTSAM_EXPORT MultilevelPreconditioner : public Preconditioner {
+public:
+  typedef Preconditioner Base;
+  MultilevelPreconditioner(const MultilevelPreconditionerParameters &p = MultilevelPreconditionerParameters());
+  virtual ~MultilevelPreconditioner() {}
+
+  /* Computation Interfaces for raw vector */
+  virtual void solve(const Vector& y, Vector &x) const;
+  virtual void transposeSolve(const Vector& y, Vector& x) const;
+  virtual void fullSolve(const Vector& y, Vector &x) const;
+
+  virtual void build(
+    const GaussianFactorGraph &gfg,
+    const KeyInfo &info,
+    const std::map<Key,Vector> &lambda
+    ) ;
+
+  /* keep the aggregates of the last build, and only recompute the Hessians of all levels */
+  virtual void refresh(
+    const GaussianFactorGraph &gfg,
+    const KeyInfo &info,
+    const std::map<Key,Vector> &lambda
+    ) ;
+
+  /* the number of levels of the last build */
+  size_t nrLevels() const { return levels_.size(); }
+
+  /* the number of variables of a level */
+  size_t nrVariables(size_t level) const { return levels_.at(level).dims.size(); }
+
+protected:
+
+  /* a block H_ij of a row i, with the index j */
+  typedef std::pair<size_t, Matrix> Block;
+
+  struct Level {
+    std::vector<size_t> dims, starts;
+    std::vector<std::vector<Block> > rows;                       /* all blocks H_ij, by row i */
+    std::vector<Eigen::LLT<Matrix> > diagonal;                   /* factored H_ii */
+    std::vector<size_t> aggregates;                              /* variable of the next level */
+  };
+
+  void assemble(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo);
+  void aggregate(Level &level, Level &coarse) const;
+  void galerkin(const Level &level, Level &coarse) const;
+  void factorize();
+  void vcycle(size_t l, const Vector &b, Vector &x) const;
+  void gaussSeidel(const Level &level, const Vector &b, Vector &x, bool forward) const;
+
+  MultilevelPreconditionerParameters parameters_;
+  std::vector<Level> levels_;
+  Eigen::LLT<Matrix> coarsest_;
+};
+
 /*********************************************************************************************/
 /* factory method to create preconditioners */
 boost::shared_ptr<Preconditioner> createPreconditioner(const boost::shared_ptr<PreconditionerParameters> parameters);
@@ -0,0 +1,549 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SchurComplementSolver.cpp
+ * @brief Linear solver that eliminates the points of bundle adjustment problems in closed form
+ */
+
+#include <gtsam/linear/SchurComplementSolver.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/base/SymmetricBlockMatrix.h>
+#include <gtsam/base/FastMap.h>
+#include <gtsam/base/FastSet.h>
+#include <gtsam/base/timing.h>
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <stdexcept>
+
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#endif
+
+using namespace std;
+
+namespace gtsam {
+
+  /* ************************************************************************* */
+  struct SchurComplementSolver::Group {
+    Matrix Ab; ///< The whitened Jacobian [E F b]
+    DenseIndex pointDim; ///< Columns of E, 0 for a camera-only factor
+    std::vector<size_t> cameras; ///< Indices in cameras_ of the cameras of F
+    std::vector<DenseIndex> columns; ///< Column in Ab of each camera, and of b
+    Eigen::LLT<Matrix> EtE; ///< Cholesky factor of E'E
+
+    /** F_k, the columns of the k-th camera */
+    Eigen::Block<const Matrix> F(size_t k, DenseIndex dim) const {
+      return Ab.block(0, columns[k], Ab.rows(), dim); }
+
+    /** e <- (I - E (E'E)^-1 E') e, the projection on the complement of the range of E */
+    void project(Vector& e) const {
+      if(pointDim > 0) {
+        const Matrix::ConstColsBlockXpr E = Ab.leftCols(pointDim);
+        e -= E * EtE.solve(E.transpose() * e);
+      }
+    }
+  };
+
+  /* ************************************************************************* */
+  SchurComplementSolver::SchurComplementSolver(const GaussianFactorGraph& graph, size_t pointDim) :
+    pointDim_(pointDim), lastIterations_(0)
+  {
+    gttic(SchurComplementSolver_analyze);
+
+    // Record the structure of the graph, and the variables of dimension pointDim
+    FastMap<Key, DenseIndex> dims;
+    FastMap<Key, bool> eliminable;
+    factorOffsets_.push_back(0);
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& factor, graph) {
+      if(factor) {
+        for(GaussianFactor::const_iterator key = factor->begin(); key != factor->end(); ++key) {
+          const DenseIndex dim = factor->getDim(key);
+          factorKeys_.push_back(*key);
+          factorDims_.push_back(dim);
+          dims[*key] = dim;
+          if(dim == (DenseIndex)pointDim_)
+            eliminable.insert(make_pair(*key, true));
+        }
+      }
+      factorOffsets_.push_back(factorKeys_.size());
+    }
+
+    // A point can only be eliminated on its own if none of its factors involves another point,
+    // and if all are JacobianFactors, whose rows can be stacked, with a Hessian
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& factor, graph) {
+      if(!factor)
+        continue;
+      size_t candidates = 0;
+      BOOST_FOREACH(Key key, factor->keys())
+        if(eliminable.count(key))
+          ++ candidates;
+      const JacobianFactor* jacobian = dynamic_cast<const JacobianFactor*>(factor.get());
+      if(candidates > 1 || (candidates == 1 && (!jacobian || (jacobian->get_model() && jacobian->isConstrained()))))
+        BOOST_FOREACH(Key key, factor->keys())
+          if(eliminable.count(key))
+            eliminable[key] = false;
+    }
+
+    // Points and cameras, in key order
+    FastMap<Key, size_t> pointIndex, cameraIndex;
+    typedef pair<Key, DenseIndex> KeyDim;
+    cameraStarts_.push_back(0);
+    BOOST_FOREACH(const KeyDim& key_dim, dims) {
+      FastMap<Key, bool>::const_iterator candidate = eliminable.find(key_dim.first);
+      if(candidate != eliminable.end() && candidate->second) {
+        pointIndex.insert(make_pair(key_dim.first, points_.size()));
+        points_.push_back(key_dim.first);
+      } else {
+        cameraIndex.insert(make_pair(key_dim.first, cameras_.size()));
+        cameras_.push_back(key_dim.first);
+        cameraDims_.push_back(key_dim.second);
+        cameraStarts_.push_back(cameraStarts_.back() + key_dim.second);
+      }
+    }
+
+    // Assign the factors to their points, and lay out the stacked Jacobian of each point
+    pointStructure_.resize(points_.size());
+    for(size_t i = 0; i < graph.size(); ++i) {
+      if(!graph[i])
+        continue;
+      size_t point = points_.size();
+      BOOST_FOREACH(Key key, graph[i]->keys()) {
+        FastMap<Key, size_t>::const_iterator p = pointIndex.find(key);
+        if(p != pointIndex.end())
+          point = p->second;
+      }
+      if(point == points_.size()) {
+        cameraFactors_.push_back(i);
+        continue;
+      }
+      Point& structure = pointStructure_[point];
+      structure.factors.push_back(i);
+      BOOST_FOREACH(Key key, graph[i]->keys()) {
+        if(key == points_[point])
+          continue;
+        const size_t camera = cameraIndex.at(key);
+        if(std::find(structure.cameras.begin(), structure.cameras.end(), camera) == structure.cameras.end())
+          structure.cameras.push_back(camera);
+      }
+    }
+    BOOST_FOREACH(Point& structure, pointStructure_) {
+      structure.columns.push_back((DenseIndex)pointDim_);
+      BOOST_FOREACH(size_t camera, structure.cameras)
+        structure.columns.push_back(structure.columns.back() + cameraDims_[camera]);
+    }
+  }
+
+  /* ************************************************************************* */
+  bool SchurComplementSolver::compatible(const GaussianFactorGraph& graph) const
+  {
+    if(graph.size() + 1 != factorOffsets_.size())
+      return false;
+    for(size_t i = 0; i < graph.size(); ++i) {
+      const size_t size = graph[i] ? graph[i]->size() : 0;
+      if(size != factorOffsets_[i + 1] - factorOffsets_[i])
+        return false;
+      size_t k = factorOffsets_[i];
+      for(size_t j = 0; j < size; ++j, ++k)
+        if(graph[i]->keys()[j] != factorKeys_[k] || graph[i]->getDim(graph[i]->begin() + j) != factorDims_[k])
+          return false;
+    }
+    return true;
+  }
+
+  /* ************************************************************************* */
+  // Stack the whitened Jacobians of the groups in a range
+  struct SchurComplementSolver::BuildGroups {
+    const SchurComplementSolver& solver;
+    const GaussianFactorGraph& graph;
+    std::vector<Group>& groups;
+    BuildGroups(const SchurComplementSolver& solver, const GaussianFactorGraph& graph, std::vector<Group>& groups) :
+      solver(solver), graph(graph), groups(groups) {}
+
+    void run(size_t begin, size_t end) const {
+      for(size_t g = begin; g != end; ++g) {
+        if(g < solver.points_.size())
+          buildPoint(g);
+        else
+          buildCameraFactor(g, solver.cameraFactors_[g - solver.points_.size()]);
+      }
+    }
+
+#ifdef GTSAM_USE_TBB
+    void operator()(const tbb::blocked_range<size_t>& r) const { run(r.begin(), r.end()); }
+#endif
+
+    void buildPoint(size_t p) const {
+      const Point& structure = solver.pointStructure_[p];
+      const Key point = solver.points_[p];
+      Group& group = groups[p];
+      group.pointDim = (DenseIndex)solver.pointDim_;
+      group.cameras = structure.cameras;
+      group.columns = structure.columns;
+
+      DenseIndex rows = 0;
+      BOOST_FOREACH(size_t i, structure.factors)
+        rows += jacobian(i).rows();
+      group.Ab = Matrix::Zero(rows, group.columns.back() + 1);
+
+      DenseIndex row = 0;
+      BOOST_FOREACH(size_t i, structure.factors) {
+        const JacobianFactor& factor = jacobian(i);
+        Matrix A;
+        Vector b;
+        boost::tie(A, b) = factor.jacobian();
+        DenseIndex column = 0;
+        for(JacobianFactor::const_iterator key = factor.begin(); key != factor.end(); ++key) {
+          const DenseIndex dim = factor.getDim(key);
+          DenseIndex destination = 0;
+          if(*key != point) {
+            size_t k = 0;
+            while(solver.cameras_[group.cameras[k]] != *key)
+              ++ k;
+            destination = group.columns[k];
+          }
+          group.Ab.block(row, destination, A.rows(), dim) = A.middleCols(column, dim);
+          column += dim;
+        }
+        group.Ab.block(row, group.columns.back(), A.rows(), 1) = b;
+        row += A.rows();
+      }
+
+      const Matrix::ColsBlockXpr E = group.Ab.leftCols(group.pointDim);
+      group.EtE.compute(E.transpose() * E);
+      if(group.EtE.info() != Eigen::Success)
+        throw IndeterminantLinearSystemException(point);
+    }
+
+    void buildCameraFactor(size_t g, size_t i) const {
+      Group& group = groups[g];
+      JacobianFactor::shared_ptr factor = boost::dynamic_pointer_cast<JacobianFactor>(graph[i]);
+      if(!factor)
+        factor = boost::make_shared<JacobianFactor>(*graph[i]);
+      if(factor->get_model() && factor->isConstrained())
+        throw invalid_argument(
+          "SchurComplementSolver: constrained noise models are not supported by the iterative solver");
+      Matrix A;
+      Vector b;
+      boost::tie(A, b) = factor->jacobian();
+      group.Ab.resize(A.rows(), A.cols() + 1);
+      group.Ab << A, b;
+      group.pointDim = 0;
+      group.columns.push_back(0);
+      for(JacobianFactor::const_iterator key = factor->begin(); key != factor->end(); ++key) {
+        group.cameras.push_back(std::lower_bound(solver.cameras_.begin(), solver.cameras_.end(), *key) - solver.cameras_.begin());
+        group.columns.push_back(group.columns.back() + factor->getDim(key));
+      }
+    }
+
+    const JacobianFactor& jacobian(size_t i) const {
+      const JacobianFactor* factor = dynamic_cast<const JacobianFactor*>(graph[i].get());
+      if(!factor)
+        throw invalid_argument("SchurComplementSolver: the factors of a point must be JacobianFactors");
+      return *factor;
+    }
+  };
+
+  /* ************************************************************************* */
+  void SchurComplementSolver::buildGroups(
+    const GaussianFactorGraph& graph, bool cameraFactors, std::vector<Group>& groups) const
+  {
+    gttic(SchurComplementSolver_buildGroups);
+    groups.resize(points_.size() + (cameraFactors ? cameraFactors_.size() : 0));
+#ifdef GTSAM_USE_TBB
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, groups.size()), BuildGroups(*this, graph, groups));
+#else
+    BuildGroups(*this, graph, groups).run(0, groups.size());
+#endif
+  }
+
+  /* ************************************************************************* */
+  // The Schur complement of each point in a range, as a HessianFactor on its cameras
+  struct SchurComplementSolver::EliminateGroups {
+    const SchurComplementSolver& solver;
+    const std::vector<Group>& groups;
+    std::vector<GaussianFactor::shared_ptr>& factors;
+    EliminateGroups(const SchurComplementSolver& solver, const std::vector<Group>& groups,
+      std::vector<GaussianFactor::shared_ptr>& factors) :
+      solver(solver), groups(groups), factors(factors) {}
+
+    void run(size_t begin, size_t end) const {
+      for(size_t p = begin; p != end; ++p) {
+        const Group& group = groups[p];
+        if(group.cameras.empty())
+          continue;
+        const Matrix::ConstColsBlockXpr E = group.Ab.leftCols(group.pointDim);
+        const Matrix::ConstColsBlockXpr M = group.Ab.rightCols(group.Ab.cols() - group.pointDim);
+        const Matrix EtM = E.transpose() * M;
+        const Matrix augmented = M.transpose() * M - EtM.transpose() * group.EtE.solve(EtM);
+        std::vector<Key> keys;
+        std::vector<DenseIndex> dims;
+        BOOST_FOREACH(size_t camera, group.cameras) {
+          keys.push_back(solver.cameras_[camera]);
+          dims.push_back(solver.cameraDims_[camera]);
+        }
+        factors[p] = boost::make_shared<HessianFactor>(keys, SymmetricBlockMatrix(dims, augmented, true));
+      }
+    }
+
+#ifdef GTSAM_USE_TBB
+    void operator()(const tbb::blocked_range<size_t>& r) const { run(r.begin(), r.end()); }
+#endif
+  };
+
+  /* ************************************************************************* */
+  GaussianFactorGraph SchurComplementSolver::reduce(
+    const GaussianFactorGraph& graph, std::vector<Group>& groups) const
+  {
+    buildGroups(graph, false, groups);
+
+    gttic(SchurComplementSolver_eliminatePoints);
+    std::vector<GaussianFactor::shared_ptr> factors(groups.size());
+#ifdef GTSAM_USE_TBB
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, groups.size()), EliminateGroups(*this, groups, factors));
+#else
+    EliminateGroups(*this, groups, factors).run(0, groups.size());
+#endif
+
+    GaussianFactorGraph reduced;
+    reduced.reserve(cameraFactors_.size() + factors.size());
+    BOOST_FOREACH(size_t i, cameraFactors_)
+      reduced.push_back(graph[i]);
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& factor, factors)
+      if(factor)
+        reduced.push_back(factor);
+    return reduced;
+  }
+
+  /* ************************************************************************* */
+  GaussianFactorGraph SchurComplementSolver::reducedGraph(const GaussianFactorGraph& graph) const
+  {
+    std::vector<Group> groups;
+    return reduce(graph, groups);
+  }
+
+  /* ************************************************************************* */
+  // Solve for the points in a range given the cameras
+  struct SchurComplementSolver::BackSubstitute {
+    const SchurComplementSolver& solver;
+    const std::vector<Group>& groups;
+    const Vector& x;
+    std::vector<Vector>& points;
+    BackSubstitute(const SchurComplementSolver& solver, const std::vector<Group>& groups,
+      const Vector& x, std::vector<Vector>& points) :
+      solver(solver), groups(groups), x(x), points(points) {}
+
+    void run(size_t begin, size_t end) const {
+      for(size_t p = begin; p != end; ++p) {
+        const Group& group = groups[p];
+        Vector e = group.Ab.col(group.columns.back());
+        for(size_t k = 0; k < group.cameras.size(); ++k) {
+          const size_t camera = group.cameras[k];
+          e -= group.F(k, solver.cameraDims_[camera])
+            * x.segment(solver.cameraStarts_[camera], solver.cameraDims_[camera]);
+        }
+        points[p] = group.EtE.solve(group.Ab.leftCols(group.pointDim).transpose() * e);
+      }
+    }
+
+#ifdef GTSAM_USE_TBB
+    void operator()(const tbb::blocked_range<size_t>& r) const { run(r.begin(), r.end()); }
+#endif
+  };
+
+  /* ************************************************************************* */
+  void SchurComplementSolver::backSubstitute(
+    const std::vector<Group>& groups, const Vector& x, VectorValues& result) const
+  {
+    gttic(SchurComplementSolver_backSubstitute);
+    std::vector<Vector> points(points_.size());
+#ifdef GTSAM_USE_TBB
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points_.size()), BackSubstitute(*this, groups, x, points));
+#else
+    BackSubstitute(*this, groups, x, points).run(0, points_.size());
+#endif
+    for(size_t p = 0; p < points_.size(); ++p)
+      result.insert(points_[p], points[p]);
+    for(size_t c = 0; c < cameras_.size(); ++c)
+      result.insert(cameras_[c], x.segment(cameraStarts_[c], cameraDims_[c]));
+  }
+
+  /* ************************************************************************* */
+  VectorValues SchurComplementSolver::optimize(const GaussianFactorGraph& graph, const Ordering& ordering) const
+  {
+    std::vector<Group> groups;
+    const GaussianFactorGraph reduced = reduce(graph, groups);
+
+    gttic(SchurComplementSolver_solveReduced);
+    Vector x(cameraStarts_.back());
+    if(!cameras_.empty()) {
+      // The cameras in the order of ordering
+      const FastSet<Key> cameras(cameras_.begin(), cameras_.end());
+      Ordering cameraOrdering;
+      BOOST_FOREACH(Key key, ordering)
+        if(cameras.exists(key))
+          cameraOrdering.push_back(key);
+      if(cameraOrdering.size() != cameras_.size())
+        throw invalid_argument("SchurComplementSolver::optimize: the ordering does not contain all cameras");
+      const VectorValues solution = reduced.eliminateMultifrontal(cameraOrdering, EliminatePreferCholesky)->optimize();
+      for(size_t c = 0; c < cameras_.size(); ++c)
+        x.segment(cameraStarts_[c], cameraDims_[c]) = solution.at(cameras_[c]);
+    }
+    gttoc(SchurComplementSolver_solveReduced);
+
+    VectorValues result;
+    backSubstitute(groups, x, result);
+    return result;
+  }
+
+  /* ************************************************************************* */
+  // Accumulates F_g' (I - E_g P_g E_g') F_g x, or the same with b_g instead of F_g x, for the
+  // groups in a range into a contiguous vector, split per thread
+  struct SchurComplementSolver::MultiplyGroups {
+    const SchurComplementSolver& solver;
+    const std::vector<Group>& groups;
+    const Vector* x; ///< null to use b_g
+    Vector result;
+    MultiplyGroups(const SchurComplementSolver& solver, const std::vector<Group>& groups, const Vector* x) :
+      solver(solver), groups(groups), x(x), result(Vector::Zero(solver.cameraStarts_.back())) {}
+
+    void run(size_t begin, size_t end) {
+      for(size_t g = begin; g != end; ++g) {
+        const Group& group = groups[g];
+        Vector e;
+        if(x) {
+          e = Vector::Zero(group.Ab.rows());
+          for(size_t k = 0; k < group.cameras.size(); ++k) {
+            const size_t camera = group.cameras[k];
+            e.noalias() += group.F(k, solver.cameraDims_[camera])
+              * x->segment(solver.cameraStarts_[camera], solver.cameraDims_[camera]);
+          }
+        } else {
+          e = group.Ab.col(group.columns.back());
+        }
+        group.project(e);
+        for(size_t k = 0; k < group.cameras.size(); ++k) {
+          const size_t camera = group.cameras[k];
+          result.segment(solver.cameraStarts_[camera], solver.cameraDims_[camera]).noalias() +=
+            group.F(k, solver.cameraDims_[camera]).transpose() * e;
+        }
+      }
+    }
+
+#ifdef GTSAM_USE_TBB
+    MultiplyGroups(MultiplyGroups& other, tbb::split) :
+      solver(other.solver), groups(other.groups), x(other.x), result(Vector::Zero(other.result.size())) {}
+    void operator()(const tbb::blocked_range<size_t>& r) { run(r.begin(), r.end()); }
+    void join(const MultiplyGroups& other) { result += other.result; }
+#endif
+
+    /** Compute the sum over all groups */
+    static Vector Sum(const SchurComplementSolver& solver, const std::vector<Group>& groups, const Vector* x) {
+      MultiplyGroups products(solver, groups, x);
+#ifdef GTSAM_USE_TBB
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      tbb::parallel_reduce(tbb::blocked_range<size_t>(0, groups.size()), products);
+#else
+      products.run(0, groups.size());
+#endif
+      return products.result;
+    }
+  };
+
+  /* ************************************************************************* */
+  /** The reduced camera system S x = b as a System of preconditionedConjugateGradient, with S
+   *  applied implicitly and preconditioned by its diagonal camera blocks */
+  class SchurComplementSolver::ImplicitSystem {
+    const SchurComplementSolver& solver_;
+    const std::vector<Group>& groups_;
+    Vector b_;
+    std::vector<Eigen::LLT<Matrix> > jacobi_;
+
+  public:
+    ImplicitSystem(const SchurComplementSolver& solver, const std::vector<Group>& groups) :
+      solver_(solver), groups_(groups), jacobi_(solver.cameras_.size())
+    {
+      b_ = MultiplyGroups::Sum(solver_, groups_, 0);
+
+      // The diagonal blocks F_c' F_c - F_c' E P E' F_c of S
+      std::vector<Matrix> blocks(solver_.cameras_.size());
+      for(size_t c = 0; c < blocks.size(); ++c)
+        blocks[c] = Matrix::Zero(solver_.cameraDims_[c], solver_.cameraDims_[c]);
+      BOOST_FOREACH(const Group& group, groups_) {
+        for(size_t k = 0; k < group.cameras.size(); ++k) {
+          const size_t camera = group.cameras[k];
+          const Eigen::Block<const Matrix> F = group.F(k, solver_.cameraDims_[camera]);
+          blocks[camera].noalias() += F.transpose() * F;
+          if(group.pointDim > 0) {
+            const Matrix EtF = group.Ab.leftCols(group.pointDim).transpose() * F;
+            blocks[camera].noalias() -= EtF.transpose() * group.EtE.solve(EtF);
+          }
+        }
+      }
+      for(size_t c = 0; c < blocks.size(); ++c) {
+        jacobi_[c].compute(blocks[c]);
+        if(jacobi_[c].info() != Eigen::Success)
+          throw IndeterminantLinearSystemException(solver_.cameras_[c]);
+      }
+    }
+
+    void residual(const Vector& x, Vector& r) const {
+      multiply(x, r);
+      r = b_ - r;
+    }
+
+    void multiply(const Vector& x, Vector& y) const {
+      y = MultiplyGroups::Sum(solver_, groups_, &x);
+    }
+
+    void precondition(const Vector& x, Vector& y) const {
+      y.resize(x.size());
+      for(size_t c = 0; c < jacobi_.size(); ++c)
+        y.segment(solver_.cameraStarts_[c], solver_.cameraDims_[c]) =
+          jacobi_[c].solve(x.segment(solver_.cameraStarts_[c], solver_.cameraDims_[c]));
+    }
+
+    void scal(const double alpha, Vector& x) const { x *= alpha; }
+    double dot(const Vector& x, const Vector& y) const { return x.dot(y); }
+    void axpy(const double alpha, const Vector& x, Vector& y) const { y += alpha * x; }
+    void getb(Vector& b) const { b = b_; }
+  };
+
+  /* ************************************************************************* */
+  VectorValues SchurComplementSolver::optimize(const GaussianFactorGraph& graph,
+    const ConjugateGradientParameters& parameters) const
+  {
+    std::vector<Group> groups;
+    buildGroups(graph, true, groups);
+
+    gttic(SchurComplementSolver_solveImplicit);
+    const ImplicitSystem system(*this, groups);
+    size_t iterations = 0;
+    const Vector x = preconditionedConjugateGradient<ImplicitSystem, Vector>(
+      system, Vector::Zero(cameraStarts_.back()), parameters, iterations);
+    lastIterations_ = iterations;
+    gttoc(SchurComplementSolver_solveImplicit);
+
+    VectorValues result;
+    backSubstitute(groups, x, result);
+    return result;
+  }
+
+}
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SchurComplementSolver.h
+ * @brief Linear solver that eliminates the points of bundle adjustment problems in closed form
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/ConjugateGradientSolver.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <vector>
+
+namespace gtsam {
+
+  /**
+   * Linear solver for bundle adjustment like problems, the backend of
+   * NonlinearOptimizerParams::SCHUR_COMPLEMENT.
+   *
+   * The constructor finds the \em points of a GaussianFactorGraph: variables of dimension
+   * \c pointDim (3 by default) whose factors are all unconstrained JacobianFactors that involve no
+   * other point.  All other variables are the \em cameras.  As no factor connects two points, each
+   * point can be eliminated on its own, with a closed form pointDim x pointDim Cholesky, which
+   * leaves the reduced camera system S = H_cc - H_cp H_pp^-1 H_pc.  Points are eliminated and
+   * back-substituted in parallel when GTSAM uses TBB.
+   *
+   * The reduced camera system is solved either directly, with the Schur complement of each point
+   * as a HessianFactor on its cameras, eliminated together with the camera-only factors by
+   * multifrontal Cholesky, or with PCG on an implicit Schur operator, which applies
+   * S x = sum_g F_g' (I - E_g P_g E_g') F_g x over the whitened Jacobians [E_g F_g] of the points
+   * without forming S, preconditioned by the diagonal camera blocks of S (Schur-Jacobi).
+   *
+   * Numeric work is repeated on each call, so one SchurComplementSolver can solve any graph with
+   * the same structure, see compatible().
+   */
+  class GTSAM_EXPORT SchurComplementSolver {
+  public:
+    typedef SchurComplementSolver This; ///< This class
+    typedef boost::shared_ptr<This> shared_ptr; ///< Shared pointer to this class
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Find the points and cameras of graphs with the structure of \c graph */
+    SchurComplementSolver(const GaussianFactorGraph& graph, size_t pointDim = 3);
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** Check whether \c graph has the structure this solver was built for, i.e. the same number
+     *  of factors, each involving the same variables with the same dimensions. */
+    bool compatible(const GaussianFactorGraph& graph) const;
+
+    /** Solve \c graph, which must be compatible(), by eliminating the points and then the reduced
+     *  camera system with multifrontal Cholesky, with the cameras in their order in \c ordering.
+     *  Throws IndeterminantLinearSystemException if a point or the reduced system is singular. */
+    VectorValues optimize(const GaussianFactorGraph& graph, const Ordering& ordering) const;
+
+    /** Solve \c graph, which must be compatible(), by eliminating the points and solving the
+     *  reduced camera system with PCG on the implicit Schur operator.  Throws
+     *  IndeterminantLinearSystemException if a point or a diagonal block of the reduced system is
+     *  singular, and std::invalid_argument if a camera-only factor has a constrained noise model. */
+    VectorValues optimize(const GaussianFactorGraph& graph,
+      const ConjugateGradientParameters& parameters) const;
+
+    /** The reduced camera system of \c graph, which must be compatible(): the camera-only factors
+     *  of \c graph, and a HessianFactor on the cameras of each point with its Schur complement. */
+    GaussianFactorGraph reducedGraph(const GaussianFactorGraph& graph) const;
+
+    /// @}
+    /// @name Advanced Interface
+    /// @{
+
+    /** The eliminated points */
+    const std::vector<Key>& points() const { return points_; }
+
+    /** The variables of the reduced camera system */
+    const std::vector<Key>& cameras() const { return cameras_; }
+
+    /** The number of PCG iterations of the last call of the iterative optimize() */
+    size_t lastIterations() const { return lastIterations_; }
+
+    /// @}
+
+  private:
+    /** The structure of a point: its factors and cameras, and the layout of its stacked Jacobian
+     *  [E F b], with E the columns of the point followed by the columns of each camera */
+    struct Point {
+      std::vector<size_t> factors; ///< Indices of the factors of the point in the graph
+      std::vector<size_t> cameras; ///< Indices in cameras_ of the cameras of the point
+      std::vector<DenseIndex> columns; ///< Column in [E F b] of each camera, and of b
+    };
+
+    size_t pointDim_; ///< Dimension of the points
+    std::vector<Key> points_; ///< The points
+    std::vector<Point> pointStructure_; ///< Structure of each point
+    std::vector<Key> cameras_; ///< The cameras
+    std::vector<DenseIndex> cameraDims_; ///< Dimension of each camera
+    std::vector<DenseIndex> cameraStarts_; ///< Offset of each camera in the reduced system, and the total dimension
+    std::vector<size_t> cameraFactors_; ///< Indices of the factors that involve no point
+    std::vector<Key> factorKeys_; ///< Keys of all factors, concatenated
+    std::vector<DenseIndex> factorDims_; ///< Dimensions of the keys of all factors, concatenated
+    std::vector<size_t> factorOffsets_; ///< Start of the keys of each factor, and the total
+    mutable size_t lastIterations_; ///< PCG iterations of the last iterative optimize()
+
+    /** The whitened Jacobian [E F b] of a group of rows, with E the columns of its point if any */
+    struct Group;
+    struct BuildGroups;
+    struct EliminateGroups;
+    struct BackSubstitute;
+    struct MultiplyGroups;
+    class ImplicitSystem;
+
+    /** The groups of all points of \c graph, followed by one group for each camera-only factor if
+     *  \c cameraFactors, factoring E'E of each point */
+    void buildGroups(const GaussianFactorGraph& graph, bool cameraFactors, std::vector<Group>& groups) const;
+
+    /** The reduced camera system of \c graph, and the groups of its points */
+    GaussianFactorGraph reduce(const GaussianFactorGraph& graph, std::vector<Group>& groups) const;
+
+    /** Solve for the points given the solution \c x of the cameras in the layout of cameras_, and
+     *  add both to \c result */
+    void backSubstitute(const std::vector<Group>& groups, const Vector& x, VectorValues& result) const;
+  };
+
+}
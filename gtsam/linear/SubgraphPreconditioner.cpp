@@ -485,7 +485,7 @@ Errors SubgraphPreconditioner::operator*(const VectorValues& y) const {
 
 /* ************************************************************************* */
 // In-place version that overwrites e
-void SubgraphPreconditioner::multiplyInPlace(const VectorValues& y, Errors& e) const {
+void SubgraphPreconditioner::multiplyInPlace(const VectorValues& y, Errors& e, bool parallel) const {
 
   Errors::iterator ei = e.begin();
   for ( Key i = 0 ; i < y.size() ; ++i, ++ei ) {
@@ -494,7 +494,7 @@ void SubgraphPreconditioner::multiplyInPlace(const VectorValues& y, Errors& e) c
 
   // Add A2 contribution
   VectorValues x = Rc1()->backSubstitute(y);      // x=inv(R1)*y
-  Ab2()->multiplyInPlace(x, ei);                  // use iterator version
+  Ab2()->multiplyInPlace(x, ei, parallel);        // use iterator version
 }
 
 /* ************************************************************************* */
@@ -512,20 +512,20 @@ VectorValues SubgraphPreconditioner::operator^(const Errors& e) const {
 /* ************************************************************************* */
 // y += alpha*A'*e
 void SubgraphPreconditioner::transposeMultiplyAdd
-(double alpha, const Errors& e, VectorValues& y) const {
+(double alpha, const Errors& e, VectorValues& y, bool parallel) const {
 
   Errors::const_iterator it = e.begin();
   for ( Key i = 0 ; i < y.size() ; ++i, ++it ) {
     const Vector& ei = *it;
     axpy(alpha, ei, y[i]);
   }
-  transposeMultiplyAdd2(alpha, it, e.end(), y);
+  transposeMultiplyAdd2(alpha, it, e.end(), y, parallel);
 }
 
 /* ************************************************************************* */
 // y += alpha*inv(R1')*A2'*e2
 void SubgraphPreconditioner::transposeMultiplyAdd2 (double alpha,
-    Errors::const_iterator it, Errors::const_iterator end, VectorValues& y) const {
+    Errors::const_iterator it, Errors::const_iterator end, VectorValues& y, bool parallel) const {
 
   // create e2 with what's left of e
   // TODO can we avoid creating e2 by passing iterator to transposeMultiplyAdd ?
@@ -533,7 +533,7 @@ void SubgraphPreconditioner::transposeMultiplyAdd2 (double alpha,
   while (it != end) e2.push_back(*(it++));
 
   VectorValues x = VectorValues::Zero(y); // x = 0
-  Ab2_->transposeMultiplyAdd(1.0,e2,x);   // x += A2'*e2
+  Ab2_->transposeMultiplyAdd(1.0,e2,x,parallel);   // x += A2'*e2
   axpy(alpha, Rc1_->backSubstituteTranspose(x), y); // y += alpha*inv(R1')*x
 }
 
@@ -595,12 +595,23 @@ void SubgraphPreconditioner::build(const GaussianFactorGraph &gfg, const KeyInfo
 {
   /* identify the subgraph structure */
   const SubgraphBuilder builder(parameters_.builderParams_);
-  Subgraph::shared_ptr subgraph = builder(gfg);
+  subgraph_ = builder(gfg);
+
+  refresh(gfg, keyInfo, lambda);
+}
+
+/*****************************************************************************/
+void SubgraphPreconditioner::refresh(const GaussianFactorGraph &gfg, const KeyInfo &keyInfo, const std::map<Key,Vector> &lambda)
+{
+  if ( !subgraph_ ) {
+    build(gfg, keyInfo, lambda);
+    return;
+  }
 
   keyInfo_ = keyInfo;
 
   /* build factor subgraph */
-  GaussianFactorGraph::shared_ptr gfg_subgraph = buildFactorSubgraph(gfg, *subgraph, true);
+  GaussianFactorGraph::shared_ptr gfg_subgraph = buildFactorSubgraph(gfg, *subgraph_, true);
 
   /* factorize and cache BayesNet */
   Rc1_ = gfg_subgraph->eliminateSequential();
@@ -193,6 +193,7 @@ namespace gtsam {
 
     KeyInfo keyInfo_;
     SubgraphPreconditionerParameters parameters_;
+    boost::shared_ptr<Subgraph> subgraph_; ///< the subgraph selected by the last build
 
   public:
 
@@ -241,7 +242,7 @@ namespace gtsam {
      * Takes a range indicating e2 !!!!
      */
     void transposeMultiplyAdd2(double alpha, Errors::const_iterator begin,
-        Errors::const_iterator end, VectorValues& y) const;
+        Errors::const_iterator end, VectorValues& y, bool parallel = false) const;
 
     /* error, given y */
     double error(const VectorValues& y) const;
@@ -252,8 +253,9 @@ namespace gtsam {
     /** Apply operator A */
     Errors operator*(const VectorValues& y) const;
 
-    /** Apply operator A in place: needs e allocated already */
-    void multiplyInPlace(const VectorValues& y, Errors& e) const;
+    /** Apply operator A in place: needs e allocated already.  If parallel, A2 is applied over
+     *  ranges of its factors with TBB, see GaussianFactorGraph::multiplyInPlace. */
+    void multiplyInPlace(const VectorValues& y, Errors& e, bool parallel = false) const;
 
     /** Apply operator A' */
     VectorValues operator^(const Errors& e) const;
@@ -262,7 +264,7 @@ namespace gtsam {
     * Add A'*e to y
     *  y += alpha*A'*[e1;e2] = [alpha*e1; alpha*inv(R1')*A2'*e2]
     */
-    void transposeMultiplyAdd(double alpha, const Errors& e, VectorValues& y) const;
+    void transposeMultiplyAdd(double alpha, const Errors& e, VectorValues& y, bool parallel = false) const;
 
     /*****************************************************************************/
     /* implement virtual functions of Preconditioner */
@@ -276,6 +278,16 @@ namespace gtsam {
       const KeyInfo &info,
       const std::map<Key,Vector> &lambda
       ) ;
+
+    /* factorize the subgraph selected by the last build again, without selecting a new one */
+    virtual void refresh(
+      const GaussianFactorGraph &gfg,
+      const KeyInfo &info,
+      const std::map<Key,Vector> &lambda
+      ) ;
+
+    /** Access the subgraph selected by the last build */
+    const boost::shared_ptr<Subgraph>& subgraph() const { return subgraph_; }
     /*****************************************************************************/
   };
 
@@ -0,0 +1,367 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SupernodalCholesky.cpp
+ * @brief Sparse supernodal Cholesky factorization of the Hessian of a GaussianFactorGraph
+ */
+
+#include <gtsam/linear/SupernodalCholesky.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/inference/inferenceExceptions.h>
+#include <gtsam/base/FastMap.h>
+#include <gtsam/base/timing.h>
+
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace gtsam {
+
+  namespace {
+    const size_t none = numeric_limits<size_t>::max();
+  }
+
+  /* ************************************************************************* */
+  SupernodalCholesky::SupernodalCholesky(const GaussianFactorGraph& graph, const Ordering& ordering) :
+    ordering_(ordering), isFactorized_(false)
+  {
+    gttic(SupernodalCholesky_analyze);
+    const size_t n = ordering.size();
+
+    // Position of each variable in the ordering
+    FastMap<Key, size_t> positions;
+    for(size_t j = 0; j < n; ++j)
+      positions.insert(make_pair(ordering[j], j));
+    if(positions.size() != n)
+      throw InconsistentEliminationRequested();
+
+    // Positions and dimensions of the variables of each factor, and the factors of each variable
+    dims_.assign(n, -1);
+    vector<vector<size_t> > variableFactors(n);
+    factorOffsets_.reserve(graph.size() + 1);
+    factorOffsets_.push_back(0);
+    for(size_t i = 0; i < graph.size(); ++i) {
+      if(const GaussianFactor* factor = graph[i].get()) {
+        for(GaussianFactor::const_iterator variable = factor->begin(); variable != factor->end(); ++variable) {
+          FastMap<Key, size_t>::const_iterator position = positions.find(*variable);
+          if(position == positions.end())
+            throw InconsistentEliminationRequested();
+          dims_[position->second] = factor->getDim(variable);
+          factorVariables_.push_back(position->second);
+          variableFactors[position->second].push_back(i);
+        }
+      }
+      factorOffsets_.push_back(factorVariables_.size());
+    }
+    columnStarts_.resize(n + 1);
+    columnStarts_[0] = 0;
+    for(size_t j = 0; j < n; ++j) {
+      if(dims_[j] < 0)
+        throw InconsistentEliminationRequested();
+      columnStarts_[j + 1] = columnStarts_[j] + dims_[j];
+    }
+
+    // Elimination tree, with Liu's algorithm with path compression
+    gttic(etree);
+    vector<size_t> parents(n, none), ancestors(n, none);
+    for(size_t k = 0; k < n; ++k) {
+      BOOST_FOREACH(size_t i, variableFactors[k]) {
+        for(size_t p = factorOffsets_[i]; p < factorOffsets_[i + 1]; ++p) {
+          // Walk from each variable before k to the root of its subtree, which becomes a child of k
+          size_t r = factorVariables_[p];
+          while(r < k) {
+            const size_t next = ancestors[r];
+            ancestors[r] = k;
+            if(next == none) {
+              parents[r] = k;
+              break;
+            }
+            r = next;
+          }
+        }
+      }
+    }
+    gttoc(etree);
+
+    // Structure of each column of L below the diagonal, which is the union of the structures of
+    // the variables in the same factors and of the columns of the children in the elimination
+    // tree.  Consecutive columns are merged into fundamental supernodes: column j joins the
+    // supernode of column j-1 if j-1 is its only child and their structures are the same.
+    gttic(supernodes);
+    vector<vector<size_t> > children(n);
+    for(size_t j = 0; j < n; ++j)
+      if(parents[j] != none)
+        children[parents[j]].push_back(j);
+    vector<vector<size_t> > structures(n);
+    vector<size_t> marker(n, none);
+    size_t firstVariable = 0;
+    for(size_t j = 0; j <= n; ++j) {
+      if(j < n) {
+        vector<size_t>& structure = structures[j];
+        marker[j] = j;
+        BOOST_FOREACH(size_t i, variableFactors[j]) {
+          for(size_t p = factorOffsets_[i]; p < factorOffsets_[i + 1]; ++p) {
+            const size_t r = factorVariables_[p];
+            if(r > j && marker[r] != j) {
+              marker[r] = j;
+              structure.push_back(r);
+            }
+          }
+        }
+        BOOST_FOREACH(size_t child, children[j]) {
+          BOOST_FOREACH(size_t r, structures[child]) {
+            if(marker[r] != j) {
+              marker[r] = j;
+              structure.push_back(r);
+            }
+          }
+        }
+        sort(structure.begin(), structure.end());
+      }
+
+      // Unless column j continues the supernode, finish the previous one
+      const bool merge = j > 0 && j < n && parents[j - 1] == j && children[j].size() == 1
+          && structures[j - 1].size() == structures[j].size() + 1;
+      if(j > 0 && !merge) {
+        Supernode supernode;
+        supernode.firstVariable = firstVariable;
+        supernode.nrVariables = j - firstVariable;
+        supernode.rows.reserve(supernode.nrVariables + structures[j - 1].size());
+        for(size_t r = firstVariable; r < j; ++r)
+          supernode.rows.push_back(r);
+        supernode.rows.insert(supernode.rows.end(), structures[j - 1].begin(), structures[j - 1].end());
+        supernodes_.push_back(supernode);
+        firstVariable = j;
+      }
+
+      // The structures of the children are no longer needed
+      if(j < n)
+        BOOST_FOREACH(size_t child, children[j])
+          vector<size_t>().swap(structures[child]);
+    }
+    gttoc(supernodes);
+
+    // Lay out the panels of the supernodes
+    supernodeOf_.resize(n);
+    size_t size = 0;
+    for(size_t s = 0; s < supernodes_.size(); ++s) {
+      Supernode& supernode = supernodes_[s];
+      supernode.rowOffsets.resize(supernode.rows.size() + 1);
+      supernode.rowOffsets[0] = 0;
+      for(size_t r = 0; r < supernode.rows.size(); ++r)
+        supernode.rowOffsets[r + 1] = supernode.rowOffsets[r] + dims_[supernode.rows[r]];
+      supernode.nrColumns = supernode.rowOffsets[supernode.nrVariables];
+      supernode.start = size;
+      size += supernode.rowOffsets.back() * supernode.nrColumns;
+      for(size_t j = supernode.firstVariable; j < supernode.firstVariable + supernode.nrVariables; ++j)
+        supernodeOf_[j] = s;
+    }
+    values_.resize(size);
+    rhs_.resize(columnStarts_[n]);
+  }
+
+  /* ************************************************************************* */
+  bool SupernodalCholesky::compatible(const GaussianFactorGraph& graph) const
+  {
+    if(graph.size() + 1 != factorOffsets_.size())
+      return false;
+    for(size_t i = 0; i < graph.size(); ++i) {
+      size_t position = factorOffsets_[i];
+      const size_t end = factorOffsets_[i + 1];
+      if(const GaussianFactor* factor = graph[i].get()) {
+        if(factor->size() != end - position)
+          return false;
+        for(GaussianFactor::const_iterator variable = factor->begin(); variable != factor->end(); ++variable, ++position) {
+          const size_t j = factorVariables_[position];
+          if(*variable != ordering_[j] || factor->getDim(variable) != dims_[j])
+            return false;
+        }
+      } else if(position != end) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* ************************************************************************* */
+  void SupernodalCholesky::factorize(const GaussianFactorGraph& graph)
+  {
+    gttic(SupernodalCholesky_factorize);
+    if(graph.size() + 1 != factorOffsets_.size())
+      throw invalid_argument("SupernodalCholesky::factorize: the graph does not have the structure of this factorization");
+    if(hasConstraints(graph))
+      throw invalid_argument("SupernodalCholesky::factorize: constrained noise models cannot be factored with Cholesky");
+    isFactorized_ = false;
+
+    // Add the lower triangle of the augmented information matrix of each factor to the panels,
+    // and its last column to A'b
+    gttic(assemble);
+    values_.setZero();
+    rhs_.setZero();
+    FastVector<DenseIndex> offsets;
+    for(size_t i = 0; i < graph.size(); ++i) {
+      const GaussianFactor* factor = graph[i].get();
+      if(!factor)
+        continue;
+      const Matrix information = factor->augmentedInformation();
+      const size_t begin = factorOffsets_[i], size = factorOffsets_[i + 1] - begin;
+      offsets.resize(size + 1);
+      offsets[0] = 0;
+      for(size_t a = 0; a < size; ++a)
+        offsets[a + 1] = offsets[a] + dims_[factorVariables_[begin + a]];
+      for(size_t b = 0; b < size; ++b) {
+        const size_t jb = factorVariables_[begin + b];
+        const Supernode& supernode = supernodes_[supernodeOf_[jb]];
+        Eigen::Map<Matrix> panel(values_.data() + supernode.start, supernode.rowOffsets.back(), supernode.nrColumns);
+        const DenseIndex column = columnStarts_[jb] - columnStarts_[supernode.firstVariable];
+        for(size_t a = 0; a < size; ++a) {
+          const size_t ja = factorVariables_[begin + a];
+          if(ja >= jb)
+            panel.block(rowOffset(supernode, ja), column, dims_[ja], dims_[jb]) +=
+              information.block(offsets[a], offsets[b], dims_[ja], dims_[jb]);
+        }
+        rhs_.segment(columnStarts_[jb], dims_[jb]) += information.block(offsets[b], offsets[size], dims_[jb], 1);
+      }
+    }
+    gttoc(assemble);
+
+    // Factor the supernodes in elimination order.  Each one is factored with dense Cholesky and
+    // a triangular solve, and updates the panels of its ancestors with the outer product of its
+    // rows below the diagonal.
+    gttic(factor);
+    Matrix update;
+    vector<size_t> relative;
+    for(size_t s = 0; s < supernodes_.size(); ++s) {
+      const Supernode& supernode = supernodes_[s];
+      const DenseIndex m = supernode.rowOffsets.back(), k = supernode.nrColumns;
+      Eigen::Map<Matrix> panel(values_.data() + supernode.start, m, k);
+
+      Eigen::LLT<Matrix> llt(panel.topRows(k));
+      if(llt.info() != Eigen::Success)
+        throw IndeterminantLinearSystemException(ordering_[supernode.firstVariable]);
+      panel.topRows(k).triangularView<Eigen::Lower>() = llt.matrixL();
+      if(m == k)
+        continue;
+      llt.matrixU().solveInPlace<Eigen::OnTheRight>(panel.bottomRows(m - k));
+
+      update.setZero(m - k, m - k);
+      update.selfadjointView<Eigen::Lower>().rankUpdate(panel.bottomRows(m - k));
+
+      // The rows below the diagonal are grouped by the supernode they belong to, the rows from
+      // each group to the last are rows of that supernode
+      const size_t nrRows = supernode.rows.size();
+      size_t u = supernode.nrVariables;
+      while(u < nrRows) {
+        const size_t t = supernodeOf_[supernode.rows[u]];
+        const Supernode& target = supernodes_[t];
+        Eigen::Map<Matrix> targetPanel(values_.data() + target.start, target.rowOffsets.back(), target.nrColumns);
+        relative.clear();
+        size_t targetRow = 0;
+        for(size_t r = u; r < nrRows; ++r) {
+          while(target.rows[targetRow] != supernode.rows[r])
+            ++targetRow;
+          relative.push_back(targetRow);
+        }
+
+        size_t v = u;
+        for(; v < nrRows && supernodeOf_[supernode.rows[v]] == t; ++v) {
+          const size_t jv = supernode.rows[v];
+          const DenseIndex updateColumn = supernode.rowOffsets[v] - k;
+          const DenseIndex targetColumn = columnStarts_[jv] - columnStarts_[target.firstVariable];
+          for(size_t r = v; r < nrRows; ++r)
+            targetPanel.block(target.rowOffsets[relative[r - u]], targetColumn, dims_[supernode.rows[r]], dims_[jv]) -=
+              update.block(supernode.rowOffsets[r] - k, updateColumn, dims_[supernode.rows[r]], dims_[jv]);
+        }
+        u = v;
+      }
+    }
+    gttoc(factor);
+    isFactorized_ = true;
+  }
+
+  /* ************************************************************************* */
+  VectorValues SupernodalCholesky::optimize() const
+  {
+    gttic(SupernodalCholesky_optimize);
+    Vector x = rhs_;
+    solveInPlace(x);
+
+    VectorValues result;
+    for(size_t j = 0; j < ordering_.size(); ++j)
+      result.insert(ordering_[j], x.segment(columnStarts_[j], dims_[j]));
+    return result;
+  }
+
+  /* ************************************************************************* */
+  VectorValues SupernodalCholesky::solve(const VectorValues& rhs) const
+  {
+    gttic(SupernodalCholesky_solve);
+    Vector x(columnStarts_.back());
+    for(size_t j = 0; j < ordering_.size(); ++j) {
+      const Vector& rhsj = rhs.at(ordering_[j]);
+      if(rhsj.size() != dims_[j])
+        throw invalid_argument("SupernodalCholesky::solve: the right-hand side has the wrong dimension");
+      x.segment(columnStarts_[j], dims_[j]) = rhsj;
+    }
+    solveInPlace(x);
+
+    VectorValues result;
+    for(size_t j = 0; j < ordering_.size(); ++j)
+      result.insert(ordering_[j], x.segment(columnStarts_[j], dims_[j]));
+    return result;
+  }
+
+  /* ************************************************************************* */
+  DenseIndex SupernodalCholesky::rowOffset(const Supernode& supernode, size_t j) const
+  {
+    const vector<size_t>::const_iterator row = lower_bound(supernode.rows.begin(), supernode.rows.end(), j);
+    assert(row != supernode.rows.end() && *row == j);
+    return supernode.rowOffsets[row - supernode.rows.begin()];
+  }
+
+  /* ************************************************************************* */
+  void SupernodalCholesky::solveInPlace(Vector& y) const
+  {
+    if(!isFactorized_)
+      throw invalid_argument("SupernodalCholesky: factorize() was not called or failed");
+
+    // Forward substitution L z = y
+    for(size_t s = 0; s < supernodes_.size(); ++s) {
+      const Supernode& supernode = supernodes_[s];
+      const DenseIndex k = supernode.nrColumns;
+      Eigen::Map<const Matrix> panel(values_.data() + supernode.start, supernode.rowOffsets.back(), k);
+      Eigen::VectorBlock<Vector> ys = y.segment(columnStarts_[supernode.firstVariable], k);
+      panel.topRows(k).triangularView<Eigen::Lower>().solveInPlace(ys);
+      for(size_t r = supernode.nrVariables; r < supernode.rows.size(); ++r) {
+        const size_t j = supernode.rows[r];
+        y.segment(columnStarts_[j], dims_[j]).noalias() -= panel.block(supernode.rowOffsets[r], 0, dims_[j], k) * ys;
+      }
+    }
+
+    // Back substitution L' x = z
+    for(size_t s = supernodes_.size(); s-- > 0; ) {
+      const Supernode& supernode = supernodes_[s];
+      const DenseIndex k = supernode.nrColumns;
+      Eigen::Map<const Matrix> panel(values_.data() + supernode.start, supernode.rowOffsets.back(), k);
+      Eigen::VectorBlock<Vector> ys = y.segment(columnStarts_[supernode.firstVariable], k);
+      for(size_t r = supernode.nrVariables; r < supernode.rows.size(); ++r) {
+        const size_t j = supernode.rows[r];
+        ys.noalias() -= panel.block(supernode.rowOffsets[r], 0, dims_[j], k).transpose() * y.segment(columnStarts_[j], dims_[j]);
+      }
+      panel.topRows(k).transpose().triangularView<Eigen::Upper>().solveInPlace(ys);
+    }
+  }
+
+}
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file SupernodalCholesky.h
+ * @brief Sparse supernodal Cholesky factorization of the Hessian of a GaussianFactorGraph
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <vector>
+
+namespace gtsam {
+
+  /**
+   * Sparse supernodal Cholesky factorization A'A = L L' of the whitened Hessian of a
+   * GaussianFactorGraph, the direct solver backend of NonlinearOptimizerParams::CHOLMOD.
+   *
+   * The constructor does the symbolic analysis for an Ordering: the elimination tree of the
+   * variables, the sparsity pattern of L, and its partition into supernodes, i.e. runs of
+   * consecutive variables in the ordering whose columns of L have the same structure below the
+   * diagonal.  All columns of a supernode are stored together as one dense column-major panel, and
+   * all panels in one contiguous array, so L is a compressed-column matrix whose column blocks
+   * are dense.
+   *
+   * factorize() then only does numeric work, which can be repeated for any graph with the same
+   * structure: it adds the information matrix of each factor directly into the panels, and
+   * factors the supernodes in order, each with a dense Cholesky of its diagonal block, a dense
+   * triangular solve for the rest of its panel, and a dense rank update of the panels of its
+   * ancestors.  Unlike multifrontal elimination, no factor graphs, conditionals, Bayes tree
+   * cliques or key maps are created during factorization.
+   *
+   * Factors with constrained noise models have no Hessian and cannot be factored.
+   */
+  class GTSAM_EXPORT SupernodalCholesky {
+  public:
+    typedef SupernodalCholesky This; ///< This class
+    typedef boost::shared_ptr<This> shared_ptr; ///< Shared pointer to this class
+
+    /// @name Standard Constructors
+    /// @{
+
+    /** Do the symbolic analysis for factoring graphs with the structure of \c graph in
+     *  \c ordering.  Throws InconsistentEliminationRequested if \c ordering does not contain
+     *  exactly the variables of \c graph. */
+    SupernodalCholesky(const GaussianFactorGraph& graph, const Ordering& ordering);
+
+    /// @}
+    /// @name Standard Interface
+    /// @{
+
+    /** Check whether \c graph has the structure this factorization was analyzed for, i.e. the
+     *  same number of factors, each involving the same variables with the same dimensions. */
+    bool compatible(const GaussianFactorGraph& graph) const;
+
+    /** Assemble the whitened Hessian A'A and the vector A'b of \c graph, which must be
+     *  compatible(), and factor A'A = L L'.  Throws IndeterminantLinearSystemException if A'A is
+     *  not positive definite, and std::invalid_argument if any factor has a constrained noise
+     *  model. */
+    void factorize(const GaussianFactorGraph& graph);
+
+    /** Solve A'A x = A'b with the factorization and A'b of the last call to factorize(), i.e.
+     *  optimize the last factored graph. */
+    VectorValues optimize() const;
+
+    /** Solve A'A x = \c rhs with the factorization of the last call to factorize(). */
+    VectorValues solve(const VectorValues& rhs) const;
+
+    /// @}
+    /// @name Advanced Interface
+    /// @{
+
+    /** The elimination ordering */
+    const Ordering& ordering() const { return ordering_; }
+
+    /** The number of supernodes */
+    size_t nrSupernodes() const { return supernodes_.size(); }
+
+    /** The number of stored entries of L, including the upper triangles of the diagonal blocks */
+    size_t nnz() const { return values_.size(); }
+
+    /// @}
+
+  private:
+    /** A run of consecutive variables whose columns of L are stored as one dense panel, with
+     *  rows for the variables of the supernode followed by the variables below the diagonal */
+    struct Supernode {
+      size_t firstVariable; ///< Position in the ordering of the first variable
+      size_t nrVariables; ///< Number of variables
+      std::vector<size_t> rows; ///< Positions of the variables of the rows of the panel, sorted
+      std::vector<DenseIndex> rowOffsets; ///< Offset of each variable in rows, and the total number of rows
+      DenseIndex nrColumns; ///< Number of scalar columns
+      size_t start; ///< Start of the panel in values_
+    };
+
+    Ordering ordering_; ///< The elimination ordering
+    std::vector<DenseIndex> dims_; ///< Dimension of each variable, by position in the ordering
+    std::vector<DenseIndex> columnStarts_; ///< Scalar offset of each variable in x, and the total dimension
+    std::vector<size_t> supernodeOf_; ///< Supernode of each variable
+    std::vector<Supernode> supernodes_; ///< Supernodes, in elimination order
+    std::vector<size_t> factorVariables_; ///< Positions of the variables of all factors, concatenated
+    std::vector<size_t> factorOffsets_; ///< Start of the variables of each factor in factorVariables_, and the total
+    Vector values_; ///< Storage of the panels of all supernodes
+    Vector rhs_; ///< A'b of the last factored graph
+    bool isFactorized_; ///< Whether the last call to factorize() succeeded
+
+    /** Offset in the panel of \c supernode of the row of the variable at position \c j */
+    DenseIndex rowOffset(const Supernode& supernode, size_t j) const;
+
+    /** Solve L L' x = \c y in place */
+    void solveInPlace(Vector& y) const;
+  };
+
+}
@@ -17,6 +17,7 @@
  */
 
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/Errors.h>
 
 #include <boost/foreach.hpp>
 #include <boost/bind.hpp>
@@ -343,5 +344,48 @@ namespace gtsam {
   }
 
   /* ************************************************************************* */
+  double dot(const VectorValues& a, const VectorValues& b, bool parallel)
+  {
+    if(!parallel)
+      return a.dot(b);
+    if(a.size() != b.size())
+      throw invalid_argument("VectorValues::dot called with a VectorValues of different structure");
+    vector<const Vector*> as, bs;
+    as.reserve(a.size());
+    bs.reserve(b.size());
+    VectorValues::const_iterator bi = b.begin();
+    BOOST_FOREACH(const VectorValues::value_type& ai, a) {
+      if(ai.first != bi->first || ai.second.size() != bi->second.size())
+        throw invalid_argument("VectorValues::dot called with a VectorValues of different structure");
+      as.push_back(&ai.second);
+      bs.push_back(&(bi++)->second);
+    }
+    return internal::parallelDot(as, bs);
+  }
+
+  /* ************************************************************************* */
+  void axpy(double alpha, const VectorValues& x, VectorValues& y, bool parallel)
+  {
+    if(x.size() != y.size())
+      throw invalid_argument("axpy(VectorValues) called with a VectorValues of different structure");
+    vector<const Vector*> xs;
+    vector<Vector*> ys;
+    xs.reserve(x.size());
+    ys.reserve(y.size());
+    VectorValues::const_iterator xi = x.begin();
+    BOOST_FOREACH(VectorValues::value_type& yi, y) {
+      if(yi.first != xi->first || yi.second.size() != xi->second.size())
+        throw invalid_argument("axpy(VectorValues) called with a VectorValues of different structure");
+      xs.push_back(&(xi++)->second);
+      ys.push_back(&yi.second);
+    }
+    if(parallel)
+      internal::parallelAxpy(alpha, xs, ys);
+    else
+      for(size_t i = 0; i < ys.size(); ++i)
+        *ys[i] += alpha * *xs[i];
+  }
+
+  /* ************************************************************************* */
 
 } // \namespace gtsam
@@ -381,4 +381,12 @@ namespace gtsam {
     }
   }; // VectorValues definition
 
+  /** Dot product of two VectorValues of the same structure, over ranges of variables with TBB if
+   *  parallel is true and GTSAM uses TBB. */
+  GTSAM_EXPORT double dot(const VectorValues& a, const VectorValues& b, bool parallel);
+
+  /** y += alpha * x for two VectorValues of the same structure, over ranges of variables with TBB
+   *  if parallel is true and GTSAM uses TBB. */
+  GTSAM_EXPORT void axpy(double alpha, const VectorValues& x, VectorValues& y, bool parallel);
+
 } // \namespace gtsam
@@ -34,6 +34,7 @@ namespace gtsam {
 
     int k;                     ///< iteration
     bool steepest;             ///< flag to indicate we are doing steepest descent
+    bool parallel;             ///< flag to multithread products and reductions, for the PARALLEL kernel
     V g, d;                    ///< gradient g and search direction d for CG
     double gamma, threshold;   ///< gamma (squared L2 norm of g) and convergence threshold
     E Ad;
@@ -41,7 +42,8 @@ namespace gtsam {
     /* ************************************************************************* */
     // Constructor
     CGState(const S& Ab, const V& x, const Parameters &parameters, bool steep):
-    parameters_(parameters),k(0),steepest(steep) {
+    parameters_(parameters),k(0),steepest(steep),
+    parallel(parameters.blasKernel() == ConjugateGradientParameters::PARALLEL) {
 
       // Start with g0 = A'*(A*x0-b), d0 = - g0
       // i.e., first step is in direction of negative gradient
@@ -49,7 +51,7 @@ namespace gtsam {
       d = g; // instead of negating gradient, alpha will be negated
 
       // init gamma and calculate threshold
-      gamma = dot(g,g);
+      gamma = dot(g,g,parallel);
       threshold = std::max(parameters_.epsilon_abs(), parameters_.epsilon() * parameters_.epsilon() * gamma);
 
       // Allocate and calculate A*d for first iteration
@@ -71,8 +73,8 @@ namespace gtsam {
     // step the solution
     double takeOptimalStep(V& x) {
       // TODO: can we use gamma instead of dot(d,g) ????? Answer not trivial
-      double alpha = -dot(d, g) / dot(Ad, Ad); // calculate optimal step-size
-      axpy(alpha, d, x); // // do step in new search direction, x += alpha*d
+      double alpha = -dot(d, g, parallel) / dot(Ad, Ad, parallel); // calculate optimal step-size
+      axpy(alpha, d, x, parallel); // // do step in new search direction, x += alpha*d
       return alpha;
     }
 
@@ -88,10 +90,10 @@ namespace gtsam {
       // update gradient (or re-calculate at reset time)
       if (k % parameters_.reset() == 0) g = Ab.gradient(x);
       // axpy(alpha, Ab ^ Ad, g);  // g += alpha*(Ab^Ad)
-      else Ab.transposeMultiplyAdd(alpha, Ad, g);
+      else Ab.transposeMultiplyAdd(alpha, Ad, g, parallel);
 
       // check for convergence
-      double new_gamma = dot(g, g);
+      double new_gamma = dot(g, g, parallel);
 
       if (parameters_.verbosity() != ConjugateGradientParameters::SILENT)
         std::cout << "iteration " << k << ": alpha = " << alpha
@@ -106,13 +108,13 @@ namespace gtsam {
         double beta = new_gamma / gamma;
         // d = g + d*beta;
         d *= beta;
-        axpy(1.0, g, d);
+        axpy(1.0, g, d, parallel);
       }
 
       gamma = new_gamma;
 
       // In-place recalculation Ad <- A*d to avoid re-allocating Ad
-      Ab.multiplyInPlace(d, Ad);
+      Ab.multiplyInPlace(d, Ad, parallel);
       return false;
     }
 
@@ -22,8 +22,15 @@
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/linear/IterativeSolver.h>
 
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
 #include <iostream>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#  include <tbb/parallel_reduce.h>
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -60,17 +67,174 @@ namespace gtsam {
     return conjugateGradients<System, Vector, Vector>(Ab, x, parameters);
   }
 
+  /* ************************************************************************* */
+  FlatSystem::FlatSystem(const GaussianFactorGraph& fg, const VectorValues& x) : rowDim_(0)
+  {
+    // Variables of x first, then the ones of the factors it is missing
+    Ordering ordering;
+    VectorValues::Dims dims;
+    BOOST_FOREACH(const VectorValues::KeyValuePair& xj, x) {
+      ordering.push_back(xj.first);
+      dims.insert(make_pair(xj.first, xj.second.size()));
+    }
+    factors_.reserve(fg.size());
+    BOOST_FOREACH(const GaussianFactor::shared_ptr& factor, fg) {
+      JacobianFactor::shared_ptr jacobian = boost::dynamic_pointer_cast<JacobianFactor>(factor);
+      if(!jacobian)
+        // Convert any non-Jacobian factors to Jacobians (e.g. Hessian -> Jacobian with Cholesky)
+        jacobian = boost::make_shared<JacobianFactor>(*factor);
+      for(JacobianFactor::const_iterator j = jacobian->begin(); j != jacobian->end(); ++j)
+        if(dims.insert(make_pair(*j, jacobian->getDim(j))).second)
+          ordering.push_back(*j);
+      factors_.push_back(jacobian);
+    }
+    layout_ = boost::make_shared<FlatVectorValues::Layout>(ordering, dims);
+
+    // Look up the offsets of the variables and rows of each factor
+    columns_.resize(factors_.size());
+    rows_.reserve(factors_.size());
+    for(size_t i = 0; i < factors_.size(); ++i) {
+      const JacobianFactor& Ai = *factors_[i];
+      columns_[i].reserve(Ai.size());
+      BOOST_FOREACH(Key j, Ai.keys())
+        columns_[i].push_back(layout_->at(j).first);
+      rows_.push_back(rowDim_);
+      rowDim_ += Ai.rows();
+    }
+  }
+
+  namespace {
+    /* ************************************************************************* */
+    // Whitened A_i*x, minus b_i if withRhs
+    Vector multiplyFactor(const JacobianFactor& Ai, const FastVector<DenseIndex>& columns,
+      const Vector& x, bool withRhs)
+    {
+      Vector Ax = withRhs ? Vector(-Ai.getb()) : Vector(Vector::Zero(Ai.rows()));
+      for(size_t pos = 0; pos < Ai.size(); ++pos)
+        Ax.noalias() += Ai.getA(Ai.begin() + pos) * x.segment(columns[pos], Ai.getDim(Ai.begin() + pos));
+      return Ai.get_model() ? Ai.get_model()->whiten(Ax) : Ax;
+    }
+
+    /* ************************************************************************* */
+    // x += alpha * A_i'*whiten(e_i)
+    void transposeMultiplyFactor(double alpha, const JacobianFactor& Ai,
+      const FastVector<DenseIndex>& columns, const Vector& e, Vector& x)
+    {
+      const Vector E = alpha * (Ai.get_model() ? Ai.get_model()->whiten(e) : e);
+      for(size_t pos = 0; pos < Ai.size(); ++pos)
+        x.segment(columns[pos], Ai.getDim(Ai.begin() + pos)).noalias() += Ai.getA(Ai.begin() + pos).transpose() * E;
+    }
+
+#ifdef GTSAM_USE_TBB
+    /* ************************************************************************* */
+    // e_i <- A_i*x for a range of factors, each writing its own rows of e
+    struct MultiplyFlatFactors {
+      const std::vector<JacobianFactor::shared_ptr>& factors;
+      const std::vector<FastVector<DenseIndex> >& columns;
+      const std::vector<DenseIndex>& rows;
+      const Vector& x;
+      Vector& e;
+      MultiplyFlatFactors(const std::vector<JacobianFactor::shared_ptr>& factors,
+        const std::vector<FastVector<DenseIndex> >& columns, const std::vector<DenseIndex>& rows,
+        const Vector& x, Vector& e) :
+        factors(factors), columns(columns), rows(rows), x(x), e(e) {}
+      void operator()(const tbb::blocked_range<size_t>& r) const {
+        for(size_t i = r.begin(); i != r.end(); ++i)
+          e.segment(rows[i], factors[i]->rows()) = multiplyFactor(*factors[i], columns[i], x, false);
+      }
+    };
+
+    /* ************************************************************************* */
+    // Accumulates A_i'*e_i for a range of factors, split per thread
+    struct TransposeMultiplyFlatFactors {
+      const std::vector<JacobianFactor::shared_ptr>& factors;
+      const std::vector<FastVector<DenseIndex> >& columns;
+      const std::vector<DenseIndex>& rows;
+      const Vector& e;
+      Vector result;
+      TransposeMultiplyFlatFactors(const std::vector<JacobianFactor::shared_ptr>& factors,
+        const std::vector<FastVector<DenseIndex> >& columns, const std::vector<DenseIndex>& rows,
+        const Vector& e, DenseIndex dim) :
+        factors(factors), columns(columns), rows(rows), e(e), result(Vector::Zero(dim)) {}
+      TransposeMultiplyFlatFactors(TransposeMultiplyFlatFactors& other, tbb::split) :
+        factors(other.factors), columns(other.columns), rows(other.rows), e(other.e),
+        result(Vector::Zero(other.result.size())) {}
+      void operator()(const tbb::blocked_range<size_t>& r) {
+        for(size_t i = r.begin(); i != r.end(); ++i)
+          transposeMultiplyFactor(1.0, *factors[i], columns[i], e.segment(rows[i], factors[i]->rows()), result);
+      }
+      void join(const TransposeMultiplyFlatFactors& other) { result += other.result; }
+    };
+#endif
+  }
+
+  /* ************************************************************************* */
+  FlatVectorValues FlatSystem::gradient(const FlatVectorValues& x) const
+  {
+    FlatVectorValues g(layout_);
+    for(size_t i = 0; i < factors_.size(); ++i)
+      transposeMultiplyFactor(1.0, *factors_[i], columns_[i],
+        multiplyFactor(*factors_[i], columns_[i], x.vector(), true), g.vector());
+    return g;
+  }
+
+  /* ************************************************************************* */
+  Vector FlatSystem::operator*(const FlatVectorValues& x) const
+  {
+    Vector e(rowDim_);
+    multiplyInPlace(x, e);
+    return e;
+  }
+
+  /* ************************************************************************* */
+  void FlatSystem::multiplyInPlace(const FlatVectorValues& x, Vector& e, bool parallel) const
+  {
+    e.resize(rowDim_);
+#ifdef GTSAM_USE_TBB
+    if(parallel) {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, factors_.size()),
+        MultiplyFlatFactors(factors_, columns_, rows_, x.vector(), e));
+      return;
+    }
+#endif
+    for(size_t i = 0; i < factors_.size(); ++i)
+      e.segment(rows_[i], factors_[i]->rows()) = multiplyFactor(*factors_[i], columns_[i], x.vector(), false);
+  }
+
+  /* ************************************************************************* */
+  void FlatSystem::transposeMultiplyAdd(double alpha, const Vector& e, FlatVectorValues& x, bool parallel) const
+  {
+#ifdef GTSAM_USE_TBB
+    if(parallel) {
+      TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+      TransposeMultiplyFlatFactors products(factors_, columns_, rows_, e, layout_->dim());
+      tbb::parallel_reduce(tbb::blocked_range<size_t>(0, factors_.size()), products);
+      x.vector() += alpha * products.result;
+      return;
+    }
+#endif
+    for(size_t i = 0; i < factors_.size(); ++i)
+      transposeMultiplyFactor(alpha, *factors_[i], columns_[i], e.segment(rows_[i], factors_[i]->rows()), x.vector());
+  }
+
   /* ************************************************************************* */
   VectorValues steepestDescent(const GaussianFactorGraph& fg,
       const VectorValues& x, const ConjugateGradientParameters & parameters) {
-    return conjugateGradients<GaussianFactorGraph, VectorValues, Errors>(
-        fg, x, parameters, true);
+    FlatSystem Ab(fg, x);
+    FlatVectorValues x0(Ab.layout());
+    x0.update(x);
+    return conjugateGradients<FlatSystem, FlatVectorValues, Vector>(
+        Ab, x0, parameters, true).toVectorValues();
   }
 
   VectorValues conjugateGradientDescent(const GaussianFactorGraph& fg,
       const VectorValues& x, const ConjugateGradientParameters & parameters) {
-    return conjugateGradients<GaussianFactorGraph, VectorValues, Errors>(
-        fg, x, parameters);
+    FlatSystem Ab(fg, x);
+    FlatVectorValues x0(Ab.layout());
+    x0.update(x);
+    return conjugateGradients<FlatSystem, FlatVectorValues, Vector>(
+        Ab, x0, parameters).toVectorValues();
   }
 
 /* ************************************************************************* */
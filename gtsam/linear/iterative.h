@@ -20,15 +20,18 @@
 
 #include <gtsam/base/Matrix.h>
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/FlatVectorValues.h>
 #include <gtsam/linear/ConjugateGradientSolver.h>
 
 namespace gtsam {
 
   /**
    * Method of conjugate gradients (CG) template
-   * "System" class S needs gradient(S,v), e=S*v, v=S^e
-   * "Vector" class V needs dot(v,v), -v, v+v, s*v
-   * "Vector" class E needs dot(v,v)
+   * "System" class S needs gradient(S,v), e=S*v, v=S^e, S.multiplyInPlace(v,e,parallel) and
+   * S.transposeMultiplyAdd(alpha,e,v,parallel)
+   * "Vector" class V needs dot(v,v,parallel), axpy(alpha,v,v,parallel), -v, v+v, s*v
+   * "Vector" class E needs dot(v,v,parallel)
+   * Here parallel is true for the PARALLEL kernel of the parameters.
    * @param Ab, the "system" that needs to be solved, examples below
    * @param x is the initial estimate
    * @param steepest flag, if true does steepest descent, not CG
@@ -79,17 +82,79 @@ namespace gtsam {
       return A() * x;
     }
 
-    /** Apply operator A in place */
-    void multiplyInPlace(const Vector& x, Vector& e) const {
+    /** Apply operator A in place, parallel is ignored for the dense matrix */
+    void multiplyInPlace(const Vector& x, Vector& e, bool parallel = false) const {
       e = A() * x;
     }
 
-    /** x += alpha* A'*e */
-    void transposeMultiplyAdd(double alpha, const Vector& e, Vector& x) const {
+    /** x += alpha* A'*e, parallel is ignored for the dense matrix */
+    void transposeMultiplyAdd(double alpha, const Vector& e, Vector& x, bool parallel = false) const {
       gtsam::transposeMultiplyAdd(alpha, A(), e, x);
     }
   };
 
+  /** dot product of the dense vectors of System, parallel is ignored */
+  inline double dot(const Vector& a, const Vector& b, bool parallel) {
+    return a.dot(b);
+  }
+
+  /** axpy on the dense vectors of System, parallel is ignored */
+  inline void axpy(double alpha, const Vector& x, Vector& y, bool parallel) {
+    y += alpha * x;
+  }
+
+  // Forward declarations
+  class JacobianFactor;
+
+  /**
+   * The system |Ax-b|^2 of a GaussianFactorGraph, with the variables stored in a FlatVectorValues
+   * and the whitened errors of all factors stacked in one Vector.  The factors are converted to
+   * JacobianFactors, and the position of each of their variables in the FlatVectorValues and of
+   * their rows in the errors are looked up, once on construction, so that the products with A
+   * and A' in each CG iteration only use offsets into contiguous storage, and the dot products and
+   * axpy of CG are BLAS-1 operations over single Vectors.
+   */
+  class GTSAM_EXPORT FlatSystem {
+
+  private:
+    FlatVectorValues::Layout::shared_ptr layout_;
+    std::vector<boost::shared_ptr<JacobianFactor> > factors_;
+    std::vector<FastVector<DenseIndex> > columns_; ///< Offset in x of each variable of each factor
+    std::vector<DenseIndex> rows_; ///< Offset in the errors of the rows of each factor
+    DenseIndex rowDim_; ///< Total number of rows
+
+  public:
+
+    /** Create the system of \c fg, laid out with the variables of \c x in increasing key order,
+     *  followed by the variables of \c fg that are not in \c x */
+    FlatSystem(const GaussianFactorGraph& fg, const VectorValues& x);
+
+    /** The layout of the variables */
+    const FlatVectorValues::Layout::shared_ptr& layout() const { return layout_; }
+
+    /** gradient of objective function 0.5*|Ax-b|^2 at x = A'*(Ax-b) */
+    FlatVectorValues gradient(const FlatVectorValues& x) const;
+
+    /** Apply operator A */
+    Vector operator*(const FlatVectorValues& x) const;
+
+    /** Apply operator A in place, over ranges of factors with TBB if parallel */
+    void multiplyInPlace(const FlatVectorValues& x, Vector& e, bool parallel = false) const;
+
+    /** x += alpha* A'*e, over ranges of factors with TBB if parallel */
+    void transposeMultiplyAdd(double alpha, const Vector& e, FlatVectorValues& x, bool parallel = false) const;
+  };
+
+  /** dot product of the variables of FlatSystem, parallel is ignored */
+  inline double dot(const FlatVectorValues& a, const FlatVectorValues& b, bool parallel) {
+    return a.dot(b);
+  }
+
+  /** axpy on the variables of FlatSystem, parallel is ignored */
+  inline void axpy(double alpha, const FlatVectorValues& x, FlatVectorValues& y, bool parallel) {
+    axpy(alpha, x, y);
+  }
+
   /**
    * Method of steepest gradients, System version
    */
@@ -127,7 +192,7 @@ namespace gtsam {
       const ConjugateGradientParameters & parameters);
 
   /**
-   * Method of steepest gradients, Gaussian Factor Graph version
+   * Method of steepest gradients, Gaussian Factor Graph version, iterates on a FlatSystem
    */
   GTSAM_EXPORT VectorValues steepestDescent(
       const GaussianFactorGraph& fg,
@@ -135,7 +200,7 @@ namespace gtsam {
       const ConjugateGradientParameters & parameters);
 
   /**
-   * Method of conjugate gradients (CG), Gaussian Factor Graph version
+   * Method of conjugate gradients (CG), Gaussian Factor Graph version, iterates on a FlatSystem
    */
   GTSAM_EXPORT VectorValues conjugateGradientDescent(
       const GaussianFactorGraph& fg,
@@ -17,6 +17,7 @@
 
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/base/treeTraversal-inst.h>
 
 #include <boost/optional.hpp>
@@ -138,6 +139,48 @@ namespace gtsam
         treeTraversal::DepthFirstForestParallel(bayesTree, rootData, preVisitor, postVisitor);
         return preVisitor.collectedResult;
       }
+
+      /* ************************************************************************* */
+      /** Pre-order visitor for recovering clique covariances.  The data passed to the children is
+      *  the covariance of their parent clique.  The results are written into entries of a map that
+      *  already exist, which is safe to do from concurrent tasks since the map is not modified. */
+      template<class CLIQUE>
+      struct CliqueCovariancesVisitor
+      {
+        FastMap<Key, GaussianCliqueCovariance>& results;
+
+        CliqueCovariancesVisitor(FastMap<Key, GaussianCliqueCovariance>& results) : results(results) {}
+
+        const GaussianCliqueCovariance* operator()(
+          const boost::shared_ptr<CLIQUE>& clique,
+          const GaussianCliqueCovariance* parentCovariance)
+        {
+          GaussianCliqueCovariance& covariance = results.at(clique->conditional()->front());
+          covariance = GaussianCliqueCovariance(*clique->conditional(), parentCovariance);
+          return &covariance;
+        }
+      };
+
+      /* ************************************************************************* */
+      template<class BAYESTREE>
+      FastMap<Key, GaussianCliqueCovariance> cliqueCovariancesBayesTree(const BAYESTREE& bayesTree)
+      {
+        gttic(linear_cliqueCovariancesBayesTree);
+        // Create the entry of every clique up front, so the tasks only write into existing entries
+        FastMap<Key, GaussianCliqueCovariance> results;
+        typedef typename BAYESTREE::Nodes::value_type KeyClique;
+        BOOST_FOREACH(const KeyClique& keyClique, bayesTree.nodes()) {
+          if(keyClique.second->conditional()->front() == keyClique.first)
+            results.insert(std::make_pair(keyClique.first, GaussianCliqueCovariance()));
+        }
+
+        const GaussianCliqueCovariance* rootData = 0;
+        CliqueCovariancesVisitor<typename BAYESTREE::Clique> preVisitor(results);
+        treeTraversal::no_op postVisitor;
+        TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+        treeTraversal::DepthFirstForestParallel(bayesTree, rootData, preVisitor, postVisitor);
+        return results;
+      }
     }
   }
 }
@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file testCompiledGaussianFactorGraph.cpp
+ * @brief Unit tests for CompiledGaussianFactorGraph
+ */
+
+#include <gtsam/linear/CompiledGaussianFactorGraph.h>
+#include <gtsam/linear/PCGSolver.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+  /* ************************************************************************* */
+  // Jacobian factors with noise models on variables of dimensions 2 and 3, and a HessianFactor
+  GaussianFactorGraph createGraph()
+  {
+    GaussianFactorGraph graph;
+    graph += JacobianFactor(0, (Matrix(2, 2) << 1., 2., 0., 3.), (Vector(2) << 1., 2.),
+      noiseModel::Diagonal::Sigmas((Vector(2) << 0.5, 2.)));
+    graph += JacobianFactor(0, (Matrix(3, 2) << 1., 0., 2., 1., 0., -1.),
+      1, (Matrix(3, 3) << 1., 2., 3., 0., 1., 0., -1., 0., 2.), (Vector(3) << 0.1, 0.2, 0.3),
+      noiseModel::Isotropic::Sigma(3, 0.1));
+    graph += JacobianFactor(1, (Matrix(2, 3) << 1., 0., 1., 0., 2., 0.),
+      2, (Matrix(2, 2) << 3., 1., 1., -1.), (Vector(2) << -1., 1.));
+    graph += HessianFactor(2, 0, (Matrix(2, 2) << 4., 1., 1., 3.), (Matrix(2, 2) << 1., 2., 0., 1.),
+      (Vector(2) << 1., -1.), (Matrix(2, 2) << 5., 0., 0., 5.), (Vector(2) << 0.5, 2.), 3.);
+    return graph;
+  }
+}
+
+/* ************************************************************************* */
+TEST(CompiledGaussianFactorGraph, multiply)
+{
+  GaussianFactorGraph graph = createGraph();
+  KeyInfo keyInfo(graph);
+  CompiledGaussianFactorGraph compiled(graph, keyInfo);
+  LONGS_EQUAL(7, compiled.dim());
+  LONGS_EQUAL(2*2 + 3*5 + 2*5 + 4*4, compiled.nnz());
+
+  Vector x = (Vector(7) << 1., -2., 0.5, 3., -1., 2., 0.25);
+  VectorValues expected = keyInfo.x0();
+  graph.multiplyHessianAdd(1.0, buildVectorValues(x, keyInfo), expected);
+
+  // The product overwrites y
+  Vector y = Vector::Ones(7);
+  compiled.multiply(x, y);
+  EXPECT(assert_equal(expected, buildVectorValues(y, keyInfo)));
+  compiled.multiply(x, y);
+  EXPECT(assert_equal(expected, buildVectorValues(y, keyInfo)));
+
+  // In a different variable layout
+  Ordering ordering;
+  ordering += 2, 0, 1;
+  KeyInfo reordered(graph, ordering);
+  CompiledGaussianFactorGraph compiled2(graph, reordered);
+  Vector x2 = expected.vector(ordering); // any vector in the new layout
+  VectorValues expected2 = reordered.x0();
+  graph.multiplyHessianAdd(1.0, buildVectorValues(x2, reordered), expected2);
+  Vector y2(7);
+  compiled2.multiply(x2, y2);
+  EXPECT(assert_equal(expected2, buildVectorValues(y2, reordered)));
+}
+
+/* ************************************************************************* */
+TEST(CompiledGaussianFactorGraph, getb)
+{
+  GaussianFactorGraph graph = createGraph();
+  KeyInfo keyInfo(graph);
+  CompiledGaussianFactorGraph compiled(graph, keyInfo);
+
+  Vector b = Vector::Ones(7);
+  compiled.getb(b);
+  EXPECT(assert_equal(-1.0 * graph.gradientAtZero(), buildVectorValues(b, keyInfo)));
+}
+
+/* ************************************************************************* */
+TEST(CompiledGaussianFactorGraph, refresh)
+{
+  GaussianFactorGraph graph = createGraph();
+  KeyInfo keyInfo(graph);
+  CompiledGaussianFactorGraph compiled(graph, keyInfo);
+
+  // New values in the same structure
+  GaussianFactorGraph scaled;
+  BOOST_FOREACH(const GaussianFactor::shared_ptr& gf, graph) {
+    if(JacobianFactor::shared_ptr jf = boost::dynamic_pointer_cast<JacobianFactor>(gf)) {
+      JacobianFactor::shared_ptr copy = boost::make_shared<JacobianFactor>(*jf);
+      copy->getA(copy->begin()) *= 2.0;
+      copy->getb() *= -1.0;
+      scaled.push_back(copy);
+    } else {
+      HessianFactor::shared_ptr copy = boost::make_shared<HessianFactor>(
+        *boost::dynamic_pointer_cast<HessianFactor>(gf));
+      copy->linearTerm() *= 3.0;
+      scaled.push_back(copy);
+    }
+  }
+  CHECK(compiled.refresh(scaled));
+  CompiledGaussianFactorGraph expected(scaled, keyInfo);
+  Vector x = (Vector(7) << 1., -2., 0.5, 3., -1., 2., 0.25), y(7), yExpected(7);
+  compiled.multiply(x, y);
+  expected.multiply(x, yExpected);
+  EXPECT(assert_equal(yExpected, y));
+  compiled.getb(y);
+  expected.getb(yExpected);
+  EXPECT(assert_equal(yExpected, y));
+
+  // A factor with a different number of rows needs a new compilation
+  GaussianFactorGraph taller = graph;
+  taller.replace(0, boost::make_shared<JacobianFactor>(0, (Matrix(3, 2) << 1., 0., 0., 1., 1., 1.), zero(3)));
+  EXPECT(!compiled.refresh(taller));
+}
+
+/* ************************************************************************* */
+TEST(CompiledGaussianFactorGraph, constrained)
+{
+  GaussianFactorGraph graph = createGraph();
+  graph += JacobianFactor(0, eye(2), zero(2), noiseModel::Constrained::All(2));
+  CHECK_EXCEPTION(CompiledGaussianFactorGraph(graph, KeyInfo(graph)), invalid_argument);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
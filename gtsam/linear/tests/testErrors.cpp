@@ -38,6 +38,20 @@ TEST( Errors, arithmetic )
   CHECK(assert_equal(expected,e));
 }
 
+/* ************************************************************************* */
+TEST( Errors, parallel )
+{
+  Errors e;
+  e += (Vector(2) << 1.0,2.0), (Vector(3) << 3.0,4.0,5.0), (Vector(1) << -1.0);
+  DOUBLES_EQUAL(dot(e,e), dot(e,e,true), 1e-9);
+  DOUBLES_EQUAL(dot(e,e), dot(e,e,false), 1e-9);
+
+  Errors expected = e;
+  axpy(-0.5,e,expected);
+  axpy(-0.5,e,e,true);
+  CHECK(assert_equal(expected,e));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
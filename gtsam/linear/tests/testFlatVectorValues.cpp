@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    testFlatVectorValues.cpp
+ * @brief   Unit tests for FlatVectorValues
+ */
+
+#include <gtsam/base/Testable.h>
+#include <gtsam/linear/FlatVectorValues.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <boost/assign/list_of.hpp>
+
+using namespace std;
+using namespace boost::assign;
+using namespace gtsam;
+
+/* ************************************************************************* */
+namespace {
+  VectorValues createVectorValues() {
+    VectorValues values;
+    values.insert(0, (Vector(1) << 1));
+    values.insert(1, (Vector(2) << 2, 3));
+    values.insert(5, (Vector(2) << 6, 7));
+    values.insert(2, (Vector(2) << 4, 5));
+    return values;
+  }
+}
+
+/* ************************************************************************* */
+TEST(FlatVectorValues, basics)
+{
+  FlatVectorValues actual(createVectorValues());
+
+  // Check dimensions
+  LONGS_EQUAL(4, actual.size());
+  LONGS_EQUAL(7, actual.dim());
+  LONGS_EQUAL(1, actual.dim(0));
+  LONGS_EQUAL(2, actual.dim(1));
+  LONGS_EQUAL(2, actual.dim(2));
+  LONGS_EQUAL(2, actual.dim(5));
+
+  // Logic
+  EXPECT(actual.exists(0));
+  EXPECT(actual.exists(2));
+  EXPECT(!actual.exists(3));
+  EXPECT(actual.exists(5));
+
+  // Keys are stored in increasing order, contiguously
+  EXPECT(assert_equal((Vector(7) << 1, 2, 3, 4, 5, 6, 7), actual.vector()));
+  EXPECT(assert_equal((Vector(2) << 4, 5), Vector(actual[2])));
+  EXPECT(assert_equal((Vector(2) << 6, 7), Vector(actual.at(5))));
+  CHECK_EXCEPTION(actual.at(3), std::out_of_range);
+
+  // Writing through a SubVector writes into the underlying Vector
+  actual[1] << 20, 30;
+  EXPECT(assert_equal((Vector(7) << 1, 20, 30, 4, 5, 6, 7), actual.vector()));
+
+  // Round trip
+  VectorValues expected = createVectorValues();
+  expected.at(1) << 20, 30;
+  EXPECT(assert_equal(expected, actual.toVectorValues()));
+}
+
+/* ************************************************************************* */
+TEST(FlatVectorValues, ordering)
+{
+  Ordering ordering = list_of(5)(0)(2)(1);
+  FlatVectorValues actual(createVectorValues(), ordering);
+
+  EXPECT(assert_equal((Vector(7) << 6, 7, 1, 4, 5, 2, 3), actual.vector()));
+  EXPECT(ordering == Ordering(actual.keys()));
+  EXPECT(assert_equal(createVectorValues(), actual.toVectorValues()));
+
+  // Same values in a different order have a different structure
+  FlatVectorValues sorted(createVectorValues());
+  EXPECT(!actual.hasSameStructure(sorted));
+  CHECK_EXCEPTION(actual.dot(sorted), std::invalid_argument);
+
+  // Layouts built separately from the same ordering and dimensions are equal
+  FlatVectorValues other(createVectorValues(), ordering);
+  EXPECT(actual.layout() != other.layout());
+  EXPECT(actual.hasSameStructure(other));
+}
+
+/* ************************************************************************* */
+TEST(FlatVectorValues, update)
+{
+  FlatVectorValues actual(createVectorValues());
+
+  VectorValues changes;
+  changes.insert(5, (Vector(2) << 60, 70));
+  changes.insert(0, (Vector(1) << 10));
+  actual.update(changes);
+  EXPECT(assert_equal((Vector(7) << 10, 2, 3, 4, 5, 60, 70), actual.vector()));
+
+  VectorValues missing;
+  missing.insert(3, (Vector(1) << 1));
+  CHECK_EXCEPTION(actual.update(missing), std::out_of_range);
+
+  VectorValues wrongDim;
+  wrongDim.insert(0, (Vector(2) << 1, 2));
+  CHECK_EXCEPTION(actual.update(wrongDim), std::invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(FlatVectorValues, LinearAlgebra)
+{
+  VectorValues test = createVectorValues();
+  FlatVectorValues x(test);
+  FlatVectorValues y = 2.0 * x;
+
+  // The result of each operation shares the layout of its arguments
+  EXPECT(x.layout() == y.layout());
+  EXPECT(x.layout() == FlatVectorValues::Zero(x).layout());
+
+  // Dot and norms agree with VectorValues
+  DOUBLES_EQUAL(test.dot(2.0 * test), x.dot(y), 1e-9);
+  DOUBLES_EQUAL(test.norm(), x.norm(), 1e-9);
+  DOUBLES_EQUAL(test.squaredNorm(), x.squaredNorm(), 1e-9);
+
+  EXPECT(assert_equal(FlatVectorValues(test + 2.0 * test), x + y));
+  EXPECT(assert_equal(FlatVectorValues(test - 2.0 * test), x - y));
+  EXPECT(assert_equal(FlatVectorValues(3.0 * test), x.scale(3.0)));
+
+  FlatVectorValues actual = x;
+  actual += y;
+  EXPECT(assert_equal(FlatVectorValues(3.0 * test), actual));
+  actual -= x;
+  EXPECT(assert_equal(y, actual));
+  actual *= 0.5;
+  EXPECT(assert_equal(x, actual));
+
+  // The generic dot and axpy used by the iterative solvers
+  DOUBLES_EQUAL(test.dot(2.0 * test), gtsam::dot(x, y), 1e-9);
+  actual = x;
+  axpy(2.0, y, actual);
+  EXPECT(assert_equal(FlatVectorValues(5.0 * test), actual));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
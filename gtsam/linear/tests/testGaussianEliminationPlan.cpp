@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file testGaussianEliminationPlan.cpp
+ * @brief Unit tests for GaussianEliminationPlan
+ */
+
+#include <gtsam/linear/GaussianEliminationPlan.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianConditional.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/inference/inferenceExceptions.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/foreach.hpp>
+using namespace boost::assign;
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+  const Key x1=1, x2=2, x3=3, x4=4, x5=5;
+  const SharedDiagonal unit2 = noiseModel::Unit::Create(2);
+  const Ordering ordering = Ordering(list_of(x1)(x3)(x2)(x5)(x4));
+
+  /* ************************************************************************* */
+  // A graph with two branches, x1-x2-x4 and x3-x2, and x5-x4, whose numbers depend on s
+  GaussianFactorGraph createGraph(double s)
+  {
+    GaussianFactorGraph graph;
+    graph += JacobianFactor(x1, (Matrix(2, 2) << 1., s, 0., 2.), (Vector(2) << 1., s), unit2);
+    graph += JacobianFactor(x1, (Matrix(2, 2) << -1., 0., 0., -1.), x2, (Matrix(2, 2) << 1., 0., s, 1.), (Vector(2) << 0.1, 0.2), unit2);
+    graph += JacobianFactor(x3, (Matrix(2, 2) << 2., 0., 0., 2.), x2, (Matrix(2, 2) << -1., s, 0., -1.), (Vector(2) << s, 0.3), unit2);
+    graph += JacobianFactor(x2, (Matrix(2, 2) << 1., 0., 0., 1.), x4, (Matrix(2, 2) << -s, 0., 0., -1.), (Vector(2) << 0.5, 0.6), unit2);
+    graph += HessianFactor(x5, x4, (Matrix(2, 2) << 3., s, s, 3.), (Matrix(2, 2) << -1., 0., 0., -1.),
+      (Vector(2) << 1., 2.), (Matrix(2, 2) << 2., 0., 0., 2.), (Vector(2) << s, 1.), 5.);
+    return graph;
+  }
+}
+
+/* ************************************************************************* */
+TEST(GaussianEliminationPlan, eliminate)
+{
+  GaussianFactorGraph graph = createGraph(0.5);
+  GaussianEliminationPlan plan(graph, ordering);
+  EXPECT(assert_equal(ordering, plan.ordering()));
+
+  GaussianBayesTree expected = *graph.eliminateMultifrontal(ordering);
+  EXPECT(assert_equal(expected, *plan.eliminate(graph)));
+
+  // The plan is reused for a graph with the same structure but different numbers
+  GaussianFactorGraph graph2 = createGraph(-0.25);
+  EXPECT(plan.compatible(graph2));
+  GaussianBayesTree::shared_ptr actual2 = plan.eliminate(graph2);
+  EXPECT(assert_equal(*graph2.eliminateMultifrontal(ordering), *actual2));
+  EXPECT(assert_equal(graph2.optimize(ordering), actual2->optimize()));
+
+  // The previous result does not share storage with the plan
+  EXPECT(assert_equal(expected, *plan.eliminate(graph)));
+}
+
+/* ************************************************************************* */
+TEST(GaussianEliminationPlan, eliminateFunction)
+{
+  GaussianFactorGraph graph = createGraph(0.5);
+  GaussianEliminationPlan plan(graph, ordering);
+  EXPECT(assert_equal(*graph.eliminateMultifrontal(ordering, EliminateQR),
+    *plan.eliminate(graph, EliminateQR)));
+
+  // Constrained noise models fall back to QR
+  GaussianFactorGraph constrained = createGraph(0.5);
+  constrained.at(0) = boost::make_shared<JacobianFactor>(x1, (Matrix(2, 2) << 1., 0., 0., 1.),
+    (Vector(2) << 1., 2.), noiseModel::Constrained::All(2));
+  EXPECT(plan.compatible(constrained));
+  EXPECT(assert_equal(constrained.optimize(ordering), plan.eliminate(constrained)->optimize()));
+}
+
+/* ************************************************************************* */
+TEST(GaussianEliminationPlan, eliminateAssembled)
+{
+  GaussianFactorGraph graph = createGraph(0.5);
+  GaussianEliminationPlan plan(graph, ordering);
+  CHECK_EXCEPTION(plan.eliminateAssembled(VectorValues()), invalid_argument);
+  plan.assemble(graph);
+
+  // Without damping this is the same as eliminating the graph
+  EXPECT(assert_equal(*plan.eliminate(graph), *plan.eliminateAssembled(VectorValues())));
+
+  // Damping is the same as adding priors, x3 is not damped
+  const FastVector<Key> dampedKeys = list_of(x1)(x2)(x4)(x5);
+  for(double lambda = 1e-3; lambda < 1e3; lambda *= 10.0) {
+    VectorValues damping;
+    GaussianFactorGraph damped = graph;
+    BOOST_FOREACH(Key j, dampedKeys) {
+      Vector d = (Vector(2) << lambda, 2.0 * lambda);
+      damping.insert(j, d);
+      damped += JacobianFactor(j, Matrix(d.cwiseSqrt().asDiagonal()), zero(2), unit2);
+    }
+    EXPECT(assert_equal(*damped.eliminateMultifrontal(ordering), *plan.eliminateAssembled(damping)));
+  }
+
+  // Constrained noise models cannot be assembled
+  GaussianFactorGraph constrained = createGraph(0.5);
+  constrained.at(0) = boost::make_shared<JacobianFactor>(x1, (Matrix(2, 2) << 1., 0., 0., 1.),
+    (Vector(2) << 1., 2.), noiseModel::Constrained::All(2));
+  CHECK_EXCEPTION(plan.assemble(constrained), invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(GaussianEliminationPlan, compatible)
+{
+  GaussianFactorGraph graph = createGraph(0.5);
+  GaussianEliminationPlan plan(graph, ordering);
+  EXPECT(plan.compatible(graph));
+
+  // Different number of factors
+  GaussianFactorGraph more = graph;
+  more += JacobianFactor(x3, (Matrix(2, 2) << 1., 0., 0., 1.), (Vector(2) << 1., 2.), unit2);
+  EXPECT(!plan.compatible(more));
+
+  // Different keys
+  GaussianFactorGraph otherKeys = graph;
+  otherKeys.at(0) = boost::make_shared<JacobianFactor>(x3, (Matrix(2, 2) << 1., 0., 0., 1.), (Vector(2) << 1., 2.), unit2);
+  EXPECT(!plan.compatible(otherKeys));
+
+  // Different dimensions
+  GaussianFactorGraph otherDims = graph;
+  otherDims.at(0) = boost::make_shared<JacobianFactor>(x1, (Matrix(1, 1) << 1.), (Vector(1) << 1.));
+  EXPECT(!plan.compatible(otherDims));
+
+  // Incomplete ordering
+  Ordering incomplete = Ordering(list_of(x1)(x3)(x2)(x5));
+  CHECK_EXCEPTION(GaussianEliminationPlan(graph, incomplete), InconsistentEliminationRequested);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
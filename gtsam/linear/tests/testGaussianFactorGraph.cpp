@@ -221,6 +221,39 @@ TEST( GaussianFactorGraph, transposeMultiplication )
   EXPECT(assert_equal(expected, actual));
 }
 
+/* ************************************************************************* */
+TEST( GaussianFactorGraph, parallelMultiplication )
+{
+  GaussianFactorGraph A = createSimpleGaussianFactorGraph();
+  VectorValues x = A.optimize();
+  x[1] += (Vector(2) << 1.0, -2.0);
+
+  // e <- A*x over ranges of factors
+  Errors expected = A * x, actual = A * VectorValues::Zero(x);
+  A.multiplyInPlace(x, actual, true);
+  EXPECT(assert_equal(expected, actual));
+
+  // x += alpha*A'*e with per-thread accumulation, adding the variables x is missing
+  VectorValues expectedX = x, actualX = x;
+  A.transposeMultiplyAdd(0.5, expected, expectedX);
+  A.transposeMultiplyAdd(0.5, expected, actualX, true);
+  EXPECT(assert_equal(expectedX, actualX));
+
+  VectorValues partial;
+  partial.insert(2, (Vector(2) << 1.0, 1.0));
+  VectorValues expectedPartial = partial;
+  A.transposeMultiplyAdd(-1.0, expected, expectedPartial);
+  A.transposeMultiplyAdd(-1.0, expected, partial, true);
+  EXPECT(assert_equal(expectedPartial, partial));
+
+  // reductions on VectorValues
+  DOUBLES_EQUAL(x.dot(expectedX), dot(x, expectedX, true), 1e-9);
+  VectorValues expectedY = expectedX;
+  expectedY += 2.0 * x;
+  axpy(2.0, x, expectedX, true);
+  EXPECT(assert_equal(expectedY, expectedX));
+}
+
 /* ************************************************************************* */
 TEST(GaussianFactorGraph, eliminate_empty )
 {
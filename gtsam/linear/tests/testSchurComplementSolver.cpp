@@ -0,0 +1,153 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file testSchurComplementSolver.cpp
+ * @brief Unit tests for SchurComplementSolver
+ */
+
+#include <gtsam/linear/SchurComplementSolver.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+
+using symbol_shorthand::X;
+using symbol_shorthand::L;
+
+namespace {
+  /* ************************************************************************* */
+  // A linear bundle adjustment problem: nrCameras cameras of dimension 6 with priors and odometry
+  // as a HessianFactor, and nrPoints points of dimension 3, each measured by every camera with
+  // 2 rows, and the first one also with a prior
+  GaussianFactorGraph createGraph(size_t nrCameras, size_t nrPoints)
+  {
+    GaussianFactorGraph graph;
+    for(size_t c = 0; c < nrCameras; ++c) {
+      graph += JacobianFactor(X(c), 2.0 * eye(6), Vector::Constant(6, 0.1 * c), noiseModel::Isotropic::Sigma(6, 0.5));
+      if(c > 0)
+        graph += HessianFactor(X(c - 1), X(c), eye(6), -0.5 * eye(6), Vector::Ones(6), eye(6), Vector::Zero(6), 10.0);
+    }
+    for(size_t p = 0; p < nrPoints; ++p) {
+      for(size_t c = 0; c < nrCameras; ++c) {
+        Matrix F(2, 6), E(2, 3);
+        for(DenseIndex i = 0; i < 2; ++i) {
+          for(DenseIndex j = 0; j < 6; ++j)
+            F(i, j) = sin(double(1 + i + 2 * j + 3 * c + 5 * p));
+          for(DenseIndex j = 0; j < 3; ++j)
+            E(i, j) = cos(double((1 + 3 * i + 7 * c + 2 * p) * (j + 1)));
+        }
+        graph += JacobianFactor(X(c), F, L(p), E, Vector::Constant(2, 0.1 * double(p) - 0.2 * double(c)),
+          noiseModel::Isotropic::Sigma(2, 0.1));
+      }
+    }
+    graph += JacobianFactor(L(0), eye(3), Vector::Ones(3), noiseModel::Unit::Create(3));
+    return graph;
+  }
+}
+
+/* ************************************************************************* */
+TEST(SchurComplementSolver, structure)
+{
+  GaussianFactorGraph graph = createGraph(3, 5);
+  SchurComplementSolver solver(graph);
+  EXPECT_LONGS_EQUAL(5, solver.points().size());
+  EXPECT_LONGS_EQUAL(3, solver.cameras().size());
+  EXPECT(solver.points()[0] == L(0));
+  EXPECT(solver.cameras()[2] == X(2));
+  EXPECT(solver.compatible(graph));
+  EXPECT(!solver.compatible(createGraph(3, 4)));
+
+  // A factor between two points prevents their elimination
+  graph += JacobianFactor(L(1), eye(3), L(2), -eye(3), Vector::Zero(3), noiseModel::Unit::Create(3));
+  SchurComplementSolver constrained(graph);
+  EXPECT_LONGS_EQUAL(3, constrained.points().size());
+  EXPECT_LONGS_EQUAL(5, constrained.cameras().size());
+
+  // So does a HessianFactor on a point
+  GaussianFactorGraph hessian = createGraph(3, 5);
+  hessian += HessianFactor(L(4), eye(3), Vector::Zero(3), 0.0);
+  EXPECT_LONGS_EQUAL(4, SchurComplementSolver(hessian).points().size());
+}
+
+/* ************************************************************************* */
+TEST(SchurComplementSolver, optimize)
+{
+  const GaussianFactorGraph graph = createGraph(4, 10);
+  const VectorValues expected = graph.optimize();
+
+  SchurComplementSolver solver(graph);
+  Ordering ordering;
+  for(size_t c = 4; c > 0; --c)
+    ordering.push_back(X(c - 1));
+  EXPECT(assert_equal(expected, solver.optimize(graph, ordering), 1e-8));
+
+  // With points that are not eliminated
+  GaussianFactorGraph connected = graph;
+  connected += JacobianFactor(L(1), eye(3), L(2), -eye(3), Vector::Zero(3), noiseModel::Unit::Create(3));
+  EXPECT(assert_equal(connected.optimize(),
+    SchurComplementSolver(connected).optimize(connected, Ordering::COLAMD(connected)), 1e-8));
+}
+
+/* ************************************************************************* */
+TEST(SchurComplementSolver, optimizeImplicit)
+{
+  const GaussianFactorGraph graph = createGraph(4, 10);
+  const VectorValues expected = graph.optimize();
+
+  SchurComplementSolver solver(graph);
+  ConjugateGradientParameters parameters;
+  parameters.setEpsilon_rel(1e-12);
+  parameters.setEpsilon_abs(1e-20);
+  EXPECT(assert_equal(expected, solver.optimize(graph, parameters), 1e-6));
+
+  // The reduced camera system has dimension 24, and is well conditioned
+  EXPECT(solver.lastIterations() > 0);
+  EXPECT(solver.lastIterations() <= 24);
+}
+
+/* ************************************************************************* */
+TEST(SchurComplementSolver, reducedGraph)
+{
+  const GaussianFactorGraph graph = createGraph(3, 5);
+  const VectorValues expected = graph.optimize();
+
+  const GaussianFactorGraph reduced = SchurComplementSolver(graph).reducedGraph(graph);
+  EXPECT_LONGS_EQUAL(3 + 2 + 5, reduced.size());
+  const VectorValues actual = reduced.optimize();
+  EXPECT_LONGS_EQUAL(3, actual.size());
+  for(size_t c = 0; c < 3; ++c)
+    EXPECT(assert_equal(expected.at(X(c)), actual.at(X(c)), 1e-8));
+}
+
+/* ************************************************************************* */
+TEST(SchurComplementSolver, indeterminant)
+{
+  // A point measured by a single camera with 2 rows is not determined
+  GaussianFactorGraph graph = createGraph(2, 2);
+  graph += JacobianFactor(X(0), Matrix::Ones(2, 6), L(2), Matrix::Ones(2, 3), Vector::Zero(2),
+    noiseModel::Unit::Create(2));
+  SchurComplementSolver solver(graph);
+  Ordering ordering;
+  ordering.push_back(X(0));
+  ordering.push_back(X(1));
+  CHECK_EXCEPTION(solver.optimize(graph, ordering), IndeterminantLinearSystemException);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
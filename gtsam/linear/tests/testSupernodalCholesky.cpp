@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file testSupernodalCholesky.cpp
+ * @brief Unit tests for SupernodalCholesky
+ */
+
+#include <gtsam/linear/SupernodalCholesky.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/inference/inferenceExceptions.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <CppUnitLite/TestHarness.h>
+
+using namespace std;
+using namespace gtsam;
+
+namespace {
+  /* ************************************************************************* */
+  // A factor between i and j, with the smaller of their dimensions
+  JacobianFactor between(Key i, Key j, double s)
+  {
+    const DenseIndex di = 2 + i % 2, dj = 2 + j % 2, m = std::min(di, dj);
+    return JacobianFactor(i, Matrix::Identity(m, di) + s * Matrix::Ones(m, di) / double(j + 1),
+      j, -Matrix::Identity(m, dj), Vector::Constant(m, 0.1 * j - s), noiseModel::Unit::Create(m));
+  }
+
+  /* ************************************************************************* */
+  // A chain of n variables of alternating dimensions 2 and 3, with odometry factors, loop
+  // closures between variables 4 apart, a prior on the first variable and a HessianFactor on
+  // the last two.  Its numbers depend on s.
+  GaussianFactorGraph createGraph(size_t n, double s)
+  {
+    GaussianFactorGraph graph;
+    graph += JacobianFactor(0, eye(2), Vector::Constant(2, s), noiseModel::Unit::Create(2));
+    for(Key j = 1; j < n; ++j) {
+      graph += between(j - 1, j, s);
+      if(j >= 4)
+        graph += between(j - 4, j, s);
+    }
+    const Key a = n - 2, b = n - 1;
+    const DenseIndex da = 2 + a % 2, db = 2 + b % 2;
+    graph += HessianFactor(a, b, 2.0 * eye(da), s * Matrix::Ones(da, db), Vector::Ones(da),
+      3.0 * eye(db), Vector::Constant(db, s), 1.0);
+    return graph;
+  }
+
+  /* ************************************************************************* */
+  Ordering naturalOrdering(size_t n)
+  {
+    Ordering ordering;
+    for(Key j = 0; j < n; ++j)
+      ordering.push_back(j);
+    return ordering;
+  }
+}
+
+/* ************************************************************************* */
+TEST(SupernodalCholesky, optimize)
+{
+  const size_t n = 20;
+  GaussianFactorGraph graph = createGraph(n, 0.5);
+
+  // In natural and COLAMD order
+  Ordering orderings[] = { naturalOrdering(n), Ordering::COLAMD(graph) };
+  for(size_t o = 0; o < 2; ++o) {
+    SupernodalCholesky cholesky(graph, orderings[o]);
+    EXPECT(cholesky.nrSupernodes() < n);
+    cholesky.factorize(graph);
+    EXPECT(assert_equal(graph.optimize(orderings[o]), cholesky.optimize(), 1e-8));
+
+    // The symbolic analysis is reused for a graph with the same structure
+    GaussianFactorGraph graph2 = createGraph(n, -0.25);
+    EXPECT(cholesky.compatible(graph2));
+    cholesky.factorize(graph2);
+    EXPECT(assert_equal(graph2.optimize(orderings[o]), cholesky.optimize(), 1e-8));
+  }
+}
+
+/* ************************************************************************* */
+TEST(SupernodalCholesky, solve)
+{
+  const size_t n = 11;
+  GaussianFactorGraph graph = createGraph(n, 0.5);
+  SupernodalCholesky cholesky(graph, Ordering::COLAMD(graph));
+  CHECK_EXCEPTION(cholesky.optimize(), invalid_argument);
+  cholesky.factorize(graph);
+
+  // A'A x = rhs
+  VectorValues rhs;
+  for(Key j = 0; j < n; ++j)
+    rhs.insert(j, Vector::LinSpaced(2 + j % 2, 1.0, double(j)));
+  VectorValues x = cholesky.solve(rhs);
+  VectorValues actual = x;
+  actual.setZero();
+  graph.multiplyHessianAdd(1.0, x, actual);
+  EXPECT(assert_equal(rhs, actual, 1e-8));
+}
+
+/* ************************************************************************* */
+TEST(SupernodalCholesky, indeterminant)
+{
+  // Without the prior and the HessianFactor the graph is not positive definite
+  GaussianFactorGraph graph = createGraph(6, 0.5);
+  graph.remove(0);
+  graph.remove(graph.size() - 1);
+  SupernodalCholesky cholesky(graph, naturalOrdering(6));
+  CHECK_EXCEPTION(cholesky.factorize(graph), IndeterminantLinearSystemException);
+  CHECK_EXCEPTION(cholesky.optimize(), invalid_argument);
+
+  // Constrained noise models cannot be factored
+  graph.at(0) = boost::make_shared<JacobianFactor>(0, eye(2), zero(2), noiseModel::Constrained::All(2));
+  CHECK_EXCEPTION(cholesky.factorize(graph), invalid_argument);
+}
+
+/* ************************************************************************* */
+TEST(SupernodalCholesky, compatible)
+{
+  GaussianFactorGraph graph = createGraph(6, 0.5);
+  SupernodalCholesky cholesky(graph, naturalOrdering(6));
+  EXPECT(cholesky.compatible(graph));
+
+  GaussianFactorGraph more = graph;
+  more += JacobianFactor(3, eye(3), zero(3), noiseModel::Unit::Create(3));
+  EXPECT(!cholesky.compatible(more));
+
+  GaussianFactorGraph otherDims = graph;
+  otherDims.at(0) = boost::make_shared<JacobianFactor>(0, eye(3), zero(3), noiseModel::Unit::Create(3));
+  EXPECT(!cholesky.compatible(otherDims));
+
+  // The ordering must contain exactly the variables of the graph
+  CHECK_EXCEPTION(SupernodalCholesky(graph, naturalOrdering(5)), InconsistentEliminationRequested);
+  CHECK_EXCEPTION(SupernodalCholesky(graph, naturalOrdering(7)), InconsistentEliminationRequested);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
+/* ************************************************************************* */
@@ -17,7 +17,7 @@
 #pragma once
 
 /* GTSAM includes */
-#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/FixedNoiseModelFactor.h>
 #include <gtsam/linear/GaussianFactor.h>
 #include <gtsam/navigation/ImuBias.h>
 #include <gtsam/geometry/Pose3.h>
@@ -46,7 +46,7 @@ namespace gtsam {
    * [3] L. Carlone, S. Williams, R. Roberts, "Preintegrated IMU factor: Computation of the Jacobian Matrices", Tech. Report, 2013.
    */
 
-  class ImuFactor: public NoiseModelFactor5<Pose3,LieVector,Pose3,LieVector,imuBias::ConstantBias> {
+  class ImuFactor: public FixedNoiseModelFactor5<Pose3,LieVector,Pose3,LieVector,imuBias::ConstantBias,9> {
 
   public:
 
@@ -285,7 +285,7 @@ namespace gtsam {
   private:
 
     typedef ImuFactor This;
-    typedef NoiseModelFactor5<Pose3,LieVector,Pose3,LieVector,imuBias::ConstantBias> Base;
+    typedef FixedNoiseModelFactor5<Pose3,LieVector,Pose3,LieVector,imuBias::ConstantBias,9> Base;
 
     PreintegratedMeasurements preintegratedMeasurements_;
     Vector3 gravity_;
@@ -372,14 +372,14 @@ namespace gtsam {
 
     /** implement functions needed to derive from Factor */
 
-    /** vector of errors */
-    Vector evaluateError(const Pose3& pose_i, const LieVector& vel_i, const Pose3& pose_j, const LieVector& vel_j,
+    /** vector of errors, with fixed-size Jacobians except for the LieVector velocities */
+    ErrorVector evaluateErrorFixed(const Pose3& pose_i, const LieVector& vel_i, const Pose3& pose_j, const LieVector& vel_j,
         const imuBias::ConstantBias& bias,
-        boost::optional<Matrix&> H1 = boost::none,
-        boost::optional<Matrix&> H2 = boost::none,
-        boost::optional<Matrix&> H3 = boost::none,
-        boost::optional<Matrix&> H4 = boost::none,
-        boost::optional<Matrix&> H5 = boost::none) const
+        boost::optional<JacobianX1&> H1 = boost::none,
+        boost::optional<JacobianX2&> H2 = boost::none,
+        boost::optional<JacobianX3&> H3 = boost::none,
+        boost::optional<JacobianX4&> H4 = boost::none,
+        boost::optional<JacobianX5&> H5 = boost::none) const
     {
 
       const double& deltaTij = preintegratedMeasurements_.deltaTij;
@@ -414,8 +414,6 @@ namespace gtsam {
       const Matrix3 Jrinv_fRhat = Rot3::rightJacobianExpMapSO3inverse(Rot3::Logmap(fRhat));
 
       if(H1) {
-        H1->resize(9,6);
-
         Matrix3 dfPdPi;
         Matrix3 dfVdPi;
         if(use2ndOrderCoriolis_){
@@ -459,12 +457,11 @@ namespace gtsam {
 
       if(H3) {
 
-        H3->resize(9,6);
         (*H3) <<
             // dfP/dPosej
             Matrix3::Zero(), Rot_j.matrix(),
             // dfV/dPosej
-            Matrix::Zero(3,6),
+            Eigen::Matrix<double,3,6>::Zero(),
             // dfR/dPosej
             Jrinv_fRhat *  ( Matrix3::Identity() ), Matrix3::Zero();
       }
@@ -486,7 +483,6 @@ namespace gtsam {
         const Matrix3 Jr_JbiasOmegaIncr = Rot3::rightJacobianExpMapSO3(preintegratedMeasurements_.delRdelBiasOmega * biasOmegaIncr);
         const Matrix3 JbiasOmega = Jr_theta_bcc * Jrinv_theta_bc * Jr_JbiasOmegaIncr * preintegratedMeasurements_.delRdelBiasOmega;
 
-        H5->resize(9,6);
         (*H5) <<
             // dfP/dBias
             - Rot_i.matrix() * preintegratedMeasurements_.delPdelBiasAcc,
@@ -495,7 +491,7 @@ namespace gtsam {
             - Rot_i.matrix() * preintegratedMeasurements_.delVdelBiasAcc,
             - Rot_i.matrix() * preintegratedMeasurements_.delVdelBiasOmega,
             // dfR/dBias
-            Matrix::Zero(3,3),
+            Matrix3::Zero(),
             Jrinv_fRhat * ( - fRhat.inverse().matrix() * JbiasOmega);
       }
 
@@ -519,7 +515,7 @@ namespace gtsam {
 
       const Vector3 fR = Rot3::Logmap(fRhat);
 
-      Vector r(9); r << fp, fv, fR;
+      ErrorVector r; r << fp, fv, fR;
       return r;
     }
 
@@ -17,6 +17,7 @@
 
 #include <gtsam/navigation/ImuFactor.h>
 #include <gtsam/nonlinear/Values.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/navigation/ImuBias.h>
 #include <gtsam/geometry/Pose3.h>
@@ -234,6 +235,42 @@ TEST( ImuFactor, Error )
 //  EXPECT(assert_equal(H5e, H5a));
 }
 
+/* ************************************************************************* */
+TEST( ImuFactor, LinearizeInPlace )
+{
+  imuBias::ConstantBias bias(Vector3(0.2, 0, 0), Vector3(0.1, 0, 0.3));
+  Pose3 x1(Rot3::RzRyRx(M_PI/12.0, M_PI/6.0, M_PI/4.0), Point3(5.0, 1.0, -50.0));
+  LieVector v1((Vector(3) << 0.5, 0.0, 0.0));
+  Pose3 x2(Rot3::RzRyRx(M_PI/12.0 + M_PI/10.0, M_PI/6.0, M_PI/4.0), Point3(5.5, 1.0, -50.0));
+  LieVector v2((Vector(3) << 0.5, 0.0, 0.0));
+
+  Vector3 gravity; gravity << 0, 0, 9.81;
+  Vector3 omegaCoriolis; omegaCoriolis << 0, 0.1, 0.1;
+  Vector3 measuredOmega; measuredOmega << M_PI/10.0+0.3, 0, 0;
+  Vector3 measuredAcc = x1.rotation().unrotate(-Point3(gravity)).vector() + Vector3(0.2, 0.0, 0.0);
+  ImuFactor::PreintegratedMeasurements pre_int_data(imuBias::ConstantBias(),
+      Matrix3::Identity() * 0.01, Matrix3::Identity() * 0.001, Matrix3::Identity() * 1e-4);
+  pre_int_data.integrateMeasurement(measuredAcc, measuredOmega, 1.0);
+  ImuFactor factor(X(1), V(1), X(2), V(2), B(1), pre_int_data, gravity, omegaCoriolis);
+
+  Values values, values2;
+  values.insert(X(1), x1);
+  values.insert(V(1), v1);
+  values.insert(X(2), x2);
+  values.insert(V(2), v2);
+  values.insert(B(1), bias);
+  values2.insert(X(1), x1.retract((Vector(6) << 0.01, -0.02, 0.03, 0.1, 0.2, -0.1)));
+  values2.insert(V(1), LieVector((Vector(3) << 0.4, 0.1, 0.0)));
+  values2.insert(X(2), x2);
+  values2.insert(V(2), LieVector((Vector(3) << 0.6, 0.0, -0.1)));
+  values2.insert(B(1), imuBias::ConstantBias());
+
+  // Relinearizing in place with the fixed-size Jacobians gives the same JacobianFactor as linearize()
+  GaussianFactor::shared_ptr linear = factor.linearize(values);
+  EXPECT(factor.linearizeInPlace(values2, *linear));
+  EXPECT(assert_equal(*factor.linearize(values2), *linear, 1e-9));
+}
+
 /* ************************************************************************* */
 TEST( ImuFactor, ErrorWithBiases )
 {
@@ -21,6 +21,7 @@
 #include <gtsam/linear/GaussianBayesTree.h>
 #include <gtsam/linear/GaussianBayesNet.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/PCGSolver.h>
 #include <gtsam/linear/VectorValues.h>
 
 #include <boost/algorithm/string.hpp>
@@ -29,6 +30,21 @@ using namespace std;
 
 namespace gtsam {
 
+namespace {
+  /* ************************************************************************* */
+  // Steihaug's truncated PCG as the step of DoglegOptimizerImpl::IterateStep
+  struct SteihaugStep {
+    PCGSolver& solver;
+    const GaussianFactorGraph& gfg;
+    const KeyInfo& keyInfo;
+    SteihaugStep(PCGSolver& solver, const GaussianFactorGraph& gfg, const KeyInfo& keyInfo) :
+      solver(solver), gfg(gfg), keyInfo(keyInfo) {}
+    VectorValues operator()(double Delta, double& norm) const {
+      return solver.optimizeTrustRegion(gfg, keyInfo, std::map<Key, Vector>(), Delta, norm);
+    }
+  };
+}
+
 /* ************************************************************************* */
 DoglegParams::VerbosityDL DoglegParams::verbosityDLTranslator(const std::string &verbosityDL) const {
   std::string s = verbosityDL;  boost::algorithm::to_upper(s);
@@ -54,7 +70,7 @@ std::string DoglegParams::verbosityDLTranslator(VerbosityDL verbosityDL) const {
 void DoglegOptimizer::iterate(void) {
 
   // Linearize graph
-  GaussianFactorGraph::shared_ptr linear = graph_.linearize(state_.values);
+  GaussianFactorGraph::shared_ptr linear = linearizeGraph(state_.values, params_);
 
   // Pull out parameters we'll use
   const bool dlVerbose = (params_.verbosityDL > DoglegParams::SILENT);
@@ -77,7 +93,16 @@ void DoglegOptimizer::iterate(void) {
       dx_u, dx_n, bn, graph_, state_.values, state_.error, dlVerbose);
   }
   else if ( params_.isIterative() ) {
-    throw runtime_error("Dogleg is not currently compatible with the linear conjugate gradient solver");
+    // Steihaug's truncated PCG instead of the dogleg point, with the trust region in the norm of
+    // the preconditioner.  The linear graph itself is the quadratic model.
+    const PCGSolverParameters* pcg =
+      dynamic_cast<const PCGSolverParameters*>(params_.iterativeParams.get());
+    if ( !pcg )
+      throw runtime_error("Dogleg with an iterative solver requires PCGSolverParameters");
+    const KeyInfo keyInfo(*linear);
+    const SteihaugStep step(pcgSolver(*pcg), *linear, keyInfo);
+    result = DoglegOptimizerImpl::IterateStep(state_.Delta, DoglegOptimizerImpl::ONE_STEP_PER_ITERATION,
+      step, keyInfo.x0(), *linear, graph_, state_.values, state_.error, dlVerbose);
   }
   else {
     throw runtime_error("Optimization parameter is invalid: DoglegParams::elimination");
@@ -87,7 +112,7 @@ void DoglegOptimizer::iterate(void) {
   if(params_.verbosity >= NonlinearOptimizerParams::DELTA) result.dx_d.print("delta");
 
   // Create new state with new values and new error
-  state_.values = state_.values.retract(result.dx_d);
+  state_.values.retractInPlace(result.dx_d);
   state_.error = result.f_error;
   state_.Delta = result.Delta;
   ++state_.iterations;
@@ -96,7 +121,7 @@ void DoglegOptimizer::iterate(void) {
 /* ************************************************************************* */
 DoglegParams DoglegOptimizer::ensureHasOrdering(DoglegParams params, const NonlinearFactorGraph& graph) const {
   if(!params.ordering)
-    params.ordering = Ordering::COLAMD(graph);
+    params.ordering = params.computeOrdering(graph);
   return params;
 }
 
@@ -24,6 +24,15 @@ namespace gtsam {
 /* ************************************************************************* */
 VectorValues DoglegOptimizerImpl::ComputeDoglegPoint(
     double Delta, const VectorValues& dx_u, const VectorValues& dx_n, const bool verbose) {
+  FlatVectorValues flat_n(dx_n);
+  FlatVectorValues flat_u = FlatVectorValues::Zero(flat_n);
+  flat_u.update(dx_u);
+  return ComputeDoglegPoint(Delta, flat_u, flat_n, verbose).toVectorValues();
+}
+
+/* ************************************************************************* */
+FlatVectorValues DoglegOptimizerImpl::ComputeDoglegPoint(
+    double Delta, const FlatVectorValues& dx_u, const FlatVectorValues& dx_n, const bool verbose) {
 
   // Get magnitude of each update and find out which segment Delta falls in
   assert(Delta >= 0.0);
@@ -33,7 +42,7 @@ VectorValues DoglegOptimizerImpl::ComputeDoglegPoint(
   if(verbose) cout << "Steepest descent magnitude " << std::sqrt(x_u_norm_sq) << ", Newton's method magnitude " << std::sqrt(x_n_norm_sq) << endl;
   if(DeltaSq < x_u_norm_sq) {
     // Trust region is smaller than steepest descent update
-    VectorValues x_d = std::sqrt(DeltaSq / x_u_norm_sq) * dx_u;
+    FlatVectorValues x_d = std::sqrt(DeltaSq / x_u_norm_sq) * dx_u;
     if(verbose) cout << "In steepest descent region with fraction " << std::sqrt(DeltaSq / x_u_norm_sq) << " of steepest descent magnitude" << endl;
     return x_d;
   } else if(DeltaSq < x_n_norm_sq) {
@@ -49,13 +58,21 @@ VectorValues DoglegOptimizerImpl::ComputeDoglegPoint(
 
 /* ************************************************************************* */
 VectorValues DoglegOptimizerImpl::ComputeBlend(double Delta, const VectorValues& x_u, const VectorValues& x_n, const bool verbose) {
+  FlatVectorValues flat_n(x_n);
+  FlatVectorValues flat_u = FlatVectorValues::Zero(flat_n);
+  flat_u.update(x_u);
+  return ComputeBlend(Delta, flat_u, flat_n, verbose).toVectorValues();
+}
+
+/* ************************************************************************* */
+FlatVectorValues DoglegOptimizerImpl::ComputeBlend(double Delta, const FlatVectorValues& x_u, const FlatVectorValues& x_n, const bool verbose) {
 
   // See doc/trustregion.lyx or doc/trustregion.pdf
 
   // Compute inner products
-  const double un = dot(x_u, x_n);
-  const double uu = dot(x_u, x_u);
-  const double nn = dot(x_n, x_n);
+  const double un = x_u.dot(x_n);
+  const double uu = x_u.squaredNorm();
+  const double nn = x_n.squaredNorm();
 
   // Compute quadratic formula terms
   const double a = uu - 2.*un + nn;
@@ -78,7 +95,7 @@ VectorValues DoglegOptimizerImpl::ComputeBlend(double Delta, const VectorValues&
 
   // Compute blended point
   if(verbose) cout << "In blend region with fraction " << tau << " of Newton's method point" << endl;
-  VectorValues blend = (1. - tau) * x_u;  axpy(tau, x_n, blend);
+  FlatVectorValues blend = (1. - tau) * x_u;  axpy(tau, x_n, blend);
   return blend;
 }
 
@@ -19,6 +19,7 @@
 #include <iomanip>
 
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/FlatVectorValues.h>
 #include <gtsam/inference/Ordering.h>
 
 namespace gtsam {
@@ -96,6 +97,23 @@ struct GTSAM_EXPORT DoglegOptimizerImpl {
       double Delta, TrustRegionAdaptationMode mode, const VectorValues& dx_u, const VectorValues& dx_n,
       const M& Rd, const F& f, const VALUES& x0, const double f_error, const bool verbose=false);
 
+  /**
+   * The trust region iteration of Iterate(), with the step for a trust region radius computed by
+   * \c step instead of as the dogleg point.  This allows other solutions of the trust region
+   * subproblem, e.g. Steihaug's truncated conjugate gradient method.
+   *
+   * @tparam S A function object with <tt>VectorValues operator()(double Delta, double& norm)</tt>
+   * that returns a step within the trust region of radius \c Delta, and sets \c norm to its norm
+   * in the norm of the trust region.
+   * @param zero A VectorValues with the keys and dimensions of the step, its value is not used.
+   * @param Rd Any quadratic model with <tt>error(const VectorValues&)</tt>, e.g. the Bayes' net or
+   * tree as in Iterate(), or the linearized GaussianFactorGraph itself.
+   */
+  template<class S, class M, class F, class VALUES>
+  static IterationResult IterateStep(
+      double Delta, TrustRegionAdaptationMode mode, const S& step, const VectorValues& zero,
+      const M& Rd, const F& f, const VALUES& x0, const double f_error, const bool verbose=false);
+
   /**
    * Compute the dogleg point given a trust region radius \f$ \Delta \f$.  The
    * dogleg point is the intersection between the dogleg path and the trust
@@ -120,6 +138,10 @@ struct GTSAM_EXPORT DoglegOptimizerImpl {
    */
   static VectorValues ComputeDoglegPoint(double Delta, const VectorValues& dx_u, const VectorValues& dx_n, const bool verbose=false);
 
+  /** ComputeDoglegPoint() with \c dx_u and \c dx_n stored contiguously, which must have the same
+   * layout.  The norms, dot products and blend are then BLAS-1 operations over single Vectors. */
+  static FlatVectorValues ComputeDoglegPoint(double Delta, const FlatVectorValues& dx_u, const FlatVectorValues& dx_n, const bool verbose=false);
+
   /** Compute the point on the line between the steepest descent point and the
    * Newton's method point intersecting the trust region boundary.
    * Mathematically, computes \f$ \tau \f$ such that \f$ 0<\tau<1 \f$ and
@@ -130,6 +152,28 @@ struct GTSAM_EXPORT DoglegOptimizerImpl {
    * @param x_n Newton's method minimizer
    */
   static VectorValues ComputeBlend(double Delta, const VectorValues& x_u, const VectorValues& x_n, const bool verbose=false);
+
+  /** ComputeBlend() with \c x_u and \c x_n stored contiguously, which must have the same layout */
+  static FlatVectorValues ComputeBlend(double Delta, const FlatVectorValues& x_u, const FlatVectorValues& x_n, const bool verbose=false);
+
+  /** The dogleg point as a step function for IterateStep().  The steepest descent and Newton's
+   * method points are copied once into contiguous storage, so that each trial radius of the
+   * search only costs BLAS-1 operations and the conversion of its result to a VectorValues. */
+  struct DoglegStep {
+    FlatVectorValues dx_u;
+    FlatVectorValues dx_n;
+    const bool verbose;
+    DoglegStep(const VectorValues& dx_u, const VectorValues& dx_n, const bool verbose) :
+      dx_n(dx_n), verbose(verbose) {
+      this->dx_u = FlatVectorValues::Zero(this->dx_n);
+      this->dx_u.update(dx_u);
+    }
+    VectorValues operator()(double Delta, double& norm) const {
+      FlatVectorValues dx_d = ComputeDoglegPoint(Delta, dx_u, dx_n, verbose);
+      norm = dx_d.norm();
+      return dx_d.toVectorValues();
+    }
+  };
 };
 
 
@@ -138,9 +182,18 @@ template<class M, class F, class VALUES>
 typename DoglegOptimizerImpl::IterationResult DoglegOptimizerImpl::Iterate(
     double Delta, TrustRegionAdaptationMode mode, const VectorValues& dx_u, const VectorValues& dx_n,
     const M& Rd, const F& f, const VALUES& x0, const double f_error, const bool verbose)
+{
+  return IterateStep(Delta, mode, DoglegStep(dx_u, dx_n, verbose), dx_u, Rd, f, x0, f_error, verbose);
+}
+
+/* ************************************************************************* */
+template<class S, class M, class F, class VALUES>
+typename DoglegOptimizerImpl::IterationResult DoglegOptimizerImpl::IterateStep(
+    double Delta, TrustRegionAdaptationMode mode, const S& step, const VectorValues& zero,
+    const M& Rd, const F& f, const VALUES& x0, const double f_error, const bool verbose)
 {
   gttic(M_error);
-  const double M_error = Rd.error(VectorValues::Zero(dx_u));
+  const double M_error = Rd.error(VectorValues::Zero(zero));
   gttoc(M_error);
 
   // Result to return
@@ -150,11 +203,12 @@ typename DoglegOptimizerImpl::IterationResult DoglegOptimizerImpl::Iterate(
   enum { NONE, INCREASED_DELTA, DECREASED_DELTA } lastAction = NONE; // Used to prevent alternating between increasing and decreasing in one iteration
   while(stay) {
     gttic(Dog_leg_point);
-    // Compute dog leg point
-    result.dx_d = ComputeDoglegPoint(Delta, dx_u, dx_n, verbose);
+    // Compute dog leg point, or the step of the trust region subproblem
+    double dx_d_norm;
+    result.dx_d = step(Delta, dx_d_norm);
     gttoc(Dog_leg_point);
 
-    if(verbose) std::cout << "Delta = " << Delta << ", dx_d_norm = " << result.dx_d.norm() << std::endl;
+    if(verbose) std::cout << "Delta = " << Delta << ", dx_d_norm = " << dx_d_norm << std::endl;
 
     gttic(retract);
     // Compute expmapped solution
@@ -185,7 +239,6 @@ typename DoglegOptimizerImpl::IterationResult DoglegOptimizerImpl::Iterate(
 
     if(rho >= 0.75) {
       // M agrees very well with f, so try to increase lambda
-      const double dx_d_norm = result.dx_d.norm();
       const double newDelta = std::max(Delta, 3.0 * dx_d_norm); // Compute new Delta
 
       if(mode == ONE_STEP_PER_ITERATION || mode == SEARCH_REDUCE_ONLY)
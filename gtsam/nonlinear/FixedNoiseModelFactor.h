@@ -0,0 +1,750 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file FixedNoiseModelFactor.h
+ * @brief NoiseModelFactor1..6 variants with compile-time fixed-size Jacobians
+ */
+
+// \callgraph
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/base/Manifold.h>
+
+namespace gtsam {
+
+namespace internal {
+
+  /**
+   * The part of FixedNoiseModelFactorN::linearizeInPlace() that does not depend on the number of
+   * variables.  The constructor checks whether \c factor, created by linearize() on \c nonlinear,
+   * can be overwritten directly with the fixed-size Jacobians: it must be a JacobianFactor on the
+   * same keys without a noise model, \c nonlinear must be active and its noise model, if any, a
+   * Gaussian that is not constrained.  Otherwise direct() is false and the general
+   * NoiseModelFactor::linearizeInPlace has to be used.  The factor then evaluates its Jacobians,
+   * checks them with fits(), and passes them to write() and the error to finish(), which
+   * whitens the augmented matrix in place.
+   */
+  template<int ZDIM>
+  class FixedLinearization {
+  public:
+    FixedLinearization(const NoiseModelFactor& nonlinear, const Values& x, GaussianFactor& factor) :
+      jacobian_(0), whitener_(0)
+    {
+      JacobianFactor* jacobian = dynamic_cast<JacobianFactor*>(&factor);
+      if(ZDIM == Eigen::Dynamic || !jacobian || jacobian->get_model() ||
+        jacobian->keys() != nonlinear.keys() || !nonlinear.active(x))
+        return;
+
+      // Whitening in place is only possible with Gaussian noise models that do not depend on the
+      // error (i.e. not robust) and do not keep a noise model (i.e. not constrained)
+      const SharedNoiseModel& noiseModel = nonlinear.get_noiseModel();
+      whitener_ = dynamic_cast<const noiseModel::Gaussian*>(noiseModel.get());
+      if(noiseModel && (!whitener_ || whitener_->isConstrained()))
+        return;
+      jacobian_ = jacobian;
+    }
+
+    /** Whether the Jacobians can be written into the factor directly */
+    bool direct() const { return jacobian_ != 0; }
+
+    /** Whether the Jacobian H of the j-th variable has the size of its block in the factor */
+    template<class JACOBIAN>
+    bool fits(size_t j, const JACOBIAN& H) const {
+      const VerticalBlockMatrix& Ab = jacobian_->matrixObject();
+      return H.rows() == Ab.rows() && H.cols() == Ab(j).cols();
+    }
+
+    /** Write the Jacobian of the j-th variable, which fits() */
+    template<class JACOBIAN>
+    void write(size_t j, const JACOBIAN& H) {
+      jacobian_->matrixObject()(j) = H;
+    }
+
+    /** Write the right-hand side -error and whiten the augmented matrix */
+    template<class ERROR>
+    bool finish(const ERROR& error) {
+      jacobian_->getb() = -error;
+      if(whitener_)
+        whitener_->WhitenInPlace(jacobian_->matrixObject().full());
+      return true;
+    }
+
+  private:
+    JacobianFactor* jacobian_;
+    const noiseModel::Gaussian* whitener_;
+  };
+
+}
+
+/* ************************************************************************* */
+/**
+ * A NoiseModelFactor1 whose error dimension ZDIM and Jacobians are fixed at compile time.  To
+ * derive from this class, implement evaluateErrorFixed(), which works with stack-allocated
+ * Eigen::Matrix<double, ZDIM, dim(X)> Jacobians, with dim(X) given by traits::dimension.
+ * The NoiseModelFactor1::evaluateError() interface is implemented as an adapter on top of it,
+ * and linearizeInPlace() writes the fixed-size Jacobians directly into the JacobianFactor
+ * without any dynamic temporaries.  Any of the dimensions may be Eigen::Dynamic, in which case
+ * the corresponding matrices are dynamic as in NoiseModelFactor1.  FixedNoiseModelFactor2..6
+ * are the same for more variables.
+ */
+template<class VALUE, int ZDIM>
+class FixedNoiseModelFactor1: public NoiseModelFactor1<VALUE> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE X;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { XDim = traits::dimension<X>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, XDim> JacobianX; ///< Jacobian with respect to X
+
+protected:
+
+  typedef NoiseModelFactor1<VALUE> Base;
+  typedef FixedNoiseModelFactor1<VALUE, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor1() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   */
+  FixedNoiseModelFactor1(const SharedNoiseModel& noiseModel, Key j1) :
+    Base(noiseModel, j1) {}
+
+  virtual ~FixedNoiseModelFactor1() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X&,
+      boost::optional<JacobianX&> H = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor1, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X& x1,
+      boost::optional<Matrix&> H = boost::none) const {
+    if(H) {
+      JacobianX H_;
+      const ErrorVector error = evaluateErrorFixed(x1, H_);
+      if(H) *H = H_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1);
+    }
+  }
+
+  /**
+   * Linearize into an existing JacobianFactor created by linearize() on this factor, evaluating
+   * the fixed-size Jacobians directly into its augmented matrix, see
+   * internal::FixedLinearization.  Falls back to NoiseModelFactor::linearizeInPlace if the error
+   * dimension is dynamic or the noise model is not a plain Gaussian.  Jacobians with respect to
+   * variables of dynamic dimension are allocated per call.
+   */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX H;
+    const ErrorVector error = evaluateErrorFixed(x.at<X>(this->keys_[0]),
+      H);
+    if(!linearization.fits(0, H))
+      return false;
+    linearization.write(0, H);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor1",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor1
+
+/* ************************************************************************* */
+/** A NoiseModelFactor2 with fixed-size Jacobians, see FixedNoiseModelFactor1 */
+template<class VALUE1, class VALUE2, int ZDIM>
+class FixedNoiseModelFactor2: public NoiseModelFactor2<VALUE1, VALUE2> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE1 X1;
+  typedef VALUE2 X2;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { X1Dim = traits::dimension<X1>::value };
+  enum { X2Dim = traits::dimension<X2>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, X1Dim> JacobianX1; ///< Jacobian with respect to X1
+  typedef Eigen::Matrix<double, ZDim, X2Dim> JacobianX2; ///< Jacobian with respect to X2
+
+protected:
+
+  typedef NoiseModelFactor2<VALUE1, VALUE2> Base;
+  typedef FixedNoiseModelFactor2<VALUE1, VALUE2, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor2() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   * @param j2 key of the second variable
+   */
+  FixedNoiseModelFactor2(const SharedNoiseModel& noiseModel, Key j1, Key j2) :
+    Base(noiseModel, j1, j2) {}
+
+  virtual ~FixedNoiseModelFactor2() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X1&, const X2&,
+      boost::optional<JacobianX1&> H1 = boost::none,
+      boost::optional<JacobianX2&> H2 = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor2, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X1& x1, const X2& x2,
+      boost::optional<Matrix&> H1 = boost::none,
+      boost::optional<Matrix&> H2 = boost::none) const {
+    if(H1 || H2) {
+      JacobianX1 H1_; JacobianX2 H2_;
+      const ErrorVector error = evaluateErrorFixed(x1, x2, H1_, H2_);
+      if(H1) *H1 = H1_;
+      if(H2) *H2 = H2_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1, x2);
+    }
+  }
+
+  /** Linearize with the fixed-size Jacobians, see FixedNoiseModelFactor1::linearizeInPlace() */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX1 H1; JacobianX2 H2;
+    const ErrorVector error = evaluateErrorFixed(x.at<X1>(this->keys_[0]), x.at<X2>(this->keys_[1]),
+      H1, H2);
+    if(!linearization.fits(0, H1) ||
+      !linearization.fits(1, H2))
+      return false;
+    linearization.write(0, H1);
+    linearization.write(1, H2);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor2",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor2
+
+/* ************************************************************************* */
+/** A NoiseModelFactor3 with fixed-size Jacobians, see FixedNoiseModelFactor1 */
+template<class VALUE1, class VALUE2, class VALUE3, int ZDIM>
+class FixedNoiseModelFactor3: public NoiseModelFactor3<VALUE1, VALUE2, VALUE3> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE1 X1;
+  typedef VALUE2 X2;
+  typedef VALUE3 X3;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { X1Dim = traits::dimension<X1>::value };
+  enum { X2Dim = traits::dimension<X2>::value };
+  enum { X3Dim = traits::dimension<X3>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, X1Dim> JacobianX1; ///< Jacobian with respect to X1
+  typedef Eigen::Matrix<double, ZDim, X2Dim> JacobianX2; ///< Jacobian with respect to X2
+  typedef Eigen::Matrix<double, ZDim, X3Dim> JacobianX3; ///< Jacobian with respect to X3
+
+protected:
+
+  typedef NoiseModelFactor3<VALUE1, VALUE2, VALUE3> Base;
+  typedef FixedNoiseModelFactor3<VALUE1, VALUE2, VALUE3, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor3() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   * @param j2 key of the second variable
+   * @param j3 key of the third variable
+   */
+  FixedNoiseModelFactor3(const SharedNoiseModel& noiseModel, Key j1, Key j2, Key j3) :
+    Base(noiseModel, j1, j2, j3) {}
+
+  virtual ~FixedNoiseModelFactor3() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X1&, const X2&, const X3&,
+      boost::optional<JacobianX1&> H1 = boost::none,
+      boost::optional<JacobianX2&> H2 = boost::none,
+      boost::optional<JacobianX3&> H3 = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor3, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X1& x1, const X2& x2, const X3& x3,
+      boost::optional<Matrix&> H1 = boost::none,
+      boost::optional<Matrix&> H2 = boost::none,
+      boost::optional<Matrix&> H3 = boost::none) const {
+    if(H1 || H2 || H3) {
+      JacobianX1 H1_; JacobianX2 H2_; JacobianX3 H3_;
+      const ErrorVector error = evaluateErrorFixed(x1, x2, x3, H1_, H2_, H3_);
+      if(H1) *H1 = H1_;
+      if(H2) *H2 = H2_;
+      if(H3) *H3 = H3_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1, x2, x3);
+    }
+  }
+
+  /** Linearize with the fixed-size Jacobians, see FixedNoiseModelFactor1::linearizeInPlace() */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX1 H1; JacobianX2 H2; JacobianX3 H3;
+    const ErrorVector error = evaluateErrorFixed(x.at<X1>(this->keys_[0]), x.at<X2>(this->keys_[1]), x.at<X3>(this->keys_[2]),
+      H1, H2, H3);
+    if(!linearization.fits(0, H1) ||
+      !linearization.fits(1, H2) ||
+      !linearization.fits(2, H3))
+      return false;
+    linearization.write(0, H1);
+    linearization.write(1, H2);
+    linearization.write(2, H3);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor3",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor3
+
+/* ************************************************************************* */
+/** A NoiseModelFactor4 with fixed-size Jacobians, see FixedNoiseModelFactor1 */
+template<class VALUE1, class VALUE2, class VALUE3, class VALUE4, int ZDIM>
+class FixedNoiseModelFactor4: public NoiseModelFactor4<VALUE1, VALUE2, VALUE3, VALUE4> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE1 X1;
+  typedef VALUE2 X2;
+  typedef VALUE3 X3;
+  typedef VALUE4 X4;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { X1Dim = traits::dimension<X1>::value };
+  enum { X2Dim = traits::dimension<X2>::value };
+  enum { X3Dim = traits::dimension<X3>::value };
+  enum { X4Dim = traits::dimension<X4>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, X1Dim> JacobianX1; ///< Jacobian with respect to X1
+  typedef Eigen::Matrix<double, ZDim, X2Dim> JacobianX2; ///< Jacobian with respect to X2
+  typedef Eigen::Matrix<double, ZDim, X3Dim> JacobianX3; ///< Jacobian with respect to X3
+  typedef Eigen::Matrix<double, ZDim, X4Dim> JacobianX4; ///< Jacobian with respect to X4
+
+protected:
+
+  typedef NoiseModelFactor4<VALUE1, VALUE2, VALUE3, VALUE4> Base;
+  typedef FixedNoiseModelFactor4<VALUE1, VALUE2, VALUE3, VALUE4, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor4() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   * @param j2 key of the second variable
+   * @param j3 key of the third variable
+   * @param j4 key of the fourth variable
+   */
+  FixedNoiseModelFactor4(const SharedNoiseModel& noiseModel, Key j1, Key j2, Key j3, Key j4) :
+    Base(noiseModel, j1, j2, j3, j4) {}
+
+  virtual ~FixedNoiseModelFactor4() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X1&, const X2&, const X3&, const X4&,
+      boost::optional<JacobianX1&> H1 = boost::none,
+      boost::optional<JacobianX2&> H2 = boost::none,
+      boost::optional<JacobianX3&> H3 = boost::none,
+      boost::optional<JacobianX4&> H4 = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor4, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X1& x1, const X2& x2, const X3& x3, const X4& x4,
+      boost::optional<Matrix&> H1 = boost::none,
+      boost::optional<Matrix&> H2 = boost::none,
+      boost::optional<Matrix&> H3 = boost::none,
+      boost::optional<Matrix&> H4 = boost::none) const {
+    if(H1 || H2 || H3 || H4) {
+      JacobianX1 H1_; JacobianX2 H2_; JacobianX3 H3_; JacobianX4 H4_;
+      const ErrorVector error = evaluateErrorFixed(x1, x2, x3, x4, H1_, H2_, H3_, H4_);
+      if(H1) *H1 = H1_;
+      if(H2) *H2 = H2_;
+      if(H3) *H3 = H3_;
+      if(H4) *H4 = H4_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1, x2, x3, x4);
+    }
+  }
+
+  /** Linearize with the fixed-size Jacobians, see FixedNoiseModelFactor1::linearizeInPlace() */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX1 H1; JacobianX2 H2; JacobianX3 H3; JacobianX4 H4;
+    const ErrorVector error = evaluateErrorFixed(x.at<X1>(this->keys_[0]), x.at<X2>(this->keys_[1]), x.at<X3>(this->keys_[2]), x.at<X4>(this->keys_[3]),
+      H1, H2, H3, H4);
+    if(!linearization.fits(0, H1) ||
+      !linearization.fits(1, H2) ||
+      !linearization.fits(2, H3) ||
+      !linearization.fits(3, H4))
+      return false;
+    linearization.write(0, H1);
+    linearization.write(1, H2);
+    linearization.write(2, H3);
+    linearization.write(3, H4);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor4",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor4
+
+/* ************************************************************************* */
+/** A NoiseModelFactor5 with fixed-size Jacobians, see FixedNoiseModelFactor1 */
+template<class VALUE1, class VALUE2, class VALUE3, class VALUE4, class VALUE5, int ZDIM>
+class FixedNoiseModelFactor5: public NoiseModelFactor5<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE1 X1;
+  typedef VALUE2 X2;
+  typedef VALUE3 X3;
+  typedef VALUE4 X4;
+  typedef VALUE5 X5;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { X1Dim = traits::dimension<X1>::value };
+  enum { X2Dim = traits::dimension<X2>::value };
+  enum { X3Dim = traits::dimension<X3>::value };
+  enum { X4Dim = traits::dimension<X4>::value };
+  enum { X5Dim = traits::dimension<X5>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, X1Dim> JacobianX1; ///< Jacobian with respect to X1
+  typedef Eigen::Matrix<double, ZDim, X2Dim> JacobianX2; ///< Jacobian with respect to X2
+  typedef Eigen::Matrix<double, ZDim, X3Dim> JacobianX3; ///< Jacobian with respect to X3
+  typedef Eigen::Matrix<double, ZDim, X4Dim> JacobianX4; ///< Jacobian with respect to X4
+  typedef Eigen::Matrix<double, ZDim, X5Dim> JacobianX5; ///< Jacobian with respect to X5
+
+protected:
+
+  typedef NoiseModelFactor5<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5> Base;
+  typedef FixedNoiseModelFactor5<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor5() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   * @param j2 key of the second variable
+   * @param j3 key of the third variable
+   * @param j4 key of the fourth variable
+   * @param j5 key of the fifth variable
+   */
+  FixedNoiseModelFactor5(const SharedNoiseModel& noiseModel, Key j1, Key j2, Key j3, Key j4, Key j5) :
+    Base(noiseModel, j1, j2, j3, j4, j5) {}
+
+  virtual ~FixedNoiseModelFactor5() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X1&, const X2&, const X3&, const X4&, const X5&,
+      boost::optional<JacobianX1&> H1 = boost::none,
+      boost::optional<JacobianX2&> H2 = boost::none,
+      boost::optional<JacobianX3&> H3 = boost::none,
+      boost::optional<JacobianX4&> H4 = boost::none,
+      boost::optional<JacobianX5&> H5 = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor5, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X1& x1, const X2& x2, const X3& x3, const X4& x4, const X5& x5,
+      boost::optional<Matrix&> H1 = boost::none,
+      boost::optional<Matrix&> H2 = boost::none,
+      boost::optional<Matrix&> H3 = boost::none,
+      boost::optional<Matrix&> H4 = boost::none,
+      boost::optional<Matrix&> H5 = boost::none) const {
+    if(H1 || H2 || H3 || H4 || H5) {
+      JacobianX1 H1_; JacobianX2 H2_; JacobianX3 H3_; JacobianX4 H4_; JacobianX5 H5_;
+      const ErrorVector error = evaluateErrorFixed(x1, x2, x3, x4, x5, H1_, H2_, H3_, H4_, H5_);
+      if(H1) *H1 = H1_;
+      if(H2) *H2 = H2_;
+      if(H3) *H3 = H3_;
+      if(H4) *H4 = H4_;
+      if(H5) *H5 = H5_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1, x2, x3, x4, x5);
+    }
+  }
+
+  /** Linearize with the fixed-size Jacobians, see FixedNoiseModelFactor1::linearizeInPlace() */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX1 H1; JacobianX2 H2; JacobianX3 H3; JacobianX4 H4; JacobianX5 H5;
+    const ErrorVector error = evaluateErrorFixed(x.at<X1>(this->keys_[0]), x.at<X2>(this->keys_[1]), x.at<X3>(this->keys_[2]), x.at<X4>(this->keys_[3]), x.at<X5>(this->keys_[4]),
+      H1, H2, H3, H4, H5);
+    if(!linearization.fits(0, H1) ||
+      !linearization.fits(1, H2) ||
+      !linearization.fits(2, H3) ||
+      !linearization.fits(3, H4) ||
+      !linearization.fits(4, H5))
+      return false;
+    linearization.write(0, H1);
+    linearization.write(1, H2);
+    linearization.write(2, H3);
+    linearization.write(3, H4);
+    linearization.write(4, H5);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor5",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor5
+
+/* ************************************************************************* */
+/** A NoiseModelFactor6 with fixed-size Jacobians, see FixedNoiseModelFactor1 */
+template<class VALUE1, class VALUE2, class VALUE3, class VALUE4, class VALUE5, class VALUE6, int ZDIM>
+class FixedNoiseModelFactor6: public NoiseModelFactor6<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5, VALUE6> {
+
+public:
+
+  // typedefs for value types pulled from keys
+  typedef VALUE1 X1;
+  typedef VALUE2 X2;
+  typedef VALUE3 X3;
+  typedef VALUE4 X4;
+  typedef VALUE5 X5;
+  typedef VALUE6 X6;
+
+  // compile-time dimensions and fixed-size types
+  enum { ZDim = ZDIM };
+  enum { X1Dim = traits::dimension<X1>::value };
+  enum { X2Dim = traits::dimension<X2>::value };
+  enum { X3Dim = traits::dimension<X3>::value };
+  enum { X4Dim = traits::dimension<X4>::value };
+  enum { X5Dim = traits::dimension<X5>::value };
+  enum { X6Dim = traits::dimension<X6>::value };
+  typedef Eigen::Matrix<double, ZDim, 1> ErrorVector; ///< Error vector
+  typedef Eigen::Matrix<double, ZDim, X1Dim> JacobianX1; ///< Jacobian with respect to X1
+  typedef Eigen::Matrix<double, ZDim, X2Dim> JacobianX2; ///< Jacobian with respect to X2
+  typedef Eigen::Matrix<double, ZDim, X3Dim> JacobianX3; ///< Jacobian with respect to X3
+  typedef Eigen::Matrix<double, ZDim, X4Dim> JacobianX4; ///< Jacobian with respect to X4
+  typedef Eigen::Matrix<double, ZDim, X5Dim> JacobianX5; ///< Jacobian with respect to X5
+  typedef Eigen::Matrix<double, ZDim, X6Dim> JacobianX6; ///< Jacobian with respect to X6
+
+protected:
+
+  typedef NoiseModelFactor6<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5, VALUE6> Base;
+  typedef FixedNoiseModelFactor6<VALUE1, VALUE2, VALUE3, VALUE4, VALUE5, VALUE6, ZDIM> This;
+
+public:
+
+  /** Default constructor for I/O only */
+  FixedNoiseModelFactor6() {}
+
+  /**
+   * Constructor
+   * @param noiseModel shared pointer to noise model
+   * @param j1 key of the first variable
+   * @param j2 key of the second variable
+   * @param j3 key of the third variable
+   * @param j4 key of the fourth variable
+   * @param j5 key of the fifth variable
+   * @param j6 key of the sixth variable
+   */
+  FixedNoiseModelFactor6(const SharedNoiseModel& noiseModel, Key j1, Key j2, Key j3, Key j4, Key j5, Key j6) :
+    Base(noiseModel, j1, j2, j3, j4, j5, j6) {}
+
+  virtual ~FixedNoiseModelFactor6() {}
+
+  /**
+   *  Override this method to finish implementing the factor, with fixed-size Jacobians.
+   *  If any of the optional Jacobian reference arguments are specified, it should compute
+   *  both the function evaluation and its derivative(s).
+   */
+  virtual ErrorVector
+  evaluateErrorFixed(const X1&, const X2&, const X3&, const X4&, const X5&, const X6&,
+      boost::optional<JacobianX1&> H1 = boost::none,
+      boost::optional<JacobianX2&> H2 = boost::none,
+      boost::optional<JacobianX3&> H3 = boost::none,
+      boost::optional<JacobianX4&> H4 = boost::none,
+      boost::optional<JacobianX5&> H5 = boost::none,
+      boost::optional<JacobianX6&> H6 = boost::none) const = 0;
+
+  /** Adapter to the dynamic-size interface of NoiseModelFactor6, calls evaluateErrorFixed() */
+  virtual Vector
+  evaluateError(const X1& x1, const X2& x2, const X3& x3, const X4& x4, const X5& x5, const X6& x6,
+      boost::optional<Matrix&> H1 = boost::none,
+      boost::optional<Matrix&> H2 = boost::none,
+      boost::optional<Matrix&> H3 = boost::none,
+      boost::optional<Matrix&> H4 = boost::none,
+      boost::optional<Matrix&> H5 = boost::none,
+      boost::optional<Matrix&> H6 = boost::none) const {
+    if(H1 || H2 || H3 || H4 || H5 || H6) {
+      JacobianX1 H1_; JacobianX2 H2_; JacobianX3 H3_; JacobianX4 H4_; JacobianX5 H5_; JacobianX6 H6_;
+      const ErrorVector error = evaluateErrorFixed(x1, x2, x3, x4, x5, x6, H1_, H2_, H3_, H4_, H5_, H6_);
+      if(H1) *H1 = H1_;
+      if(H2) *H2 = H2_;
+      if(H3) *H3 = H3_;
+      if(H4) *H4 = H4_;
+      if(H5) *H5 = H5_;
+      if(H6) *H6 = H6_;
+      return error;
+    } else {
+      return evaluateErrorFixed(x1, x2, x3, x4, x5, x6);
+    }
+  }
+
+  /** Linearize with the fixed-size Jacobians, see FixedNoiseModelFactor1::linearizeInPlace() */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    internal::FixedLinearization<ZDim> linearization(*this, x, factor);
+    if(!linearization.direct())
+      return Base::linearizeInPlace(x, factor);
+
+    JacobianX1 H1; JacobianX2 H2; JacobianX3 H3; JacobianX4 H4; JacobianX5 H5; JacobianX6 H6;
+    const ErrorVector error = evaluateErrorFixed(x.at<X1>(this->keys_[0]), x.at<X2>(this->keys_[1]), x.at<X3>(this->keys_[2]), x.at<X4>(this->keys_[3]), x.at<X5>(this->keys_[4]), x.at<X6>(this->keys_[5]),
+      H1, H2, H3, H4, H5, H6);
+    if(!linearization.fits(0, H1) ||
+      !linearization.fits(1, H2) ||
+      !linearization.fits(2, H3) ||
+      !linearization.fits(3, H4) ||
+      !linearization.fits(4, H5) ||
+      !linearization.fits(5, H6))
+      return false;
+    linearization.write(0, H1);
+    linearization.write(1, H2);
+    linearization.write(2, H3);
+    linearization.write(3, H4);
+    linearization.write(4, H5);
+    linearization.write(5, H6);
+    return linearization.finish(error);
+  }
+
+private:
+
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template<class ARCHIVE>
+  void serialize(ARCHIVE & ar, const unsigned int version) {
+    ar & boost::serialization::make_nvp("NoiseModelFactor6",
+        boost::serialization::base_object<Base>(*this));
+  }
+}; // \class FixedNoiseModelFactor6
+
+} // \namespace gtsam
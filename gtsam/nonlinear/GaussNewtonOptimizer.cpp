@@ -30,7 +30,7 @@ void GaussNewtonOptimizer::iterate() {
   const NonlinearOptimizerState& current = state_;
 
   // Linearize graph
-  GaussianFactorGraph::shared_ptr linear = graph_.linearize(current.values);
+  GaussianFactorGraph::shared_ptr linear = linearizeGraph(current.values, params_);
 
   // Solve Factor Graph
   const VectorValues delta = solve(*linear, current.values, params_);
@@ -39,7 +39,7 @@ void GaussNewtonOptimizer::iterate() {
   if(params_.verbosity >= NonlinearOptimizerParams::DELTA) delta.print("delta");
 
   // Create new state with new values and new error
-  state_.values = current.values.retract(delta);
+  state_.values.retractInPlace(delta);
   state_.error = graph_.error(state_.values);
   ++ state_.iterations;
 }
@@ -49,7 +49,7 @@ GaussNewtonParams GaussNewtonOptimizer::ensureHasOrdering(
   GaussNewtonParams params, const NonlinearFactorGraph& graph) const
 {
   if(!params.ordering)
-    params.ordering = Ordering::COLAMD(graph);
+    params.ordering = params.computeOrdering(graph);
   return params;
 }
 
@@ -22,6 +22,14 @@
 #include <functional>
 #include <boost/range/adaptors.hpp>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/tbb.h>
+#  include <tbb/concurrent_unordered_set.h>
+#  undef max // TBB seems to include windows.h and we don't want these macros
+#  undef min
+#  undef ERROR
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -249,9 +257,7 @@ void ISAM2::Impl::ExpmapMasked(Values& values, const VectorValues& delta,
     assert(delta[var].size() == (int)key_value->value.dim());
     assert(delta[var].allFinite());
     if(mask.exists(var)) {
-      Value* retracted = key_value->value.retract_(delta[var]);
-      key_value->value = *retracted;
-      retracted->deallocate_();
+      key_value->value.retractInPlace_(delta[var]);
       if(invalidateIfDebug)
         (*invalidateIfDebug)[var].operator=(Vector::Constant(delta[var].rows(), numeric_limits<double>::infinity())); // Strange syntax to work with clang++ (bug in clang?)
     }
@@ -270,12 +276,131 @@ inline static void optimizeInPlace(const boost::shared_ptr<ISAM2Clique>& clique,
 }
 }
 
+/* ************************************************************************* */
+#ifdef GTSAM_USE_TBB
+namespace internal {
+
+// Cliques whose subtree is smaller than this are back-substituted in the task of their parent
+static const int backSubstitutionProblemSizeThreshold = 10;
+
+// Data shared by all back-substitution tasks
+struct BackSubstitutionData {
+  double threshold; // wildfire threshold, or <= 0 to solve every clique
+  const FastSet<Key>& replaced;
+  VectorValues& delta;
+  tbb::concurrent_unordered_set<Key> changed;
+  tbb::atomic<size_t> count;
+  BackSubstitutionData(double threshold, const FastSet<Key>& replaced, VectorValues& delta) :
+    threshold(threshold), replaced(replaced), delta(delta) { count = 0; }
+};
+
+// Top-down back-substitution task - solves one clique, then spawns one task per child since the
+// solution of the children's separators is now known.  With a positive threshold, children are
+// only visited if optimizeWildfireNode decided to recalculate this clique, exactly as in the
+// serial optimizeWildfireNonRecursive.  Each task only writes the frontal variables of its own
+// clique, and VectorValues is a concurrent map when compiled with TBB, so no locking is needed.
+class BackSubstitutionTask : public tbb::task
+{
+  const ISAM2::sharedClique& clique_;
+  BackSubstitutionData& data_;
+  bool makeNewTasks_;
+
+public:
+  BackSubstitutionTask(const ISAM2::sharedClique& clique, BackSubstitutionData& data, bool makeNewTasks = true) :
+    clique_(clique), data_(data), makeNewTasks_(makeNewTasks) {}
+
+  tbb::task* execute()
+  {
+    if(makeNewTasks_)
+    {
+      if(processNode(clique_) && !clique_->children.empty())
+      {
+        tbb::task_list childTasks;
+        BOOST_FOREACH(const ISAM2::sharedClique& child, clique_->children) {
+          // Each child decides from the size of its own subtree whether it spawns further tasks
+          const bool overThreshold = (child->problemSize() >= backSubstitutionProblemSizeThreshold);
+          childTasks.push_back(*new(allocate_child()) BackSubstitutionTask(child, data_, overThreshold));
+        }
+        set_ref_count(1 + (int)clique_->children.size());
+        spawn_and_wait_for_all(childTasks);
+      }
+    }
+    else
+    {
+      processNodeRecursively(clique_);
+    }
+    return NULL;
+  }
+
+private:
+  // Solve one clique, returns whether its children need to be visited
+  bool processNode(const ISAM2::sharedClique& clique)
+  {
+    size_t count = 0;
+    bool recalculate;
+    if(data_.threshold <= 0.0) {
+      data_.delta.update(clique->conditional()->solve(data_.delta));
+      count = clique->conditional()->nrFrontals();
+      recalculate = true;
+    } else {
+      recalculate = optimizeWildfireNode(clique, data_.threshold, data_.changed, data_.replaced, data_.delta, count);
+    }
+    data_.count += count;
+    return recalculate;
+  }
+
+  void processNodeRecursively(const ISAM2::sharedClique& clique)
+  {
+    if(processNode(clique)) {
+      BOOST_FOREACH(const ISAM2::sharedClique& child, clique->children)
+        processNodeRecursively(child);
+    }
+  }
+};
+
+// Root task - spawns a back-substitution task for each root and waits for them all
+class BackSubstitutionRootTask : public tbb::task
+{
+  const FastVector<ISAM2::sharedClique>& roots_;
+  BackSubstitutionData& data_;
+
+public:
+  BackSubstitutionRootTask(const FastVector<ISAM2::sharedClique>& roots, BackSubstitutionData& data) :
+    roots_(roots), data_(data) {}
+
+  tbb::task* execute()
+  {
+    tbb::task_list tasks;
+    BOOST_FOREACH(const ISAM2::sharedClique& root, roots_)
+      tasks.push_back(*new(allocate_child()) BackSubstitutionTask(root, data_));
+    set_ref_count(1 + (int)roots_.size());
+    spawn_and_wait_for_all(tasks);
+    return NULL;
+  }
+};
+
+}
+#endif
+
 /* ************************************************************************* */
 size_t ISAM2::Impl::UpdateGaussNewtonDelta(const FastVector<ISAM2::sharedClique>& roots,
     const FastSet<Key>& replacedKeys, VectorValues& delta, double wildfireThreshold) {
 
   size_t lastBacksubVariableCount;
 
+#ifdef GTSAM_USE_TBB
+
+  // Parallel top-down back-substitution, see internal::BackSubstitutionTask
+  internal::BackSubstitutionData data(wildfireThreshold, replacedKeys, delta);
+  {
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::task::spawn_root_and_wait(*new(tbb::task::allocate_root())
+      internal::BackSubstitutionRootTask(roots, data));
+  }
+  lastBacksubVariableCount = (wildfireThreshold <= 0.0) ? delta.size() : size_t(data.count);
+
+#else
+
   if (wildfireThreshold <= 0.0) {
     // Threshold is zero or less, so do a full recalculation
     BOOST_FOREACH(const ISAM2::sharedClique& root, roots)
@@ -288,12 +413,16 @@ size_t ISAM2::Impl::UpdateGaussNewtonDelta(const FastVector<ISAM2::sharedClique>
     BOOST_FOREACH(const ISAM2::sharedClique& root, roots)
       lastBacksubVariableCount += optimizeWildfireNonRecursive(
       root, wildfireThreshold, replacedKeys, delta); // modifies delta
+  }
+
+#endif
 
 #ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
+  if (wildfireThreshold > 0.0) {
     for(size_t j=0; j<delta.size(); ++j)
       assert(delta[j].unaryExpr(ptr_fun(isfinite<double>)).all());
-#endif
   }
+#endif
 
   return lastBacksubVariableCount;
 }
@@ -111,9 +111,12 @@ void optimizeWildfire(const boost::shared_ptr<CLIQUE>& clique, double threshold,
   }
 }
 
-template<class CLIQUE>
+// KEYSET is the set of keys whose values changed above the threshold, usually a FastSet<Key>.
+// The parallel back-substitution in ISAM2-impl.cpp passes a concurrent set here instead, which
+// is safe because a clique is only processed after all of its ancestors have been processed.
+template<class CLIQUE, class KEYSET>
 bool optimizeWildfireNode(const boost::shared_ptr<CLIQUE>& clique, double threshold,
-    FastSet<Key>& changed, const FastSet<Key>& replaced, VectorValues& delta, size_t& count)
+    KEYSET& changed, const FastSet<Key>& replaced, VectorValues& delta, size_t& count)
 {
   // if none of the variables in this clique (frontal and separator!) changed
   // significantly, then by the running intersection property, none of the
@@ -131,7 +134,7 @@ bool optimizeWildfireNode(const boost::shared_ptr<CLIQUE>& clique, double thresh
   bool recalculate = cliqueReplaced;
   if(!recalculate) {
     BOOST_FOREACH(Key parent, clique->conditional()->parents()) {
-      if(changed.exists(parent)) {
+      if(changed.count(parent)) {
         recalculate = true;
         break;
       }
@@ -21,6 +21,7 @@ using namespace boost::assign;
 #include <boost/range/adaptors.hpp>
 #include <boost/range/algorithm/copy.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/scoped_ptr.hpp>
 namespace br { using namespace boost::range; using namespace boost::adaptors; }
 
 #include <gtsam/base/timing.h>
@@ -38,6 +39,10 @@ namespace br { using namespace boost::range; using namespace boost::adaptors; }
 #include <gtsam/nonlinear/nonlinearExceptions.h>
 #include <gtsam/nonlinear/LinearContainerFactor.h>
 
+#ifdef GTSAM_USE_TBB
+#  include <tbb/parallel_for.h>
+#endif
+
 using namespace std;
 
 namespace gtsam {
@@ -49,6 +54,24 @@ template class BayesTree<ISAM2Clique>;
 static const bool disableReordering = false;
 static const double batchThreshold = 0.65;
 
+/* ************************************************************************* */
+// Wall-clock stopwatch used to fill in ISAM2Result::Timing
+namespace {
+class WallTimer {
+#ifdef GTSAM_USING_NEW_BOOST_TIMERS
+  boost::chrono::steady_clock::time_point start_;
+public:
+  WallTimer() : start_(boost::chrono::steady_clock::now()) {}
+  double elapsed() const {
+    return boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start_).count(); }
+#else
+  boost::timer timer_;
+public:
+  double elapsed() const { return timer_.elapsed(); }
+#endif
+};
+}
+
 /* ************************************************************************* */
 // Special BayesTree class that uses ISAM2 cliques - this is the result of reeliminating ISAM2
 // subtrees.
@@ -118,6 +141,56 @@ std::string ISAM2Params::factorizationTranslator(const ISAM2Params::Factorizatio
   return s;
 }
 
+/* ************************************************************************* */
+bool ISAM2Params::equals(const ISAM2Params& other, double tol) const {
+  // Optimization parameters
+  if(optimizationParams.which() != other.optimizationParams.which())
+    return false;
+  if(optimizationParams.type() == typeid(ISAM2GaussNewtonParams)) {
+    const ISAM2GaussNewtonParams& gn = boost::get<ISAM2GaussNewtonParams>(optimizationParams);
+    const ISAM2GaussNewtonParams& otherGn = boost::get<ISAM2GaussNewtonParams>(other.optimizationParams);
+    if(fabs(gn.wildfireThreshold - otherGn.wildfireThreshold) > tol)
+      return false;
+  } else {
+    const ISAM2DoglegParams& dl = boost::get<ISAM2DoglegParams>(optimizationParams);
+    const ISAM2DoglegParams& otherDl = boost::get<ISAM2DoglegParams>(other.optimizationParams);
+    if(fabs(dl.initialDelta - otherDl.initialDelta) > tol
+      || fabs(dl.wildfireThreshold - otherDl.wildfireThreshold) > tol
+      || dl.adaptationMode != otherDl.adaptationMode || dl.verbose != otherDl.verbose)
+      return false;
+  }
+
+  // Relinearization threshold
+  if(relinearizeThreshold.which() != other.relinearizeThreshold.which())
+    return false;
+  if(relinearizeThreshold.type() == typeid(double)) {
+    if(fabs(boost::get<double>(relinearizeThreshold) - boost::get<double>(other.relinearizeThreshold)) > tol)
+      return false;
+  } else {
+    const ISAM2ThresholdMap& thresholds = boost::get<ISAM2ThresholdMap>(relinearizeThreshold);
+    const ISAM2ThresholdMap& otherThresholds = boost::get<ISAM2ThresholdMap>(other.relinearizeThreshold);
+    if(thresholds.size() != otherThresholds.size())
+      return false;
+    BOOST_FOREACH(const ISAM2ThresholdMapValue& value, thresholds) {
+      ISAM2ThresholdMap::const_iterator otherValue = otherThresholds.find(value.first);
+      if(otherValue == otherThresholds.end() || !equal_with_abs_tol(value.second, otherValue->second, tol))
+        return false;
+    }
+  }
+
+  return relinearizeSkip == other.relinearizeSkip
+    && enableRelinearization == other.enableRelinearization
+    && evaluateNonlinearError == other.evaluateNonlinearError
+    && factorization == other.factorization
+    && cacheLinearizedFactors == other.cacheLinearizedFactors
+    && enableDetailedResults == other.enableDetailedResults
+    && enablePartialRelinearizationCheck == other.enablePartialRelinearizationCheck
+    && findUnusedFactorSlots == other.findUnusedFactorSlots
+    && numThreads == other.numThreads
+    && parallelRelinearizeThreshold == other.parallelRelinearizeThreshold
+    && cacheMarginals == other.cacheMarginals;
+}
+
 /* ************************************************************************* */
 void ISAM2Clique::setEliminationResult(const FactorGraphType::EliminationResult& eliminationResult)
 {
@@ -130,6 +203,16 @@ void ISAM2Clique::setEliminationResult(const FactorGraphType::EliminationResult&
     -conditional_->get_S().transpose() * conditional_->get_d();
 }
 
+/* ************************************************************************* */
+void ISAM2Clique::clearCachedCovariance()
+{
+  if(cachedCovariance_) {
+    cachedCovariance_.reset();
+    BOOST_FOREACH(const shared_ptr& child, children)
+      child->clearCachedCovariance();
+  }
+}
+
 /* ************************************************************************* */
 bool ISAM2Clique::equals(const This& other, double tol) const {
   return Base::equals(other) &&
@@ -189,6 +272,39 @@ FastSet<size_t> ISAM2::getAffectedFactors(const FastList<Key>& keys) const {
   return indices;
 }
 
+/* ************************************************************************* */
+namespace {
+  // Linearize the factors with the given indices in a range, and cache them in their slots of
+  // cache if not null
+  struct LinearizeFactors {
+    const NonlinearFactorGraph& factors;
+    const Values& theta;
+    const FastVector<size_t>& indices;
+    std::vector<GaussianFactor::shared_ptr>& result;
+    GaussianFactorGraph* cache;
+    LinearizeFactors(const NonlinearFactorGraph& factors, const Values& theta, const FastVector<size_t>& indices,
+      std::vector<GaussianFactor::shared_ptr>& result, GaussianFactorGraph* cache) :
+      factors(factors), theta(theta), indices(indices), result(result), cache(cache) {}
+
+    void run(size_t begin, size_t end) const {
+      for(size_t k = begin; k != end; ++k) {
+        const size_t idx = indices[k];
+        result[k] = factors[idx]->linearize(theta);
+        if(cache) {
+#ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
+          assert((*cache)[idx]->keys() == result[k]->keys());
+#endif
+          (*cache)[idx] = result[k];
+        }
+      }
+    }
+
+#ifdef GTSAM_USE_TBB
+    void operator()(const tbb::blocked_range<size_t>& r) const { run(r.begin(), r.end()); }
+#endif
+  };
+}
+
 /* ************************************************************************* */
 // retrieve all factors that ONLY contain the affected variables
 // (note that the remaining stuff is summarized in the cached factors)
@@ -208,39 +324,63 @@ ISAM2::relinearizeAffectedFactors(const FastList<Key>& affectedKeys, const FastS
   affectedKeysSet.insert(affectedKeys.begin(), affectedKeys.end());
   gttoc(affectedKeysSet);
 
-  gttic(check_candidates_and_linearize);
-  GaussianFactorGraph::shared_ptr linearized = boost::make_shared<GaussianFactorGraph>();
+  gttic(check_candidates);
+  // The factors that ONLY contain affected variables, in index order, and those of them that
+  // have to be relinearized instead of taken from the cache
+  FastVector<size_t> inside, relinearize;
   BOOST_FOREACH(size_t idx, candidates) {
-    bool inside = true;
+    bool isInside = true;
     bool useCachedLinear = params_.cacheLinearizedFactors;
     BOOST_FOREACH(Key key, nonlinearFactors_[idx]->keys()) {
       if(affectedKeysSet.find(key) == affectedKeysSet.end()) {
-        inside = false;
+        isInside = false;
         break;
       }
       if(useCachedLinear && relinKeys.find(key) != relinKeys.end())
         useCachedLinear = false;
     }
-    if(inside) {
-      if(useCachedLinear) {
+    if(isInside) {
+      inside.push_back(idx);
+      if(!useCachedLinear)
+        relinearize.push_back(idx);
 #ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
+      else {
         assert(linearFactors_[idx]);
         assert(linearFactors_[idx]->keys() == nonlinearFactors_[idx]->keys());
-#endif
-        linearized->push_back(linearFactors_[idx]);
-      } else {
-        GaussianFactor::shared_ptr linearFactor = nonlinearFactors_[idx]->linearize(theta_);
-        linearized->push_back(linearFactor);
-        if(params_.cacheLinearizedFactors) {
-#ifdef GTSAM_EXTRA_CONSISTENCY_CHECKS
-          assert(linearFactors_[idx]->keys() == linearFactor->keys());
-#endif
-          linearFactors_[idx] = linearFactor;
-        }
       }
+#endif
     }
   }
-  gttoc(check_candidates_and_linearize);
+  gttoc(check_candidates);
+
+  gttic(linearize);
+  // Each factor is linearized into its own slot, and cached into its own slot of linearFactors_,
+  // so the result does not depend on the threads
+  GaussianFactorGraph* cache = params_.cacheLinearizedFactors ? &linearFactors_ : 0;
+  std::vector<GaussianFactor::shared_ptr> linearFactors(relinearize.size());
+#ifdef GTSAM_USE_TBB
+  if(relinearize.size() >= params_.parallelRelinearizeThreshold) {
+    TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, relinearize.size()),
+      LinearizeFactors(nonlinearFactors_, theta_, relinearize, linearFactors, cache));
+  } else
+#endif
+  {
+    LinearizeFactors(nonlinearFactors_, theta_, relinearize, linearFactors, cache).run(0, relinearize.size());
+  }
+  gttoc(linearize);
+
+  gttic(collect);
+  GaussianFactorGraph::shared_ptr linearized = boost::make_shared<GaussianFactorGraph>();
+  linearized->reserve(inside.size());
+  size_t k = 0;
+  BOOST_FOREACH(size_t idx, inside) {
+    if(k < relinearize.size() && relinearize[k] == idx)
+      linearized->push_back(linearFactors[k++]);
+    else
+      linearized->push_back(linearFactors_[idx]);
+  }
+  gttoc(collect);
 
   return linearized;
 }
@@ -306,6 +446,9 @@ boost::shared_ptr<FastSet<Key> > ISAM2::recalculate(const FastSet<Key>& markedKe
   Cliques orphans;
   GaussianBayesNet affectedBayesNet;
   this->removeTop(FastVector<Key>(markedKeys.begin(), markedKeys.end()), affectedBayesNet, orphans);
+  // The removed cliques are replaced, but the orphans remain and their ancestors change
+  BOOST_FOREACH(const sharedClique& orphan, orphans)
+    orphan->clearCachedCovariance();
   gttoc(removetop);
 
   //    FactorGraph<GaussianFactor> factors(affectedBayesNet);
@@ -347,6 +490,7 @@ boost::shared_ptr<FastSet<Key> > ISAM2::recalculate(const FastSet<Key>& markedKe
     gttoc(add_keys);
 
     gttic(ordering);
+    WallTimer orderingTimer;
     Ordering order;
     if(constrainKeys)
     {
@@ -367,17 +511,22 @@ boost::shared_ptr<FastSet<Key> > ISAM2::recalculate(const FastSet<Key>& markedKe
         order = Ordering::COLAMD(affectedFactorsVarIndex);
       }
     }
+    result.timing.ordering += orderingTimer.elapsed();
     gttoc(ordering);
 
     gttic(linearize);
+    WallTimer linearizeTimer;
     GaussianFactorGraph linearized = *nonlinearFactors_.linearize(theta_);
     if(params_.cacheLinearizedFactors)
       linearFactors_ = linearized;
+    result.timing.linearize += linearizeTimer.elapsed();
     gttoc(linearize);
 
     gttic(eliminate);
+    WallTimer eliminateTimer;
     ISAM2BayesTree::shared_ptr bayesTree = ISAM2JunctionTree(GaussianEliminationTree(linearized, affectedFactorsVarIndex, order))
       .eliminate(params_.getEliminationFunction()).first;
+    result.timing.eliminate += eliminateTimer.elapsed();
     gttoc(eliminate);
 
     gttic(insert);
@@ -411,7 +560,9 @@ boost::shared_ptr<FastSet<Key> > ISAM2::recalculate(const FastSet<Key>& markedKe
     affectedAndNewKeys.insert(affectedAndNewKeys.end(), affectedKeys.begin(), affectedKeys.end());
     affectedAndNewKeys.insert(affectedAndNewKeys.end(), observedKeys.begin(), observedKeys.end());
     gttic(relinearizeAffected);
+    WallTimer linearizeTimer;
     GaussianFactorGraph factors(*relinearizeAffectedFactors(affectedAndNewKeys, relinKeys));
+    result.timing.linearize += linearizeTimer.elapsed();
     if(debug) factors.print("Relinearized factors: ");
     gttoc(relinearizeAffected);
 
@@ -490,11 +641,19 @@ boost::shared_ptr<FastSet<Key> > ISAM2::recalculate(const FastSet<Key>& markedKe
 
     // Generate ordering
     gttic(Ordering);
+    WallTimer orderingTimer;
     Ordering ordering = Ordering::COLAMDConstrained(affectedFactorsVarIndex, constraintGroups);
+    result.timing.ordering += orderingTimer.elapsed();
     gttoc(Ordering);
 
+    // Independent branches of the junction tree, including those that have orphans attached, are
+    // eliminated in parallel by ClusterTree::eliminate when compiled with TBB.
+    gttic(eliminate);
+    WallTimer eliminateTimer;
     ISAM2BayesTree::shared_ptr bayesTree = ISAM2JunctionTree(GaussianEliminationTree(
       factors, affectedFactorsVarIndex, ordering)).eliminate(params_.getEliminationFunction()).first;
+    result.timing.eliminate += eliminateTimer.elapsed();
+    gttoc(eliminate);
 
     gttoc(reorder_and_eliminate);
 
@@ -529,6 +688,14 @@ ISAM2Result ISAM2::update(
   const bool verbose = ISDEBUG("ISAM2 update verbose");
 
   gttic(ISAM2_update);
+  WallTimer updateTimer;
+
+#ifdef GTSAM_USE_TBB
+  // Limit the number of threads used during this update, if requested
+  boost::scoped_ptr<tbb::task_scheduler_init> threadLimiter;
+  if(params_.numThreads > 0)
+    threadLimiter.reset(new tbb::task_scheduler_init(params_.numThreads));
+#endif
 
   this->update_count_++;
 
@@ -552,7 +719,9 @@ ISAM2Result ISAM2::update(
   // Update delta if we need it to check relinearization later
   if(relinearizeThisStep) {
     gttic(updateDelta);
+    WallTimer updateDeltaTimer;
     updateDelta(disableReordering);
+    result.timing.updateDelta = updateDeltaTimer.elapsed();
     gttoc(updateDelta);
   }
 
@@ -643,6 +812,7 @@ ISAM2Result ISAM2::update(
   // Check relinearization if we're at the nth step, or we are using a looser loop relin threshold
   FastSet<Key> relinKeys;
   if (relinearizeThisStep) {
+    WallTimer relinearizeTimer;
     gttic(gather_relinearize_keys);
     // 4. Mark keys in \Delta above threshold \beta: J=\{\Delta_{j}\in\Delta|\Delta_{j}\geq\beta\}.
     if(params_.enablePartialRelinearizationCheck)
@@ -701,6 +871,7 @@ ISAM2Result ISAM2::update(
     gttoc(expmap);
 
     result.variablesRelinearized = markedKeys.size();
+    result.timing.relinearize = relinearizeTimer.elapsed();
   } else {
     result.variablesRelinearized = 0;
   }
@@ -709,6 +880,7 @@ ISAM2Result ISAM2::update(
   // 7. Linearize new factors
   if(params_.cacheLinearizedFactors) {
     gttic(linearize);
+    WallTimer linearizeTimer;
     GaussianFactorGraph::shared_ptr linearFactors = newFactors.linearize(theta_);
     if(params_.findUnusedFactorSlots)
     {
@@ -721,6 +893,7 @@ ISAM2Result ISAM2::update(
       linearFactors_.push_back(*linearFactors);
     }
     assert(nonlinearFactors_.size() == linearFactors_.size());
+    result.timing.linearize += linearizeTimer.elapsed();
     gttoc(linearize);
   }
   gttoc(linearize_new);
@@ -758,6 +931,7 @@ ISAM2Result ISAM2::update(
     result.errorAfter.reset(nonlinearFactors_.error(calculateEstimate()));
   gttoc(evaluate_error_after);
 
+  result.timing.total = updateTimer.elapsed();
   return result;
 }
 
@@ -916,6 +1090,7 @@ void ISAM2::marginalizeLeaves(const FastList<Key>& leafKeysList,
         FastVector<Key> originalKeys; originalKeys.swap(clique->conditional()->keys());
         clique->conditional()->keys().assign(originalKeys.begin() + nToRemove, originalKeys.end());
         clique->conditional()->nrFrontals() -= nToRemove;
+        clique->clearCachedCovariance();
 
         // Add to factors to remove factors involved in frontals of current clique
         BOOST_FOREACH(Key frontal, cliqueFrontalsToEliminate)
@@ -1044,7 +1219,27 @@ Values ISAM2::calculateBestEstimate() const {
 
 /* ************************************************************************* */
 Matrix ISAM2::marginalCovariance(Key key) const {
-  return marginalFactor(key, params_.getEliminationFunction())->information().inverse();
+  if(params_.cacheMarginals)
+    return cliqueCovariance(nodes_.at(key)).block(key, key);
+  else
+    return marginalFactor(key, params_.getEliminationFunction())->information().inverse();
+}
+
+/* ************************************************************************* */
+const GaussianCliqueCovariance& ISAM2::cliqueCovariance(const sharedClique& clique) const {
+  gttic(cliqueCovariance);
+  // Collect the cliques from this one up to the first one with a cached covariance
+  FastVector<sharedClique> path;
+  for(sharedClique ancestor = clique; ancestor && !ancestor->cachedCovariance(); ancestor = ancestor->parent())
+    path.push_back(ancestor);
+
+  // Compute their covariances top-down
+  for(FastVector<sharedClique>::const_reverse_iterator it = path.rbegin(); it != path.rend(); ++it) {
+    const sharedClique parent = (*it)->parent();
+    (*it)->cachedCovariance_ = boost::make_shared<GaussianCliqueCovariance>(
+      *(*it)->conditional(), parent ? parent->cachedCovariance().get() : 0);
+  }
+  return *clique->cachedCovariance();
 }
 
 /* ************************************************************************* */
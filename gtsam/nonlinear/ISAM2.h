@@ -169,6 +169,29 @@ struct GTSAM_EXPORT ISAM2Params {
   /// having to search for slots every time a factor is added.
   bool findUnusedFactorSlots;
 
+  /** Maximum number of threads used by the parallel parts of ISAM2::update(), most notably the
+   * re-elimination of the top of the Bayes tree, in which independent branches of the junction
+   * tree are eliminated concurrently (default: 0, meaning that TBB chooses the number of threads).
+   * This has no effect if GTSAM is compiled without TBB, or if the calling thread has already
+   * initialized the TBB task scheduler with a different number of threads.
+   */
+  int numThreads;
+
+  /** Minimum number of factors relinearized in one update for the linearization to be split among
+   * TBB threads (default: 64).  Smaller batches are linearized by the calling thread, since they
+   * are not worth the scheduling overhead.  This has no effect if GTSAM is compiled without TBB.
+   */
+  size_t parallelRelinearizeThreshold;
+
+  /** Whether marginalCovariance() keeps the joint covariance of each clique it computes, so that
+   * later queries only compute the covariances of cliques that are not cached yet (default: false).
+   * An update discards the cached covariances of the cliques it re-eliminates and of their
+   * subtrees, since the covariance of a clique depends on all of its ancestors.  When querying the
+   * covariance of recent variables, which iSAM2 keeps near the root, this makes repeated queries
+   * cost little more than a lookup.  This uses memory proportional to the cached cliques.
+   */
+  bool cacheMarginals;
+
   /** Specify parameters as constructor arguments */
   ISAM2Params(
       OptimizationParams _optimizationParams = ISAM2GaussNewtonParams(), ///< see ISAM2Params::optimizationParams
@@ -184,7 +207,8 @@ struct GTSAM_EXPORT ISAM2Params {
       evaluateNonlinearError(_evaluateNonlinearError), factorization(_factorization),
       cacheLinearizedFactors(_cacheLinearizedFactors), keyFormatter(_keyFormatter),
       enableDetailedResults(false), enablePartialRelinearizationCheck(false),
-      findUnusedFactorSlots(false) {}
+      findUnusedFactorSlots(false), numThreads(0), parallelRelinearizeThreshold(64),
+      cacheMarginals(false) {}
 
   void print(const std::string& str = "") const {
     std::cout << str << "\n";
@@ -211,9 +235,15 @@ struct GTSAM_EXPORT ISAM2Params {
     std::cout << "enableDetailedResults:             " << enableDetailedResults << "\n";
     std::cout << "enablePartialRelinearizationCheck: " << enablePartialRelinearizationCheck << "\n";
     std::cout << "findUnusedFactorSlots:             " << findUnusedFactorSlots << "\n";
+    std::cout << "numThreads:                        " << numThreads << "\n";
+    std::cout << "parallelRelinearizeThreshold:      " << parallelRelinearizeThreshold << "\n";
+    std::cout << "cacheMarginals:                    " << cacheMarginals << "\n";
     std::cout.flush();
   }
 
+  /** Check whether all parameters are equal, up to \c tol for the floating-point ones */
+  bool equals(const ISAM2Params& other, double tol = 1e-9) const;
+
    /** Getters and Setters for all properties */
   OptimizationParams getOptimizationParams() const { return this->optimizationParams; }
   RelinearizationThreshold getRelinearizeThreshold() const { return relinearizeThreshold; }
@@ -225,6 +255,9 @@ struct GTSAM_EXPORT ISAM2Params {
   KeyFormatter getKeyFormatter() const { return keyFormatter; }
   bool isEnableDetailedResults() const { return enableDetailedResults; }
   bool isEnablePartialRelinearizationCheck() const { return enablePartialRelinearizationCheck; }
+  int getNumThreads() const { return numThreads; }
+  size_t getParallelRelinearizeThreshold() const { return parallelRelinearizeThreshold; }
+  bool isCacheMarginals() const { return cacheMarginals; }
 
   void setOptimizationParams(OptimizationParams optimizationParams) { this->optimizationParams = optimizationParams; }
   void setRelinearizeThreshold(RelinearizationThreshold relinearizeThreshold) { this->relinearizeThreshold = relinearizeThreshold; }
@@ -237,6 +270,9 @@ struct GTSAM_EXPORT ISAM2Params {
   void setEnableDetailedResults(bool enableDetailedResults) { this->enableDetailedResults = enableDetailedResults; }
   void setEnablePartialRelinearizationCheck(bool enablePartialRelinearizationCheck) { this->enablePartialRelinearizationCheck = enablePartialRelinearizationCheck; }
   void setEnableFindUnusedFactorSlots(bool enableFindUnusedFactorSlots) { this->findUnusedFactorSlots = enableFindUnusedFactorSlots; }
+  void setNumThreads(int numThreads) { this->numThreads = numThreads; }
+  void setParallelRelinearizeThreshold(size_t parallelRelinearizeThreshold) { this->parallelRelinearizeThreshold = parallelRelinearizeThreshold; }
+  void setCacheMarginals(bool cacheMarginals) { this->cacheMarginals = cacheMarginals; }
 
   Factorization factorizationTranslator(const std::string& str) const;
   std::string factorizationTranslator(const Factorization& value) const;
@@ -341,6 +377,22 @@ struct GTSAM_EXPORT ISAM2Result {
    * Detail for information about the results data stored here. */
   boost::optional<DetailedResults> detail;
 
+  /** Wall-clock time, in seconds, spent in the main steps of ISAM2::update().
+   * Together with variablesReeliminated and factorsRecalculated this shows
+   * where the latency of an update comes from, e.g. after a loop closure. */
+  struct Timing {
+    double updateDelta; ///< Back-substitution needed to check for relinearization
+    double relinearize; ///< Finding the variables to relinearize and updating their linearization points
+    double linearize; ///< Linearizing the new factors and the factors in the affected part of the tree
+    double ordering; ///< Computing the ordering of the affected variables
+    double eliminate; ///< (Parallel) re-elimination of the affected part of the Bayes tree
+    double total; ///< Total time spent in ISAM2::update()
+    Timing() : updateDelta(0.0), relinearize(0.0), linearize(0.0), ordering(0.0), eliminate(0.0), total(0.0) {}
+  };
+
+  /** Time breakdown of the update, see Timing */
+  Timing timing;
+
 
   void print(const std::string str = "") const {
     std::cout << str << "  Reelimintated: " << variablesReeliminated << "  Relinearized: " << variablesRelinearized << "  Cliques: " << cliques << std::endl;
@@ -369,13 +421,15 @@ public:
   Base::FactorType::shared_ptr cachedFactor_;
   Vector gradientContribution_;
   FastMap<Key, VectorValues::iterator> solnPointers_;
+  boost::shared_ptr<GaussianCliqueCovariance> cachedCovariance_;
 
   /// Default constructor
   ISAM2Clique() : Base() {}
 
   /// Copy constructor, does *not* copy solution pointers as these are invalid in different trees.
   ISAM2Clique(const ISAM2Clique& other) :
-    Base(other), cachedFactor_(other.cachedFactor_), gradientContribution_(other.gradientContribution_) {}
+    Base(other), cachedFactor_(other.cachedFactor_), gradientContribution_(other.gradientContribution_),
+    cachedCovariance_(other.cachedCovariance_) {}
 
   /// Assignment operator, does *not* copy solution pointers as these are invalid in different trees.
   ISAM2Clique& operator=(const ISAM2Clique& other)
@@ -383,6 +437,7 @@ public:
     Base::operator=(other);
     cachedFactor_ = other.cachedFactor_;
     gradientContribution_ = other.gradientContribution_;
+    cachedCovariance_ = other.cachedCovariance_;
     return *this;
   }
 
@@ -395,6 +450,14 @@ public:
   /** Access the gradient contribution */
   const Vector& gradientContribution() const { return gradientContribution_; }
 
+  /** Access the cached joint covariance of the clique, see ISAM2Params::cacheMarginals.  If a
+   * clique has a cached covariance, so do all of its ancestors. */
+  const boost::shared_ptr<GaussianCliqueCovariance>& cachedCovariance() const { return cachedCovariance_; }
+
+  /** Discard the cached covariance of this clique and of its subtree.  This only descends into
+   * children that have a cached covariance, since their descendants cannot have one otherwise. */
+  void clearCachedCovariance();
+
   bool equals(const This& other, double tol=1e-9) const;
 
   /** print this node */
@@ -572,7 +635,9 @@ public:
    */
   const Value& calculateEstimate(Key key) const;
 
-  /** Return marginal on any variable as a covariance matrix */
+  /** Return marginal on any variable as a covariance matrix.  With ISAM2Params::cacheMarginals,
+   * this reuses the cached covariances of the clique of the variable and of its ancestors, and
+   * caches the ones it has to compute. */
   Matrix marginalCovariance(Key key) const;
 
   /// @name Public members for non-typical usage
@@ -631,6 +696,7 @@ protected:
   virtual boost::shared_ptr<FastSet<Key> > recalculate(const FastSet<Key>& markedKeys, const FastSet<Key>& relinKeys,
       const std::vector<Key>& observedKeys, const FastSet<Key>& unusedIndices, const boost::optional<FastMap<Key,int> >& constrainKeys, ISAM2Result& result);
   void updateDelta(bool forceFullSolve = false) const;
+  const GaussianCliqueCovariance& cliqueCovariance(const sharedClique& clique) const;
 
 }; // ISAM2
 
@@ -20,6 +20,7 @@
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/linear/linearExceptions.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianEliminationPlan.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/Errors.h>
 
@@ -101,6 +102,7 @@ void LevenbergMarquardtParams::print(const std::string& str) const {
   std::cout << "            diagonalDamping: " << diagonalDamping << "\n";
   std::cout << "               min_diagonal: " << min_diagonal_ << "\n";
   std::cout << "               max_diagonal: " << max_diagonal_ << "\n";
+  std::cout << "           assembledDamping: " << assembledDamping << "\n";
   std::cout << "                verbosityLM: "
       << verbosityLMTranslator(verbosityLM) << "\n";
   std::cout.flush();
@@ -108,7 +110,10 @@ void LevenbergMarquardtParams::print(const std::string& str) const {
 
 /* ************************************************************************* */
 GaussianFactorGraph::shared_ptr LevenbergMarquardtOptimizer::linearize() const {
-  return graph_.linearize(state_.values);
+  // The graph structure does not change between iterations, so relinearize into the factors of
+  // the previous iteration, which are no longer referenced once the previous iterate() returned
+  linear_ = linearizeGraph(state_.values, params_, linear_);
+  return linear_;
 }
 
 /* ************************************************************************* */
@@ -138,13 +143,8 @@ void LevenbergMarquardtOptimizer::decreaseLambda(double stepQuality) {
 }
 
 /* ************************************************************************* */
-GaussianFactorGraph::shared_ptr LevenbergMarquardtOptimizer::buildDampedSystem(
+void LevenbergMarquardtOptimizer::updateHessianDiagonal(
     const GaussianFactorGraph& linear) {
-
-  gttic(damp);
-  if (params_.verbosityLM >= LevenbergMarquardtParams::DAMPED)
-    cout << "building damped system with lambda " << state_.lambda << endl;
-
   // Only retrieve diagonal vector when reuse_diagonal = false
   if (params_.diagonalDamping && params_.reuse_diagonal_ == false) {
     state_.hessianDiagonal = linear.hessianDiagonal();
@@ -156,6 +156,17 @@ GaussianFactorGraph::shared_ptr LevenbergMarquardtOptimizer::buildDampedSystem(
       }
     }
   } // reuse diagonal
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr LevenbergMarquardtOptimizer::buildDampedSystem(
+    const GaussianFactorGraph& linear) {
+
+  gttic(damp);
+  if (params_.verbosityLM >= LevenbergMarquardtParams::DAMPED)
+    cout << "building damped system with lambda " << state_.lambda << endl;
+
+  updateHessianDiagonal(linear);
 
   // for each of the variables, add a prior
   double sigma = 1.0 / std::sqrt(state_.lambda);
@@ -192,6 +203,29 @@ GaussianFactorGraph::shared_ptr LevenbergMarquardtOptimizer::buildDampedSystem(
   return dampedPtr;
 }
 
+/* ************************************************************************* */
+VectorValues LevenbergMarquardtOptimizer::buildDampingDiagonal(
+    const GaussianFactorGraph& linear) {
+
+  gttic(damp);
+  if (params_.verbosityLM >= LevenbergMarquardtParams::DAMPED)
+    cout << "building damping diagonal with lambda " << state_.lambda << endl;
+
+  updateHessianDiagonal(linear);
+
+  // A prior with A = diag(a) and sigma = 1/sqrt(lambda) adds lambda * a.^2 to the diagonal
+  VectorValues damping;
+  if (params_.diagonalDamping) {
+    BOOST_FOREACH(const VectorValues::KeyValuePair& key_vector, state_.hessianDiagonal)
+      damping.insert(key_vector.first, state_.lambda * key_vector.second.cwiseAbs2());
+  } else {
+    BOOST_FOREACH(const Values::KeyValuePair& key_value, state_.values)
+      damping.insert(key_value.key, Vector::Constant(key_value.value.dim(), state_.lambda));
+  }
+  gttoc(damp);
+  return damping;
+}
+
 /* ************************************************************************* */
 // Log current error/lambda to file
 inline void LevenbergMarquardtOptimizer::writeLogFile(double currentError){
@@ -222,27 +256,41 @@ void LevenbergMarquardtOptimizer::iterate() {
   if(state_.totalNumberInnerIterations==0) // write initial error
     writeLogFile(state_.error);
 
+  // With assembledDamping, sum the linear system into the clique Hessians only once, and add
+  // lambda to their diagonal for each lambda trial, instead of building a damped system
+  GaussianEliminationPlan* assembled = 0;
+  if (params_.assembledDamping
+      && params_.linearSolverType == NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY
+      && !hasConstraints(*linear)) {
+    const size_t nrKeys = linear->keys().size();
+    if (nrKeys == params_.ordering->size() && nrKeys == state_.values.size()) {
+      assembled = &eliminationPlan(*linear, *params_.ordering);
+      assembled->assemble(*linear);
+    }
+  }
+
   // Keep increasing lambda until we make make progress
   while (true) {
 
     if (lmVerbosity >= LevenbergMarquardtParams::TRYLAMBDA)
       cout << "trying lambda = " << state_.lambda << endl;
 
-    // Build damped system for this lambda (adds prior factors that make it like gradient descent)
-    GaussianFactorGraph::shared_ptr dampedSystemPtr = buildDampedSystem(*linear);
-    GaussianFactorGraph &dampedSystem = (*dampedSystemPtr);
-
     // Try solving
     double modelFidelity = 0.0;
     bool step_is_successful = false;
     bool stopSearchingLambda = false;
     double newError;
-    Values newValues;
     VectorValues delta;
 
     bool systemSolvedSuccessfully;
     try {
-      delta = solve(dampedSystem, state_.values, params_);
+      if (assembled) {
+        delta = assembled->eliminateAssembled(buildDampingDiagonal(*linear))->optimize();
+      } else {
+        // Build damped system for this lambda (adds prior factors that make it like gradient descent)
+        GaussianFactorGraph::shared_ptr dampedSystem = buildDampedSystem(*linear);
+        delta = solve(*dampedSystem, state_.values, params_);
+      }
       systemSolvedSuccessfully = true;
     } catch (IndeterminantLinearSystemException) {
       systemSolvedSuccessfully = false;
@@ -267,14 +315,14 @@ void LevenbergMarquardtOptimizer::iterate() {
       if (linearizedCostChange >= 0) { // step is valid
         // update values
         gttic(retract);
-        newValues = state_.values.retract(delta);
+        state_.values.retract(delta, newValues_);
         gttoc(retract);
 
         // compute new error
         gttic(compute_error);
         if (lmVerbosity >= LevenbergMarquardtParams::TRYLAMBDA)
           cout << "calculating error:" << endl;
-        newError = graph_.error(newValues);
+        newError = graph_.error(newValues_);
         gttoc(compute_error);
 
         if (lmVerbosity >= LevenbergMarquardtParams::TRYLAMBDA)
@@ -307,7 +355,7 @@ void LevenbergMarquardtOptimizer::iterate() {
     ++state_.totalNumberInnerIterations;
 
     if (step_is_successful) { // we have successfully decreased the cost and we have good modelFidelity
-      state_.values.swap(newValues);
+      state_.values.swap(newValues_);
       state_.error = newError;
       decreaseLambda(modelFidelity);
       writeLogFile(state_.error);
@@ -341,7 +389,7 @@ void LevenbergMarquardtOptimizer::iterate() {
 LevenbergMarquardtParams LevenbergMarquardtOptimizer::ensureHasOrdering(
     LevenbergMarquardtParams params, const NonlinearFactorGraph& graph) const {
   if (!params.ordering)
-    params.ordering = Ordering::COLAMD(graph);
+    params.ordering = params.computeOrdering(graph);
   return params;
 }
 
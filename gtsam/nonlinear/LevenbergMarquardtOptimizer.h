@@ -58,12 +58,13 @@ public:
   bool useFixedLambdaFactor_; ///< if true applies constant increase (or decrease) to lambda according to lambdaFactor
   double min_diagonal_; ///< when using diagonal damping saturates the minimum diagonal entries (default: 1e-6)
   double max_diagonal_; ///< when using diagonal damping saturates the maximum diagonal entries (default: 1e32)
+  bool assembledDamping; ///< if true, add lambda to the diagonal of the clique Hessians, assembled once per linearization, instead of building and eliminating a damped graph for each lambda.  Keeps the elimination plan between iterations like reuseEliminationPlan (MULTIFRONTAL_CHOLESKY only, default: false)
 
   LevenbergMarquardtParams() :
       lambdaInitial(1e-5), lambdaFactor(10.0), lambdaUpperBound(1e5), lambdaLowerBound(
           0.0), verbosityLM(SILENT), minModelFidelity(1e-3),
           diagonalDamping(false), reuse_diagonal_(false), useFixedLambdaFactor_(true),
-          min_diagonal_(1e-6), max_diagonal_(1e32) {
+          min_diagonal_(1e-6), max_diagonal_(1e32), assembledDamping(false) {
   }
   virtual ~LevenbergMarquardtParams() {
   }
@@ -91,6 +92,9 @@ public:
   inline bool getDiagonalDamping() const {
     return diagonalDamping;
   }
+  inline bool getAssembledDamping() const {
+    return assembledDamping;
+  }
 
   inline void setlambdaInitial(double value) {
     lambdaInitial = value;
@@ -116,6 +120,9 @@ public:
   inline void setUseFixedLambdaFactor(bool flag) {
     useFixedLambdaFactor_ = flag;
   }
+  inline void setAssembledDamping(bool flag) {
+    assembledDamping = flag;
+  }
 };
 
 /**
@@ -160,6 +167,8 @@ class GTSAM_EXPORT LevenbergMarquardtOptimizer: public NonlinearOptimizer {
 protected:
   LevenbergMarquardtParams params_; ///< LM parameters
   LevenbergMarquardtState state_; ///< optimization state
+  mutable GaussianFactorGraph::shared_ptr linear_; ///< Last linearization, its storage is reused by linearize()
+  Values newValues_; ///< Values of the last trial step, their storage is reused by the next retract
 
 public:
   typedef boost::shared_ptr<LevenbergMarquardtOptimizer> shared_ptr;
@@ -255,6 +264,10 @@ public:
 
   /** Build a damped system for a specific lambda */
   GaussianFactorGraph::shared_ptr buildDampedSystem(const GaussianFactorGraph& linear);
+
+  /** Build the damping for a specific lambda as the values added to the diagonal of the Hessian
+   * of \c linear, which is equivalent to the prior factors added by buildDampedSystem */
+  VectorValues buildDampingDiagonal(const GaussianFactorGraph& linear);
   friend class ::NonlinearOptimizerMoreOptimizationTest;
 
   void writeLogFile(double currentError);
@@ -273,6 +286,9 @@ protected:
     return state_;
   }
 
+  /** Compute the clamped Hessian diagonal used for diagonal damping, unless it is reused */
+  void updateHessianDiagonal(const GaussianFactorGraph& linear);
+
   /** Internal function for computing a COLAMD ordering if no ordering is specified */
   LevenbergMarquardtParams ensureHasOrdering(LevenbergMarquardtParams params,
       const NonlinearFactorGraph& graph) const;
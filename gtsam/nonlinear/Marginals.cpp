@@ -57,6 +57,45 @@ Matrix Marginals::marginalCovariance(Key variable) const {
   return marginalInformation(variable).inverse();
 }
 
+/* ************************************************************************* */
+FastMap<Key, Matrix> Marginals::marginalCovariances() const {
+  gttic(marginalCovariances);
+  const FastMap<Key, GaussianCliqueCovariance> cliqueCovariances = bayesTree_.cliqueCovariances();
+
+  // The diagonal blocks of the frontal variables of every clique
+  FastMap<Key, Matrix> covariances;
+  typedef FastMap<Key, GaussianCliqueCovariance>::value_type KeyCovariance;
+  BOOST_FOREACH(const KeyCovariance& keyCovariance, cliqueCovariances) {
+    const GaussianCliqueCovariance& clique = keyCovariance.second;
+    for(size_t i = 0; i < clique.nrFrontals; ++i) {
+      const DenseIndex dim = clique.offsets[i+1] - clique.offsets[i];
+      covariances.insert(make_pair(clique.keys[i],
+        Matrix(clique.covariance.block(clique.offsets[i], clique.offsets[i], dim, dim))));
+    }
+  }
+  return covariances;
+}
+
+/* ************************************************************************* */
+std::vector<JointMarginal> Marginals::cliqueMarginalCovariances() const {
+  gttic(cliqueMarginalCovariances);
+  const FastMap<Key, GaussianCliqueCovariance> cliqueCovariances = bayesTree_.cliqueCovariances();
+
+  std::vector<JointMarginal> marginals;
+  marginals.reserve(cliqueCovariances.size());
+  typedef FastMap<Key, GaussianCliqueCovariance>::value_type KeyCovariance;
+  BOOST_FOREACH(const KeyCovariance& keyCovariance, cliqueCovariances) {
+    const GaussianCliqueCovariance& clique = keyCovariance.second;
+    std::vector<size_t> dims;
+    dims.reserve(clique.keys.size());
+    for(size_t i = 0; i < clique.keys.size(); ++i)
+      dims.push_back(clique.offsets[i+1] - clique.offsets[i]);
+    marginals.push_back(JointMarginal(clique.covariance, dims,
+      std::vector<Key>(clique.keys.begin(), clique.keys.end())));
+  }
+  return marginals;
+}
+
 /* ************************************************************************* */
 Matrix Marginals::marginalInformation(Key variable) const {
   gttic(marginalInformation);
@@ -76,10 +115,36 @@ Matrix Marginals::marginalInformation(Key variable) const {
 /* ************************************************************************* */
 JointMarginal Marginals::jointMarginalCovariance(const std::vector<Key>& variables) const {
   JointMarginal info = jointMarginalInformation(variables);
+  invertJointMarginal(info);
+  return info;
+}
+
+/* ************************************************************************* */
+void Marginals::invertJointMarginal(JointMarginal& info) {
   info.blockMatrix_.full().triangularView() =
     info.blockMatrix_.full().selfadjointView().llt().solve(
     Matrix::Identity(info.blockMatrix_.full().rows(), info.blockMatrix_.full().rows())).triangularView<Eigen::Upper>();
-  return info;
+}
+
+/* ************************************************************************* */
+std::vector<JointMarginal> Marginals::jointMarginalCovariances(const std::vector<std::pair<Key, Key> >& pairs) const {
+  gttic(jointMarginalCovariances);
+  std::vector<GaussianBayesNet::shared_ptr> joints;
+  if(factorization_ == CHOLESKY)
+    joints = bayesTree_.jointBayesNets(pairs, EliminatePreferCholesky);
+  else if(factorization_ == QR)
+    joints = bayesTree_.jointBayesNets(pairs, EliminateQR);
+
+  std::vector<JointMarginal> marginals;
+  marginals.reserve(pairs.size());
+  for(size_t i = 0; i < pairs.size(); ++i) {
+    std::vector<Key> variables;
+    variables.push_back(pairs[i].first);
+    variables.push_back(pairs[i].second);
+    marginals.push_back(jointMarginalFromGraph(GaussianFactorGraph(*joints[i]), variables));
+    invertJointMarginal(marginals.back());
+  }
+  return marginals;
 }
 
 /* ************************************************************************* */
@@ -110,23 +175,28 @@ JointMarginal Marginals::jointMarginalInformation(const std::vector<Key>& variab
         jointFG = GaussianFactorGraph(*graph_.marginalMultifrontalBayesTree(variables, boost::none, EliminateQR));
     }
 
-    // Get information matrix
-    Matrix augmentedInfo = jointFG.augmentedHessian();
-    Matrix info = augmentedInfo.topLeftCorner(augmentedInfo.rows()-1, augmentedInfo.cols()-1);
-
-    // Information matrix will be returned with sorted keys
-    std::vector<Key> variablesSorted = variables;
-    std::sort(variablesSorted.begin(), variablesSorted.end());
-
-    // Get dimensions from factor graph
-    std::vector<size_t> dims;
-    dims.reserve(variablesSorted.size());
-    BOOST_FOREACH(Key key, variablesSorted) {
-      dims.push_back(values_.at(key).dim());
-    }
+    return jointMarginalFromGraph(jointFG, variables);
+  }
+}
 
-    return JointMarginal(info, dims, variablesSorted);
+/* ************************************************************************* */
+JointMarginal Marginals::jointMarginalFromGraph(const GaussianFactorGraph& jointFG, const std::vector<Key>& variables) const {
+  // Get information matrix
+  Matrix augmentedInfo = jointFG.augmentedHessian();
+  Matrix info = augmentedInfo.topLeftCorner(augmentedInfo.rows()-1, augmentedInfo.cols()-1);
+
+  // Information matrix will be returned with sorted keys
+  std::vector<Key> variablesSorted = variables;
+  std::sort(variablesSorted.begin(), variablesSorted.end());
+
+  // Get dimensions from factor graph
+  std::vector<size_t> dims;
+  dims.reserve(variablesSorted.size());
+  BOOST_FOREACH(Key key, variablesSorted) {
+    dims.push_back(values_.at(key).dim());
   }
+
+  return JointMarginal(info, dims, variablesSorted);
 }
 
 /* ************************************************************************* */
@@ -61,6 +61,16 @@ public:
   /** Compute the marginal covariance of a single variable */
   Matrix marginalCovariance(Key variable) const;
 
+  /** Compute the marginal covariances of all variables at once, in one top-down pass over the
+   * Bayes tree (see GaussianBayesTree::cliqueCovariances).  This is much faster than calling
+   * marginalCovariance() for every variable. */
+  FastMap<Key, Matrix> marginalCovariances() const;
+
+  /** Compute the joint marginal covariance of the frontal and separator variables of every clique
+   * of the Bayes tree, in one top-down pass.  Together these contain the covariance of every pair
+   * of variables that appear in a clique together, in addition to all marginal covariances. */
+  std::vector<JointMarginal> cliqueMarginalCovariances() const;
+
   /** Compute the marginal information matrix of a single variable.  You can
    * use LLt(const Matrix&) or RtR(const Matrix&) to obtain the square-root information
    * matrix. */
@@ -71,6 +81,20 @@ public:
 
   /** Compute the joint marginal information of several variables */
   JointMarginal jointMarginalInformation(const std::vector<Key>& variables) const;
+
+  /** Compute the joint marginal covariances of many pairs of variables, in the order of the
+   * pairs.  This is much faster than calling jointMarginalCovariance() for each pair, since the
+   * pairs are grouped by the lowest common ancestor of their cliques and the groups are evaluated
+   * in parallel (see BayesTree::jointBayesNets).  The two variables of each pair must differ. */
+  std::vector<JointMarginal> jointMarginalCovariances(const std::vector<std::pair<Key, Key> >& pairs) const;
+
+protected:
+
+  /** Extract the joint marginal information of the variables of a factor graph on only them */
+  JointMarginal jointMarginalFromGraph(const GaussianFactorGraph& jointFG, const std::vector<Key>& variables) const;
+
+  /** Invert the information matrix of a joint marginal in place, giving its covariance */
+  static void invertJointMarginal(JointMarginal& info);
 };
 
 /**
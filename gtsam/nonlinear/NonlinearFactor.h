@@ -22,10 +22,12 @@
 
 #include <boost/serialization/base_object.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/thread/tss.hpp>
 
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/HessianFactor.h>
 #include <gtsam/inference/Factor.h>
 
 
@@ -42,6 +44,23 @@ namespace gtsam {
 
 using boost::assign::cref_list_of;
 
+namespace internal {
+
+  /**
+   * Jacobians of the calling thread, resized to \c n, into which NoiseModelFactor evaluates
+   * unwhitenedError when relinearizing in place.  They are only used until the Jacobians are
+   * written into the linear factor, so one small buffer per thread serves all factors.
+   */
+  inline std::vector<Matrix>& jacobianScratch(size_t n) {
+    static boost::thread_specific_ptr<std::vector<Matrix> > scratch;
+    if(!scratch.get())
+      scratch.reset(new std::vector<Matrix>());
+    scratch->resize(n);
+    return *scratch;
+  }
+
+}
+
 /* ************************************************************************* */
 /**
  * Nonlinear factor base class
@@ -143,6 +162,28 @@ public:
   virtual boost::shared_ptr<GaussianFactor>
   linearize(const Values& c) const = 0;
 
+  /**
+   * Linearize to a HessianFactor where possible, for solvers that eliminate with Cholesky and
+   * would otherwise convert the linearized factor to a Hessian.  Factors that can compute the
+   * Hessian directly from their Jacobians override this to skip the intermediate
+   * JacobianFactor.  The default returns linearize(c).
+   */
+  virtual boost::shared_ptr<GaussianFactor> linearizeToHessian(const Values& c) const {
+    return linearize(c);
+  }
+
+  /**
+   * Linearize into \c factor, a GaussianFactor previously returned by linearize() on this
+   * factor, overwriting it and reusing its storage instead of allocating a new factor.  This
+   * is used to relinearize a graph whose structure has not changed between iterations.
+   * @return true if \c factor was overwritten, or false if in-place linearization is not
+   * supported or the structure of \c factor has changed, in which case \c factor is not
+   * modified and linearize() should be called instead.  The default returns false.
+   */
+  virtual bool linearizeInPlace(const Values& c, GaussianFactor& factor) const {
+    return false;
+  }
+
   /**
    * Create a symbolic factor using the given ordering to determine the
    * variable indices.
@@ -367,6 +408,132 @@ public:
       return GaussianFactor::shared_ptr(new JacobianFactor(terms, b));
   }
 
+  /**
+   * Linearize to a HessianFactor on the keys of this factor, with the information form
+   * G = A'A, g = A'b and f = b'b of the whitened Jacobian A and right-hand side b, computed
+   * directly from the Jacobians of unwhitenedError without building a JacobianFactor.  Constrained
+   * noise models have no information form, and fall back to linearize().
+   */
+  boost::shared_ptr<GaussianFactor> linearizeToHessian(const Values& x) const {
+    // Only linearize if the factor is active
+    if (!this->active(x))
+      return boost::shared_ptr<HessianFactor>();
+    if (boost::dynamic_pointer_cast<noiseModel::Constrained>(this->noiseModel_))
+      return linearize(x);
+
+    std::vector<Matrix> A(this->size());
+    Vector b = -unwhitenedError(x, A);
+    if(noiseModel_)
+    {
+      if((size_t) b.size() != noiseModel_->dim())
+        throw std::invalid_argument("This factor was created with a NoiseModel of incorrect dimension.");
+
+      this->noiseModel_->WhitenSystem(A,b);
+    }
+
+    std::vector<DenseIndex> dims(this->size());
+    for(size_t j=0; j<this->size(); ++j)
+      dims[j] = A[j].cols();
+    HessianFactor::shared_ptr hessian = boost::make_shared<HessianFactor>(
+      this->keys(), SymmetricBlockMatrix(dims, true));
+    writeInformation(A, b, *hessian);
+    return hessian;
+  }
+
+  /**
+   * Linearize into an existing JacobianFactor created by linearize() on this factor, writing
+   * the whitened Jacobians and right-hand side into its augmented matrix, or into an existing
+   * HessianFactor created by linearizeToHessian(), writing their information form.  The
+   * Jacobians are evaluated into a buffer of the calling thread (see internal::jacobianScratch)
+   * and, for Gaussian noise models, whitened in the augmented matrix itself, so that after the
+   * first call this allocates neither the linear factor nor its matrix.  Returns false, leaving
+   * \c factor unchanged, if \c factor is not a JacobianFactor or HessianFactor on the same keys
+   * and dimensions, if it is a JacobianFactor with a noise model (i.e. this factor has a
+   * constrained noise model), or if this factor is not active.  Derived classes that override
+   * linearize() should also override this function.
+   */
+  virtual bool linearizeInPlace(const Values& x, GaussianFactor& factor) const {
+    HessianFactor* hessian = dynamic_cast<HessianFactor*>(&factor);
+    if(hessian)
+      return relinearizeHessian(x, *hessian);
+    JacobianFactor* jacobian = dynamic_cast<JacobianFactor*>(&factor);
+    if(!jacobian || jacobian->get_model() || jacobian->keys() != this->keys() || !this->active(x))
+      return false;
+    if(boost::dynamic_pointer_cast<noiseModel::Constrained>(this->noiseModel_))
+      return false;
+
+    // Call evaluate error to get Jacobians and b vector
+    std::vector<Matrix>& A = internal::jacobianScratch(this->size());
+    Vector b = -unwhitenedError(x, A);
+    if((size_t) b.size() != jacobian->rows())
+      return false;
+    VerticalBlockMatrix& Ab = jacobian->matrixObject();
+    for(size_t j=0; j<this->size(); ++j)
+      if(A[j].rows() != Ab(j).rows() || A[j].cols() != Ab(j).cols())
+        return false;
+
+    // Gaussian noise models whiten the augmented matrix in place, robust ones depend on b and
+    // whiten the Jacobians before they are written
+    const noiseModel::Gaussian* gaussian = dynamic_cast<const noiseModel::Gaussian*>(noiseModel_.get());
+    if(noiseModel_)
+    {
+      if((size_t) b.size() != noiseModel_->dim())
+        throw std::invalid_argument("This factor was created with a NoiseModel of incorrect dimension.");
+
+      if(!gaussian)
+        this->noiseModel_->WhitenSystem(A,b);
+    }
+
+    // Overwrite the terms
+    for(size_t j=0; j<this->size(); ++j)
+      Ab(j) = A[j];
+    jacobian->getb() = b;
+    if(gaussian)
+      gaussian->WhitenInPlace(Ab.full());
+    return true;
+  }
+
+protected:
+
+  /** Linearize into a HessianFactor created by linearizeToHessian(), see linearizeInPlace() */
+  bool relinearizeHessian(const Values& x, HessianFactor& hessian) const {
+    if(hessian.keys() != this->keys() || !this->active(x))
+      return false;
+    if(boost::dynamic_pointer_cast<noiseModel::Constrained>(this->noiseModel_))
+      return false;
+
+    std::vector<Matrix>& A = internal::jacobianScratch(this->size());
+    Vector b = -unwhitenedError(x, A);
+    for(size_t j=0; j<this->size(); ++j)
+      if(A[j].cols() != hessian.getDim(hessian.begin() + j))
+        return false;
+
+    if(noiseModel_)
+    {
+      if((size_t) b.size() != noiseModel_->dim())
+        throw std::invalid_argument("This factor was created with a NoiseModel of incorrect dimension.");
+
+      this->noiseModel_->WhitenSystem(A,b);
+    }
+
+    writeInformation(A, b, hessian);
+    return true;
+  }
+
+  /** Overwrite \c hessian with the information form G = A'A, g = A'b and f = b'b of the whitened
+   *  system A x = b, with one Jacobian in \c A per key of \c hessian */
+  static void writeInformation(const std::vector<Matrix>& A, const Vector& b, HessianFactor& hessian) {
+    const size_t n = A.size();
+    for(size_t i=0; i<n; ++i) {
+      const HessianFactor::iterator ki = hessian.begin() + i;
+      hessian.info(ki, ki).triangularView() = A[i].transpose() * A[i];
+      for(size_t j=i+1; j<n; ++j)
+        hessian.info(ki, hessian.begin() + j).knownOffDiagonal() = A[i].transpose() * A[j];
+      hessian.info(ki, hessian.end()).knownOffDiagonal() = A[i].transpose() * b;
+    }
+    hessian.constantTerm() = b.squaredNorm();
+  }
+
 private:
 
   /** Serialization function */
@@ -26,6 +26,7 @@
 #include <gtsam/inference/FactorGraph-inst.h>
 #include <gtsam/symbolic/SymbolicFactorGraph.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/HessianFactor.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
@@ -325,14 +326,16 @@ namespace {
     const NonlinearFactorGraph& graph;
     const Values& linearizationPoint;
     GaussianFactorGraph& result;
-    _LinearizeOneFactor(const NonlinearFactorGraph& graph, const Values& linearizationPoint, GaussianFactorGraph& result) :
-      graph(graph), linearizationPoint(linearizationPoint), result(result) {}
+    bool hessian;
+    _LinearizeOneFactor(const NonlinearFactorGraph& graph, const Values& linearizationPoint, GaussianFactorGraph& result,
+      bool hessian = false) :
+      graph(graph), linearizationPoint(linearizationPoint), result(result), hessian(hessian) {}
     void operator()(const tbb::blocked_range<size_t>& r) const
     {
       for(size_t i = r.begin(); i != r.end(); ++i)
       {
         if(graph[i])
-          result[i] = graph[i]->linearize(linearizationPoint);
+          result[i] = hessian ? graph[i]->linearizeToHessian(linearizationPoint) : graph[i]->linearize(linearizationPoint);
         else
           result[i] = GaussianFactor::shared_ptr();
       }
@@ -340,6 +343,43 @@ namespace {
   };
 #endif
 
+  /* ************************************************************************* */
+  void relinearizeFactors(const NonlinearFactorGraph& graph, const Values& linearizationPoint,
+    GaussianFactorGraph& result, size_t begin, size_t end)
+  {
+    for(size_t i = begin; i != end; ++i)
+    {
+      if(graph[i]) {
+        // Reuse the previous linear factor only if no one else can see it change
+        if(!result[i] || !result[i].unique() ||
+          !graph[i]->linearizeInPlace(linearizationPoint, *result[i]))
+        {
+          // Keep the kind of linear factor the previous linearization produced
+          if(dynamic_cast<const HessianFactor*>(result[i].get()))
+            result[i] = graph[i]->linearizeToHessian(linearizationPoint);
+          else
+            result[i] = graph[i]->linearize(linearizationPoint);
+        }
+      } else {
+        result[i] = GaussianFactor::shared_ptr();
+      }
+    }
+  }
+
+#ifdef GTSAM_USE_TBB
+  struct _RelinearizeFactors {
+    const NonlinearFactorGraph& graph;
+    const Values& linearizationPoint;
+    GaussianFactorGraph& result;
+    _RelinearizeFactors(const NonlinearFactorGraph& graph, const Values& linearizationPoint, GaussianFactorGraph& result) :
+      graph(graph), linearizationPoint(linearizationPoint), result(result) {}
+    void operator()(const tbb::blocked_range<size_t>& r) const
+    {
+      relinearizeFactors(graph, linearizationPoint, result, r.begin(), r.end());
+    }
+  };
+#endif
+
 }
 
 /* ************************************************************************* */
@@ -374,6 +414,59 @@ GaussianFactorGraph::shared_ptr NonlinearFactorGraph::linearize(const Values& li
   return linearFG;
 }
 
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr NonlinearFactorGraph::linearizeToHessian(const Values& linearizationPoint) const
+{
+  gttic(NonlinearFactorGraph_linearizeToHessian);
+
+  GaussianFactorGraph::shared_ptr linearFG = boost::make_shared<GaussianFactorGraph>();
+
+#ifdef GTSAM_USE_TBB
+
+  linearFG->resize(this->size());
+  TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, this->size()),
+    _LinearizeOneFactor(*this, linearizationPoint, *linearFG, true));
+
+#else
+
+  linearFG->reserve(this->size());
+  BOOST_FOREACH(const sharedFactor& factor, this->factors_) {
+    if(factor)
+      (*linearFG) += factor->linearizeToHessian(linearizationPoint);
+    else
+      (*linearFG) += GaussianFactor::shared_ptr();
+  }
+
+#endif
+
+  return linearFG;
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr NonlinearFactorGraph::linearize(const Values& linearizationPoint,
+  const GaussianFactorGraph::shared_ptr& previous) const
+{
+  if(!previous || !previous.unique() || previous->size() != this->size())
+    return linearize(linearizationPoint);
+
+  gttic(NonlinearFactorGraph_relinearize);
+
+#ifdef GTSAM_USE_TBB
+
+  TbbOpenMPMixedScope threadLimiter; // Limits OpenMP threads since we're mixing TBB and OpenMP
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, this->size()),
+    _RelinearizeFactors(*this, linearizationPoint, *previous));
+
+#else
+
+  relinearizeFactors(*this, linearizationPoint, *previous, 0, this->size());
+
+#endif
+
+  return previous;
+}
+
 /* ************************************************************************* */
 NonlinearFactorGraph NonlinearFactorGraph::clone() const {
   NonlinearFactorGraph result;
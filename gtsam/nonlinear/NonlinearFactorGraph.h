@@ -135,6 +135,25 @@ namespace gtsam {
      */
     boost::shared_ptr<GaussianFactorGraph> linearize(const Values& linearizationPoint) const;
 
+    /**
+     * Linearize a nonlinear factor graph into HessianFactors where possible (see
+     * NonlinearFactor::linearizeToHessian), which skips the intermediate JacobianFactors when the
+     * linear system is eliminated with Cholesky.  Relinearizing the result with
+     * linearize(linearizationPoint, previous) overwrites the HessianFactors in place.
+     */
+    boost::shared_ptr<GaussianFactorGraph> linearizeToHessian(const Values& linearizationPoint) const;
+
+    /**
+     * Relinearize a nonlinear factor graph into \c previous, a GaussianFactorGraph returned by
+     * a previous call to linearize() on this graph, reusing the storage of each linear factor
+     * that is not shared with anyone else (see NonlinearFactor::linearizeInPlace).  Factors that
+     * cannot be reused are replaced by newly linearized factors.  If \c previous is null, shared,
+     * or of a different size, this is the same as linearize(linearizationPoint).
+     * @return \c previous, relinearized, or a new GaussianFactorGraph
+     */
+    boost::shared_ptr<GaussianFactorGraph> linearize(const Values& linearizationPoint,
+      const boost::shared_ptr<GaussianFactorGraph>& previous) const;
+
     /**
      * Clone() performs a deep-copy of the graph, including all of the factors
      */
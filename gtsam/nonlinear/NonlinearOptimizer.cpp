@@ -19,9 +19,12 @@
 #include <gtsam/nonlinear/NonlinearOptimizer.h>
 
 #include <gtsam/linear/GaussianEliminationTree.h>
+#include <gtsam/linear/GaussianEliminationPlan.h>
+#include <gtsam/linear/SupernodalCholesky.h>
 #include <gtsam/linear/VectorValues.h>
 #include <gtsam/linear/SubgraphSolver.h>
 #include <gtsam/linear/PCGSolver.h>
+#include <gtsam/linear/SchurComplementSolver.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/linear/VectorValues.h>
 
@@ -96,6 +99,38 @@ const Values& NonlinearOptimizer::optimizeSafely() {
   }
 }
 
+/* ************************************************************************* */
+GaussianEliminationPlan& NonlinearOptimizer::eliminationPlan(
+    const GaussianFactorGraph &gfg, const Ordering& ordering) const {
+  // The symbolic elimination structure only depends on the ordering and on the structure of the
+  // graph, so it is only recomputed when either changes.
+  if (!eliminationPlan_ || !eliminationPlan_->ordering().equals(ordering)
+      || !eliminationPlan_->compatible(gfg))
+    eliminationPlan_ = boost::make_shared<GaussianEliminationPlan>(gfg, ordering);
+  return *eliminationPlan_;
+}
+
+/* ************************************************************************* */
+PCGSolver& NonlinearOptimizer::pcgSolver(const PCGSolverParameters& parameters) const {
+  if (!pcgSolver_)
+    pcgSolver_ = boost::make_shared<PCGSolver>(parameters);
+  return *pcgSolver_;
+}
+
+/* ************************************************************************* */
+GaussianFactorGraph::shared_ptr NonlinearOptimizer::linearizeGraph(const Values& values,
+    const NonlinearOptimizerParams& params, const GaussianFactorGraph::shared_ptr& previous) const {
+  // Factors of a previous linearization keep their kind when relinearized in place
+  if (previous && previous.unique() && previous->size() == graph_.size())
+    return graph_.linearize(values, previous);
+  // Cholesky converts each JacobianFactor to a HessianFactor anyway, so optionally skip the
+  // JacobianFactors.  This costs more memory for factors with fewer rows than columns.
+  if (params.linearizeToHessian
+      && params.linearSolverType == NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY)
+    return graph_.linearizeToHessian(values);
+  return graph_.linearize(values);
+}
+
 /* ************************************************************************* */
 VectorValues NonlinearOptimizer::solve(const GaussianFactorGraph &gfg,
     const Values& initial, const NonlinearOptimizerParams& params) const {
@@ -106,10 +141,40 @@ VectorValues NonlinearOptimizer::solve(const GaussianFactorGraph &gfg,
   // Check which solver we are using
   if (params.isMultifrontal()) {
     // Multifrontal QR or Cholesky (decided by params.getEliminationFunction())
-    delta = gfg.optimize(*params.ordering, params.getEliminationFunction());
+    if (!params.reuseEliminationPlan) {
+      delta = gfg.optimize(*params.ordering, params.getEliminationFunction());
+    } else {
+      GaussianEliminationPlan& plan = eliminationPlan(gfg, *params.ordering);
+      if (params.linearSolverType == NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY)
+        delta = plan.eliminate(gfg)->optimize();
+      else
+        delta = plan.eliminate(gfg, params.getEliminationFunction())->optimize();
+    }
   } else if (params.isSequential()) {
     // Sequential QR or Cholesky (decided by params.getEliminationFunction())
     delta = gfg.eliminateSequential(*params.ordering, params.getEliminationFunction())->optimize();
+  } else if (params.isCholmod()) {
+    // Supernodal sparse Cholesky, whose symbolic analysis is reused like the elimination plan.
+    // Constrained noise models have no Hessian and require QR.
+    if (hasConstraints(gfg)) {
+      delta = gfg.optimize(*params.ordering, EliminateQR);
+    } else {
+      if (!supernodalCholesky_ || !supernodalCholesky_->ordering().equals(*params.ordering)
+          || !supernodalCholesky_->compatible(gfg))
+        supernodalCholesky_ = boost::make_shared<SupernodalCholesky>(gfg, *params.ordering);
+      supernodalCholesky_->factorize(gfg);
+      delta = supernodalCholesky_->optimize();
+    }
+  } else if (params.isSchurComplement()) {
+    // Eliminate the points in closed form, and solve the reduced camera system with PCG if given
+    // ConjugateGradientParameters, or else with multifrontal Cholesky
+    if (!schurComplementSolver_ || !schurComplementSolver_->compatible(gfg))
+      schurComplementSolver_ = boost::make_shared<SchurComplementSolver>(gfg);
+    if (boost::shared_ptr<ConjugateGradientParameters> cg =
+        boost::dynamic_pointer_cast<ConjugateGradientParameters>(params.iterativeParams))
+      delta = schurComplementSolver_->optimize(gfg, *cg);
+    else
+      delta = schurComplementSolver_->optimize(gfg, *params.ordering);
   } else if (params.isIterative()) {
 
     // Conjugate Gradient -> needs params.iterativeParams
@@ -117,7 +182,7 @@ VectorValues NonlinearOptimizer::solve(const GaussianFactorGraph &gfg,
       throw std::runtime_error("NonlinearOptimizer::solve: cg parameter has to be assigned ...");
 
     if (boost::shared_ptr<PCGSolverParameters> pcg = boost::dynamic_pointer_cast<PCGSolverParameters>(params.iterativeParams) ) {
-      delta = PCGSolver(*pcg).optimize(gfg);
+      delta = pcgSolver(*pcg).optimize(gfg);
     }
     else if (boost::shared_ptr<SubgraphSolverParameters> spcg = boost::dynamic_pointer_cast<SubgraphSolverParameters>(params.iterativeParams) ) {
       delta = SubgraphSolver(gfg, *spcg, *params.ordering).optimize();
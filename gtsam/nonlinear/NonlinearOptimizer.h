@@ -24,6 +24,11 @@
 namespace gtsam {
 
 class NonlinearOptimizer;
+class GaussianEliminationPlan;
+class SupernodalCholesky;
+class PCGSolver;
+class SchurComplementSolver;
+struct PCGSolverParameters;
 
 /**
  * Base class for a nonlinear optimization state, including the current estimate
@@ -136,6 +141,20 @@ class GTSAM_EXPORT NonlinearOptimizer {
 protected:
   NonlinearFactorGraph graph_;
 
+  /** Symbolic elimination structure reused by solve() across iterations when
+   *  NonlinearOptimizerParams::reuseEliminationPlan is set, see eliminationPlan() */
+  mutable boost::shared_ptr<GaussianEliminationPlan> eliminationPlan_;
+
+  /** Symbolic analysis of the CHOLMOD solver reused by solve() across iterations */
+  mutable boost::shared_ptr<SupernodalCholesky> supernodalCholesky_;
+
+  /** PCG solver reused by solve() across iterations, which keeps its preconditioner as set in
+   *  PCGSolverParameters */
+  mutable boost::shared_ptr<PCGSolver> pcgSolver_;
+
+  /** Points and cameras found by the SCHUR_COMPLEMENT solver, reused by solve() across iterations */
+  mutable boost::shared_ptr<SchurComplementSolver> schurComplementSolver_;
+
 public:
   /** A shared pointer to this class */
   typedef boost::shared_ptr<const NonlinearOptimizer> shared_ptr;
@@ -183,6 +202,10 @@ public:
   virtual VectorValues solve(const GaussianFactorGraph &gfg,
       const Values& initial, const NonlinearOptimizerParams& params) const;
 
+  /** The PCG solver used by solve() with PCGSolverParameters, with the statistics of its
+   *  preconditioner reuse, or null if it was not used yet */
+  boost::shared_ptr<const PCGSolver> pcgSolver() const { return pcgSolver_; }
+
   /** Perform a single iteration, returning a new NonlinearOptimizer class
    * containing the updated variable assignments, which may be retrieved with
    * values().
@@ -201,9 +224,38 @@ protected:
 
   virtual const NonlinearOptimizerParams& _params() const = 0;
 
+  /** The elimination plan for \c gfg in \c ordering, which is reused as long as the ordering and
+   * the structure of the linear systems do not change */
+  GaussianEliminationPlan& eliminationPlan(const GaussianFactorGraph &gfg,
+      const Ordering& ordering) const;
+
+  /** The PCG solver reused across iterations, created with \c parameters on first use */
+  PCGSolver& pcgSolver(const PCGSolverParameters& parameters) const;
+
+  /** Linearize graph_ at \c values for the linear solver of \c params.  Linearizes to
+   * JacobianFactors, or directly to HessianFactors for MULTIFRONTAL_CHOLESKY when
+   * params.linearizeToHessian is set, see NonlinearFactorGraph::linearizeToHessian.  If given, \c previous is relinearized in place, see
+   * NonlinearFactorGraph::linearize(const Values&, const GaussianFactorGraph::shared_ptr&). */
+  GaussianFactorGraph::shared_ptr linearizeGraph(const Values& values, const NonlinearOptimizerParams& params,
+      const GaussianFactorGraph::shared_ptr& previous = GaussianFactorGraph::shared_ptr()) const;
+
   /** Constructor for initial construction of base classes. */
   NonlinearOptimizer(const NonlinearFactorGraph& graph) : graph_(graph) {}
 
+  /** Copies the graph, but not the elimination plan and solvers cached by solve(), which each
+   * copy rebuilds on first use, so that copies never iterate on shared numeric storage. */
+  NonlinearOptimizer(const NonlinearOptimizer& other) : graph_(other.graph_) {}
+
+  /** Assigns the graph and drops the cached elimination plan and solvers, see the copy constructor */
+  NonlinearOptimizer& operator=(const NonlinearOptimizer& other) {
+    graph_ = other.graph_;
+    eliminationPlan_.reset();
+    supernodalCholesky_.reset();
+    pcgSolver_.reset();
+    schurComplementSolver_.reset();
+    return *this;
+  }
+
 };
 
 /** Check whether the relative error decrease is less than relativeErrorTreshold,
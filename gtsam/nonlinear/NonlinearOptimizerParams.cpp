@@ -102,6 +102,9 @@ void NonlinearOptimizerParams::print(const std::string& str) const {
   case Iterative:
     std::cout << "         linear solver type: ITERATIVE\n";
     break;
+  case SCHUR_COMPLEMENT:
+    std::cout << "         linear solver type: SCHUR COMPLEMENT\n";
+    break;
   default:
     std::cout << "         linear solver type: (invalid)\n";
     break;
@@ -110,7 +113,14 @@ void NonlinearOptimizerParams::print(const std::string& str) const {
   if (ordering)
     std::cout << "                   ordering: custom\n";
   else
-    std::cout << "                   ordering: COLAMD\n";
+    std::cout << "                   ordering: "
+        << orderingTypeTranslator(orderingType) << "\n";
+
+  if (linearSolverType == MULTIFRONTAL_CHOLESKY)
+    std::cout << "       linearize to Hessian: " << linearizeToHessian << "\n";
+
+  if (isMultifrontal())
+    std::cout << "     reuse elimination plan: " << reuseEliminationPlan << "\n";
 
   std::cout.flush();
 }
@@ -131,6 +141,8 @@ std::string NonlinearOptimizerParams::linearSolverTranslator(
     return "ITERATIVE";
   case CHOLMOD:
     return "CHOLMOD";
+  case SCHUR_COMPLEMENT:
+    return "SCHUR_COMPLEMENT";
   default:
     throw std::invalid_argument(
         "Unknown linear solver type in SuccessiveLinearizationOptimizer");
@@ -152,9 +164,50 @@ NonlinearOptimizerParams::LinearSolverType NonlinearOptimizerParams::linearSolve
     return Iterative;
   if (linearSolverType == "CHOLMOD")
     return CHOLMOD;
+  if (linearSolverType == "SCHUR_COMPLEMENT")
+    return SCHUR_COMPLEMENT;
   throw std::invalid_argument(
       "Unknown linear solver type in SuccessiveLinearizationOptimizer");
 }
+
+/* ************************************************************************* */
+std::string NonlinearOptimizerParams::orderingTypeTranslator(
+    OrderingType type) const {
+  switch (type) {
+  case COLAMD:
+    return "COLAMD";
+  case NESTED_DISSECTION:
+    return "NESTED_DISSECTION";
+  default:
+    throw std::invalid_argument(
+        "Unknown ordering type in SuccessiveLinearizationOptimizer");
+  }
+}
+
+/* ************************************************************************* */
+NonlinearOptimizerParams::OrderingType NonlinearOptimizerParams::orderingTypeTranslator(
+    const std::string& type) const {
+  if (type == "COLAMD")
+    return COLAMD;
+  if (type == "NESTED_DISSECTION")
+    return NESTED_DISSECTION;
+  throw std::invalid_argument(
+      "Unknown ordering type in SuccessiveLinearizationOptimizer");
+}
+
+/* ************************************************************************* */
+Ordering NonlinearOptimizerParams::computeOrdering(
+    const VariableIndex& variableIndex) const {
+  switch (orderingType) {
+  case COLAMD:
+    return Ordering::COLAMD(variableIndex);
+  case NESTED_DISSECTION:
+    return Ordering::NestedDissection(variableIndex);
+  default:
+    throw std::invalid_argument(
+        "Unknown ordering type in SuccessiveLinearizationOptimizer");
+  }
+}
 /* ************************************************************************* */
 
 } // namespace
@@ -45,7 +45,8 @@ public:
 
   NonlinearOptimizerParams() :
       maxIterations(100), relativeErrorTol(1e-5), absoluteErrorTol(1e-5), errorTol(
-          0.0), verbosity(SILENT), linearSolverType(MULTIFRONTAL_CHOLESKY) {
+          0.0), verbosity(SILENT), linearSolverType(MULTIFRONTAL_CHOLESKY),
+          orderingType(COLAMD), linearizeToHessian(false), reuseEliminationPlan(false) {
   }
 
   virtual ~NonlinearOptimizerParams() {
@@ -99,12 +100,22 @@ public:
     SEQUENTIAL_CHOLESKY,
     SEQUENTIAL_QR,
     Iterative, /* Experimental Flag */
-    CHOLMOD, /* Experimental Flag */
+    CHOLMOD, /* Supernodal sparse Cholesky, see SupernodalCholesky */
+    SCHUR_COMPLEMENT, /* Points eliminated in closed form, see SchurComplementSolver */
+  };
+
+  /** See NonlinearOptimizerParams::orderingType */
+  enum OrderingType {
+    COLAMD, /* See Ordering::COLAMD */
+    NESTED_DISSECTION, /* See Ordering::NestedDissection */
   };
 
   LinearSolverType linearSolverType; ///< The type of linear solver to use in the nonlinear optimizer
-  boost::optional<Ordering> ordering; ///< The variable elimination ordering, or empty to use COLAMD (default: empty)
+  boost::optional<Ordering> ordering; ///< The variable elimination ordering, or empty to use orderingType (default: empty)
+  OrderingType orderingType; ///< The fill-reducing ordering computed when ordering is empty (default: COLAMD)
   IterativeOptimizationParameters::shared_ptr iterativeParams; ///< The container for iterativeOptimization parameters. used in CG Solvers.
+  bool linearizeToHessian; ///< With MULTIFRONTAL_CHOLESKY, linearize directly to HessianFactors, see NonlinearFactorGraph::linearizeToHessian (default: false)
+  bool reuseEliminationPlan; ///< With the MULTIFRONTAL solvers, keep the symbolic structure and clique storage of the elimination between iterations, see GaussianEliminationPlan.  This keeps a HessianFactor per clique alive for the lifetime of the optimizer (default: false)
 
   inline bool isMultifrontal() const {
     return (linearSolverType == MULTIFRONTAL_CHOLESKY)
@@ -124,6 +135,10 @@ public:
     return (linearSolverType == Iterative);
   }
 
+  inline bool isSchurComplement() const {
+    return (linearSolverType == SCHUR_COMPLEMENT);
+  }
+
   GaussianFactorGraph::Eliminate getEliminationFunction() const {
     switch (linearSolverType) {
     case MULTIFRONTAL_CHOLESKY:
@@ -154,10 +169,45 @@ public:
     this->ordering = ordering;
   }
 
+  std::string getOrderingType() const {
+    return orderingTypeTranslator(orderingType);
+  }
+
+  void setOrderingType(const std::string& type) {
+    orderingType = orderingTypeTranslator(type);
+  }
+
+  bool getLinearizeToHessian() const {
+    return linearizeToHessian;
+  }
+
+  void setLinearizeToHessian(bool value) {
+    linearizeToHessian = value;
+  }
+
+  bool getReuseEliminationPlan() const {
+    return reuseEliminationPlan;
+  }
+
+  void setReuseEliminationPlan(bool value) {
+    reuseEliminationPlan = value;
+  }
+
+  /** Compute the fill-reducing ordering of type orderingType, used when ordering is empty */
+  template<class FACTOR>
+  Ordering computeOrdering(const FactorGraph<FACTOR>& graph) const {
+    return computeOrdering(VariableIndex(graph));
+  }
+
+  /** Compute the fill-reducing ordering of type orderingType from a VariableIndex */
+  Ordering computeOrdering(const VariableIndex& variableIndex) const;
+
 private:
   std::string linearSolverTranslator(LinearSolverType linearSolverType) const;
   LinearSolverType linearSolverTranslator(
       const std::string& linearSolverType) const;
+  std::string orderingTypeTranslator(OrderingType type) const;
+  OrderingType orderingTypeTranslator(const std::string& type) const;
 };
 
 // For backward compatibility:
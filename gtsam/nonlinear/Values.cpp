@@ -79,22 +79,36 @@ namespace gtsam {
   /* ************************************************************************* */
   Values Values::retract(const VectorValues& delta) const
   {
-    Values result;
+    Values result(*this);
+    result.retractInPlace(delta);
+    return result;
+  }
 
-    for(const_iterator key_value = begin(); key_value != end(); ++key_value) {
-      VectorValues::const_iterator vector_item = delta.find(key_value->key);
-      Key key = key_value->key;  // Non-const duplicate to deal with non-const insert argument
-      if(vector_item != delta.end()) {
-//        const Vector& singleDelta = delta[key_value->key]; // Delta for this value
-        const Vector& singleDelta = vector_item->second;
-        Value* retractedValue(key_value->value.retract_(singleDelta)); // Retract
-        result.values_.insert(key, retractedValue); // Add retracted result directly to result values
-      } else {
-        result.values_.insert(key, key_value->value.clone_()); // Add original version to result values
-      }
+  /* ************************************************************************* */
+  void Values::retract(const VectorValues& delta, Values& result) const
+  {
+    // Overwrite the values of result in place while its structure matches, copy otherwise
+    bool sameStructure = result.size() == size();
+    KeyValueMap::iterator to = result.values_.begin();
+    for(KeyValueMap::const_iterator from = values_.begin();
+        sameStructure && from != values_.end(); ++from, ++to) {
+      sameStructure = from->first == to->first && typeid(*from->second) == typeid(*to->second);
+      if(sameStructure)
+        *to->second = *from->second;
     }
+    if(!sameStructure)
+      result = *this;
+    result.retractInPlace(delta);
+  }
 
-    return result;
+  /* ************************************************************************* */
+  void Values::retractInPlace(const VectorValues& delta)
+  {
+    for(KeyValueMap::iterator key_value = values_.begin(); key_value != values_.end(); ++key_value) {
+      VectorValues::const_iterator vector_item = delta.find(key_value->first);
+      if(vector_item != delta.end())
+        key_value->second->retractInPlace_(vector_item->second);
+    }
   }
 
   /* ************************************************************************* */
@@ -240,6 +240,15 @@ namespace gtsam {
     /** Add a delta config to current config and returns a new config */
     Values retract(const VectorValues& delta) const;
 
+    /** Set \c result to retract(delta).  If \c result already holds values with the same keys and
+     * types as this one, e.g. from a previous retract, they are overwritten and retracted in place
+     * instead of allocating new values. */
+    void retract(const VectorValues& delta, Values& result) const;
+
+    /** Add a delta config to current config in place, without allocating new values.  Variables
+     * without a delta in \c delta are left unchanged. */
+    void retractInPlace(const VectorValues& delta);
+
     /** Get a delta config about a linearization point c0 (*this) */
     VectorValues localCoordinates(const Values& cp) const;
 
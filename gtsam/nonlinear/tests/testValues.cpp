@@ -55,6 +55,7 @@ class TestValue : public DerivedValue<TestValue> {
   TestValueData data_;
 public:
   virtual void print(const std::string& str = "") const {}
+  virtual void print(std::ostream& os, const std::string& str = "") const {}
   bool equals(const TestValue& other, double tol = 1e-9) const { return true; }
   virtual size_t dim() const { return 0; }
   TestValue retract(const Vector&) const { return TestValue(); }
@@ -231,6 +232,55 @@ TEST(Values, expmap_b)
   CHECK(assert_equal(expected, config0.retract(increment)));
 }
 
+/* ************************************************************************* */
+TEST(Values, retractInPlace)
+{
+  // The in-place retract of a single Value agrees with retract()
+  Pose3 pose(Rot3::ypr(0.1, -0.2, 0.3), Point3(1.0, 2.0, 3.0));
+  Vector poseDelta = (Vector(6) << 0.01, -0.02, 0.03, 0.4, 0.5, -0.6);
+  Pose3 actualPose = pose;
+  static_cast<Value&>(actualPose).retractInPlace_(poseDelta);
+  EXPECT(assert_equal(pose.retract(poseDelta), actualPose));
+
+  Point3 point(1.0, 2.0, 3.0);
+  Vector pointDelta = (Vector(3) << 0.4, 0.5, -0.6);
+  Point3 actualPoint = point;
+  static_cast<Value&>(actualPoint).retractInPlace_(pointDelta);
+  EXPECT(assert_equal(point.retract(pointDelta), actualPoint));
+
+  // Values, only the variables with a delta change
+  Values values;
+  values.insert(key1, pose);
+  values.insert(key2, point);
+  values.insert(key3, Point3(4.0, 5.0, 6.0));
+  VectorValues delta = pair_list_of<Key, Vector>(key1, poseDelta)(key2, pointDelta);
+
+  Values expected;
+  expected.insert(key1, pose.retract(poseDelta));
+  expected.insert(key2, point.retract(pointDelta));
+  expected.insert(key3, Point3(4.0, 5.0, 6.0));
+  EXPECT(assert_equal(expected, values.retract(delta)));
+
+  Values actual = values;
+  actual.retractInPlace(delta);
+  EXPECT(assert_equal(expected, actual));
+
+  // Retracting into a Values with the same structure reuses its storage
+  Values result;
+  values.retract(delta, result);
+  EXPECT(assert_equal(expected, result));
+  const Value* storage = &result.at(key1);
+  values.retract(delta, result);
+  EXPECT(assert_equal(expected, result));
+  EXPECT(storage == &result.at(key1));
+
+  // A Values with a different structure is replaced
+  Values other;
+  other.insert(key1, Point3());
+  values.retract(delta, other);
+  EXPECT(assert_equal(expected, other));
+}
+
 /* ************************************************************************* */
 //TEST(Values, expmap_c)
 //{
@@ -19,17 +19,94 @@
 
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/Lie.h>
-#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/FixedNoiseModelFactor.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
 
 namespace gtsam {
 
+  namespace internal {
+
+    /**
+     * p1.between(p2) with its Jacobians written into the fixed-size Jacobians of BetweenFactor.
+     * This generic version goes through the dynamic-size Jacobians of T::between, the
+     * overloads below compute them in place for the common fixed-size types.
+     */
+    template<class T, class JACOBIAN>
+    T betweenFixed(const T& p1, const T& p2,
+        boost::optional<JACOBIAN&> H1, boost::optional<JACOBIAN&> H2) {
+      if(!H1 && !H2)
+        return p1.between(p2);
+      Matrix D1, D2;
+      const T hx = p1.between(p2,
+          H1 ? boost::optional<Matrix&>(D1) : boost::optional<Matrix&>(),
+          H2 ? boost::optional<Matrix&>(D2) : boost::optional<Matrix&>());
+      if(H1) *H1 = D1;
+      if(H2) *H2 = D2;
+      return hx;
+    }
+
+    /** Pose3::between, with H1 = -Ad(hx^-1) */
+    inline Pose3 betweenFixed(const Pose3& p1, const Pose3& p2,
+        boost::optional<Matrix6&> H1, boost::optional<Matrix6&> H2) {
+      const Pose3 hx = p1.between(p2);
+      if(H1) *H1 = -hx.inverse().AdjointMap();
+      if(H2) H2->setIdentity();
+      return hx;
+    }
+
+    /** Pose2::between, with H1 = -Ad(hx^-1) */
+    inline Pose2 betweenFixed(const Pose2& p1, const Pose2& p2,
+        boost::optional<Matrix3&> H1, boost::optional<Matrix3&> H2) {
+      const Pose2 hx = p1.between(p2);
+      if(H1) {
+        const Pose2 hxInv = hx.inverse();
+        const double c = hxInv.r().c(), s = hxInv.r().s();
+        *H1 <<
+            -c,   s,  -hxInv.y(),
+            -s,  -c,   hxInv.x(),
+            0.0, 0.0, -1.0;
+      }
+      if(H2) H2->setIdentity();
+      return hx;
+    }
+
+    /** Rot3::between, with H1 = -R2' R1 */
+    inline Rot3 betweenFixed(const Rot3& R1, const Rot3& R2,
+        boost::optional<Matrix3&> H1, boost::optional<Matrix3&> H2) {
+      if(H1) *H1 = -(R2.transpose() * R1.matrix());
+      if(H2) H2->setIdentity();
+      return R1.between(R2);
+    }
+
+    /** Point3::between */
+    inline Point3 betweenFixed(const Point3& p1, const Point3& p2,
+        boost::optional<Matrix3&> H1, boost::optional<Matrix3&> H2) {
+      if(H1) *H1 = -Matrix3::Identity();
+      if(H2) H2->setIdentity();
+      return p2 - p1;
+    }
+
+    /** Point2::between */
+    inline Point2 betweenFixed(const Point2& p1, const Point2& p2,
+        boost::optional<Eigen::Matrix2d&> H1, boost::optional<Eigen::Matrix2d&> H2) {
+      if(H1) *H1 = -Eigen::Matrix2d::Identity();
+      if(H2) H2->setIdentity();
+      return p2 - p1;
+    }
+
+  }
+
   /**
    * A class for a measurement predicted by "between(config[key1],config[key2])"
    * @tparam VALUE the Value type
    * @addtogroup SLAM
    */
   template<class VALUE>
-  class BetweenFactor: public NoiseModelFactor2<VALUE, VALUE> {
+  class BetweenFactor: public FixedNoiseModelFactor2<VALUE, VALUE, traits::dimension<VALUE>::value> {
 
   public:
 
@@ -38,7 +115,7 @@ namespace gtsam {
   private:
 
     typedef BetweenFactor<VALUE> This;
-    typedef NoiseModelFactor2<VALUE, VALUE> Base;
+    typedef FixedNoiseModelFactor2<VALUE, VALUE, traits::dimension<VALUE>::value> Base;
 
     VALUE measured_; /** The measurement */
 
@@ -94,11 +171,11 @@ namespace gtsam {
 
     /** implement functions needed to derive from Factor */
 
-    /** vector of errors */
-    Vector evaluateError(const T& p1, const T& p2,
-        boost::optional<Matrix&> H1 = boost::none, boost::optional<Matrix&> H2 =
-            boost::none) const {
-      T hx = p1.between(p2, H1, H2); // h(x)
+    /** vector of errors, with fixed-size Jacobians */
+    typename Base::ErrorVector evaluateErrorFixed(const T& p1, const T& p2,
+        boost::optional<typename Base::JacobianX1&> H1 = boost::none,
+        boost::optional<typename Base::JacobianX2&> H2 = boost::none) const {
+      T hx = internal::betweenFixed(p1, p2, H1, H2); // h(x)
       // manifold equivalent of h(x)-z -> log(z,h(x))
       return measured_.localCoordinates(hx);
     }
@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/FixedNoiseModelFactor.h>
 #include <gtsam/geometry/CalibratedCamera.h>
 #include <gtsam/geometry/PinholeCamera.h>
 #include <gtsam/geometry/Point2.h>
@@ -35,7 +35,7 @@ namespace gtsam {
    * @addtogroup SLAM
    */
   template <class CAMERA, class LANDMARK>
-  class GeneralSFMFactor:  public NoiseModelFactor2<CAMERA, LANDMARK> {
+  class GeneralSFMFactor:  public FixedNoiseModelFactor2<CAMERA, LANDMARK, 2> {
   protected:
     Point2 measured_;      ///< the 2D measurement
 
@@ -43,7 +43,10 @@ namespace gtsam {
 
     typedef CAMERA Cam;                        ///< typedef for camera type
     typedef GeneralSFMFactor<CAMERA, LANDMARK> This;  ///< typedef for this object
-    typedef NoiseModelFactor2<CAMERA, LANDMARK> Base;  ///< typedef for the base class
+    typedef FixedNoiseModelFactor2<CAMERA, LANDMARK, 2> Base;  ///< typedef for the base class
+    typedef typename Base::ErrorVector ErrorVector;    ///< 2D reprojection error
+    typedef typename Base::JacobianX1 JacobianX1;      ///< Jacobian with respect to [pose3 calibration]
+    typedef typename Base::JacobianX2 JacobianX2;      ///< Jacobian with respect to the landmark
     typedef Point2 Measurement;              ///< typedef for the measurement
 
     // shorthand for a smart pointer to a factor
@@ -88,20 +91,29 @@ namespace gtsam {
       return e && Base::equals(p, tol) && this->measured_.equals(e->measured_, tol) ;
     }
 
-    /** h(x)-z */
-    Vector evaluateError(const Cam& camera,  const Point3& point,
-        boost::optional<Matrix&> H1=boost::none, boost::optional<Matrix&> H2=boost::none) const {
+    /** h(x)-z, with fixed-size Jacobians */
+    ErrorVector evaluateErrorFixed(const Cam& camera,  const Point3& point,
+        boost::optional<JacobianX1&> H1=boost::none, boost::optional<JacobianX2&> H2=boost::none) const {
 
       try {
-        Point2 reprojError(camera.project2(point,H1,H2) - measured_);
-        return reprojError.vector();
+        if (H1) {
+          Eigen::Matrix<double, 2, 6> Dpose;
+          Eigen::Matrix<double, 2, Base::X1Dim == Eigen::Dynamic ? Eigen::Dynamic : Base::X1Dim - 6> Dcal;
+          Point2 reprojError(camera.projectFixed(point, &Dpose, H2.get_ptr(), &Dcal) - measured_);
+          H1->resize(2, 6 + Dcal.cols());
+          *H1 << Dpose, Dcal;
+          return reprojError.vector();
+        } else {
+          Point2 reprojError(camera.projectFixed(point, 0, H2.get_ptr()) - measured_);
+          return reprojError.vector();
+        }
       }
       catch( CheiralityException& e) {
-        if (H1) *H1 = zeros(2, camera.dim());
-        if (H2) *H2 = zeros(2, point.dim());
+        if (H1) H1->setZero();
+        if (H2) H2->setZero();
         std::cout << e.what() << ": Landmark "<< DefaultKeyFormatter(this->key2())
                               << " behind Camera " << DefaultKeyFormatter(this->key1()) << std::endl;
-        return zero(2);
+        return ErrorVector::Zero();
       }
     }
 
@@ -126,7 +138,7 @@ namespace gtsam {
    * Compared to GeneralSFMFactor, it is a ternary-factor because the calibration is isolated from camera..
    */
   template <class CALIBRATION>
-  class GeneralSFMFactor2: public NoiseModelFactor3<Pose3, Point3, CALIBRATION> {
+  class GeneralSFMFactor2: public FixedNoiseModelFactor3<Pose3, Point3, CALIBRATION, 2> {
   protected:
     Point2 measured_;     ///< the 2D measurement
 
@@ -134,7 +146,11 @@ namespace gtsam {
 
     typedef GeneralSFMFactor2<CALIBRATION> This;
     typedef PinholeCamera<CALIBRATION> Camera;                  ///< typedef for camera type
-    typedef NoiseModelFactor3<Pose3, Point3, CALIBRATION> Base; ///< typedef for the base class
+    typedef FixedNoiseModelFactor3<Pose3, Point3, CALIBRATION, 2> Base; ///< typedef for the base class
+    typedef typename Base::ErrorVector ErrorVector;             ///< 2D reprojection error
+    typedef typename Base::JacobianX1 JacobianX1;               ///< 2*6 Jacobian with respect to the pose
+    typedef typename Base::JacobianX2 JacobianX2;               ///< 2*3 Jacobian with respect to the landmark
+    typedef typename Base::JacobianX3 JacobianX3;               ///< Jacobian with respect to the calibration
     typedef Point2 Measurement;                                 ///< typedef for the measurement
 
     // shorthand for a smart pointer to a factor
@@ -177,25 +193,25 @@ namespace gtsam {
       return e && Base::equals(p, tol) && this->measured_.equals(e->measured_, tol) ;
     }
 
-    /** h(x)-z */
-    Vector evaluateError(const Pose3& pose3, const Point3& point, const CALIBRATION &calib,
-                         boost::optional<Matrix&> H1=boost::none,
-                         boost::optional<Matrix&> H2=boost::none,
-                         boost::optional<Matrix&> H3=boost::none) const
+    /** h(x)-z, with fixed-size Jacobians */
+    ErrorVector evaluateErrorFixed(const Pose3& pose3, const Point3& point, const CALIBRATION &calib,
+                         boost::optional<JacobianX1&> H1=boost::none,
+                         boost::optional<JacobianX2&> H2=boost::none,
+                         boost::optional<JacobianX3&> H3=boost::none) const
     {
       try {
         Camera camera(pose3,calib);
-        Point2 reprojError(camera.project(point, H1, H2, H3) - measured_);
+        Point2 reprojError(camera.projectFixed(point, H1.get_ptr(), H2.get_ptr(), H3.get_ptr()) - measured_);
         return reprojError.vector();
       }
       catch( CheiralityException& e) {
-        if (H1) *H1 = zeros(2, pose3.dim());
-        if (H2) *H2 = zeros(2, point.dim());
-        if (H3) *H3 = zeros(2, calib.dim());
+        if (H1) H1->setZero();
+        if (H2) H2->setZero();
+        if (H3) H3->setZero();
         std::cout << e.what() << ": Landmark "<< DefaultKeyFormatter(this->key2())
                               << " behind Camera " << DefaultKeyFormatter(this->key1()) << std::endl;
       }
-      return zero(2);
+      return ErrorVector::Zero();
     }
 
     /** return the measured */
@@ -20,7 +20,7 @@
 
 #pragma once
 
-#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/FixedNoiseModelFactor.h>
 #include <gtsam/geometry/SimpleCamera.h>
 #include <boost/optional.hpp>
 
@@ -32,7 +32,7 @@ namespace gtsam {
    * @addtogroup SLAM
    */
   template<class POSE, class LANDMARK, class CALIBRATION = Cal3_S2>
-  class GenericProjectionFactor: public NoiseModelFactor2<POSE, LANDMARK> {
+  class GenericProjectionFactor: public FixedNoiseModelFactor2<POSE, LANDMARK, 2> {
   protected:
 
     // Keep a copy of measurement and calibration for I/O
@@ -47,7 +47,11 @@ namespace gtsam {
   public:
 
     /// shorthand for base class type
-    typedef NoiseModelFactor2<POSE, LANDMARK> Base;
+    typedef FixedNoiseModelFactor2<POSE, LANDMARK, 2> Base;
+
+    typedef typename Base::ErrorVector ErrorVector; ///< 2D reprojection error
+    typedef typename Base::JacobianX1 JacobianX1; ///< 2*6 Jacobian with respect to the pose
+    typedef typename Base::JacobianX2 JacobianX2; ///< 2*3 Jacobian with respect to the landmark
 
     /// shorthand for this class
     typedef GenericProjectionFactor<POSE, LANDMARK, CALIBRATION> This;
@@ -124,37 +128,31 @@ namespace gtsam {
           && ((!body_P_sensor_ && !e->body_P_sensor_) || (body_P_sensor_ && e->body_P_sensor_ && body_P_sensor_->equals(*e->body_P_sensor_)));
     }
 
-    /// Evaluate error h(x)-z and optionally derivatives
-    Vector evaluateError(const Pose3& pose, const Point3& point,
-        boost::optional<Matrix&> H1 = boost::none, boost::optional<Matrix&> H2 = boost::none) const {
+    /// Evaluate error h(x)-z and optionally derivatives, with fixed-size Jacobians
+    ErrorVector evaluateErrorFixed(const Pose3& pose, const Point3& point,
+        boost::optional<JacobianX1&> H1 = boost::none, boost::optional<JacobianX2&> H2 = boost::none) const {
       try {
         if(body_P_sensor_) {
-          if(H1) {
-            gtsam::Matrix H0;
-            PinholeCamera<CALIBRATION> camera(pose.compose(*body_P_sensor_, H0), *K_);
-            Point2 reprojectionError(camera.project(point, H1, H2) - measured_);
-            *H1 = *H1 * H0;
-            return reprojectionError.vector();
-          } else {
-            PinholeCamera<CALIBRATION> camera(pose.compose(*body_P_sensor_), *K_);
-            Point2 reprojectionError(camera.project(point, H1, H2) - measured_);
-            return reprojectionError.vector();
-          }
+          PinholeCamera<CALIBRATION> camera(pose.compose(*body_P_sensor_), *K_);
+          Point2 reprojectionError(camera.projectFixed(point, H1.get_ptr(), H2.get_ptr()) - measured_);
+          // chain with the Jacobian of pose.compose(body_P_sensor) with respect to pose
+          if(H1) *H1 = *H1 * body_P_sensor_->inverse().AdjointMap();
+          return reprojectionError.vector();
         } else {
           PinholeCamera<CALIBRATION> camera(pose, *K_);
-          Point2 reprojectionError(camera.project(point, H1, H2) - measured_);
+          Point2 reprojectionError(camera.projectFixed(point, H1.get_ptr(), H2.get_ptr()) - measured_);
           return reprojectionError.vector();
         }
       } catch( CheiralityException& e) {
-        if (H1) *H1 = zeros(2,6);
-        if (H2) *H2 = zeros(2,3);
+        if (H1) H1->setZero();
+        if (H2) H2->setZero();
         if (verboseCheirality_)
           std::cout << e.what() << ": Landmark "<< DefaultKeyFormatter(this->key2()) <<
               " moved behind camera " << DefaultKeyFormatter(this->key1()) << std::endl;
         if (throwCheirality_)
           throw e;
       }
-      return ones(2) * 2.0 * K_->fx();
+      return ErrorVector::Constant(2.0 * K_->fx());
     }
 
     /** return the measurement */
@@ -6,7 +6,13 @@
  */
 
 #include <gtsam/base/numericalDerivative.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/LieVector.h>
+#include <gtsam/geometry/Rot2.h>
 #include <gtsam/geometry/Rot3.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/slam/BetweenFactor.h>
 #include <CppUnitLite/TestHarness.h>
@@ -44,6 +50,42 @@ TEST(BetweenFactor, Rot3) {
   EXPECT(assert_equal(numericalH2,actualH2, 1E-5));
 }
 
+/* ************************************************************************* */
+// Checks that the fixed-size Jacobians of BetweenFactor<T> match those of T::between, and that
+// relinearizing in place gives the same JacobianFactor as linearize()
+template<class T>
+bool fixedMatchesDynamic(const T& p1, const T& p2) {
+  BetweenFactor<T> factor(X(1), X(2), p1.between(p2), Isotropic::Sigma(p1.dim(), 0.05));
+
+  Matrix expectedH1, expectedH2, actualH1, actualH2;
+  p1.between(p2, expectedH1, expectedH2);
+  factor.evaluateError(p1, p2, actualH1, actualH2);
+
+  Values values, values2;
+  values.insert(X(1), p1);
+  values.insert(X(2), p2);
+  values2.insert(X(1), p2);
+  values2.insert(X(2), p1);
+  GaussianFactor::shared_ptr linear = factor.linearize(values);
+  return assert_equal(expectedH1, actualH1, 1e-9) && assert_equal(expectedH2, actualH2, 1e-9)
+      && factor.linearizeInPlace(values2, *linear)
+      && assert_equal(*factor.linearize(values2), *linear, 1e-9);
+}
+
+/* ************************************************************************* */
+TEST(BetweenFactor, FixedJacobians) {
+  EXPECT(fixedMatchesDynamic(Pose3(Rot3::rodriguez(0.1, 0.2, 0.3), Point3(1.0, 2.0, 3.0)),
+      Pose3(Rot3::rodriguez(0.4, 0.5, 0.6), Point3(-1.0, 0.5, 2.0))));
+  EXPECT(fixedMatchesDynamic(Pose2(1.0, 2.0, 0.3), Pose2(-1.0, 0.5, 2.0)));
+  EXPECT(fixedMatchesDynamic(Rot3::rodriguez(0.1, 0.2, 0.3), Rot3::rodriguez(0.4, 0.5, 0.6)));
+  EXPECT(fixedMatchesDynamic(Point3(1.0, 2.0, 3.0), Point3(-1.0, 0.5, 2.0)));
+  EXPECT(fixedMatchesDynamic(Point2(1.0, 2.0), Point2(-1.0, 0.5)));
+
+  // Types without a fixed-size overload go through T::between
+  EXPECT(fixedMatchesDynamic(Rot2(0.3), Rot2(2.0)));
+  EXPECT(fixedMatchesDynamic(LieVector(Vector3(1.0, 2.0, 3.0)), LieVector(Vector3(-1.0, 0.5, 2.0))));
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
@@ -24,6 +24,7 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/linear/VectorValues.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <gtsam/geometry/Cal3_S2.h>
 #include <gtsam/geometry/PinholeCamera.h>
 #include <gtsam/base/Testable.h>
@@ -41,6 +42,7 @@ using namespace gtsam;
 // Convenience for named keys
 using symbol_shorthand::X;
 using symbol_shorthand::L;
+using symbol_shorthand::K;
 
 typedef PinholeCamera<Cal3_S2> GeneralCamera;
 typedef GeneralSFMFactor<GeneralCamera, Point3> Projection;
@@ -430,6 +432,41 @@ TEST(GeneralSFMFactor, CalibratedCameraPoseRange) {
   EXPECT(assert_equal(expected, actual, 1e-4));
 }
 
+/* ************************************************************************* */
+TEST(GeneralSFMFactor, FixedJacobians) {
+  // The fixed-size Jacobians match those of the dynamic-size PinholeCamera::project2/project
+  Point2 z(323.0, 240.0);
+  GeneralCamera camera(Pose3(Rot3::RzRyRx(0.1, -0.05, 0.2), Point3(0.5, 0.2, -6.0)),
+      Cal3_S2(600.0, 580.0, 0.1, 320.0, 240.0));
+  Point3 point(0.3, -0.2, 0.4);
+
+  Projection factor(z, sigma1, X(1), L(1));
+  Matrix H1Expected, H2Expected, H3Expected, H1Actual, H2Actual, H3Actual;
+  Vector expectedError = (camera.project2(point, H1Expected, H2Expected) - z).vector();
+  Vector actualError = factor.evaluateError(camera, point, H1Actual, H2Actual);
+  EXPECT(assert_equal(expectedError, actualError, 1e-9));
+  EXPECT(assert_equal(H1Expected, H1Actual, 1e-9));
+  EXPECT(assert_equal(H2Expected, H2Actual, 1e-9));
+
+  GeneralSFMFactor2<Cal3_S2> factor2(z, sigma1, X(1), L(1), K(1));
+  expectedError = (camera.project(point, H1Expected, H2Expected, H3Expected) - z).vector();
+  actualError = factor2.evaluateError(camera.pose(), point, camera.calibration(), H1Actual, H2Actual, H3Actual);
+  EXPECT(assert_equal(expectedError, actualError, 1e-9));
+  EXPECT(assert_equal(H1Expected, H1Actual, 1e-9));
+  EXPECT(assert_equal(H2Expected, H2Actual, 1e-9));
+  EXPECT(assert_equal(H3Expected, H3Actual, 1e-9));
+
+  // Relinearizing in place gives the same JacobianFactor as linearize()
+  Values values, values2;
+  values.insert(X(1), camera);
+  values.insert(L(1), point);
+  values2.insert(X(1), camera.retract((Vector(11) << 0.01, -0.02, 0.03, 0.1, 0.2, -0.1, 5.0, -3.0, 0.0, 1.0, 2.0)));
+  values2.insert(L(1), Point3(0.1, 0.1, 0.1));
+  GaussianFactor::shared_ptr linear = factor.linearize(values);
+  EXPECT(factor.linearizeInPlace(values2, *linear));
+  EXPECT(assert_equal(*factor.linearize(values2), *linear, 1e-9));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
 /* ************************************************************************* */
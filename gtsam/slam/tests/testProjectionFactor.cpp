@@ -24,6 +24,7 @@
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Point2.h>
 #include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
 #include <CppUnitLite/TestHarness.h>
 
 using namespace std;
@@ -188,6 +189,44 @@ TEST( ProjectionFactor, JacobianWithTransform ) {
   CHECK(assert_equal(H2Expected, H2Actual, 1e-3));
 }
 
+/* ************************************************************************* */
+TEST( ProjectionFactor, FixedJacobians ) {
+  // The fixed-size Jacobians match those of the dynamic-size PinholeCamera::project
+  Point2 measurement(323.0, 240.0);
+  Pose3 body_P_sensor(Rot3::RzRyRx(-M_PI_2, 0.0, -M_PI_2), Point3(0.25, -0.10, 1.0));
+  TestProjectionFactor factor(measurement, model, X(1), L(1), K);
+  TestProjectionFactor factorWithTransform(measurement, model, X(1), L(1), K, body_P_sensor);
+  Pose3 pose(Rot3::RzRyRx(0.1, -0.05, 0.2), Point3(0.5, 0.2, -6.0));
+  Point3 point(0.3, -0.2, 0.4);
+
+  Matrix H1Expected, H2Expected, H1Actual, H2Actual;
+  Vector expectedError = (SimpleCamera(pose, *K).project(point, H1Expected, H2Expected) - measurement).vector();
+  Vector actualError = factor.evaluateError(pose, point, H1Actual, H2Actual);
+  EXPECT(assert_equal(expectedError, actualError, 1e-9));
+  EXPECT(assert_equal(H1Expected, H1Actual, 1e-9));
+  EXPECT(assert_equal(H2Expected, H2Actual, 1e-9));
+
+  Pose3 bodyPose(Rot3::RzRyRx(0.05, 0.1, -0.1), Point3(-6.25, 0.10, -1.0));
+  Matrix H0;
+  SimpleCamera sensor(bodyPose.compose(body_P_sensor, H0), *K);
+  expectedError = (sensor.project(point, H1Expected, H2Expected) - measurement).vector();
+  H1Expected = H1Expected * H0;
+  actualError = factorWithTransform.evaluateError(bodyPose, point, H1Actual, H2Actual);
+  EXPECT(assert_equal(expectedError, actualError, 1e-9));
+  EXPECT(assert_equal(H1Expected, H1Actual, 1e-9));
+  EXPECT(assert_equal(H2Expected, H2Actual, 1e-9));
+
+  // Relinearizing in place gives the same JacobianFactor as linearize()
+  Values values, values2;
+  values.insert(X(1), bodyPose);
+  values.insert(L(1), point);
+  values2.insert(X(1), bodyPose.retract((Vector(6) << 0.01, -0.02, 0.03, 0.1, 0.2, -0.1)));
+  values2.insert(L(1), Point3(0.1, 0.1, 0.1));
+  GaussianFactor::shared_ptr linear = factorWithTransform.linearize(values);
+  EXPECT(factorWithTransform.linearizeInPlace(values2, *linear));
+  EXPECT(assert_equal(*factorWithTransform.linearize(values2), *linear, 1e-9));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
 /* ************************************************************************* */
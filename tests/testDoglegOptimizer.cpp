@@ -116,6 +116,14 @@ TEST(DoglegOptimizer, ComputeDoglegPoint) {
   VectorValues expected3 = gbn.optimize();
   VectorValues actual3 = DoglegOptimizerImpl::ComputeDoglegPoint(Delta3, gbn.optimizeGradientSearch(), gbn.optimize());
   EXPECT(assert_equal(expected3, actual3));
+
+  // Contiguous storage gives the same points
+  FlatVectorValues xn(gbn.optimize());
+  FlatVectorValues xu = FlatVectorValues::Zero(xn);
+  xu.update(gbn.optimizeGradientSearch());
+  EXPECT(assert_equal(FlatVectorValues(actual1), DoglegOptimizerImpl::ComputeDoglegPoint(Delta1, xu, xn)));
+  EXPECT(assert_equal(FlatVectorValues(actual2), DoglegOptimizerImpl::ComputeDoglegPoint(Delta2, xu, xn)));
+  EXPECT(assert_equal(xn, DoglegOptimizerImpl::ComputeDoglegPoint(Delta3, xu, xn)));
 }
 
 /* ************************************************************************* */
@@ -283,6 +283,65 @@ TEST( GaussianBayesTree, balanced_smoother_joint )
   //  EXPECT(assert_equal(expected4,actual4,tol));
 }
 
+/* ************************************************************************* */
+TEST( GaussianBayesTree, balanced_smoother_jointBayesNets )
+{
+  // Same Bayes tree as above
+  Ordering ordering;
+  ordering += X(1),X(3),X(5),X(7),X(2),X(6),X(4);
+  GaussianFactorGraph smoother = createSmoother(7);
+  GaussianBayesTree bayesTree = *smoother.eliminateMultifrontal(ordering);
+
+  // Batched joints agree with one query at a time, in the order of the queries
+  std::vector<std::pair<Key, Key> > pairs;
+  pairs.push_back(std::make_pair(X(1), X(7)));
+  pairs.push_back(std::make_pair(X(1), X(4)));
+  pairs.push_back(std::make_pair(X(2), X(7)));
+  pairs.push_back(std::make_pair(X(1), X(2)));
+  pairs.push_back(std::make_pair(X(3), X(6)));
+  std::vector<GaussianBayesNet::shared_ptr> actual = bayesTree.jointBayesNets(pairs);
+  LONGS_EQUAL(pairs.size(), actual.size());
+  GaussianBayesTree fresh = *smoother.eliminateMultifrontal(ordering);
+  for(size_t i = 0; i < pairs.size(); ++i)
+    EXPECT(assert_equal(*fresh.jointBayesNet(pairs[i].first, pairs[i].second), *actual[i], tol));
+}
+
+/* ************************************************************************* */
+TEST( GaussianBayesTree, shortcutCacheCapacity )
+{
+  Ordering ordering;
+  ordering += X(1),X(3),X(5),X(7),X(2),X(6),X(4);
+  GaussianFactorGraph smoother = createSmoother(7);
+  GaussianBayesTree bayesTree = *smoother.eliminateMultifrontal(ordering);
+
+  // Marginals cached while the cache is unbounded are dropped when bounding it
+  bayesTree.marginalFactor(X(7));
+  EXPECT(bayesTree.numCachedSeparatorMarginals() > 0);
+  bayesTree.setShortcutCacheCapacity(3);
+  EXPECT_LONGS_EQUAL(0, (long)bayesTree.numCachedSeparatorMarginals());
+
+  // Prefetching caches the whole path to the root, here x7, x5 x6, and x3 x2 x4
+  FastVector<Key> keys;
+  keys.push_back(X(7));
+  bayesTree.prefetchShortcuts(keys);
+  EXPECT_LONGS_EQUAL(3, (long)bayesTree.numCachedSeparatorMarginals());
+
+  // Lowering the capacity evicts the least recently used clique, which is the leaf
+  bayesTree.setShortcutCacheCapacity(2);
+  EXPECT_LONGS_EQUAL(2, (long)bayesTree.numCachedSeparatorMarginals());
+  EXPECT(!bayesTree[X(7)]->cachedSeparatorMarginal());
+  EXPECT(bayesTree[X(5)]->cachedSeparatorMarginal());
+
+  // Queries stay within the capacity and give the same marginals
+  GaussianBayesTree unbounded = *smoother.eliminateMultifrontal(ordering);
+  for(size_t j = 1; j <= 7; ++j) {
+    EXPECT(assert_equal(*unbounded.marginalFactor(X(j)), *bayesTree.marginalFactor(X(j)), tol));
+    EXPECT(bayesTree.numCachedSeparatorMarginals() <= 2);
+  }
+  EXPECT(assert_equal(*unbounded.jointBayesNet(X(1), X(7)), *bayesTree.jointBayesNet(X(1), X(7)), tol));
+  EXPECT(bayesTree.numCachedSeparatorMarginals() <= 2);
+}
+
 /* ************************************************************************* */
 TEST(GaussianBayesTree, shortcut_overlapping_separator)
 {
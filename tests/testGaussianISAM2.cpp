@@ -19,6 +19,7 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/Marginals.h>
 #include <gtsam/slam/PriorFactor.h>
 #include <gtsam/slam/BetweenFactor.h>
@@ -644,6 +645,83 @@ TEST(ISAM2, slamlike_solution_partial_relinearization_check)
   CHECK(isam_check(fullgraph, fullinit, isam, *this, result_));
 }
 
+/* ************************************************************************* */
+TEST(ISAM2, slamlike_solution_limited_threads)
+{
+  // These variables will be reused and accumulate factors and values
+  Values fullinit;
+  NonlinearFactorGraph fullgraph;
+  ISAM2Params params(ISAM2GaussNewtonParams(0.001), 0.0, 0, false);
+  params.numThreads = 2;
+  ISAM2 isam = createSlamlikeISAM2(fullinit, fullgraph, params);
+
+  // Compare solutions
+  CHECK(isam_check(fullgraph, fullinit, isam, *this, result_));
+
+  // Limiting the threads does not change the result
+  params.numThreads = 0;
+  ISAM2 unlimited = createSlamlikeISAM2(boost::none, boost::none, params);
+  EXPECT(assert_equal(unlimited.calculateEstimate(), isam.calculateEstimate(), 1e-9));
+
+  // A loop closure re-eliminates the top of the tree, check that the time breakdown of the update is
+  // filled in, and that the phases, which do not overlap, take no more than the whole update
+  NonlinearFactorGraph loopClosure;
+  loopClosure += BetweenFactor<Pose2>(0, 5, fullinit.at<Pose2>(0).between(fullinit.at<Pose2>(5)), odoNoise);
+  ISAM2Result result = isam.update(loopClosure);
+  unlimited.update(loopClosure);
+  EXPECT(assert_equal(unlimited.calculateEstimate(), isam.calculateEstimate(), 1e-9));
+  const ISAM2Result::Timing& timing = result.timing;
+  EXPECT(timing.linearize > 0.0);
+  EXPECT(timing.ordering > 0.0);
+  EXPECT(timing.eliminate > 0.0);
+  EXPECT(timing.updateDelta >= 0.0 && timing.relinearize >= 0.0);
+  EXPECT(timing.updateDelta + timing.relinearize + timing.linearize + timing.ordering
+    + timing.eliminate <= timing.total);
+}
+
+/* ************************************************************************* */
+TEST(ISAM2, relinearize_many)
+{
+  // A pose chain with loop closures that is large enough for all of its factors to be relinearized
+  // in parallel once every variable is relinearized
+  NonlinearFactorGraph graph;
+  Values init;
+  graph += PriorFactor<Pose2>(0, Pose2(), odoNoise);
+  init.insert(0, Pose2(0.01, -0.01, 0.01));
+  for(size_t i = 1; i < 100; ++i) {
+    graph += BetweenFactor<Pose2>(i - 1, i, Pose2(1.0, 0.0, 2.0 * M_PI / 50.0), odoNoise);
+    if(i >= 50)
+      graph += BetweenFactor<Pose2>(i - 50, i, Pose2(), odoNoise);
+    init.insert(i, init.at<Pose2>(i - 1).compose(Pose2(1.05, 0.02, 2.0 * M_PI / 50.0 - 0.01)));
+  }
+
+  ISAM2Params params(ISAM2GaussNewtonParams(0.0), 0.0, 1);
+  EXPECT_LONGS_EQUAL(64, params.parallelRelinearizeThreshold);
+  EXPECT(graph.size() > params.parallelRelinearizeThreshold);
+  ISAM2 isam(params);
+  params.cacheLinearizedFactors = false;
+  params.setParallelRelinearizeThreshold(graph.size() + 1);
+  ISAM2 uncached(params);
+  EXPECT(!uncached.params().equals(isam.params()));
+  params.cacheLinearizedFactors = true;
+  EXPECT(!isam.params().equals(params));
+  params.setParallelRelinearizeThreshold(64);
+  EXPECT(isam.params().equals(params));
+  isam.update(graph, init);
+  uncached.update(graph, init);
+  for(size_t i = 0; i < 5; ++i) {
+    ISAM2Result result = isam.update();
+    EXPECT_LONGS_EQUAL(100, result.variablesRelinearized);
+    uncached.update();
+  }
+
+  // Cached and freshly linearized factors, linearized in parallel and serially respectively, give
+  // the same solution, which is the batch solution
+  Values expected = GaussNewtonOptimizer(graph, init).optimize();
+  EXPECT(assert_equal(uncached.calculateEstimate(), isam.calculateEstimate(), 1e-9));
+  EXPECT(assert_equal(expected, isam.calculateEstimate(), 1e-6));
+}
+
 namespace {
   bool checkMarginalizeLeaves(ISAM2& isam, const FastList<Key>& leafKeys) {
     Matrix expectedAugmentedHessian, expected3AugmentedHessian;
@@ -838,6 +916,42 @@ TEST(ISAM2, marginalCovariance)
   EXPECT(assert_equal(expected, actual));
 }
 
+/* ************************************************************************* */
+TEST(ISAM2, marginalCovarianceCached)
+{
+  // Create isam2 that caches the covariances of cliques
+  ISAM2Params params(ISAM2GaussNewtonParams(0.001), 0.0, 0, false, true);
+  params.cacheMarginals = true;
+  Values fullinit;
+  NonlinearFactorGraph fullgraph;
+  ISAM2 isam = createSlamlikeISAM2(fullinit, fullgraph, params);
+
+  // Querying a variable caches the covariances of its clique and all of its ancestors
+  const ISAM2::sharedClique clique = isam[0];
+  EXPECT(!clique->cachedCovariance());
+  Marginals marginals(isam.getFactorsUnsafe(), isam.getLinearizationPoint());
+  EXPECT(assert_equal(marginals.marginalCovariance(0), isam.marginalCovariance(0), 1e-8));
+  for(ISAM2::sharedClique ancestor = clique; ancestor; ancestor = ancestor->parent())
+    EXPECT(ancestor->cachedCovariance());
+  BOOST_FOREACH(Key key, fullinit.keys()) {
+    EXPECT(assert_equal(marginals.marginalCovariance(key), isam.marginalCovariance(key), 1e-8));
+  }
+
+  // An update discards the cached covariances that changed
+  NonlinearFactorGraph newfactors;
+  newfactors += BetweenFactor<Pose2>(0, 10, Pose2(10.0, 0.0, 0.0), odoNoise);
+  fullgraph.push_back(newfactors);
+  isam.update(newfactors);
+  typedef ISAM2::Nodes::value_type KeyClique;
+  BOOST_FOREACH(const KeyClique& keyClique, isam.nodes()) {
+    EXPECT(!keyClique.second->cachedCovariance());
+  }
+  Marginals updatedMarginals(isam.getFactorsUnsafe(), isam.getLinearizationPoint());
+  BOOST_FOREACH(Key key, fullinit.keys()) {
+    EXPECT(assert_equal(updatedMarginals.marginalCovariance(key), isam.marginalCovariance(key), 1e-8));
+  }
+}
+
 /* ************************************************************************* */
 TEST(ISAM2, calculate_nnz)
 {
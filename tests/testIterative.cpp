@@ -25,6 +25,8 @@
 
 #include <CppUnitLite/TestHarness.h>
 
+#include <boost/foreach.hpp>
+
 using namespace std;
 using namespace gtsam;
 using namespace example;
@@ -81,6 +83,56 @@ TEST( Iterative, conjugateGradientDescent )
   CHECK(assert_equal(expected,actual,1e-2));
 }
 
+/* ************************************************************************* */
+TEST( Iterative, conjugateGradientDescent_parallel )
+{
+  // The PARALLEL kernel gives the iterates of the serial one
+  GaussianFactorGraph fg = createGaussianFactorGraph();
+  VectorValues zero = VectorValues::Zero(fg.optimize());
+  ConjugateGradientParameters parallel(parameters);
+  parallel.setBlasKernel(ConjugateGradientParameters::PARALLEL);
+  LONGS_EQUAL(ConjugateGradientParameters::PARALLEL, parallel.blasKernel());
+  EXPECT(assert_equal(conjugateGradientDescent(fg, zero, parameters),
+    conjugateGradientDescent(fg, zero, parallel), 1e-9));
+  EXPECT(assert_equal(steepestDescent(fg, zero, parameters),
+    steepestDescent(fg, zero, parallel), 1e-9));
+}
+
+/* ************************************************************************* */
+TEST( Iterative, FlatSystem )
+{
+  // The products of the flat system agree with those of the factor graph
+  GaussianFactorGraph fg = createGaussianFactorGraph();
+  VectorValues x = fg.optimize();
+  x.at(X(1)) << 1, 2;
+  FlatSystem Ab(fg, x);
+  FlatVectorValues flatX(Ab.layout());
+  flatX.update(x);
+  EXPECT(assert_equal(FlatVectorValues(fg.gradient(x)), Ab.gradient(flatX)));
+
+  Errors e = fg * x;
+  Vector flatE = Ab * flatX;
+  DenseIndex row = 0;
+  BOOST_FOREACH(const Vector& ei, e) {
+    EXPECT(assert_equal(ei, Vector(flatE.segment(row, ei.size()))));
+    row += ei.size();
+  }
+  LONGS_EQUAL(row, flatE.size());
+
+  VectorValues y = VectorValues::Zero(x);
+  FlatVectorValues flatY(Ab.layout());
+  fg.transposeMultiplyAdd(0.5, e, y);
+  Ab.transposeMultiplyAdd(0.5, flatE, flatY);
+  EXPECT(assert_equal(FlatVectorValues(y), flatY));
+
+  // Variables missing from the initial estimate are added after the others
+  VectorValues partial;
+  partial.insert(L(1), x.at(L(1)));
+  FlatSystem partialAb(fg, partial);
+  EXPECT(L(1) == partialAb.layout()->keys().front());
+  LONGS_EQUAL(3, partialAb.layout()->size());
+}
+
 /* ************************************************************************* */
 TEST( Iterative, conjugateGradientDescent_hard_constraint )
 {
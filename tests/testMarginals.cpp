@@ -237,6 +237,88 @@ TEST(Marginals, order) {
   LONGS_EQUAL(2, (long)joint(101,101).rows());
 }
 
+/* ************************************************************************* */
+TEST(Marginals, batchCovariances) {
+  // A pose chain with loop closures, so that cliques have separators of several variables
+  NonlinearFactorGraph fg;
+  Values vals;
+  fg += PriorFactor<Pose2>(0, Pose2(), noiseModel::Isotropic::Sigma(3, 0.1));
+  vals.insert(0, Pose2());
+  for(Key j = 1; j < 8; ++j) {
+    fg += BetweenFactor<Pose2>(j-1, j, Pose2(1,0,0.3), noiseModel::Diagonal::Sigmas((Vector(3) << 0.2, 0.1, 0.05)));
+    vals.insert(j, Pose2(j, 0.1*j, 0.3*j));
+  }
+  fg += BetweenFactor<Pose2>(0, 5, Pose2(2,1,0.5), noiseModel::Unit::Create(3));
+  fg += BetweenFactor<Pose2>(2, 7, Pose2(1,2,0.5), noiseModel::Unit::Create(3));
+
+  Marginals marginals(fg, vals);
+  const KeyList keyList = vals.keys();
+  const vector<Key> keys(keyList.begin(), keyList.end());
+  const JointMarginal full = marginals.jointMarginalCovariance(keys);
+
+  // Marginal covariances of all variables
+  FastMap<Key, Matrix> covariances = marginals.marginalCovariances();
+  LONGS_EQUAL(8, (long)covariances.size());
+  BOOST_FOREACH(Key j, keys) {
+    EXPECT(assert_equal(marginals.marginalCovariance(j), covariances.at(j), 1e-8));
+  }
+
+  // Joint covariances of the variables of each clique
+  vector<JointMarginal> cliques = marginals.cliqueMarginalCovariances();
+  EXPECT(!cliques.empty());
+  BOOST_FOREACH(const JointMarginal& clique, cliques) {
+    BOOST_FOREACH(Key i, keys) {
+      BOOST_FOREACH(Key j, keys) {
+        try {
+          EXPECT(assert_equal(Matrix(full(i,j)), Matrix(clique(i,j)), 1e-8));
+        } catch(std::out_of_range&) {} // i or j not in this clique
+      }
+    }
+  }
+
+  // Same result with QR
+  Marginals marginalsQR(fg, vals, Marginals::QR);
+  FastMap<Key, Matrix> covariancesQR = marginalsQR.marginalCovariances();
+  BOOST_FOREACH(Key j, keys) {
+    EXPECT(assert_equal(covariances.at(j), covariancesQR.at(j), 1e-8));
+  }
+}
+
+/* ************************************************************************* */
+TEST(Marginals, jointMarginalCovariances) {
+  // A pose chain with loop closures
+  NonlinearFactorGraph fg;
+  Values vals;
+  fg += PriorFactor<Pose2>(0, Pose2(), noiseModel::Isotropic::Sigma(3, 0.1));
+  vals.insert(0, Pose2());
+  for(Key j = 1; j < 10; ++j) {
+    fg += BetweenFactor<Pose2>(j-1, j, Pose2(1,0,0.3), noiseModel::Diagonal::Sigmas((Vector(3) << 0.2, 0.1, 0.05)));
+    vals.insert(j, Pose2(j, 0.1*j, 0.3*j));
+  }
+  fg += BetweenFactor<Pose2>(1, 6, Pose2(2,1,0.5), noiseModel::Unit::Create(3));
+  fg += BetweenFactor<Pose2>(3, 9, Pose2(1,2,0.5), noiseModel::Unit::Create(3));
+
+  // All pairs of variables, in both orders
+  vector<pair<Key, Key> > pairs;
+  for(Key i = 0; i < 10; ++i)
+    for(Key j = 0; j < 10; ++j)
+      if(i != j)
+        pairs.push_back(make_pair(i, j));
+
+  Marginals marginals(fg, vals);
+  vector<JointMarginal> actual = marginals.jointMarginalCovariances(pairs);
+  LONGS_EQUAL(pairs.size(), actual.size());
+  for(size_t k = 0; k < pairs.size(); ++k) {
+    vector<Key> variables;
+    variables.push_back(pairs[k].first);
+    variables.push_back(pairs[k].second);
+    JointMarginal expected = marginals.jointMarginalCovariance(variables);
+    EXPECT(assert_equal(Matrix(expected(pairs[k].first, pairs[k].first)), Matrix(actual[k](pairs[k].first, pairs[k].first)), 1e-8));
+    EXPECT(assert_equal(Matrix(expected(pairs[k].first, pairs[k].second)), Matrix(actual[k](pairs[k].first, pairs[k].second)), 1e-8));
+    EXPECT(assert_equal(Matrix(expected(pairs[k].second, pairs[k].second)), Matrix(actual[k](pairs[k].second, pairs[k].second)), 1e-8));
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -32,6 +32,9 @@
 #include <tests/simulated2D.h>
 #include <gtsam/linear/GaussianFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/FixedNoiseModelFactor.h>
+#include <gtsam/geometry/Point2.h>
+#include <gtsam/geometry/Point3.h>
 #include <gtsam/inference/Symbol.h>
 
 using namespace std;
@@ -282,6 +285,64 @@ TEST(NonlinearFactor, NoiseModelFactor4) {
   EXPECT(assert_equal((Matrix)(Matrix(1, 1) << 1.5), jf.getA(jf.begin()+2)));
   EXPECT(assert_equal((Matrix)(Matrix(1, 1) << 2.0), jf.getA(jf.begin()+3)));
   EXPECT(assert_equal((Vector)(Vector(1) << -5.0), jf.getb()));
+
+  // Relinearize in-place, whitening in the augmented matrix
+  GaussianFactor::shared_ptr actual = tf.linearize(tv);
+  Values tv2;
+  tv2.insert(X(1), LieVector((Vector(1) << -1.0)));
+  tv2.insert(X(2), LieVector((Vector(1) << 0.5)));
+  tv2.insert(X(3), LieVector((Vector(1) << 2.0)));
+  tv2.insert(X(4), LieVector((Vector(1) << 0.0)));
+  EXPECT(tf.linearizeInPlace(tv2, *actual));
+  EXPECT(assert_equal(*tf.linearize(tv2), *actual));
+}
+
+/* ************************************************************************* */
+class TestFixedFactor2 : public FixedNoiseModelFactor2<Point2, Point3, 2> {
+public:
+  typedef FixedNoiseModelFactor2<Point2, Point3, 2> Base;
+  TestFixedFactor2() : Base(noiseModel::Isotropic::Sigma(2, 2.0), X(1), L(1)) {}
+
+  virtual ErrorVector
+    evaluateErrorFixed(const Point2& x1, const Point3& x2,
+        boost::optional<JacobianX1&> H1 = boost::none,
+        boost::optional<JacobianX2&> H2 = boost::none) const {
+    Eigen::Matrix<double, 2, 3> A;
+    A << 1.0, 2.0, 3.0, 4.0, 5.0, 6.0;
+    if(H1) *H1 = Eigen::Matrix2d::Identity();
+    if(H2) *H2 = A;
+    return x1.vector() + A * x2.vector();
+  }
+};
+
+/* ************************************ */
+TEST(NonlinearFactor, FixedNoiseModelFactor2) {
+  LONGS_EQUAL(2, TestFixedFactor2::X1Dim);
+  LONGS_EQUAL(3, TestFixedFactor2::X2Dim);
+  LONGS_EQUAL(Eigen::Dynamic, traits::dimension<LieVector>::value);
+
+  TestFixedFactor2 tf;
+  Values tv;
+  tv.insert(X(1), Point2(1.0, 2.0));
+  tv.insert(L(1), Point3(1.0, 1.0, 1.0));
+  EXPECT(assert_equal((Vector(2) << 7.0, 17.0), tf.unwhitenedError(tv)));
+
+  // The dynamic-size adapter
+  Matrix H1, H2;
+  tf.evaluateError(Point2(1.0, 2.0), Point3(1.0, 1.0, 1.0), H1, H2);
+  EXPECT(assert_equal(eye(2), H1));
+  EXPECT(assert_equal((Matrix(2, 3) << 1.0, 2.0, 3.0, 4.0, 5.0, 6.0), H2));
+
+  JacobianFactor expected(X(1), 0.5 * eye(2), L(1), 0.5 * H2, (Vector(2) << -3.5, -8.5));
+  GaussianFactor::shared_ptr actual = tf.linearize(tv);
+  EXPECT(assert_equal((const GaussianFactor&)expected, *actual));
+
+  // Relinearize in-place at another linearization point
+  Values tv2;
+  tv2.insert(X(1), Point2(0.0, 0.0));
+  tv2.insert(L(1), Point3(1.0, 0.0, 0.0));
+  EXPECT(tf.linearizeInPlace(tv2, *actual));
+  EXPECT(assert_equal(*tf.linearize(tv2), *actual));
 }
 
 /* ************************************************************************* */
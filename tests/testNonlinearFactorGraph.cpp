@@ -23,6 +23,7 @@ using namespace std;
 
 #include <boost/assign/std/list.hpp>
 #include <boost/assign/std/set.hpp>
+#include <boost/foreach.hpp>
 using namespace boost::assign;
 
 #include <CppUnitLite/TestHarness.h>
@@ -34,6 +35,7 @@ using namespace boost::assign;
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/symbolic/SymbolicFactorGraph.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/linear/HessianFactor.h>
 
 using namespace gtsam;
 using namespace example;
@@ -112,6 +114,69 @@ TEST( NonlinearFactorGraph, linearize )
   CHECK(assert_equal(expected,linearized)); // Needs correct linearizations
 }
 
+/* ************************************************************************* */
+TEST( NonlinearFactorGraph, linearizeInPlace )
+{
+  NonlinearFactorGraph fg = createNonlinearFactorGraph();
+  GaussianFactorGraph::shared_ptr previous = fg.linearize(createValues());
+  const GaussianFactorGraph::sharedFactor firstFactor = previous->at(0);
+  const GaussianFactor* secondFactor = previous->at(1).get();
+
+  // Relinearizing overwrites the previous linear factors that are not shared
+  GaussianFactorGraph::shared_ptr actual = fg.linearize(createNoisyValues(), previous);
+  EXPECT(actual == previous);
+  EXPECT(actual->at(0) != firstFactor);
+  EXPECT(actual->at(1).get() == secondFactor);
+  CHECK(assert_equal(createGaussianFactorGraph(), *actual));
+
+  // A shared graph is not modified
+  GaussianFactorGraph::shared_ptr shared = actual;
+  GaussianFactorGraph::shared_ptr fresh = fg.linearize(createValues(), shared);
+  EXPECT(fresh != shared);
+  CHECK(assert_equal(*fg.linearize(createValues()), *fresh));
+  CHECK(assert_equal(createGaussianFactorGraph(), *shared));
+}
+
+/* ************************************************************************* */
+TEST( NonlinearFactorGraph, linearizeInPlaceStorage )
+{
+  // Relinearizing writes into the augmented matrices of the previous JacobianFactors
+  NonlinearFactorGraph fg = createNonlinearFactorGraph();
+  GaussianFactorGraph::shared_ptr linear = fg.linearize(createValues());
+  std::vector<const double*> storage;
+  BOOST_FOREACH(const GaussianFactor::shared_ptr& factor, *linear)
+    storage.push_back(boost::dynamic_pointer_cast<JacobianFactor>(factor)->matrixObject().matrix().data());
+  linear = fg.linearize(createNoisyValues(), linear);
+  linear = fg.linearize(createValues(), linear);
+  linear = fg.linearize(createNoisyValues(), linear);
+  for(size_t i = 0; i < linear->size(); ++i)
+    EXPECT(boost::dynamic_pointer_cast<JacobianFactor>(linear->at(i))->matrixObject().matrix().data() == storage[i]);
+  CHECK(assert_equal(createGaussianFactorGraph(), *linear));
+}
+
+/* ************************************************************************* */
+TEST( NonlinearFactorGraph, linearizeToHessian )
+{
+  NonlinearFactorGraph fg = createNonlinearFactorGraph();
+  GaussianFactorGraph expected = createGaussianFactorGraph();
+  GaussianFactorGraph::shared_ptr actual = fg.linearizeToHessian(createNoisyValues());
+  LONGS_EQUAL(expected.size(), actual->size());
+  for(size_t i = 0; i < expected.size(); ++i) {
+    EXPECT(dynamic_cast<const HessianFactor*>(actual->at(i).get()));
+    EXPECT(assert_equal((const GaussianFactor&)HessianFactor(*expected[i]), *actual->at(i), 1e-9));
+  }
+
+  // Relinearizing overwrites the HessianFactors in place
+  const GaussianFactor* firstFactor = actual->at(0).get();
+  GaussianFactorGraph::shared_ptr relinearized = fg.linearize(createValues(), actual);
+  EXPECT(relinearized == actual);
+  EXPECT(relinearized->at(0).get() == firstFactor);
+  GaussianFactorGraph::shared_ptr jacobians = fg.linearize(createValues());
+  for(size_t i = 0; i < jacobians->size(); ++i)
+    EXPECT(assert_equal((const GaussianFactor&)HessianFactor(*jacobians->at(i)), *relinearized->at(i), 1e-9));
+  EXPECT(assert_equal(jacobians->optimize(), relinearized->optimize(), 1e-9));
+}
+
 /* ************************************************************************* */
 TEST( NonlinearFactorGraph, clone )
 {
@@ -18,6 +18,7 @@
 #include <tests/smallExample.h>
 #include <gtsam/slam/PriorFactor.h>
 #include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/ProjectionFactor.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/inference/Symbol.h>
@@ -26,8 +27,10 @@
 #include <gtsam/nonlinear/DoglegOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianEliminationPlan.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/SimpleCamera.h>
 #include <gtsam/base/Matrix.h>
 
 #include <CppUnitLite/TestHarness.h>
@@ -158,6 +161,8 @@ TEST( NonlinearOptimizer, optimization_method )
   paramsQR.linearSolverType = LevenbergMarquardtParams::MULTIFRONTAL_QR;
   LevenbergMarquardtParams paramsChol;
   paramsChol.linearSolverType = LevenbergMarquardtParams::MULTIFRONTAL_CHOLESKY;
+  LevenbergMarquardtParams paramsCholmod;
+  paramsCholmod.linearSolverType = LevenbergMarquardtParams::CHOLMOD;
 
   NonlinearFactorGraph fg = example::createReallyNonlinearFactorGraph();
 
@@ -170,6 +175,49 @@ TEST( NonlinearOptimizer, optimization_method )
 
   Values actualMFChol = LevenbergMarquardtOptimizer(fg, c0, paramsChol).optimize();
   DOUBLES_EQUAL(0,fg.error(actualMFChol),tol);
+
+  Values actualCholmod = LevenbergMarquardtOptimizer(fg, c0, paramsCholmod).optimize();
+  DOUBLES_EQUAL(0,fg.error(actualCholmod),tol);
+}
+
+/* ************************************************************************* */
+TEST( NonlinearOptimizer, SchurComplement )
+{
+  // Four cameras on a circle looking at eight points, with priors on two cameras
+  Cal3_S2::shared_ptr K(new Cal3_S2(500, 500, 0, 320, 240));
+  const SharedNoiseModel pixel = noiseModel::Isotropic::Sigma(2, 1.0);
+  NonlinearFactorGraph graph;
+  Values truth, initial;
+  for(size_t j = 0; j < 8; ++j) {
+    const Point3 point(cos(0.8 * j), sin(0.8 * j), 0.2 * j - 0.7);
+    truth.insert(L(j), point);
+    initial.insert(L(j), point + Point3(0.1, -0.05, 0.1));
+  }
+  for(size_t i = 0; i < 4; ++i) {
+    const SimpleCamera camera = SimpleCamera::Lookat(
+      Point3(10 * cos(0.5 * i), 10 * sin(0.5 * i), 1.0), Point3(), Point3(0, 0, 1), *K);
+    truth.insert(X(i), camera.pose());
+    initial.insert(X(i), camera.pose().retract((Vector(6) << 0.02, -0.01, 0.01, 0.1, 0.2, -0.1)));
+    for(size_t j = 0; j < 8; ++j)
+      graph += GenericProjectionFactor<Pose3, Point3>(camera.project(truth.at<Point3>(L(j))), pixel, X(i), L(j), K);
+    if(i < 2)
+      graph += PriorFactor<Pose3>(X(i), camera.pose(), noiseModel::Isotropic::Sigma(6, 0.01));
+  }
+
+  // Direct and implicit PCG solves of the reduced camera system converge to the same solution
+  LevenbergMarquardtParams paramsChol, paramsSchur, paramsSchurPCG;
+  paramsChol.linearSolverType = LevenbergMarquardtParams::MULTIFRONTAL_CHOLESKY;
+  paramsSchur.linearSolverType = LevenbergMarquardtParams::SCHUR_COMPLEMENT;
+  paramsSchurPCG.linearSolverType = LevenbergMarquardtParams::SCHUR_COMPLEMENT;
+  boost::shared_ptr<ConjugateGradientParameters> cg(new ConjugateGradientParameters);
+  cg->setEpsilon_rel(1e-10);
+  cg->setEpsilon_abs(1e-20);
+  paramsSchurPCG.iterativeParams = cg;
+
+  const Values expected = LevenbergMarquardtOptimizer(graph, initial, paramsChol).optimize();
+  EXPECT(assert_equal(truth, expected, 1e-5));
+  EXPECT(assert_equal(expected, LevenbergMarquardtOptimizer(graph, initial, paramsSchur).optimize(), 1e-6));
+  EXPECT(assert_equal(expected, LevenbergMarquardtOptimizer(graph, initial, paramsSchurPCG).optimize(), 1e-5));
 }
 
 /* ************************************************************************* */
@@ -340,6 +388,96 @@ TEST_UNSAFE(NonlinearOptimizer, MoreOptimization) {
   }
 }
 
+/* ************************************************************************* */
+TEST(NonlinearOptimizer, assembledDamping) {
+
+  NonlinearFactorGraph fg;
+  fg += PriorFactor<Pose2>(0, Pose2(0, 0, 0),
+      noiseModel::Isotropic::Sigma(3, 1));
+  fg += BetweenFactor<Pose2>(0, 1, Pose2(1, 0, M_PI / 2),
+      noiseModel::Isotropic::Sigma(3, 1));
+  fg += BetweenFactor<Pose2>(1, 2, Pose2(1, 0, M_PI / 2),
+      noiseModel::Isotropic::Sigma(3, 1));
+
+  Values init;
+  init.insert(0, Pose2(3, 4, -M_PI));
+  init.insert(1, Pose2(10, 2, -M_PI));
+  init.insert(2, Pose2(11, 7, -M_PI));
+
+  LevenbergMarquardtParams params;
+  params.setlambdaUpperBound(1e9);
+  for (int diagonal = 0; diagonal < 2; ++diagonal) {
+    params.setDiagonalDamping(diagonal != 0);
+    LevenbergMarquardtParams assembledParams = params;
+    assembledParams.setAssembledDamping(true);
+    LevenbergMarquardtOptimizer expected(fg, init, params);
+    LevenbergMarquardtOptimizer actual(fg, init, assembledParams);
+
+    // The damping diagonal is the diagonal added by the damped system
+    GaussianFactorGraph::shared_ptr linear = fg.linearize(init);
+    VectorValues damping = actual.buildDampingDiagonal(*linear);
+    EXPECT(assert_equal(expected.buildDampedSystem(*linear)->hessianDiagonal(),
+        linear->hessianDiagonal() + damping));
+
+    // Damping the assembled Hessians follows the same lambda trials
+    Values expectedValues = expected.optimize();
+    EXPECT(assert_equal(expectedValues, actual.optimize(), 1e-9));
+    EXPECT_LONGS_EQUAL(expected.iterations(), actual.iterations());
+    EXPECT_LONGS_EQUAL(expected.getInnerIterations(), actual.getInnerIterations());
+    EXPECT_DOUBLES_EQUAL(expected.lambda(), actual.lambda(), 1e-9);
+  }
+}
+
+/* ************************************************************************* */
+namespace {
+  /// Exposes the elimination plan cached by solve()
+  class PlanGaussNewton : public GaussNewtonOptimizer {
+  public:
+    PlanGaussNewton(const NonlinearFactorGraph& graph, const Values& initial, const GaussNewtonParams& params) :
+      GaussNewtonOptimizer(graph, initial, params) {}
+    const GaussianEliminationPlan* plan() const { return eliminationPlan_.get(); }
+  };
+}
+
+/* ************************************************************************* */
+TEST(NonlinearOptimizer, reuseEliminationPlan) {
+
+  NonlinearFactorGraph fg;
+  fg += PriorFactor<Pose2>(0, Pose2(0, 0, 0),
+      noiseModel::Isotropic::Sigma(3, 1));
+  fg += BetweenFactor<Pose2>(0, 1, Pose2(1, 0, M_PI / 2),
+      noiseModel::Isotropic::Sigma(3, 1));
+  fg += BetweenFactor<Pose2>(1, 2, Pose2(1, 0, M_PI / 2),
+      noiseModel::Isotropic::Sigma(3, 1));
+
+  Values init;
+  init.insert(0, Pose2(3, 4, -M_PI));
+  init.insert(1, Pose2(10, 2, -M_PI));
+  init.insert(2, Pose2(11, 7, -M_PI));
+
+  GaussNewtonParams params;
+  EXPECT(!params.reuseEliminationPlan);
+  for (int qr = 0; qr < 2; ++qr) {
+    params.linearSolverType = qr ? NonlinearOptimizerParams::MULTIFRONTAL_QR
+        : NonlinearOptimizerParams::MULTIFRONTAL_CHOLESKY;
+    GaussNewtonParams reuseParams = params;
+    reuseParams.setReuseEliminationPlan(true);
+
+    // The plan is only kept when asked for, and gives the same solution
+    PlanGaussNewton expected(fg, init, params);
+    PlanGaussNewton actual(fg, init, reuseParams);
+    EXPECT(assert_equal(expected.optimize(), actual.optimize(), 1e-9));
+    EXPECT(!expected.plan());
+    EXPECT(actual.plan());
+
+    // Copies build their own plan
+    PlanGaussNewton copy(actual);
+    EXPECT(!copy.plan());
+    copy.iterate();
+    EXPECT(copy.plan() && copy.plan() != actual.plan());
+  }
+}
+
 /* ************************************************************************* */
 TEST(NonlinearOptimizer, MoreOptimizationWithHuber) {
 
@@ -387,6 +525,61 @@ TEST(NonlinearOptimizer, disconnected_graph) {
   EXPECT(assert_equal(expected, LevenbergMarquardtOptimizer(graph, init).optimize()));
 }
 
+/* ************************************************************************* */
+TEST(NonlinearOptimizer, orderingType) {
+  // A pose chain with loop closures
+  NonlinearFactorGraph graph;
+  Values init, expected;
+  graph += PriorFactor<Pose2>(X(0), Pose2(), noiseModel::Isotropic::Sigma(3,1));
+  for(size_t j = 0; j < 30; ++j) {
+    expected.insert(X(j), Pose2(double(j), 0., 0.));
+    init.insert(X(j), Pose2(double(j) + 0.1, 0.2, 0.05));
+    if(j > 0)
+      graph += BetweenFactor<Pose2>(X(j-1), X(j), Pose2(1.,0.,0.), noiseModel::Isotropic::Sigma(3,1));
+    if(j > 5)
+      graph += BetweenFactor<Pose2>(X(j-6), X(j), Pose2(6.,0.,0.), noiseModel::Isotropic::Sigma(3,1));
+  }
+
+  GaussNewtonParams params;
+  EXPECT(params.getOrderingType() == "COLAMD");
+  params.setOrderingType("NESTED_DISSECTION");
+  EXPECT(params.orderingType == GaussNewtonParams::NESTED_DISSECTION);
+  CHECK_EXCEPTION(params.setOrderingType("METIS"), invalid_argument);
+
+  // The ordering is computed when none is given
+  Ordering nestedDissection = Ordering::NestedDissection(graph);
+  GaussNewtonOptimizer optimizer(graph, init, params);
+  EXPECT(assert_equal(nestedDissection, *optimizer.params().ordering));
+  EXPECT(assert_equal(expected, optimizer.optimize(), 1e-6));
+
+  LevenbergMarquardtParams lmParams;
+  lmParams.orderingType = LevenbergMarquardtParams::NESTED_DISSECTION;
+  EXPECT(assert_equal(expected, LevenbergMarquardtOptimizer(graph, init, lmParams).optimize(), 1e-6));
+}
+
+/* ************************************************************************* */
+TEST(NonlinearOptimizer, linearizeToHessian) {
+  NonlinearFactorGraph fg(example::createReallyNonlinearFactorGraph());
+
+  Point2 x0(3,3);
+  Values c0;
+  c0.insert(X(1), x0);
+
+  // The Jacobian path is the default
+  LevenbergMarquardtParams params;
+  EXPECT(!params.getLinearizeToHessian());
+  Values expected = LevenbergMarquardtOptimizer(fg, c0, params).optimize();
+
+  // Opting in to HessianFactors gives the same result with Cholesky
+  params.setLinearizeToHessian(true);
+  EXPECT(assert_equal(expected, LevenbergMarquardtOptimizer(fg, c0, params).optimize(), 1e-9));
+
+  GaussNewtonParams gnParams;
+  Values expectedGN = GaussNewtonOptimizer(fg, c0, gnParams).optimize();
+  gnParams.linearizeToHessian = true;
+  EXPECT(assert_equal(expectedGN, GaussNewtonOptimizer(fg, c0, gnParams).optimize(), 1e-9));
+}
+
 /* ************************************************************************* */
 #include <gtsam/linear/iterative.h>
 
@@ -28,6 +28,7 @@
 #include <gtsam/linear/PCGSolver.h>
 #include <gtsam/linear/Preconditioner.h>
 #include <gtsam/linear/SubgraphPreconditioner.h>
+#include <gtsam/linear/SubgraphSolver.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/inference/Symbol.h>
 #include <gtsam/geometry/Pose2.h>
@@ -149,6 +150,250 @@ TEST( PCGSolver, subgraph )
   DOUBLES_EQUAL(0,fg.error(actualPCG),tol);
 }
 
+/* ************************************************************************* */
+TEST( PCGSolver, incompleteCholesky )
+{
+  LevenbergMarquardtParams paramsPCG;
+  paramsPCG.linearSolverType = LevenbergMarquardtParams::Iterative;
+  PCGSolverParameters::shared_ptr pcg = boost::make_shared<PCGSolverParameters>();
+  pcg->preconditioner_ = boost::make_shared<IncompleteCholeskyPreconditionerParameters>();
+  paramsPCG.iterativeParams = pcg;
+
+  NonlinearFactorGraph fg = example::createReallyNonlinearFactorGraph();
+
+  Point2 x0(10,10);
+  Values c0;
+  c0.insert(X(1), x0);
+
+  Values actualPCG = LevenbergMarquardtOptimizer(fg, c0, paramsPCG).optimize();
+
+  DOUBLES_EQUAL(0,fg.error(actualPCG),tol);
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, incompleteCholeskyChain )
+{
+  /* on a chain in natural order IC(0) has no fill to drop, so it is the exact factorization */
+  GaussianFactorGraph gfg = example::createSmoother(7);
+  KeyInfo keyInfo(gfg);
+  std::map<Key,Vector> lambda;
+  IncompleteCholeskyPreconditioner ic;
+  ic.build(gfg, keyInfo, lambda);
+  DOUBLES_EQUAL(0.0, ic.shift(), 1e-9);
+
+  Vector b = gfg.gradientAtZero().vector(keyInfo.ordering()), x;
+  ic.fullSolve(b, x);
+  Matrix H = gfg.hessian(keyInfo.ordering()).first;
+  EXPECT(assert_equal(b, H * x, 1e-6));
+
+  /* threshold IC on a grid keeps some fill, and PCG converges to the direct solution */
+  GaussianFactorGraph grid = example::planarGraph(5).get<0>();
+  KeyInfo gridInfo(grid);
+  PCGSolverParameters parameters;
+  parameters.setEpsilon_rel(1e-9);
+  parameters.setEpsilon_abs(1e-12);
+  parameters.preconditioner_ = boost::make_shared<IncompleteCholeskyPreconditionerParameters>(1e-4);
+  PCGSolver solver(parameters);
+  VectorValues actual = solver.optimize(grid, gridInfo, lambda, gridInfo.x0());
+  EXPECT(assert_equal(grid.optimize(), actual, 1e-5));
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, multilevel )
+{
+  LevenbergMarquardtParams paramsPCG;
+  paramsPCG.linearSolverType = LevenbergMarquardtParams::Iterative;
+  PCGSolverParameters::shared_ptr pcg = boost::make_shared<PCGSolverParameters>();
+  pcg->preconditioner_ = boost::make_shared<MultilevelPreconditionerParameters>();
+  paramsPCG.iterativeParams = pcg;
+
+  NonlinearFactorGraph fg = example::createReallyNonlinearFactorGraph();
+
+  Point2 x0(10,10);
+  Values c0;
+  c0.insert(X(1), x0);
+
+  Values actualPCG = LevenbergMarquardtOptimizer(fg, c0, paramsPCG).optimize();
+
+  DOUBLES_EQUAL(0,fg.error(actualPCG),tol);
+
+  /* coarsen a grid, and solve it with PCG */
+  GaussianFactorGraph grid = example::planarGraph(8).get<0>();
+  KeyInfo keyInfo(grid);
+  std::map<Key,Vector> lambda;
+  MultilevelPreconditionerParameters multilevel;
+  multilevel.maxCoarseDim_ = 20;
+  MultilevelPreconditioner preconditioner(multilevel);
+  preconditioner.build(grid, keyInfo, lambda);
+  CHECK(preconditioner.nrLevels() > 1);
+  CHECK(preconditioner.nrVariables(1) < preconditioner.nrVariables(0));
+
+  /* refreshing the same system keeps the levels and gives the same preconditioner */
+  const size_t nrLevels = preconditioner.nrLevels();
+  Vector b = keyInfo.x0vector(), expected, actual;
+  b.setOnes();
+  preconditioner.fullSolve(b, expected);
+  preconditioner.refresh(grid, keyInfo, lambda);
+  preconditioner.fullSolve(b, actual);
+  LONGS_EQUAL(nrLevels, preconditioner.nrLevels());
+  EXPECT(assert_equal(expected, actual, 1e-9));
+
+  PCGSolverParameters parameters;
+  parameters.setEpsilon_rel(1e-9);
+  parameters.setEpsilon_abs(1e-12);
+  parameters.preconditioner_ = boost::make_shared<MultilevelPreconditionerParameters>(multilevel);
+  PCGSolver solver(parameters);
+  EXPECT(assert_equal(grid.optimize(), solver.optimize(grid, keyInfo, lambda, keyInfo.x0()), 1e-5));
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, reuse )
+{
+  /* refresh the numeric values of the subgraph preconditioner every other call */
+  GaussianFactorGraph grid = example::planarGraph(5).get<0>();
+  KeyInfo keyInfo(grid);
+  std::map<Key,Vector> lambda;
+  PCGSolverParameters parameters;
+  parameters.setEpsilon_rel(1e-9);
+  parameters.setEpsilon_abs(1e-12);
+  parameters.preconditioner_ = boost::make_shared<SubgraphPreconditionerParameters>();
+  parameters.reuseStructure_ = true;
+  parameters.refreshInterval_ = 2;
+  PCGSolver solver(parameters);
+  const VectorValues expected = grid.optimize();
+  for ( size_t i = 0 ; i < 5 ; ++i )
+    EXPECT(assert_equal(expected, solver.optimize(grid, keyInfo, lambda, keyInfo.x0()), 1e-5));
+  LONGS_EQUAL(5, solver.nrSolves());
+  LONGS_EQUAL(1, solver.nrBuilds());
+  LONGS_EQUAL(2, solver.nrRefreshes());
+  LONGS_EQUAL(1, solver.nrCompiles());
+
+  /* a system with a different structure needs a new preconditioner */
+  GaussianFactorGraph smaller = example::planarGraph(4).get<0>();
+  KeyInfo smallerInfo(smaller);
+  EXPECT(assert_equal(smaller.optimize(), solver.optimize(smaller, smallerInfo, lambda, smallerInfo.x0()), 1e-5));
+  LONGS_EQUAL(2, solver.nrBuilds());
+  LONGS_EQUAL(2, solver.nrCompiles());
+
+  /* keep the preconditioner of the first linearization for all iterations of LM */
+  LevenbergMarquardtParams paramsPCG;
+  paramsPCG.linearSolverType = LevenbergMarquardtParams::Iterative;
+  PCGSolverParameters::shared_ptr pcg = boost::make_shared<PCGSolverParameters>();
+  pcg->preconditioner_ = boost::make_shared<BlockJacobiPreconditionerParameters>();
+  pcg->refreshInterval_ = 0;
+  paramsPCG.iterativeParams = pcg;
+
+  NonlinearFactorGraph fg = example::createReallyNonlinearFactorGraph();
+  Values c0;
+  c0.insert(X(1), Point2(10,10));
+  LevenbergMarquardtOptimizer optimizer(fg, c0, paramsPCG);
+  DOUBLES_EQUAL(0, fg.error(optimizer.optimize()), tol);
+  CHECK(optimizer.pcgSolver());
+  CHECK(optimizer.pcgSolver()->nrSolves() > 1);
+  LONGS_EQUAL(1, optimizer.pcgSolver()->nrBuilds());
+  LONGS_EQUAL(0, optimizer.pcgSolver()->nrRefreshes());
+  LONGS_EQUAL(1, optimizer.pcgSolver()->nrCompiles());
+}
+
+/* ************************************************************************* */
+namespace {
+  /* a loop of poses with a chord, and an initial estimate perturbed from the solution */
+  NonlinearFactorGraph createPoseLoop(Values &initial) {
+    NonlinearFactorGraph graph;
+    const noiseModel::Diagonal::shared_ptr model = noiseModel::Diagonal::Sigmas((Vector(3) << 0.2, 0.2, 0.1));
+    graph.add(PriorFactor<Pose2>(0, Pose2(), noiseModel::Isotropic::Sigma(3, 1e-3)));
+    vector<Pose2> poses(1, Pose2());
+    for ( size_t i = 1 ; i < 8 ; ++i )
+      poses.push_back(poses.back() * Pose2(1.0, 0.0, M_PI / 4));
+    for ( size_t i = 0 ; i < 8 ; ++i ) {
+      graph.add(BetweenFactor<Pose2>(i, (i + 1) % 8, poses[i].between(poses[(i + 1) % 8]), model));
+      initial.insert(i, poses[i].retract((Vector(3) << 0.3 * sin(i), 0.3 * cos(i), 0.2 * sin(2.0 * i))));
+    }
+    graph.add(BetweenFactor<Pose2>(0, 4, poses[0].between(poses[4]), model));
+    return graph;
+  }
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, inexactNewton )
+{
+  Values initial;
+  const NonlinearFactorGraph graph = createPoseLoop(initial);
+  const Values expected = GaussNewtonOptimizer(graph, initial).optimize();
+
+  /* exact solves as a reference for the number of CG iterations */
+  LevenbergMarquardtParams params;
+  params.linearSolverType = LevenbergMarquardtParams::Iterative;
+  params.relativeErrorTol = 1e-10;
+  PCGSolverParameters::shared_ptr pcg = boost::make_shared<PCGSolverParameters>();
+  pcg->preconditioner_ = boost::make_shared<BlockJacobiPreconditionerParameters>();
+  pcg->setEpsilon_rel(1e-6);
+  pcg->setEpsilon_abs(1e-12);
+  params.iterativeParams = pcg;
+  LevenbergMarquardtOptimizer exact(graph, initial, params);
+  EXPECT(assert_equal(expected, exact.optimize(), 1e-5));
+
+  /* loose solves far from the solution, warm started from the last step */
+  PCGSolverParameters::shared_ptr inexact = boost::make_shared<PCGSolverParameters>(*pcg);
+  inexact->warmStart_ = true;
+  inexact->inexactNewton_ = true;
+  params.iterativeParams = inexact;
+  LevenbergMarquardtOptimizer optimizer(graph, initial, params);
+  EXPECT(assert_equal(expected, optimizer.optimize(), 1e-5));
+  CHECK(optimizer.pcgSolver()->nrIterations() / optimizer.pcgSolver()->nrSolves() <
+        exact.pcgSolver()->nrIterations() / exact.pcgSolver()->nrSolves());
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, steihaug )
+{
+  GaussianFactorGraph grid = example::planarGraph(5).get<0>();
+  KeyInfo keyInfo(grid);
+  std::map<Key,Vector> lambda;
+  PCGSolverParameters parameters;
+  parameters.setEpsilon_rel(1e-9);
+  parameters.setEpsilon_abs(1e-12);
+  parameters.preconditioner_ = boost::make_shared<DummyPreconditionerParameters>();
+  PCGSolver solver(parameters);
+
+  /* a trust region containing the Newton step does not truncate CG */
+  const VectorValues expected = grid.optimize();
+  double stepNorm;
+  EXPECT(assert_equal(expected, solver.optimizeTrustRegion(grid, keyInfo, lambda, 1e3, stepNorm), 1e-5));
+  DOUBLES_EQUAL(expected.norm(), stepNorm, 1e-5);
+
+  /* a small trust region gives a step on its boundary, which decreases the error */
+  const VectorValues step = solver.optimizeTrustRegion(grid, keyInfo, lambda, 0.1, stepNorm);
+  DOUBLES_EQUAL(0.1, stepNorm, 1e-9);
+  DOUBLES_EQUAL(0.1, step.norm(), 1e-9);
+  CHECK(grid.error(step) < grid.error(keyInfo.x0()));
+}
+
+/* ************************************************************************* */
+TEST( PCGSolver, doglegSteihaug )
+{
+  Values initial;
+  const NonlinearFactorGraph graph = createPoseLoop(initial);
+  const Values expected = GaussNewtonOptimizer(graph, initial).optimize();
+
+  DoglegParams params;
+  params.linearSolverType = DoglegParams::Iterative;
+  params.relativeErrorTol = 1e-10;
+  PCGSolverParameters::shared_ptr pcg = boost::make_shared<PCGSolverParameters>();
+  pcg->preconditioner_ = boost::make_shared<BlockJacobiPreconditionerParameters>();
+  pcg->setEpsilon_rel(1e-10);
+  pcg->setEpsilon_abs(0.0);
+  params.iterativeParams = pcg;
+  DoglegOptimizer optimizer(graph, initial, params);
+  EXPECT(assert_equal(expected, optimizer.optimize(), 1e-5));
+  CHECK(optimizer.pcgSolver()->nrSolves() > 1);
+
+  /* other iterative solvers are not supported */
+  params.iterativeParams = boost::make_shared<SubgraphSolverParameters>();
+  DoglegOptimizer subgraph(graph, initial, params);
+  CHECK_EXCEPTION(subgraph.iterate(), runtime_error);
+}
+
 /* ************************************************************************* */
 int main() {
   TestResult tr;
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    timePCGPreconditioners.cpp
+ * @brief   Compare the iterations and time of PCG with the available preconditioners
+ */
+
+#include <gtsam/slam/dataset.h>
+#include <gtsam/slam/PriorFactor.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/linear/PCGSolver.h>
+#include <gtsam/linear/Preconditioner.h>
+#include <gtsam/base/timing.h>
+
+#include <boost/foreach.hpp>
+
+#include <iostream>
+
+using namespace std;
+using namespace gtsam;
+
+/* ************************************************************************* */
+// Solve the linearized problem with PCG, which prints the number of iterations
+void solve(const GaussianFactorGraph& gfg, const KeyInfo& keyInfo,
+    const boost::shared_ptr<PreconditionerParameters>& preconditioner) {
+  PCGSolverParameters parameters;
+  parameters.verbosity_ = PCGSolverParameters::COMPLEXITY;
+  parameters.setMaxIterations(2000);
+  parameters.setReset(2001);
+  parameters.setEpsilon_rel(1e-6);
+  parameters.setEpsilon_abs(0.0);
+  parameters.preconditioner_ = preconditioner;
+  PCGSolver solver(parameters);
+  solver.optimize(gfg, keyInfo, map<Key, Vector>(), keyInfo.x0());
+}
+
+/* ************************************************************************* */
+void timePreconditioners(const GaussianFactorGraph& gfg) {
+  const KeyInfo keyInfo(gfg);
+  cout << keyInfo.size() << " variables, dimension " << keyInfo.numCols() << endl;
+
+  { gttic_(blockJacobi);
+    cout << "block Jacobi" << endl;
+    solve(gfg, keyInfo, boost::make_shared<BlockJacobiPreconditionerParameters>()); }
+  { gttic_(incompleteCholesky0);
+    cout << "IC(0)" << endl;
+    solve(gfg, keyInfo, boost::make_shared<IncompleteCholeskyPreconditionerParameters>()); }
+  { gttic_(incompleteCholeskyThreshold);
+    cout << "threshold IC, drop tolerance 1e-3" << endl;
+    solve(gfg, keyInfo, boost::make_shared<IncompleteCholeskyPreconditionerParameters>(1e-3)); }
+  { gttic_(multilevel);
+    cout << "multilevel" << endl;
+    solve(gfg, keyInfo, boost::make_shared<MultilevelPreconditionerParameters>()); }
+}
+
+/* ************************************************************************* */
+int main(int argc, char *argv[]) {
+
+  // 2D pose graph, linearized at the initial estimate of the dataset
+  {
+    NonlinearFactorGraph::shared_ptr graph;
+    Values::shared_ptr initial;
+    boost::tie(graph, initial) = load2D(findExampleDataFile("w100.graph"));
+    graph->add(PriorFactor<Pose2>(0, Pose2(), noiseModel::Isotropic::Sigma(3, 1e-3)));
+    GaussianFactorGraph::shared_ptr gfg = graph->linearize(*initial);
+
+    cout << "w100.graph: ";
+    gttic_(w100);
+    timePreconditioners(*gfg);
+  }
+
+  // Larger 2D pose graph without initial estimate, linearized at the identity
+  {
+    NonlinearFactorGraph::shared_ptr graph;
+    boost::tie(graph, boost::tuples::ignore) = load2D(findExampleDataFile("w20000.txt"));
+    graph->add(PriorFactor<Pose2>(0, Pose2(), noiseModel::Isotropic::Sigma(3, 1e-3)));
+    Values identity;
+    BOOST_FOREACH(Key key, graph->keys())
+      identity.insert(key, Pose2());
+    GaussianFactorGraph::shared_ptr gfg = graph->linearize(identity);
+
+    cout << "w20000.txt: ";
+    gttic_(w20000);
+    timePreconditioners(*gfg);
+  }
+
+  tictoc_finishedIteration_();
+  tictoc_print_();
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+
+ * GTSAM Copyright 2010, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * Authors: Frank Dellaert, et al. (see THANKS for the full author list)
+
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file    timeiSAM2BackSubstitution.cpp
+ * @brief   Times the (parallel) back-substitution of iSAM2 on a large pose graph, for an
+ *          increasing number of threads
+ */
+
+#include <gtsam/base/timing.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/slam/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/nonlinear/ISAM2.h>
+
+#include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#ifdef GTSAM_USE_TBB
+#include <tbb/task_scheduler_init.h>
+#endif
+
+using namespace std;
+using namespace gtsam;
+
+typedef Pose2 Pose;
+
+noiseModel::Unit::shared_ptr model = noiseModel::Unit::Create(Pose::Dim());
+
+int main(int argc, char *argv[]) {
+
+  const size_t steps = 100000;
+  const size_t loopClosureInterval = 100;
+  const size_t trials = 10;
+
+  // Build a long chain with random loop closures, so that the Bayes tree is wide and deep
+  cout << "Creating " << steps << "-pose graph..." << endl;
+  boost::mt19937 rng(42);
+  NonlinearFactorGraph graph;
+  Values initial;
+  graph.add(PriorFactor<Pose>(0, Pose(), model));
+  initial.insert(0, Pose());
+  for(size_t step = 1; step < steps; ++step) {
+    Vector eta = Vector::Random(Pose::Dim()) * 0.1;
+    Pose between = Pose().retract(eta);
+    graph.add(BetweenFactor<Pose>(step-1, step, between, model));
+    initial.insert(step, initial.at<Pose>(step-1) * between);
+    if(step % loopClosureInterval == 0) {
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<size_t> > other(rng, boost::uniform_int<size_t>(0, step-2));
+      graph.add(BetweenFactor<Pose>(other(), step, Pose(), model));
+    }
+  }
+
+  // Eliminate once
+  cout << "Eliminating..." << endl;
+  ISAM2 isam2(ISAM2Params(ISAM2GaussNewtonParams(0.0)));
+  isam2.update(graph, initial);
+
+#ifdef GTSAM_USE_TBB
+  const int maxThreads = tbb::task_scheduler_init::default_num_threads();
+#else
+  const int maxThreads = 1;
+  cout << "GTSAM is compiled without TBB, the back-substitution runs single-threaded" << endl;
+#endif
+
+  // Time full back-substitution (wildfire threshold of zero) for each number of threads
+  VectorValues delta = isam2.getDelta();
+  double singleThreadTime = 0.0;
+  for(int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+#ifdef GTSAM_USE_TBB
+    tbb::task_scheduler_init init(nThreads);
+#endif
+    tictoc_reset_();
+    for(size_t trial = 0; trial < trials; ++trial) {
+      gttic_(Back_substitution);
+      ISAM2::Impl::UpdateGaussNewtonDelta(isam2.roots(), FastSet<Key>(), delta, 0.0);
+      gttoc_(Back_substitution);
+      tictoc_finishedIteration_();
+    }
+    tictoc_getNode(node, Back_substitution);
+    const double time = node->wall() / double(trials);
+    if(nThreads == 1)
+      singleThreadTime = time;
+    cout << nThreads << " threads: " << time << " s per back-substitution, speedup "
+      << singleThreadTime / time << endl;
+  }
+
+  // Time wildfire back-substitution (non-zero threshold) starting from a stale delta, and check
+  // that the result matches the serial optimizeWildfireNonRecursive
+  const double wildfireThreshold = 0.001;
+  FastSet<Key> replacedKeys;
+  for(size_t step = steps - loopClosureInterval; step < steps; ++step)
+    replacedKeys.insert(step);
+  VectorValues staleDelta = isam2.getDelta();
+  staleDelta.setZero();
+  VectorValues expectedDelta = staleDelta;
+  size_t expectedCount = 0;
+  BOOST_FOREACH(const ISAM2::sharedClique& root, isam2.roots())
+    expectedCount += optimizeWildfireNonRecursive(root, wildfireThreshold, replacedKeys, expectedDelta);
+  cout << "Wildfire with threshold " << wildfireThreshold << " recalculates " << expectedCount
+    << " of " << staleDelta.size() << " variables" << endl;
+
+  singleThreadTime = 0.0;
+  for(int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+#ifdef GTSAM_USE_TBB
+    tbb::task_scheduler_init init(nThreads);
+#endif
+    tictoc_reset_();
+    size_t count = 0;
+    for(size_t trial = 0; trial < trials; ++trial) {
+      delta = staleDelta;
+      gttic_(Wildfire_back_substitution);
+      count = ISAM2::Impl::UpdateGaussNewtonDelta(isam2.roots(), replacedKeys, delta, wildfireThreshold);
+      gttoc_(Wildfire_back_substitution);
+      tictoc_finishedIteration_();
+    }
+    if(count != expectedCount || !delta.equals(expectedDelta, 1e-9)) {
+      cout << nThreads << " threads: wildfire result differs from the serial back-substitution" << endl;
+      return 1;
+    }
+    tictoc_getNode(node, Wildfire_back_substitution);
+    const double time = node->wall() / double(trials);
+    if(nThreads == 1)
+      singleThreadTime = time;
+    cout << nThreads << " threads: " << time << " s per wildfire back-substitution, speedup "
+      << singleThreadTime / time << endl;
+  }
+
+  return 0;
+}